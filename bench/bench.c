@@ -0,0 +1,1743 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup bench Variable Message Generator Benchmark
+ * @brief Load generator and benchmark for the variable message generator
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file bench.c
+
+    Variable Message Generator Benchmark
+
+    The varmsg benchmark runs the complete variable message generator
+    in-process against a mock variable server (see varmock.c), and
+    measures its performance under a synthetic load.
+
+    For each sink type being measured, the benchmark forks a child
+    process which creates N variables of mixed types and M message
+    configurations, starts the message generator on a thread, and then
+    drives it with trigger notifications at a fixed rate, or lets the
+    interval timers drive it, while it updates the values of the
+    variables.  The child reports the message rate, the median and
+    99th percentile render latency, the read and write system calls
+    per message and the output byte rate, which are taken from the
+    status and statistics variables published by the generator and
+    from /proc/self/io.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <mqueue.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <varserver/varserver.h>
+#include "shmring.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! maximum number of histogram buckets read from /varmsg/stats */
+#define BENCH_HIST_BUCKETS      ( 64 )
+
+/*! size of the /varmsg/stats value buffer */
+#define BENCH_STATS_SIZE        ( 1024 )
+
+/*! length of the string variable values */
+#define BENCH_STR_LEN           ( 32 )
+
+/*! time the generator takes to publish its counters (milliseconds) */
+#define BENCH_SETTLE_MS         ( 1200 )
+
+/*! time to wait for the generator to start (milliseconds) */
+#define BENCH_START_TIMEOUT_MS  ( 5000 )
+
+/*! maximum length of a file, variable or object name */
+#define BENCH_NAME_LEN          ( 256 )
+
+/*! first local port used for the udp sink */
+#define BENCH_UDP_PORT          ( 40000 )
+
+/*! number of local ports used for the udp sink */
+#define BENCH_UDP_PORTS         ( 20000 )
+
+/*! The BenchConfig object holds the benchmark parameters */
+typedef struct _benchConfig
+{
+    /*! number of synthetic body variables */
+    size_t numVars;
+
+    /*! number of message configurations */
+    size_t numConfigs;
+
+    /*! duration of the load in seconds */
+    unsigned int seconds;
+
+    /*! trigger (or variable update) rate per second, 0 for no limit */
+    unsigned int rate;
+
+    /*! message interval in milliseconds, 0 for triggered messages */
+    unsigned int interval_ms;
+
+    /*! number of variables updated before each trigger */
+    size_t updates;
+
+    /*! true if every message contains all of the variables */
+    bool all;
+
+    /*! message format */
+    char *format;
+
+    /*! comma separated list of sink types to measure */
+    char *sinks;
+
+    /*! number of render worker threads */
+    char *workers;
+
+    /*! output queue depth */
+    char *depth;
+
+    /*! process identifier of the benchmark, used to name the outputs */
+    pid_t pid;
+
+    /*! configuration directory */
+    char dir[BENCH_NAME_LEN];
+
+} BenchConfig;
+
+/*! The BenchResult object holds the measurements for one sink type */
+typedef struct _benchResult
+{
+    /*! true if the measurement succeeded */
+    bool ok;
+
+    /*! number of messages generated */
+    uint64_t messages;
+
+    /*! messages generated per second */
+    double msgRate;
+
+    /*! median render latency in microseconds */
+    double p50;
+
+    /*! 99th percentile render latency in microseconds */
+    double p99;
+
+    /*! read and write system calls per message */
+    double rwPerMsg;
+
+    /*! output bytes per second */
+    double byteRate;
+
+} BenchResult;
+
+/*! The BenchCounters object is a snapshot of the generator counters */
+typedef struct _benchCounters
+{
+    /*! total number of messages generated */
+    uint64_t messages;
+
+    /*! total number of output bytes */
+    uint64_t bytes;
+
+    /*! total number of read and write system calls */
+    uint64_t rwcalls;
+
+    /*! render latency histogram */
+    uint64_t hist[BENCH_HIST_BUCKETS];
+
+} BenchCounters;
+
+/*! The BenchVar object is a synthetic variable */
+typedef struct _benchVar
+{
+    /*! handle of the variable */
+    VAR_HANDLE hVar;
+
+    /*! type of the variable */
+    VarType type;
+
+} BenchVar;
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! types of the synthetic variables, used in rotation */
+static const VarType varTypes[] =
+{
+    VARTYPE_UINT16,
+    VARTYPE_INT16,
+    VARTYPE_UINT32,
+    VARTYPE_INT32,
+    VARTYPE_UINT64,
+    VARTYPE_INT64,
+    VARTYPE_FLOAT,
+    VARTYPE_STR
+};
+
+/*! sink types which can be measured */
+static const char *sinkTypes[] =
+{
+    "stdout",
+    "file",
+    "mqueue",
+    "shm",
+    "udp"
+};
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int VARMSG_Main( int argc, char **argv );
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static void usage( char *cmdname );
+static int ProcessOptions( int argC, char *argV[], BenchConfig *pConfig );
+static int RunSink( BenchConfig *pConfig,
+                    const char *sink,
+                    BenchResult *pResult );
+static void RunChild( BenchConfig *pConfig, const char *sink, int fd );
+static void Measure( BenchConfig *pConfig,
+                     VARSERVER_HANDLE hVarServer,
+                     BenchCounters *pStart,
+                     uint64_t startTime,
+                     BenchResult *pResult );
+static int CreateVars( BenchConfig *pConfig,
+                       VARSERVER_HANDLE hVarServer,
+                       BenchVar **ppVars,
+                       VAR_HANDLE *phTrigger );
+static int WriteConfigs( BenchConfig *pConfig,
+                         const char *sink,
+                         const char *output );
+static void RemoveConfigs( BenchConfig *pConfig );
+static int StartGenerator( BenchConfig *pConfig, pthread_t *pThread );
+static void *GeneratorThread( void *arg );
+static void *DrainQueue( void *arg );
+static void *DrainRing( void *arg );
+static void *DrainSocket( void *arg );
+static int WaitStarted( BenchConfig *pConfig, VARSERVER_HANDLE hVarServer );
+static void DriveLoad( BenchConfig *pConfig,
+                       VARSERVER_HANDLE hVarServer,
+                       BenchVar *pVars,
+                       VAR_HANDLE hTrigger );
+static void SetValue( VARSERVER_HANDLE hVarServer,
+                      BenchVar *pVar,
+                      uint32_t n );
+static void GetCounters( BenchConfig *pConfig,
+                         VARSERVER_HANDLE hVarServer,
+                         BenchCounters *pCounters );
+static uint64_t GetCounter( VARSERVER_HANDLE hVarServer,
+                            const char *name,
+                            size_t idx );
+static uint64_t GetRWCalls( void );
+static void ParseHist( const char *str, const char *key, uint64_t *pHist );
+static double Percentile( uint64_t *pHist, double q );
+static uint64_t GetTimeMs( void );
+static void SleepMs( unsigned int ms );
+static void OutputName( BenchConfig *pConfig,
+                        const char *sink,
+                        char *name,
+                        size_t len );
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  main                                                                      */
+/*!
+    Main entry point for the varmsg benchmark
+
+    The main function measures the performance of the variable message
+    generator for each of the requested sink types, and prints a line
+    of results for each one.
+
+    @param[in]
+        argc
+            number of arguments on the command line
+            (including the command itself)
+
+    @param[in]
+        argv
+            array of pointers to the command line arguments
+
+    @retval 0 all of the measurements succeeded
+    @retval 1 a measurement failed
+
+==============================================================================*/
+int main( int argc, char **argv )
+{
+    BenchConfig config;
+    BenchResult result;
+    char *sinks;
+    char *sink;
+    char *save = NULL;
+    int rc = EOK;
+
+    memset( &config, 0, sizeof( BenchConfig ) );
+    config.numVars = 1000;
+    config.numConfigs = 10;
+    config.seconds = 5;
+    config.rate = 1000;
+    config.updates = 10;
+    config.format = "json";
+    config.sinks = "stdout,file,mqueue,shm";
+    config.workers = "0";
+    config.depth = "0";
+    config.pid = getpid();
+
+    rc = ProcessOptions( argc, argv, &config );
+    if ( rc == EOK )
+    {
+        printf( "%zu variables, %zu messages, %us, %s\n",
+                config.numVars,
+                config.numConfigs,
+                config.seconds,
+                ( config.interval_ms != 0 ) ? "interval" : "triggered" );
+        printf( "%-8s %12s %10s %10s %10s %14s\n",
+                "sink",
+                "msgs/s",
+                "p50_us",
+                "p99_us",
+                "rw/msg",
+                "bytes/s" );
+
+        sinks = strdup( config.sinks );
+        sink = ( sinks != NULL ) ? strtok_r( sinks, ",", &save ) : NULL;
+        while ( sink != NULL )
+        {
+            if ( RunSink( &config, sink, &result ) == EOK )
+            {
+                printf( "%-8s %12.1f %10.1f %10.1f %10.2f %14.0f\n",
+                        sink,
+                        result.msgRate,
+                        result.p50,
+                        result.p99,
+                        result.rwPerMsg,
+                        result.byteRate );
+            }
+            else
+            {
+                printf( "%-8s failed\n", sink );
+                rc = EIO;
+            }
+
+            fflush( stdout );
+            sink = strtok_r( NULL, ",", &save );
+        }
+
+        free( sinks );
+    }
+
+    return ( rc == EOK ) ? 0 : 1;
+}
+
+/*============================================================================*/
+/*  usage                                                                     */
+/*!
+    Display the application usage
+
+    @param[in]
+       cmdname
+            pointer to the invoked command name
+
+==============================================================================*/
+static void usage( char *cmdname )
+{
+    if ( cmdname != NULL )
+    {
+        fprintf( stderr,
+                 "usage: %s [-h] [-a] [-n vars] [-m messages] [-t seconds] "
+                 "[-r rate]\n"
+                 " [-i interval_ms] [-u updates] [-f format] [-o sinks] "
+                 "[-j workers] [-q depth]\n"
+                 " [-h] : display this help\n"
+                 " [-a] : every message contains all of the variables\n"
+                 " [-n] : number of variables (default 1000)\n"
+                 " [-m] : number of messages (default 10)\n"
+                 " [-t] : duration of the load in seconds (default 5)\n"
+                 " [-r] : triggers per second, 0 for no limit "
+                 "(default 1000)\n"
+                 " [-i] : send interval messages every interval_ms "
+                 "instead of\n"
+                 "        triggered messages\n"
+                 " [-u] : variables updated per trigger (default 10)\n"
+                 " [-f] : message format, json or cbor (default json)\n"
+                 " [-o] : sink types to measure "
+                 "(default stdout,file,mqueue,shm)\n"
+                 "        udp may also be measured\n"
+                 " [-j] : number of render worker threads (default 0)\n"
+                 " [-q] : output queue depth (default 0, no queue)\n",
+                 cmdname );
+    }
+}
+
+/*============================================================================*/
+/*  ProcessOptions                                                            */
+/*!
+    Process the command line options
+
+    @param[in]
+        argC
+            number of arguments
+            (including the command itself)
+
+    @param[in]
+        argV
+            array of pointers to the command line arguments
+
+    @param[in]
+        pConfig
+            pointer to the benchmark parameters to populate
+
+    @retval EOK the options were processed
+    @retval EINVAL invalid options, or help was requested
+
+==============================================================================*/
+static int ProcessOptions( int argC, char *argV[], BenchConfig *pConfig )
+{
+    int c;
+    int result = EINVAL;
+    const char *options = "han:m:t:r:i:u:f:o:j:q:";
+
+    if ( ( pConfig != NULL ) &&
+         ( argV != NULL ) )
+    {
+        result = EOK;
+
+        while ( ( c = getopt( argC, argV, options ) ) != -1 )
+        {
+            switch( c )
+            {
+                case 'a':
+                    pConfig->all = true;
+                    break;
+
+                case 'n':
+                    pConfig->numVars = strtoul( optarg, NULL, 0 );
+                    break;
+
+                case 'm':
+                    pConfig->numConfigs = strtoul( optarg, NULL, 0 );
+                    break;
+
+                case 't':
+                    pConfig->seconds = strtoul( optarg, NULL, 0 );
+                    break;
+
+                case 'r':
+                    pConfig->rate = strtoul( optarg, NULL, 0 );
+                    break;
+
+                case 'i':
+                    pConfig->interval_ms = strtoul( optarg, NULL, 0 );
+                    break;
+
+                case 'u':
+                    pConfig->updates = strtoul( optarg, NULL, 0 );
+                    break;
+
+                case 'f':
+                    pConfig->format = optarg;
+                    break;
+
+                case 'o':
+                    pConfig->sinks = optarg;
+                    break;
+
+                case 'j':
+                    pConfig->workers = optarg;
+                    break;
+
+                case 'q':
+                    pConfig->depth = optarg;
+                    break;
+
+                case 'h':
+                default:
+                    usage( argV[0] );
+                    result = EINVAL;
+                    break;
+            }
+        }
+
+        if ( ( pConfig->numVars == 0 ) ||
+             ( pConfig->numConfigs == 0 ) ||
+             ( pConfig->seconds == 0 ) )
+        {
+            usage( argV[0] );
+            result = EINVAL;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RunSink                                                                   */
+/*!
+    Measure the performance of one sink type
+
+    The RunSink function creates a configuration directory, and forks
+    a child process to run the benchmark for the sink type.  It waits
+    for the child to report its results and cleans up the configurations
+    and the output objects it created.
+
+    @param[in]
+        pConfig
+            pointer to the benchmark parameters
+
+    @param[in]
+        sink
+            name of the sink type to measure
+
+    @param[out]
+        pResult
+            pointer to a location to store the measurements
+
+    @retval EOK the measurement succeeded
+    @retval ENOTSUP the sink type is not supported
+    @retval EIO the measurement failed
+    @retval EINVAL invalid arguments
+    @retval other error from mkdtemp(), pipe() or fork()
+
+==============================================================================*/
+static int RunSink( BenchConfig *pConfig,
+                    const char *sink,
+                    BenchResult *pResult )
+{
+    int result = EINVAL;
+    char name[BENCH_NAME_LEN];
+    int fds[2];
+    pid_t pid;
+    ssize_t n;
+    size_t i;
+
+    if ( ( pConfig != NULL ) &&
+         ( sink != NULL ) &&
+         ( pResult != NULL ) )
+    {
+        memset( pResult, 0, sizeof( BenchResult ) );
+
+        result = ENOTSUP;
+        for ( i = 0; i < sizeof( sinkTypes ) / sizeof( sinkTypes[0] ); i++ )
+        {
+            if ( strcmp( sink, sinkTypes[i] ) == 0 )
+            {
+                result = EOK;
+            }
+        }
+
+        strcpy( pConfig->dir, "/tmp/varmsg_bench.XXXXXX" );
+        if ( ( result == EOK ) &&
+             ( mkdtemp( pConfig->dir ) == NULL ) )
+        {
+            result = errno;
+        }
+
+        if ( ( result == EOK ) &&
+             ( pipe( fds ) != 0 ) )
+        {
+            result = errno;
+            rmdir( pConfig->dir );
+        }
+
+        if ( result == EOK )
+        {
+            fflush( stdout );
+
+            pid = fork();
+            if ( pid == 0 )
+            {
+                close( fds[0] );
+                RunChild( pConfig, sink, fds[1] );
+                _exit( 0 );
+            }
+
+            close( fds[1] );
+
+            if ( pid == -1 )
+            {
+                result = errno;
+            }
+            else
+            {
+                /* the child writes its results just before it exits */
+                n = read( fds[0], pResult, sizeof( BenchResult ) );
+                if ( ( n != sizeof( BenchResult ) ) ||
+                     ( pResult->ok == false ) )
+                {
+                    result = EIO;
+                }
+
+                kill( pid, SIGKILL );
+                waitpid( pid, NULL, 0 );
+            }
+
+            close( fds[0] );
+
+            /* clean up the configurations and output objects */
+            RemoveConfigs( pConfig );
+            OutputName( pConfig, sink, name, sizeof( name ) );
+            if ( strcmp( sink, "shm" ) == 0 )
+            {
+                shm_unlink( name );
+            }
+            else if ( strcmp( sink, "mqueue" ) == 0 )
+            {
+                mq_unlink( name );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RunChild                                                                  */
+/*!
+    Run the benchmark for one sink type in a child process
+
+    The RunChild function creates the synthetic variables and the
+    message configurations, starts the message generator, then takes
+    the measurements and writes them to the results pipe.
+
+    @param[in]
+        pConfig
+            pointer to the benchmark parameters
+
+    @param[in]
+        sink
+            name of the sink type to measure
+
+    @param[in]
+        fd
+            write end of the results pipe
+
+==============================================================================*/
+static void RunChild( BenchConfig *pConfig, const char *sink, int fd )
+{
+    BenchResult result;
+    BenchCounters start;
+    uint64_t startTime = 0;
+    VARSERVER_HANDLE hVarServer;
+    BenchVar *pVars = NULL;
+    VAR_HANDLE hTrigger = VAR_INVALID;
+    char name[BENCH_NAME_LEN];
+    pthread_t generator;
+    pthread_t drain;
+    sigset_t mask;
+    int rc;
+    int null;
+
+    memset( &result, 0, sizeof( BenchResult ) );
+
+    /* the variable server signals are only received by the generator */
+    sigemptyset( &mask );
+    sigaddset( &mask, SIG_VAR_MODIFIED );
+    sigaddset( &mask, SIG_VAR_CALC );
+    sigaddset( &mask, SIG_VAR_VALIDATE );
+    sigaddset( &mask, SIG_VAR_PRINT );
+    sigaddset( &mask, SIG_VAR_TIMER );
+    pthread_sigmask( SIG_BLOCK, &mask, NULL );
+
+    /* discard the stdout sink output */
+    null = open( "/dev/null", O_WRONLY );
+    if ( null != -1 )
+    {
+        dup2( null, STDOUT_FILENO );
+        close( null );
+    }
+
+    OutputName( pConfig, sink, name, sizeof( name ) );
+
+    hVarServer = VARSERVER_Open();
+    rc = CreateVars( pConfig, hVarServer, &pVars, &hTrigger );
+    if ( rc == EOK )
+    {
+        rc = WriteConfigs( pConfig, sink, name );
+    }
+
+    if ( ( rc == EOK ) &&
+         ( strcmp( sink, "mqueue" ) == 0 ) )
+    {
+        /* read the message queue so the generator never blocks on it */
+        rc = pthread_create( &drain, NULL, DrainQueue, (void *)name );
+    }
+
+    if ( ( rc == EOK ) &&
+         ( strcmp( sink, "udp" ) == 0 ) )
+    {
+        /* receive the datagrams so they are not refused */
+        rc = pthread_create( &drain, NULL, DrainSocket, (void *)name );
+    }
+
+    if ( rc == EOK )
+    {
+        rc = StartGenerator( pConfig, &generator );
+    }
+
+    if ( rc == EOK )
+    {
+        rc = WaitStarted( pConfig, hVarServer );
+    }
+
+    if ( ( rc == EOK ) &&
+         ( strcmp( sink, "shm" ) == 0 ) )
+    {
+        /* consume the ring so the generator never finds it full */
+        rc = pthread_create( &drain, NULL, DrainRing, (void *)name );
+    }
+
+    if ( rc == EOK )
+    {
+        /* let the generator publish its counters before the load */
+        SleepMs( BENCH_SETTLE_MS );
+        GetCounters( pConfig, hVarServer, &start );
+        startTime = GetTimeMs();
+
+        DriveLoad( pConfig, hVarServer, pVars, hTrigger );
+
+        Measure( pConfig, hVarServer, &start, startTime, &result );
+        result.ok = true;
+    }
+
+    if ( write( fd, &result, sizeof( BenchResult ) ) !=
+                sizeof( BenchResult ) )
+    {
+        fprintf( stderr, "varmsg_bench: failed to report results\n" );
+    }
+
+    close( fd );
+}
+
+/*============================================================================*/
+/*  Measure                                                                   */
+/*!
+    Calculate the results at the end of the load
+
+    The Measure function takes a snapshot of the read and write system
+    calls at the end of the load, then waits for the generator to
+    publish its counters and takes a snapshot of them.  The results are
+    calculated from the difference between the start and end snapshots.
+
+    @param[in]
+        pConfig
+            pointer to the benchmark parameters
+
+    @param[in]
+        hVarServer
+            handle of the mock variable server
+
+    @param[in]
+        pStart
+            pointer to the snapshot taken at the start of the load
+
+    @param[in]
+        startTime
+            time the load was started (milliseconds)
+
+    @param[out]
+        pResult
+            pointer to a location to store the results
+
+==============================================================================*/
+static void Measure( BenchConfig *pConfig,
+                     VARSERVER_HANDLE hVarServer,
+                     BenchCounters *pStart,
+                     uint64_t startTime,
+                     BenchResult *pResult )
+{
+    BenchCounters end;
+    uint64_t rwcalls;
+    double seconds;
+    size_t i;
+
+    seconds = ( GetTimeMs() - startTime ) / 1000.0;
+    rwcalls = GetRWCalls();
+
+    /* wait for the generator to publish its counters */
+    SleepMs( BENCH_SETTLE_MS );
+    GetCounters( pConfig, hVarServer, &end );
+
+    for ( i = 0; i < BENCH_HIST_BUCKETS; i++ )
+    {
+        end.hist[i] -= pStart->hist[i];
+    }
+
+    pResult->messages = end.messages - pStart->messages;
+    pResult->msgRate = pResult->messages / seconds;
+    pResult->byteRate = ( end.bytes - pStart->bytes ) / seconds;
+    pResult->p50 = Percentile( end.hist, 0.5 );
+    pResult->p99 = Percentile( end.hist, 0.99 );
+    if ( pResult->messages > 0 )
+    {
+        pResult->rwPerMsg = (double)( rwcalls - pStart->rwcalls ) /
+                            pResult->messages;
+    }
+}
+
+/*============================================================================*/
+/*  CreateVars                                                                */
+/*!
+    Create the synthetic variables
+
+    The CreateVars function creates the body variables, rotating through
+    the numeric and string variable types, and the trigger variable.
+    The body variables are named /bench/v/<message>/<n> and are spread
+    evenly across the messages.
+
+    @param[in]
+        pConfig
+            pointer to the benchmark parameters
+
+    @param[in]
+        hVarServer
+            handle of the mock variable server
+
+    @param[out]
+        ppVars
+            pointer to a location to store the body variable array
+
+    @param[out]
+        phTrigger
+            pointer to a location to store the trigger variable handle
+
+    @retval EOK the variables were created
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+    @retval other error from VARSERVER_CreateVar
+
+==============================================================================*/
+static int CreateVars( BenchConfig *pConfig,
+                       VARSERVER_HANDLE hVarServer,
+                       BenchVar **ppVars,
+                       VAR_HANDLE *phTrigger )
+{
+    int result = EINVAL;
+    BenchVar *pVars;
+    VarInfo info;
+    size_t ntypes = sizeof( varTypes ) / sizeof( varTypes[0] );
+    size_t i;
+
+    if ( ( pConfig != NULL ) &&
+         ( ppVars != NULL ) &&
+         ( phTrigger != NULL ) )
+    {
+        result = ENOMEM;
+
+        pVars = calloc( pConfig->numVars, sizeof( BenchVar ) );
+        if ( pVars != NULL )
+        {
+            result = EOK;
+        }
+
+        for ( i = 0; ( result == EOK ) && ( i < pConfig->numVars ); i++ )
+        {
+            memset( &info, 0, sizeof( VarInfo ) );
+            snprintf( info.name,
+                      sizeof( info.name ),
+                      "/bench/v/%zu/%zu",
+                      i % pConfig->numConfigs,
+                      i / pConfig->numConfigs );
+            strcpy( info.tagspec, "bench" );
+            info.flags = VARFLAG_VOLATILE;
+            info.var.type = varTypes[i % ntypes];
+            info.var.len = ( info.var.type == VARTYPE_STR ) ? BENCH_STR_LEN
+                                                            : 0;
+
+            result = VARSERVER_CreateVar( hVarServer, &info );
+            if ( result == EOK )
+            {
+                pVars[i].hVar = info.hVar;
+                pVars[i].type = info.var.type;
+                SetValue( hVarServer, &pVars[i], i );
+            }
+        }
+
+        if ( result == EOK )
+        {
+            memset( &info, 0, sizeof( VarInfo ) );
+            strcpy( info.name, "/bench/trigger" );
+            strcpy( info.tagspec, "benchtrig" );
+            info.flags = VARFLAG_VOLATILE;
+            info.var.type = VARTYPE_UINT32;
+
+            result = VARSERVER_CreateVar( hVarServer, &info );
+            *phTrigger = info.hVar;
+        }
+
+        *ppVars = pVars;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  WriteConfigs                                                              */
+/*!
+    Write the message configurations
+
+    The WriteConfigs function writes one configuration file for each
+    message into the configuration directory.  All of the messages
+    write to the same output.
+
+    @param[in]
+        pConfig
+            pointer to the benchmark parameters
+
+    @param[in]
+        sink
+            name of the sink type
+
+    @param[in]
+        output
+            name of the output
+
+    @retval EOK the configurations were written
+    @retval EINVAL invalid arguments
+    @retval other error from fopen()
+
+==============================================================================*/
+static int WriteConfigs( BenchConfig *pConfig,
+                         const char *sink,
+                         const char *output )
+{
+    int result = EINVAL;
+    char filename[BENCH_NAME_LEN * 2];
+    char match[BENCH_NAME_LEN];
+    FILE *fp;
+    size_t i;
+
+    if ( ( pConfig != NULL ) &&
+         ( sink != NULL ) &&
+         ( output != NULL ) )
+    {
+        result = EOK;
+
+        for ( i = 0; ( result == EOK ) && ( i < pConfig->numConfigs ); i++ )
+        {
+            if ( pConfig->all == true )
+            {
+                strcpy( match, "/bench/v/" );
+            }
+            else
+            {
+                snprintf( match, sizeof( match ), "/bench/v/%zu/", i );
+            }
+
+            snprintf( filename,
+                      sizeof( filename ),
+                      "%s/m%zu.json",
+                      pConfig->dir,
+                      i );
+
+            fp = fopen( filename, "w" );
+            if ( fp != NULL )
+            {
+                fprintf( fp,
+                         "{ \"enabled\" : true, "
+                         "\"prefix\" : \"/bench/m%zu/\", "
+                         "\"output_type\" : \"%s\", "
+                         "\"output\" : \"%s\", "
+                         "\"format\" : \"%s\", ",
+                         i,
+                         sink,
+                         output,
+                         pConfig->format );
+
+                if ( pConfig->interval_ms != 0 )
+                {
+                    fprintf( fp,
+                             "\"interval_ms\" : %u, ",
+                             pConfig->interval_ms );
+                }
+                else
+                {
+                    fprintf( fp,
+                             "\"trigger\" : { \"tags\" : \"benchtrig\" }, " );
+                }
+
+                fprintf( fp, "\"vars\" : { \"match\" : \"%s\" } }\n", match );
+                fclose( fp );
+            }
+            else
+            {
+                result = errno;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RemoveConfigs                                                             */
+/*!
+    Remove the message configurations and the configuration directory
+
+    @param[in]
+        pConfig
+            pointer to the benchmark parameters
+
+==============================================================================*/
+static void RemoveConfigs( BenchConfig *pConfig )
+{
+    char filename[BENCH_NAME_LEN * 2];
+    size_t i;
+
+    if ( pConfig != NULL )
+    {
+        for ( i = 0; i < pConfig->numConfigs; i++ )
+        {
+            snprintf( filename,
+                      sizeof( filename ),
+                      "%s/m%zu.json",
+                      pConfig->dir,
+                      i );
+            unlink( filename );
+        }
+
+        rmdir( pConfig->dir );
+    }
+}
+
+/*============================================================================*/
+/*  StartGenerator                                                            */
+/*!
+    Start the variable message generator
+
+    The StartGenerator function runs the variable message generator on
+    its own thread, with the benchmark configuration directory, worker
+    threads and output queue depth.
+
+    @param[in]
+        pConfig
+            pointer to the benchmark parameters
+
+    @param[out]
+        pThread
+            pointer to a location to store the generator thread
+
+    @retval EOK the generator was started
+    @retval EINVAL invalid arguments
+    @retval other error from pthread_create()
+
+==============================================================================*/
+static int StartGenerator( BenchConfig *pConfig, pthread_t *pThread )
+{
+    static char *argv[8];
+    int result = EINVAL;
+
+    if ( ( pConfig != NULL ) &&
+         ( pThread != NULL ) )
+    {
+        argv[0] = "varmsg";
+        argv[1] = "-d";
+        argv[2] = pConfig->dir;
+        argv[3] = "-j";
+        argv[4] = pConfig->workers;
+        argv[5] = "-q";
+        argv[6] = pConfig->depth;
+        argv[7] = NULL;
+
+        result = pthread_create( pThread, NULL, GeneratorThread, argv );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  GeneratorThread                                                           */
+/*!
+    Run the variable message generator
+
+    @param[in]
+        arg
+            pointer to the NULL terminated generator argument list
+
+    @retval NULL
+
+==============================================================================*/
+static void *GeneratorThread( void *arg )
+{
+    char **argv = (char **)arg;
+    int argc = 0;
+
+    while ( argv[argc] != NULL )
+    {
+        argc++;
+    }
+
+    /* restart the option scan for the generator's own options */
+    optind = 1;
+    VARMSG_Main( argc, argv );
+
+    return NULL;
+}
+
+/*============================================================================*/
+/*  DrainQueue                                                                */
+/*!
+    Discard the messages written to the message queue
+
+    @param[in]
+        arg
+            pointer to the name of the message queue
+
+    @retval NULL
+
+==============================================================================*/
+static void *DrainQueue( void *arg )
+{
+    struct mq_attr attr;
+    mqd_t mq;
+    char *buf = NULL;
+
+    mq = mq_open( (char *)arg, O_RDONLY | O_CREAT, 0600, NULL );
+    if ( ( mq != (mqd_t)-1 ) &&
+         ( mq_getattr( mq, &attr ) == 0 ) )
+    {
+        buf = malloc( attr.mq_msgsize );
+    }
+
+    while ( buf != NULL )
+    {
+        mq_receive( mq, buf, attr.mq_msgsize, NULL );
+    }
+
+    return NULL;
+}
+
+/*============================================================================*/
+/*  DrainRing                                                                 */
+/*!
+    Consume the messages written to the shared memory ring
+
+    @param[in]
+        arg
+            pointer to the name of the shared memory ring
+
+    @retval NULL
+
+==============================================================================*/
+static void *DrainRing( void *arg )
+{
+    ShmRing ring;
+    const char *pData;
+    size_t len;
+    int rc;
+
+    rc = SHMRING_Attach( &ring, (const char *)arg );
+    while ( rc == EOK )
+    {
+        if ( SHMRING_Read( &ring, &pData, &len ) == EOK )
+        {
+            SHMRING_Release( &ring );
+        }
+        else
+        {
+            SHMRING_Wait( &ring );
+        }
+    }
+
+    return NULL;
+}
+
+/*============================================================================*/
+/*  DrainSocket                                                               */
+/*!
+    Discard the datagrams sent to the udp sink
+
+    @param[in]
+        arg
+            pointer to the address of the udp sink
+
+    @retval NULL
+
+==============================================================================*/
+static void *DrainSocket( void *arg )
+{
+    struct sockaddr_in addr;
+    char buf[65536];
+    int fd;
+
+    memset( &addr, 0, sizeof( addr ) );
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+    addr.sin_port = htons( atoi( strchr( (char *)arg, ':' ) + 1 ) );
+
+    fd = socket( AF_INET, SOCK_DGRAM, 0 );
+    if ( ( fd != -1 ) &&
+         ( bind( fd, (struct sockaddr *)&addr, sizeof( addr ) ) == 0 ) )
+    {
+        while ( recv( fd, buf, sizeof( buf ), 0 ) >= 0 )
+        {
+        }
+    }
+
+    return NULL;
+}
+
+/*============================================================================*/
+/*  WaitStarted                                                               */
+/*!
+    Wait for the variable message generator to start
+
+    The generator has started when it has created the global statistics
+    variable, which it does once all of the messages are set up.
+
+    @param[in]
+        pConfig
+            pointer to the benchmark parameters
+
+    @param[in]
+        hVarServer
+            handle of the mock variable server
+
+    @retval EOK the generator has started
+    @retval ETIMEDOUT the generator did not start
+
+==============================================================================*/
+static int WaitStarted( BenchConfig *pConfig, VARSERVER_HANDLE hVarServer )
+{
+    int result = ETIMEDOUT;
+    uint64_t deadline = GetTimeMs() + BENCH_START_TIMEOUT_MS;
+
+    (void)pConfig;
+
+    while ( ( result != EOK ) && ( GetTimeMs() < deadline ) )
+    {
+        if ( VAR_FindByName( hVarServer, "/varmsg/stats" ) != VAR_INVALID )
+        {
+            result = EOK;
+        }
+        else
+        {
+            SleepMs( 10 );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  DriveLoad                                                                 */
+/*!
+    Drive the benchmark load
+
+    The DriveLoad function runs for the benchmark duration.  At the
+    configured rate it updates the next few body variables, and for
+    triggered messages it then sets the trigger variable.  Without a
+    rate limit, each trigger waits for the first message to be sent
+    for the previous one, so the notifications do not queue up faster
+    than the generator can handle them.
+
+    @param[in]
+        pConfig
+            pointer to the benchmark parameters
+
+    @param[in]
+        hVarServer
+            handle of the mock variable server
+
+    @param[in]
+        pVars
+            pointer to the body variables
+
+    @param[in]
+        hTrigger
+            handle of the trigger variable
+
+==============================================================================*/
+static void DriveLoad( BenchConfig *pConfig,
+                       VARSERVER_HANDLE hVarServer,
+                       BenchVar *pVars,
+                       VAR_HANDLE hTrigger )
+{
+    struct timespec next;
+    uint64_t end;
+    uint32_t n = 0;
+    uint64_t sent;
+    size_t idx = 0;
+    size_t i;
+    long period;
+    VarObject obj;
+
+    if ( ( pConfig != NULL ) &&
+         ( pVars != NULL ) )
+    {
+        period = ( pConfig->rate > 0 ) ? 1000000000L / pConfig->rate : 0;
+        end = GetTimeMs() + ( pConfig->seconds * 1000 );
+        clock_gettime( CLOCK_MONOTONIC, &next );
+        sent = GetCounter( hVarServer, "txcount", 0 );
+
+        while ( GetTimeMs() < end )
+        {
+            n++;
+
+            for ( i = 0; i < pConfig->updates; i++ )
+            {
+                SetValue( hVarServer, &pVars[idx], n );
+                idx = ( idx + 1 ) % pConfig->numVars;
+            }
+
+            if ( pConfig->interval_ms == 0 )
+            {
+                obj.type = VARTYPE_UINT32;
+                obj.val.ul = n;
+                VAR_Set( hVarServer, hTrigger, &obj );
+            }
+
+            if ( ( period == 0 ) &&
+                 ( pConfig->interval_ms == 0 ) )
+            {
+                while ( ( GetCounter( hVarServer, "txcount", 0 ) < sent + 1 ) &&
+                        ( GetTimeMs() < end ) )
+                {
+                    sched_yield();
+                }
+
+                sent++;
+            }
+            else if ( period > 0 )
+            {
+                next.tv_nsec += period;
+                while ( next.tv_nsec >= 1000000000L )
+                {
+                    next.tv_nsec -= 1000000000L;
+                    next.tv_sec++;
+                }
+
+                clock_nanosleep( CLOCK_MONOTONIC,
+                                 TIMER_ABSTIME,
+                                 &next,
+                                 NULL );
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  SetValue                                                                  */
+/*!
+    Set the value of a synthetic variable
+
+    @param[in]
+        hVarServer
+            handle of the mock variable server
+
+    @param[in]
+        pVar
+            pointer to the synthetic variable
+
+    @param[in]
+        n
+            number to derive the new value from
+
+==============================================================================*/
+static void SetValue( VARSERVER_HANDLE hVarServer,
+                      BenchVar *pVar,
+                      uint32_t n )
+{
+    VarObject obj;
+    char str[BENCH_STR_LEN];
+
+    obj.type = pVar->type;
+    obj.len = 0;
+
+    switch( pVar->type )
+    {
+        case VARTYPE_UINT16:
+            obj.val.ui = (uint16_t)n;
+            break;
+
+        case VARTYPE_INT16:
+            obj.val.i = -(int16_t)n;
+            break;
+
+        case VARTYPE_UINT32:
+            obj.val.ul = n;
+            break;
+
+        case VARTYPE_INT32:
+            obj.val.l = -(int32_t)n;
+            break;
+
+        case VARTYPE_UINT64:
+            obj.val.ull = (uint64_t)n << 20;
+            break;
+
+        case VARTYPE_INT64:
+            obj.val.ll = -( (int64_t)n << 20 );
+            break;
+
+        case VARTYPE_FLOAT:
+            obj.val.f = n / 8.0f;
+            break;
+
+        case VARTYPE_STR:
+        default:
+            snprintf( str, sizeof( str ), "value \"%u\"", n );
+            obj.val.str = str;
+            obj.len = strlen( str ) + 1;
+            break;
+    }
+
+    VAR_Set( hVarServer, pVar->hVar, &obj );
+}
+
+/*============================================================================*/
+/*  GetCounters                                                               */
+/*!
+    Take a snapshot of the generator counters
+
+    @param[in]
+        pConfig
+            pointer to the benchmark parameters
+
+    @param[in]
+        hVarServer
+            handle of the mock variable server
+
+    @param[out]
+        pCounters
+            pointer to a location to store the snapshot
+
+==============================================================================*/
+static void GetCounters( BenchConfig *pConfig,
+                         VARSERVER_HANDLE hVarServer,
+                         BenchCounters *pCounters )
+{
+    char stats[BENCH_STATS_SIZE];
+    VarObject obj;
+    VAR_HANDLE hVar;
+    size_t i;
+
+    memset( pCounters, 0, sizeof( BenchCounters ) );
+
+    pCounters->rwcalls = GetRWCalls();
+
+    for ( i = 0; i < pConfig->numConfigs; i++ )
+    {
+        pCounters->messages += GetCounter( hVarServer, "txcount", i );
+        pCounters->bytes += GetCounter( hVarServer, "bytes", i );
+    }
+
+    hVar = VAR_FindByName( hVarServer, "/varmsg/stats" );
+    obj.val.str = stats;
+    obj.len = sizeof( stats );
+    if ( VAR_Get( hVarServer, hVar, &obj ) == EOK )
+    {
+        ParseHist( stats, "\"render_us\":[", pCounters->hist );
+    }
+}
+
+/*============================================================================*/
+/*  GetCounter                                                                */
+/*!
+    Get the value of a message status variable
+
+    @param[in]
+        hVarServer
+            handle of the mock variable server
+
+    @param[in]
+        name
+            name of the status variable, without the message prefix
+
+    @param[in]
+        idx
+            index of the message
+
+    @retval the value of the status variable, or 0 if it is not found
+
+==============================================================================*/
+static uint64_t GetCounter( VARSERVER_HANDLE hVarServer,
+                            const char *name,
+                            size_t idx )
+{
+    char varname[BENCH_NAME_LEN];
+    VarObject obj;
+    uint64_t value = 0;
+
+    snprintf( varname, sizeof( varname ), "/bench/m%zu/%s", idx, name );
+    if ( VAR_Get( hVarServer,
+                  VAR_FindByName( hVarServer, varname ),
+                  &obj ) == EOK )
+    {
+        value = ( obj.type == VARTYPE_UINT64 ) ? obj.val.ull : obj.val.ul;
+    }
+
+    return value;
+}
+
+/*============================================================================*/
+/*  GetRWCalls                                                                */
+/*!
+    Get the number of read and write system calls made by the process
+
+    @retval the sum of the syscr and syscw counts from /proc/self/io
+
+==============================================================================*/
+static uint64_t GetRWCalls( void )
+{
+    FILE *fp;
+    char line[BENCH_NAME_LEN];
+    unsigned long long n;
+    uint64_t count = 0;
+
+    fp = fopen( "/proc/self/io", "r" );
+    if ( fp != NULL )
+    {
+        while ( fgets( line, sizeof( line ), fp ) != NULL )
+        {
+            if ( ( sscanf( line, "syscr: %llu", &n ) == 1 ) ||
+                 ( sscanf( line, "syscw: %llu", &n ) == 1 ) )
+            {
+                count += n;
+            }
+        }
+
+        fclose( fp );
+    }
+
+    return count;
+}
+
+/*============================================================================*/
+/*  ParseHist                                                                 */
+/*!
+    Parse a latency histogram from the global statistics
+
+    @param[in]
+        str
+            the global statistics JSON object
+
+    @param[in]
+        key
+            the histogram key, including its opening bracket
+
+    @param[out]
+        pHist
+            pointer to the BENCH_HIST_BUCKETS histogram buckets
+
+==============================================================================*/
+static void ParseHist( const char *str, const char *key, uint64_t *pHist )
+{
+    const char *p;
+    char *end;
+    size_t i = 0;
+
+    p = strstr( str, key );
+    if ( p != NULL )
+    {
+        p += strlen( key );
+        while ( ( i < BENCH_HIST_BUCKETS ) && ( *p != ']' ) )
+        {
+            pHist[i++] = strtoull( p, &end, 10 );
+            p = ( *end == ',' ) ? end + 1 : end;
+            if ( end == p )
+            {
+                break;
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  Percentile                                                                */
+/*!
+    Estimate a percentile from a log2 latency histogram
+
+    Bucket 0 counts latencies of 0us, and bucket n counts latencies from
+    2^(n-1)us up to 2^n us.  The latencies are assumed to be spread
+    evenly across the bucket which contains the percentile.
+
+    @param[in]
+        pHist
+            pointer to the BENCH_HIST_BUCKETS histogram buckets
+
+    @param[in]
+        q
+            the percentile to estimate, from 0 to 1
+
+    @retval the estimated latency in microseconds
+
+==============================================================================*/
+static double Percentile( uint64_t *pHist, double q )
+{
+    uint64_t total = 0;
+    double target;
+    double cumulative = 0;
+    double value = 0;
+    double lower;
+    size_t i;
+
+    for ( i = 0; i < BENCH_HIST_BUCKETS; i++ )
+    {
+        total += pHist[i];
+    }
+
+    target = q * total;
+
+    for ( i = 0; ( total > 0 ) && ( i < BENCH_HIST_BUCKETS ); i++ )
+    {
+        if ( ( pHist[i] > 0 ) &&
+             ( cumulative + pHist[i] >= target ) )
+        {
+            if ( i > 0 )
+            {
+                lower = (double)( 1ULL << ( i - 1 ) );
+                value = lower + ( lower * ( target - cumulative ) / pHist[i] );
+            }
+
+            break;
+        }
+
+        cumulative += pHist[i];
+    }
+
+    return value;
+}
+
+/*============================================================================*/
+/*  GetTimeMs                                                                 */
+/*!
+    Get the current monotonic time in milliseconds
+
+    @retval the current CLOCK_MONOTONIC time in milliseconds
+
+==============================================================================*/
+static uint64_t GetTimeMs( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( (uint64_t)ts.tv_sec * 1000 ) + ( ts.tv_nsec / 1000000 );
+}
+
+/*============================================================================*/
+/*  SleepMs                                                                   */
+/*!
+    Sleep for the specified time
+
+    @param[in]
+        ms
+            time to sleep in milliseconds
+
+==============================================================================*/
+static void SleepMs( unsigned int ms )
+{
+    struct timespec ts;
+
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = ( ms % 1000 ) * 1000000L;
+
+    while ( nanosleep( &ts, &ts ) != 0 )
+    {
+    }
+}
+
+/*============================================================================*/
+/*  OutputName                                                                */
+/*!
+    Get the output name for a sink type
+
+    The file sink writes to /dev/null.  The message queue and shared
+    memory ring are named after the benchmark process, and the udp
+    sink sends to a local port chosen from the process id.
+
+    @param[in]
+        pConfig
+            pointer to the benchmark parameters
+
+    @param[in]
+        sink
+            name of the sink type
+
+    @param[out]
+        name
+            pointer to a buffer to store the output name
+
+    @param[in]
+        len
+            size of the output name buffer
+
+==============================================================================*/
+static void OutputName( BenchConfig *pConfig,
+                        const char *sink,
+                        char *name,
+                        size_t len )
+{
+    if ( strcmp( sink, "file" ) == 0 )
+    {
+        snprintf( name, len, "/dev/null" );
+    }
+    else if ( strcmp( sink, "udp" ) == 0 )
+    {
+        snprintf( name,
+                  len,
+                  "127.0.0.1:%d",
+                  BENCH_UDP_PORT + ( (int)pConfig->pid % BENCH_UDP_PORTS ) );
+    }
+    else
+    {
+        snprintf( name, len, "/varmsg_bench.%d", (int)pConfig->pid );
+    }
+}
+
+/*! @}
+ * end of bench group */
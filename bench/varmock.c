@@ -0,0 +1,1502 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup varmock Variable Server Mock
+ * @brief In-process mock of the variable server client API
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file varmock.c
+
+    Variable Server Mock
+
+    The Variable Server Mock implements the parts of the variable server
+    client API (VARSERVER_*, VAR_*, VARCACHE_*, VARQUERY_* and VARFP_*)
+    used by varmsg against an in-process variable table.  It is linked
+    into the varmsg benchmark in place of the variable server library,
+    so the message generator can be measured without a running
+    variable server.
+
+    Variables are created with VARSERVER_CreateVar and their handles
+    are their position in the table.  Setting a variable which has a
+    modification notification registered queues a SIG_VAR_MODIFIED
+    signal to the process, just as the variable server does.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <regex.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <varserver/varserver.h>
+#include <varserver/varcache.h>
+#include <varserver/varquery.h>
+#include <varserver/varfp.h>
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! initial number of variables in the variable table */
+#define VARMOCK_SIZE_INITIAL        ( 1024 )
+
+/*! A VarMockVar is one variable in the mock variable table */
+typedef struct _varMockVar
+{
+    /*! variable information, including its current value */
+    VarInfo info;
+
+    /*! storage for the value of a string variable */
+    char *str;
+
+    /*! true if a modification notification is registered */
+    bool notify;
+
+} VarMockVar;
+
+/*! The _VarCache object is a growable list of variable handles */
+struct _VarCache
+{
+    /*! pointer to the variable handles */
+    VAR_HANDLE *pHandles;
+
+    /*! number of handles in the cache */
+    size_t n;
+
+    /*! number of handles allocated */
+    size_t size;
+
+    /*! number of handles to grow the cache by when it is full */
+    size_t growBy;
+};
+
+/*! The _VarFP object is a memory buffer backed by a file descriptor */
+struct _VarFP
+{
+    /*! memory file descriptor */
+    int fd;
+
+    /*! pointer to the mapped memory buffer */
+    char *pData;
+
+    /*! size of the memory buffer */
+    size_t size;
+};
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! the variable table */
+static VarMockVar *pVars = NULL;
+
+/*! number of variables in the variable table */
+static size_t numVars = 0;
+
+/*! number of variables allocated in the variable table */
+static size_t maxVars = 0;
+
+/*! lock protecting the variable table */
+static pthread_rwlock_t lock = PTHREAD_RWLOCK_INITIALIZER;
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static VarMockVar *GetVar( VAR_HANDLE hVar );
+static VAR_HANDLE FindVar( const char *name );
+static bool HasTags( const char *tagspec, const char *tags );
+static bool QueryMatch( VarQuery *pQuery, regex_t *pRegex, VarInfo *pInfo );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  VARSERVER_Open                                                            */
+/*!
+    Open a connection to the mock variable server
+
+    @retval handle of the mock variable server (never NULL)
+
+==============================================================================*/
+VARSERVER_HANDLE VARSERVER_Open( void )
+{
+    return (VARSERVER_HANDLE)&pVars;
+}
+
+/*============================================================================*/
+/*  VARSERVER_Close                                                           */
+/*!
+    Close a connection to the mock variable server
+
+    @param[in]
+        hVarServer
+            handle of the mock variable server
+
+    @retval EOK the connection was closed
+
+==============================================================================*/
+int VARSERVER_Close( VARSERVER_HANDLE hVarServer )
+{
+    (void)hVarServer;
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  VARSERVER_CreateVar                                                       */
+/*!
+    Create a variable in the mock variable table
+
+    The VARSERVER_CreateVar function adds a new variable to the table.
+    String variables are allocated var.len bytes of storage.
+
+    @param[in]
+        hVarServer
+            handle of the mock variable server
+
+    @param[in,out]
+        pVarInfo
+            pointer to the variable definition.  Its hVar is set to
+            the handle of the new variable.
+
+    @retval EOK the variable was created
+    @retval EEXIST a variable with the same name already exists
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARSERVER_CreateVar( VARSERVER_HANDLE hVarServer, VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    VarMockVar *p;
+    VarMockVar *pVar;
+    size_t size;
+
+    if ( ( hVarServer != NULL ) &&
+         ( pVarInfo != NULL ) )
+    {
+        pthread_rwlock_wrlock( &lock );
+
+        result = EOK;
+        if ( FindVar( pVarInfo->name ) != VAR_INVALID )
+        {
+            result = EEXIST;
+        }
+        else if ( numVars == maxVars )
+        {
+            size = ( maxVars > 0 ) ? maxVars * 2 : VARMOCK_SIZE_INITIAL;
+            p = realloc( pVars, size * sizeof( VarMockVar ) );
+            if ( p != NULL )
+            {
+                pVars = p;
+                maxVars = size;
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+
+        if ( result == EOK )
+        {
+            pVar = &pVars[numVars];
+            memset( pVar, 0, sizeof( VarMockVar ) );
+            pVar->info = *pVarInfo;
+
+            if ( pVar->info.var.type == VARTYPE_STR )
+            {
+                if ( pVar->info.var.len == 0 )
+                {
+                    pVar->info.var.len = 1;
+                }
+
+                pVar->str = calloc( 1, pVar->info.var.len );
+                result = ( pVar->str != NULL ) ? EOK : ENOMEM;
+            }
+        }
+
+        if ( result == EOK )
+        {
+            /* handles start at 1 since 0 is VAR_INVALID */
+            numVars++;
+            pVar->info.hVar = (VAR_HANDLE)numVars;
+            pVarInfo->hVar = pVar->info.hVar;
+        }
+
+        pthread_rwlock_unlock( &lock );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARSERVER_WaitSignal                                                      */
+/*!
+    Wait for a variable server signal
+
+    The VARSERVER_WaitSignal function blocks the variable server signals
+    in the calling thread and waits for one of them to arrive.
+
+    @param[out]
+        sigval
+            pointer to a location to store the signal value
+
+    @retval the received signal number
+
+==============================================================================*/
+int VARSERVER_WaitSignal( int *sigval )
+{
+    sigset_t mask;
+    siginfo_t info;
+    int sig;
+
+    sigemptyset( &mask );
+    sigaddset( &mask, SIG_VAR_MODIFIED );
+    sigaddset( &mask, SIG_VAR_CALC );
+    sigaddset( &mask, SIG_VAR_VALIDATE );
+    sigaddset( &mask, SIG_VAR_PRINT );
+    sigaddset( &mask, SIG_VAR_TIMER );
+    pthread_sigmask( SIG_BLOCK, &mask, NULL );
+
+    do
+    {
+        sig = sigwaitinfo( &mask, &info );
+    } while ( sig == -1 );
+
+    if ( sigval != NULL )
+    {
+        *sigval = info.si_value.sival_int;
+    }
+
+    return sig;
+}
+
+/*============================================================================*/
+/*  VARSERVER_StrToFlags                                                      */
+/*!
+    Convert a comma separated list of flag names to a flags bitmap
+
+    @param[in]
+        str
+            comma separated list of flag names
+
+    @param[out]
+        pFlags
+            pointer to a location to store the flags bitmap
+
+    @retval EOK the flags were converted
+    @retval ENOENT a flag name was not recognized
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARSERVER_StrToFlags( char *str, uint32_t *pFlags )
+{
+    int result = EINVAL;
+    char buf[MAX_NAME_LEN];
+    char *name;
+    char *save = NULL;
+
+    if ( ( str != NULL ) &&
+         ( pFlags != NULL ) &&
+         ( strlen( str ) < sizeof( buf ) ) )
+    {
+        result = EOK;
+        *pFlags = 0;
+
+        strcpy( buf, str );
+        name = strtok_r( buf, ",", &save );
+        while ( name != NULL )
+        {
+            if ( strcmp( name, "volatile" ) == 0 )
+            {
+                *pFlags |= VARFLAG_VOLATILE;
+            }
+            else if ( strcmp( name, "readonly" ) == 0 )
+            {
+                *pFlags |= VARFLAG_READONLY;
+            }
+            else if ( strcmp( name, "hidden" ) == 0 )
+            {
+                *pFlags |= VARFLAG_HIDDEN;
+            }
+            else
+            {
+                result = ENOENT;
+            }
+
+            name = strtok_r( NULL, ",", &save );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_FindByName                                                            */
+/*!
+    Find a variable by name
+
+    @param[in]
+        hVarServer
+            handle of the mock variable server
+
+    @param[in]
+        name
+            name of the variable to find
+
+    @retval handle of the variable
+    @retval VAR_INVALID the variable was not found
+
+==============================================================================*/
+VAR_HANDLE VAR_FindByName( VARSERVER_HANDLE hVarServer, char *name )
+{
+    VAR_HANDLE hVar = VAR_INVALID;
+
+    if ( ( hVarServer != NULL ) &&
+         ( name != NULL ) )
+    {
+        pthread_rwlock_rdlock( &lock );
+        hVar = FindVar( name );
+        pthread_rwlock_unlock( &lock );
+    }
+
+    return hVar;
+}
+
+/*============================================================================*/
+/*  VAR_Get                                                                   */
+/*!
+    Get the value of a variable
+
+    The value of a string variable is copied into the buffer described
+    by the val.str and len members of the variable object.
+
+    @param[in]
+        hVarServer
+            handle of the mock variable server
+
+    @param[in]
+        hVar
+            handle of the variable to get
+
+    @param[in,out]
+        pVarObject
+            pointer to the variable object to store the value in
+
+    @retval EOK the value was retrieved
+    @retval ENOENT the variable does not exist
+    @retval E2BIG the string buffer is too small
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VAR_Get( VARSERVER_HANDLE hVarServer,
+             VAR_HANDLE hVar,
+             VarObject *pVarObject )
+{
+    int result = EINVAL;
+    VarMockVar *pVar;
+    size_t len;
+
+    if ( ( hVarServer != NULL ) &&
+         ( pVarObject != NULL ) )
+    {
+        pthread_rwlock_rdlock( &lock );
+
+        pVar = GetVar( hVar );
+        if ( pVar == NULL )
+        {
+            result = ENOENT;
+        }
+        else if ( pVar->info.var.type == VARTYPE_STR )
+        {
+            len = strlen( pVar->str ) + 1;
+            if ( ( pVarObject->val.str != NULL ) &&
+                 ( pVarObject->len >= len ) )
+            {
+                memcpy( pVarObject->val.str, pVar->str, len );
+                pVarObject->type = VARTYPE_STR;
+                result = EOK;
+            }
+            else
+            {
+                result = E2BIG;
+            }
+        }
+        else
+        {
+            *pVarObject = pVar->info.var;
+            result = EOK;
+        }
+
+        pthread_rwlock_unlock( &lock );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_Set                                                                   */
+/*!
+    Set the value of a variable
+
+    The VAR_Set function updates the value of a variable, and queues
+    a SIG_VAR_MODIFIED signal to the process if a modification
+    notification is registered for it.  String values which do not
+    fit in the variable storage are truncated.
+
+    @param[in]
+        hVarServer
+            handle of the mock variable server
+
+    @param[in]
+        hVar
+            handle of the variable to set
+
+    @param[in]
+        pVarObject
+            pointer to the new value
+
+    @retval EOK the value was set
+    @retval ENOENT the variable does not exist
+    @retval EINVAL invalid arguments or mismatched type
+
+==============================================================================*/
+int VAR_Set( VARSERVER_HANDLE hVarServer,
+             VAR_HANDLE hVar,
+             VarObject *pVarObject )
+{
+    int result = EINVAL;
+    VarMockVar *pVar;
+    bool notify = false;
+    union sigval val;
+
+    if ( ( hVarServer != NULL ) &&
+         ( pVarObject != NULL ) )
+    {
+        pthread_rwlock_wrlock( &lock );
+
+        pVar = GetVar( hVar );
+        if ( pVar == NULL )
+        {
+            result = ENOENT;
+        }
+        else if ( pVarObject->type != pVar->info.var.type )
+        {
+            result = EINVAL;
+        }
+        else if ( pVarObject->type == VARTYPE_STR )
+        {
+            if ( pVarObject->val.str != NULL )
+            {
+                snprintf( pVar->str,
+                          pVar->info.var.len,
+                          "%s",
+                          pVarObject->val.str );
+                result = EOK;
+            }
+        }
+        else
+        {
+            pVar->info.var.val = pVarObject->val;
+            result = EOK;
+        }
+
+        if ( result == EOK )
+        {
+            notify = pVar->notify;
+        }
+
+        pthread_rwlock_unlock( &lock );
+    }
+
+    if ( notify == true )
+    {
+        /* a full signal queue loses the notification, as it would
+           with the variable server */
+        val.sival_int = (int)hVar;
+        sigqueue( getpid(), SIG_VAR_MODIFIED, val );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_GetInfo                                                               */
+/*!
+    Get the definition of a variable
+
+    @param[in]
+        hVarServer
+            handle of the mock variable server
+
+    @param[in]
+        hVar
+            handle of the variable
+
+    @param[out]
+        pVarInfo
+            pointer to a location to store the variable definition
+
+    @retval EOK the definition was retrieved
+    @retval ENOENT the variable does not exist
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VAR_GetInfo( VARSERVER_HANDLE hVarServer,
+                 VAR_HANDLE hVar,
+                 VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    VarMockVar *pVar;
+
+    if ( ( hVarServer != NULL ) &&
+         ( pVarInfo != NULL ) )
+    {
+        pthread_rwlock_rdlock( &lock );
+
+        pVar = GetVar( hVar );
+        if ( pVar != NULL )
+        {
+            *pVarInfo = pVar->info;
+            pVarInfo->var.val.str = NULL;
+            result = EOK;
+        }
+        else
+        {
+            result = ENOENT;
+        }
+
+        pthread_rwlock_unlock( &lock );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_Print                                                                 */
+/*!
+    Print the value of a variable to a file descriptor
+
+    @param[in]
+        hVarServer
+            handle of the mock variable server
+
+    @param[in]
+        hVar
+            handle of the variable to print
+
+    @param[in]
+        fd
+            file descriptor to print the value to
+
+    @retval EOK the value was printed
+    @retval ENOENT the variable does not exist
+    @retval EIO the value could not be written
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VAR_Print( VARSERVER_HANDLE hVarServer, VAR_HANDLE hVar, int fd )
+{
+    int result = EINVAL;
+    VarMockVar *pVar;
+    VarData *pVal;
+    int n = -1;
+
+    if ( hVarServer != NULL )
+    {
+        pthread_rwlock_rdlock( &lock );
+
+        pVar = GetVar( hVar );
+        if ( pVar != NULL )
+        {
+            pVal = &pVar->info.var.val;
+            switch( pVar->info.var.type )
+            {
+                case VARTYPE_UINT16:
+                    n = dprintf( fd, "%u", pVal->ui );
+                    break;
+
+                case VARTYPE_INT16:
+                    n = dprintf( fd, "%d", pVal->i );
+                    break;
+
+                case VARTYPE_UINT32:
+                    n = dprintf( fd, "%u", pVal->ul );
+                    break;
+
+                case VARTYPE_INT32:
+                    n = dprintf( fd, "%d", pVal->l );
+                    break;
+
+                case VARTYPE_UINT64:
+                    n = dprintf( fd, "%llu", (unsigned long long)pVal->ull );
+                    break;
+
+                case VARTYPE_INT64:
+                    n = dprintf( fd, "%lld", (long long)pVal->ll );
+                    break;
+
+                case VARTYPE_FLOAT:
+                    n = dprintf( fd, "%f", pVal->f );
+                    break;
+
+                case VARTYPE_STR:
+                    n = dprintf( fd, "%s", pVar->str );
+                    break;
+
+                default:
+                    n = 0;
+                    break;
+            }
+
+            result = ( n >= 0 ) ? EOK : EIO;
+        }
+        else
+        {
+            result = ENOENT;
+        }
+
+        pthread_rwlock_unlock( &lock );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_Notify                                                                */
+/*!
+    Register for a variable notification
+
+    Only modification notifications are supported.
+
+    @param[in]
+        hVarServer
+            handle of the mock variable server
+
+    @param[in]
+        hVar
+            handle of the variable
+
+    @param[in]
+        notificationType
+            type of notification to register for
+
+    @retval EOK the notification was registered
+    @retval ENOENT the variable does not exist
+    @retval ENOTSUP the notification type is not supported
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VAR_Notify( VARSERVER_HANDLE hVarServer,
+                VAR_HANDLE hVar,
+                NotificationType notificationType )
+{
+    int result = EINVAL;
+    VarMockVar *pVar;
+
+    if ( hVarServer != NULL )
+    {
+        pthread_rwlock_wrlock( &lock );
+
+        pVar = GetVar( hVar );
+        if ( pVar == NULL )
+        {
+            result = ENOENT;
+        }
+        else if ( notificationType != NOTIFY_MODIFIED )
+        {
+            result = ENOTSUP;
+        }
+        else
+        {
+            pVar->notify = true;
+            result = EOK;
+        }
+
+        pthread_rwlock_unlock( &lock );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_NotifyCancel                                                          */
+/*!
+    Cancel a variable notification
+
+    @param[in]
+        hVarServer
+            handle of the mock variable server
+
+    @param[in]
+        hVar
+            handle of the variable
+
+    @param[in]
+        notificationType
+            type of notification to cancel
+
+    @retval EOK the notification was cancelled
+    @retval ENOENT the variable does not exist
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VAR_NotifyCancel( VARSERVER_HANDLE hVarServer,
+                      VAR_HANDLE hVar,
+                      NotificationType notificationType )
+{
+    int result = EINVAL;
+    VarMockVar *pVar;
+
+    if ( hVarServer != NULL )
+    {
+        pthread_rwlock_wrlock( &lock );
+
+        pVar = GetVar( hVar );
+        if ( pVar == NULL )
+        {
+            result = ENOENT;
+        }
+        else
+        {
+            if ( notificationType == NOTIFY_MODIFIED )
+            {
+                pVar->notify = false;
+            }
+
+            result = EOK;
+        }
+
+        pthread_rwlock_unlock( &lock );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARQUERY_CacheUnique                                                      */
+/*!
+    Add the variables which match a query to a variable cache
+
+    The VARQUERY_CacheUnique function adds every variable which matches
+    all of the search criteria of the query, and is not already in the
+    cache, to the variable cache.
+
+    @param[in]
+        hVarServer
+            handle of the mock variable server
+
+    @param[in]
+        pQuery
+            pointer to the variable query
+
+    @param[in]
+        pVarCache
+            pointer to the variable cache to add the variables to
+
+    @retval EOK the query was run
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments or regular expression
+
+==============================================================================*/
+int VARQUERY_CacheUnique( VARSERVER_HANDLE hVarServer,
+                          VarQuery *pQuery,
+                          VarCache *pVarCache )
+{
+    int result = EINVAL;
+    regex_t regex;
+    bool useRegex = false;
+    size_t i;
+
+    if ( ( hVarServer != NULL ) &&
+         ( pQuery != NULL ) &&
+         ( pVarCache != NULL ) )
+    {
+        result = EOK;
+
+        if ( pQuery->type & QUERY_REGEX )
+        {
+            if ( ( pQuery->match != NULL ) &&
+                 ( regcomp( &regex, pQuery->match, REG_NOSUB ) == 0 ) )
+            {
+                useRegex = true;
+            }
+            else
+            {
+                result = EINVAL;
+            }
+        }
+
+        pthread_rwlock_rdlock( &lock );
+
+        for ( i = 0; ( result == EOK ) && ( i < numVars ); i++ )
+        {
+            if ( QueryMatch( pQuery,
+                             ( useRegex == true ) ? &regex : NULL,
+                             &pVars[i].info ) == true )
+            {
+                if ( VARCACHE_AddUnique( pVarCache,
+                                         pVars[i].info.hVar ) == ENOMEM )
+                {
+                    result = ENOMEM;
+                }
+            }
+        }
+
+        pthread_rwlock_unlock( &lock );
+
+        if ( useRegex == true )
+        {
+            regfree( &regex );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARCACHE_Init                                                             */
+/*!
+    Create a variable cache
+
+    @param[out]
+        ppVarCache
+            pointer to a location to store the new variable cache
+
+    @param[in]
+        initialSize
+            initial number of handles to allocate
+
+    @param[in]
+        growBy
+            number of handles to grow the cache by when it is full
+
+    @retval EOK the variable cache was created
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARCACHE_Init( VarCache **ppVarCache, size_t initialSize, size_t growBy )
+{
+    int result = EINVAL;
+    VarCache *pVarCache;
+
+    if ( ppVarCache != NULL )
+    {
+        result = ENOMEM;
+
+        pVarCache = calloc( 1, sizeof( VarCache ) );
+        if ( pVarCache != NULL )
+        {
+            pVarCache->size = ( initialSize > 0 ) ? initialSize : 1;
+            pVarCache->growBy = ( growBy > 0 ) ? growBy : 1;
+            pVarCache->pHandles = calloc( pVarCache->size,
+                                          sizeof( VAR_HANDLE ) );
+            if ( pVarCache->pHandles != NULL )
+            {
+                *ppVarCache = pVarCache;
+                result = EOK;
+            }
+            else
+            {
+                free( pVarCache );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARCACHE_Add                                                              */
+/*!
+    Add a variable handle to a variable cache
+
+    @param[in]
+        pVarCache
+            pointer to the variable cache
+
+    @param[in]
+        hVar
+            handle of the variable to add
+
+    @retval EOK the handle was added
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARCACHE_Add( VarCache *pVarCache, VAR_HANDLE hVar )
+{
+    int result = EINVAL;
+    VAR_HANDLE *p;
+    size_t size;
+
+    if ( pVarCache != NULL )
+    {
+        result = EOK;
+
+        if ( pVarCache->n == pVarCache->size )
+        {
+            size = pVarCache->size + pVarCache->growBy;
+            p = realloc( pVarCache->pHandles, size * sizeof( VAR_HANDLE ) );
+            if ( p != NULL )
+            {
+                pVarCache->pHandles = p;
+                pVarCache->size = size;
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+
+        if ( result == EOK )
+        {
+            pVarCache->pHandles[pVarCache->n++] = hVar;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARCACHE_AddUnique                                                        */
+/*!
+    Add a variable handle to a variable cache if it is not already there
+
+    @param[in]
+        pVarCache
+            pointer to the variable cache
+
+    @param[in]
+        hVar
+            handle of the variable to add
+
+    @retval EOK the handle was added
+    @retval EEXIST the handle is already in the cache
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARCACHE_AddUnique( VarCache *pVarCache, VAR_HANDLE hVar )
+{
+    int result;
+
+    if ( VARCACHE_HasVar( pVarCache, hVar ) == true )
+    {
+        result = EEXIST;
+    }
+    else
+    {
+        result = VARCACHE_Add( pVarCache, hVar );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARCACHE_HasVar                                                           */
+/*!
+    Check if a variable handle is in a variable cache
+
+    @param[in]
+        pVarCache
+            pointer to the variable cache
+
+    @param[in]
+        hVar
+            handle of the variable to look for
+
+    @retval true the handle is in the cache
+    @retval false the handle is not in the cache
+
+==============================================================================*/
+bool VARCACHE_HasVar( VarCache *pVarCache, VAR_HANDLE hVar )
+{
+    bool found = false;
+    size_t i;
+
+    for ( i = 0; ( pVarCache != NULL ) && ( i < pVarCache->n ); i++ )
+    {
+        if ( pVarCache->pHandles[i] == hVar )
+        {
+            found = true;
+            break;
+        }
+    }
+
+    return found;
+}
+
+/*============================================================================*/
+/*  VARCACHE_Map                                                              */
+/*!
+    Call a function for each variable handle in a variable cache
+
+    @param[in]
+        pVarCache
+            pointer to the variable cache
+
+    @param[in]
+        fn
+            function to call for each variable handle
+
+    @param[in]
+        arg
+            opaque argument passed to the function
+
+    @retval EOK the function succeeded for every handle
+    @retval EINVAL invalid arguments
+    @retval other the last error returned by the function
+
+==============================================================================*/
+int VARCACHE_Map( VarCache *pVarCache,
+                  int (*fn)( VAR_HANDLE hVar, void *arg ),
+                  void *arg )
+{
+    int result = EINVAL;
+    size_t i;
+    int rc;
+
+    if ( ( pVarCache != NULL ) &&
+         ( fn != NULL ) )
+    {
+        result = EOK;
+
+        for ( i = 0; i < pVarCache->n; i++ )
+        {
+            rc = fn( pVarCache->pHandles[i], arg );
+            if ( rc != EOK )
+            {
+                result = rc;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARCACHE_Size                                                             */
+/*!
+    Get the number of variable handles in a variable cache
+
+    @param[in]
+        pVarCache
+            pointer to the variable cache
+
+    @retval number of variable handles in the cache
+
+==============================================================================*/
+int VARCACHE_Size( VarCache *pVarCache )
+{
+    return ( pVarCache != NULL ) ? (int)pVarCache->n : 0;
+}
+
+/*============================================================================*/
+/*  VARCACHE_Get                                                              */
+/*!
+    Get a variable handle from a variable cache
+
+    @param[in]
+        pVarCache
+            pointer to the variable cache
+
+    @param[in]
+        idx
+            index of the variable handle to get
+
+    @retval the variable handle
+    @retval VAR_INVALID the index is out of range
+
+==============================================================================*/
+VAR_HANDLE VARCACHE_Get( VarCache *pVarCache, int idx )
+{
+    VAR_HANDLE hVar = VAR_INVALID;
+
+    if ( ( pVarCache != NULL ) &&
+         ( idx >= 0 ) &&
+         ( (size_t)idx < pVarCache->n ) )
+    {
+        hVar = pVarCache->pHandles[idx];
+    }
+
+    return hVar;
+}
+
+/*============================================================================*/
+/*  VARCACHE_Clear                                                            */
+/*!
+    Remove all of the variable handles from a variable cache
+
+    @param[in]
+        pVarCache
+            pointer to the variable cache
+
+    @retval EOK the cache was cleared
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARCACHE_Clear( VarCache *pVarCache )
+{
+    int result = EINVAL;
+
+    if ( pVarCache != NULL )
+    {
+        pVarCache->n = 0;
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARCACHE_Free                                                             */
+/*!
+    Release a variable cache
+
+    @param[in]
+        pVarCache
+            pointer to the variable cache to release
+
+==============================================================================*/
+void VARCACHE_Free( VarCache *pVarCache )
+{
+    if ( pVarCache != NULL )
+    {
+        free( pVarCache->pHandles );
+        free( pVarCache );
+    }
+}
+
+/*============================================================================*/
+/*  VARFP_Open                                                                */
+/*!
+    Open a memory buffer backed by a file descriptor
+
+    @param[in]
+        name
+            name of the memory buffer
+
+    @param[in]
+        size
+            size of the memory buffer
+
+    @retval pointer to the new VarFP object
+    @retval NULL the memory buffer could not be created
+
+==============================================================================*/
+VarFP *VARFP_Open( char *name, size_t size )
+{
+    VarFP *pVarFP = NULL;
+    int fd;
+    char *pData;
+
+    if ( ( name != NULL ) &&
+         ( size > 0 ) )
+    {
+        fd = memfd_create( name, MFD_CLOEXEC );
+        if ( ( fd != -1 ) &&
+             ( ftruncate( fd, size ) == 0 ) )
+        {
+            pData = mmap( NULL,
+                          size,
+                          PROT_READ | PROT_WRITE,
+                          MAP_SHARED,
+                          fd,
+                          0 );
+            if ( pData != MAP_FAILED )
+            {
+                pVarFP = calloc( 1, sizeof( VarFP ) );
+                if ( pVarFP != NULL )
+                {
+                    pVarFP->fd = fd;
+                    pVarFP->pData = pData;
+                    pVarFP->size = size;
+                }
+                else
+                {
+                    munmap( pData, size );
+                }
+            }
+        }
+
+        if ( ( pVarFP == NULL ) && ( fd != -1 ) )
+        {
+            close( fd );
+        }
+    }
+
+    return pVarFP;
+}
+
+/*============================================================================*/
+/*  VARFP_GetFd                                                               */
+/*!
+    Get the file descriptor of a memory buffer
+
+    @param[in]
+        pVarFP
+            pointer to the VarFP object
+
+    @retval the file descriptor
+    @retval -1 invalid arguments
+
+==============================================================================*/
+int VARFP_GetFd( VarFP *pVarFP )
+{
+    return ( pVarFP != NULL ) ? pVarFP->fd : -1;
+}
+
+/*============================================================================*/
+/*  VARFP_GetData                                                             */
+/*!
+    Get a pointer to the content of a memory buffer
+
+    @param[in]
+        pVarFP
+            pointer to the VarFP object
+
+    @retval pointer to the memory buffer
+    @retval NULL invalid arguments
+
+==============================================================================*/
+char *VARFP_GetData( VarFP *pVarFP )
+{
+    return ( pVarFP != NULL ) ? pVarFP->pData : NULL;
+}
+
+/*============================================================================*/
+/*  VARFP_Close                                                               */
+/*!
+    Close a memory buffer
+
+    @param[in]
+        pVarFP
+            pointer to the VarFP object to close
+
+    @retval EOK the memory buffer was closed
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARFP_Close( VarFP *pVarFP )
+{
+    int result = EINVAL;
+
+    if ( pVarFP != NULL )
+    {
+        munmap( pVarFP->pData, pVarFP->size );
+        close( pVarFP->fd );
+        free( pVarFP );
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  GetVar                                                                    */
+/*!
+    Get a variable from the variable table
+
+    The caller must hold the table lock.
+
+    @param[in]
+        hVar
+            handle of the variable
+
+    @retval pointer to the variable
+    @retval NULL the variable does not exist
+
+==============================================================================*/
+static VarMockVar *GetVar( VAR_HANDLE hVar )
+{
+    return ( ( hVar != VAR_INVALID ) && ( hVar <= numVars ) )
+           ? &pVars[hVar - 1]
+           : NULL;
+}
+
+/*============================================================================*/
+/*  FindVar                                                                   */
+/*!
+    Find a variable in the variable table by name
+
+    The caller must hold the table lock.
+
+    @param[in]
+        name
+            name of the variable to find
+
+    @retval handle of the variable
+    @retval VAR_INVALID the variable was not found
+
+==============================================================================*/
+static VAR_HANDLE FindVar( const char *name )
+{
+    VAR_HANDLE hVar = VAR_INVALID;
+    size_t i;
+
+    for ( i = 0; i < numVars; i++ )
+    {
+        if ( strcmp( pVars[i].info.name, name ) == 0 )
+        {
+            hVar = pVars[i].info.hVar;
+            break;
+        }
+    }
+
+    return hVar;
+}
+
+/*============================================================================*/
+/*  HasTags                                                                   */
+/*!
+    Check if a variable has all of the specified tags
+
+    @param[in]
+        tagspec
+            comma separated list of the variable's tags
+
+    @param[in]
+        tags
+            comma separated list of the tags to look for
+
+    @retval true the variable has every tag
+    @retval false the variable is missing a tag
+
+==============================================================================*/
+static bool HasTags( const char *tagspec, const char *tags )
+{
+    bool found = true;
+    const char *tag = tags;
+    const char *p;
+    size_t len;
+
+    while ( ( found == true ) && ( *tag != '\0' ) )
+    {
+        len = strcspn( tag, "," );
+
+        /* look for the tag as a complete element of the tagspec */
+        found = false;
+        p = tagspec;
+        while ( ( found == false ) && ( *p != '\0' ) )
+        {
+            if ( ( strncmp( p, tag, len ) == 0 ) &&
+                 ( ( p[len] == ',' ) || ( p[len] == '\0' ) ) )
+            {
+                found = true;
+            }
+
+            p += strcspn( p, "," );
+            p += ( *p == ',' ) ? 1 : 0;
+        }
+
+        tag += len;
+        tag += ( *tag == ',' ) ? 1 : 0;
+    }
+
+    return found;
+}
+
+/*============================================================================*/
+/*  QueryMatch                                                                */
+/*!
+    Check if a variable matches a variable query
+
+    @param[in]
+        pQuery
+            pointer to the variable query
+
+    @param[in]
+        pRegex
+            pointer to the compiled regular expression for a
+            QUERY_REGEX query, or NULL
+
+    @param[in]
+        pInfo
+            pointer to the variable definition
+
+    @retval true the variable matches every search criterion
+    @retval false the variable does not match
+
+==============================================================================*/
+static bool QueryMatch( VarQuery *pQuery, regex_t *pRegex, VarInfo *pInfo )
+{
+    bool match = true;
+
+    if ( pRegex != NULL )
+    {
+        match = ( regexec( pRegex, pInfo->name, 0, NULL, 0 ) == 0 );
+    }
+    else if ( ( pQuery->type & QUERY_MATCH ) &&
+              ( pQuery->match != NULL ) )
+    {
+        match = ( strstr( pInfo->name, pQuery->match ) != NULL );
+    }
+
+    if ( ( match == true ) &&
+         ( pQuery->type & QUERY_TAGS ) )
+    {
+        match = HasTags( pInfo->tagspec, pQuery->tagspec );
+    }
+
+    if ( ( match == true ) &&
+         ( pQuery->type & QUERY_FLAGS ) )
+    {
+        match = ( ( pInfo->flags & pQuery->flags ) == pQuery->flags );
+    }
+
+    if ( ( match == true ) &&
+         ( pQuery->type & QUERY_INSTANCEID ) )
+    {
+        match = ( pInfo->instanceID == (uint32_t)pQuery->instanceID );
+    }
+
+    return match;
+}
+
+/*! @}
+ * end of varmock group */
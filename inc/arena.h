@@ -0,0 +1,94 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef ARENA_H
+#define ARENA_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stddef.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef EOK
+/*! success response */
+#define EOK 0
+#endif
+
+/*! alignment of every arena allocation */
+#define ARENA_ALIGN             ( _Alignof( max_align_t ) )
+
+/*! size an allocation of len bytes occupies in an arena */
+#define ARENA_ROUND( len ) \
+    ( ( (size_t)(len) + ARENA_ALIGN - 1 ) & ~( (size_t)ARENA_ALIGN - 1 ) )
+
+/*! The ArenaBlock object is the header of one block of arena memory.
+    The block data follows the header */
+typedef struct _arenaBlock
+{
+    /*! pointer to the next block in the arena */
+    struct _arenaBlock *pNext;
+
+    /*! number of data bytes in the block */
+    size_t size;
+
+    /*! number of data bytes allocated from the block */
+    size_t used;
+
+} ArenaBlock;
+
+/*! The Arena object owns a list of memory blocks which allocations are
+    carved from.  Allocations are never released individually; all of
+    them are released together when the arena is freed.  The Arena
+    object itself lives in the first block of the arena */
+typedef struct _arena
+{
+    /*! pointer to the block allocations are currently made from */
+    ArenaBlock *pBlocks;
+
+    /*! size of the blocks added when the arena is full */
+    size_t blockSize;
+
+    /*! total number of bytes allocated from the system */
+    size_t total;
+
+} Arena;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+Arena *ARENA_Create( size_t size );
+void *ARENA_Alloc( Arena *pArena, size_t len );
+void *ARENA_Calloc( Arena *pArena, size_t n, size_t size );
+void *ARENA_Dup( Arena *pArena, const void *pData, size_t len );
+char *ARENA_StrDup( Arena *pArena, const char *str );
+size_t ARENA_Size( Arena *pArena );
+void ARENA_Free( Arena *pArena );
+
+#endif
@@ -0,0 +1,84 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef CBOR_H
+#define CBOR_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include "msgbuf.h"
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef EOK
+/*! success response */
+#define EOK 0
+#endif
+
+/*! CBOR major type for an unsigned integer */
+#define CBOR_MAJOR_UINT     ( 0 )
+
+/*! CBOR major type for a negative integer */
+#define CBOR_MAJOR_NEGINT   ( 1 )
+
+/*! CBOR major type for a byte string */
+#define CBOR_MAJOR_BYTES    ( 2 )
+
+/*! CBOR major type for a text string */
+#define CBOR_MAJOR_TEXT     ( 3 )
+
+/*! CBOR major type for an array */
+#define CBOR_MAJOR_ARRAY    ( 4 )
+
+/*! CBOR major type for a map */
+#define CBOR_MAJOR_MAP      ( 5 )
+
+/*! CBOR major type for a tag */
+#define CBOR_MAJOR_TAG      ( 6 )
+
+/*! CBOR major type for simple values and floats */
+#define CBOR_MAJOR_SIMPLE   ( 7 )
+
+/*! maximum length of an encoded CBOR item head */
+#define CBOR_HEAD_MAX_LEN   ( 9 )
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int CBOR_AppendHead( MsgBuf *pMsgBuf, uint8_t major, uint64_t value );
+int CBOR_AppendUInt( MsgBuf *pMsgBuf, uint64_t value );
+int CBOR_AppendInt( MsgBuf *pMsgBuf, int64_t value );
+int CBOR_AppendFloat( MsgBuf *pMsgBuf, float value );
+int CBOR_AppendText( MsgBuf *pMsgBuf, const char *str, size_t len );
+int CBOR_BeginMap( MsgBuf *pMsgBuf );
+int CBOR_AppendBreak( MsgBuf *pMsgBuf );
+
+#endif
@@ -0,0 +1,92 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "msgbuf.h"
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef EOK
+/*! success response */
+#define EOK 0
+#endif
+
+/*! The CompressType specifies the compression applied to a sink */
+typedef enum _compressType
+{
+    /*! output is not compressed */
+    COMPRESS_NONE = 0,
+
+    /*! output is compressed as LZ4 frames */
+    COMPRESS_LZ4,
+
+    /*! output is compressed as Zstandard frames */
+    COMPRESS_ZSTD
+
+} CompressType;
+
+/*! The Compressor object holds a long-lived streaming compression
+    context.  Messages are compressed into the current frame, which is
+    flushed or ended at a message boundary */
+typedef struct _compressor
+{
+    /*! type of compression */
+    CompressType type;
+
+    /*! compression library context */
+    void *pCtx;
+
+    /*! a frame has been started and not yet ended */
+    bool inFrame;
+
+    /*! number of uncompressed bytes in the current frame */
+    size_t frameLen;
+
+} Compressor;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int COMPRESS_ParseType( const char *name, CompressType *pType );
+int COMPRESS_Init( Compressor *pCompressor, CompressType type );
+int COMPRESS_Write( Compressor *pCompressor,
+                    const char *pData,
+                    size_t len,
+                    MsgBuf *pOut );
+int COMPRESS_Flush( Compressor *pCompressor, MsgBuf *pOut );
+int COMPRESS_EndFrame( Compressor *pCompressor, MsgBuf *pOut );
+void COMPRESS_Free( Compressor *pCompressor );
+
+#endif
@@ -0,0 +1,96 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef EVLOOP_H
+#define EVLOOP_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdint.h>
+#include <sys/epoll.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef EOK
+/*! success response */
+#define EOK 0
+#endif
+
+/*! event mask for a readable file descriptor */
+#define EVLOOP_READ     ( EPOLLIN )
+
+/*! event mask for a writable file descriptor */
+#define EVLOOP_WRITE    ( EPOLLOUT )
+
+/*! The EvHandler function is called when the file descriptor of an
+    event source is ready.  It is passed the file descriptor, the
+    ready events and the source's argument */
+typedef void (*EvHandler)( int fd, uint32_t events, void *arg );
+
+/*! The EvSource object is one file descriptor watched by an event
+    loop.  It is owned by the caller, and must remain valid until it
+    is removed from the loop */
+typedef struct _evSource
+{
+    /*! file descriptor being watched */
+    int fd;
+
+    /*! function called when the file descriptor is ready */
+    EvHandler handler;
+
+    /*! argument passed to the handler */
+    void *arg;
+
+} EvSource;
+
+/*! The EvLoop object waits for any of a set of event sources to
+    become ready */
+typedef struct _evLoop
+{
+    /*! epoll file descriptor */
+    int epfd;
+
+} EvLoop;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int EVLOOP_Init( EvLoop *pLoop );
+int EVLOOP_Add( EvLoop *pLoop,
+                EvSource *pSource,
+                int fd,
+                uint32_t events,
+                EvHandler handler,
+                void *arg );
+int EVLOOP_Remove( EvLoop *pLoop, EvSource *pSource );
+int EVLOOP_Wait( EvLoop *pLoop, int timeout );
+void EVLOOP_Free( EvLoop *pLoop );
+
+#endif
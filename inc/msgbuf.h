@@ -0,0 +1,72 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef MSGBUF_H
+#define MSGBUF_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stddef.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef EOK
+/*! success response */
+#define EOK 0
+#endif
+
+/*! The MsgBuf object is a growable buffer used to assemble a complete
+    message in memory before it is sent to its output */
+typedef struct _msgBuf
+{
+    /*! pointer to the buffer data */
+    char *pData;
+
+    /*! number of bytes currently stored in the buffer */
+    size_t len;
+
+    /*! number of bytes allocated for the buffer */
+    size_t size;
+
+} MsgBuf;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int MSGBUF_Init( MsgBuf *pMsgBuf, size_t size );
+void MSGBUF_Reset( MsgBuf *pMsgBuf );
+int MSGBUF_Reserve( MsgBuf *pMsgBuf, size_t len );
+int MSGBUF_Append( MsgBuf *pMsgBuf, const void *pData, size_t len );
+int MSGBUF_AppendChar( MsgBuf *pMsgBuf, char c );
+int MSGBUF_AppendStr( MsgBuf *pMsgBuf, const char *str );
+int MSGBUF_AppendEscaped( MsgBuf *pMsgBuf, const char *str, size_t len );
+int MSGBUF_Printf( MsgBuf *pMsgBuf, const char *fmt, ... );
+void MSGBUF_Free( MsgBuf *pMsgBuf );
+
+#endif
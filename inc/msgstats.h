@@ -0,0 +1,126 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef MSGSTATS_H
+#define MSGSTATS_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include "msgbuf.h"
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef EOK
+/*! success response */
+#define EOK 0
+#endif
+
+/*! number of buckets in a latency histogram.  Bucket 0 counts latencies
+    below 1 microsecond, bucket i counts latencies from 2^(i-1) up to
+    2^i microseconds, and the last bucket also counts everything above */
+#define MSGSTATS_HIST_BUCKETS   ( 24 )
+
+/*! The MsgStats object holds the performance counters of one message.
+    The counters are updated atomically by the render threads without
+    any locking.  The window counters cover the time since the
+    previous snapshot */
+typedef struct _msgStats
+{
+    /*! time taken by the most recent render in microseconds */
+    uint32_t lastRender;
+
+    /*! total render time in the current window in microseconds */
+    uint64_t renderTotal;
+
+    /*! number of renders in the current window */
+    uint32_t renderCount;
+
+    /*! longest render time in the current window in microseconds */
+    uint32_t renderMax;
+
+    /*! total sink write time in the current window in microseconds */
+    uint64_t sinkTotal;
+
+    /*! total number of bytes sent */
+    uint64_t bytes;
+
+    /*! total number of variables rendered */
+    uint64_t vars;
+
+} MsgStats;
+
+/*! The MsgStatsSnapshot object holds the values published for a
+    message's performance counters */
+typedef struct _msgStatsSnapshot
+{
+    /*! time taken by the most recent render in microseconds */
+    uint32_t lastRender;
+
+    /*! average render time in the window in microseconds */
+    uint32_t avgRender;
+
+    /*! longest render time in the window in microseconds */
+    uint32_t maxRender;
+
+    /*! average sink write time in the window in microseconds */
+    uint32_t avgSink;
+
+    /*! total number of bytes sent */
+    uint64_t bytes;
+
+    /*! total number of variables rendered */
+    uint64_t vars;
+
+} MsgStatsSnapshot;
+
+/*! The LatencyHist object is a histogram of latencies with logarithmic
+    buckets, which is updated atomically without any locking */
+typedef struct _latencyHist
+{
+    /*! number of latencies counted in each bucket */
+    uint64_t count[MSGSTATS_HIST_BUCKETS];
+
+} LatencyHist;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+void MSGSTATS_Record( MsgStats *pStats,
+                      uint32_t renderUs,
+                      uint32_t sinkUs,
+                      size_t bytes,
+                      size_t vars );
+void MSGSTATS_Snapshot( MsgStats *pStats, MsgStatsSnapshot *pSnapshot );
+void MSGSTATS_HistAdd( LatencyHist *pHist, uint32_t us );
+int MSGSTATS_HistFormat( LatencyHist *pHist, MsgBuf *pMsgBuf );
+
+#endif
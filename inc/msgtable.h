@@ -0,0 +1,102 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef MSGTABLE_H
+#define MSGTABLE_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef EOK
+/*! success response */
+#define EOK 0
+#endif
+
+/*! The MsgTable object holds the scheduling state which is read each
+    time a message is triggered or is due, for all of the messages.
+    The state is stored as a structure of arrays indexed by message
+    identifier, so the state of many messages shares each cache line.
+    The rest of each message lives in the object it belongs to */
+typedef struct _msgTable
+{
+    /*! opaque pointer to the object owning each message, or NULL if
+        the identifier is not in use */
+    void **ppData;
+
+    /*! the message is enabled */
+    bool *pEnabled;
+
+    /*! a rescan of the message variable queries was requested */
+    bool *pRescan;
+
+    /*! time interval in milliseconds, or zero */
+    uint32_t *pInterval;
+
+    /*! time between automatic rescans in milliseconds, or zero */
+    uint32_t *pRescanInterval;
+
+    /*! minimum time between triggered messages in milliseconds */
+    uint32_t *pMinInterval;
+
+    /*! time to collect triggers before the message is sent in
+        milliseconds */
+    uint32_t *pDebounce;
+
+    /*! monotonic time of the last message in milliseconds */
+    uint64_t *pLastSent;
+
+    /*! load shedding priority, from 0 (highest) upwards */
+    uint32_t *pPriority;
+
+    /*! number of messages considered while the message was being shed */
+    uint32_t *pSampled;
+
+    /*! number of identifiers which have been handed out */
+    size_t n;
+
+    /*! number of table entries allocated */
+    size_t size;
+
+} MsgTable;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int MSGTABLE_Init( MsgTable *pTable, size_t size );
+int MSGTABLE_Add( MsgTable *pTable, void *pData, uint32_t *pId );
+void MSGTABLE_Remove( MsgTable *pTable, uint32_t id );
+void MSGTABLE_Free( MsgTable *pTable );
+
+#endif
@@ -0,0 +1,111 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef MSGTMPL_H
+#define MSGTMPL_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <varserver/varserver.h>
+#include "msgbuf.h"
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef EOK
+/*! success response */
+#define EOK 0
+#endif
+
+/*! The MsgTmplPartType enumeration lists the kinds of part
+    a compiled message template is made of */
+typedef enum _msgTmplPartType
+{
+    /*! static text which is copied to the message */
+    MSGTMPL_TEXT = 0,
+
+    /*! slot which is filled with the value of a variable */
+    MSGTMPL_VAR,
+
+    /*! slot which is filled with the message body */
+    MSGTMPL_BODY
+
+} MsgTmplPartType;
+
+/*! The MsgTmplPart object describes one part of a compiled template */
+typedef struct _msgTmplPart
+{
+    /*! type of template part */
+    MsgTmplPartType type;
+
+    /*! offset of the static text, or of the NUL terminated variable
+        name, in the template text buffer */
+    size_t offset;
+
+    /*! length of the static text or variable name */
+    size_t len;
+
+    /*! handle of the slot variable.  This is VAR_INVALID until it is
+        resolved by the user of the template */
+    VAR_HANDLE hVar;
+
+    /*! true if the slot variable value is formatted in-process */
+    bool typed;
+
+} MsgTmplPart;
+
+/*! The MsgTemplate object is a message template compiled into a
+    sequence of static text segments and variable slots */
+typedef struct _msgTemplate
+{
+    /*! buffer containing the static text and the slot variable names */
+    MsgBuf text;
+
+    /*! array of template parts, in message order */
+    MsgTmplPart *pParts;
+
+    /*! number of template parts */
+    size_t n;
+
+    /*! index of the message body part, or n if the template does
+        not contain one */
+    size_t bodyIdx;
+
+} MsgTemplate;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int MSGTMPL_Compile( MsgTemplate *pTmpl, const char *pText, size_t len );
+int MSGTMPL_Load( MsgTemplate *pTmpl, const char *pFileName );
+void MSGTMPL_Free( MsgTemplate *pTmpl );
+
+#endif
@@ -0,0 +1,131 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef NETCONN_H
+#define NETCONN_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include "msgbuf.h"
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef EOK
+/*! success response */
+#define EOK 0
+#endif
+
+/*! The NetConnType enumeration lists the network transports */
+typedef enum _netConnType
+{
+    /*! each message is sent as one UDP datagram */
+    NETCONN_UDP = 0,
+
+    /*! messages are sent back to back on a TCP connection */
+    NETCONN_TCP
+
+} NetConnType;
+
+/*! The NetConnState enumeration lists the states of a connection */
+typedef enum _netConnState
+{
+    /*! not connected, waiting for the next connection attempt */
+    NETCONN_IDLE = 0,
+
+    /*! a connection attempt is in progress */
+    NETCONN_CONNECTING,
+
+    /*! connected to the peer */
+    NETCONN_CONNECTED
+
+} NetConnState;
+
+/*! The NetConn object is a persistent connection to a network peer.
+    Messages are queued by NETCONN_Write and sent together by
+    NETCONN_Flush.  The connection is re-established automatically,
+    with an increasing delay between attempts, if it fails */
+typedef struct _netConn
+{
+    /*! transport used to send the messages */
+    NetConnType type;
+
+    /*! connection state */
+    NetConnState state;
+
+    /*! socket descriptor, or -1 if there is no socket */
+    int fd;
+
+    /*! address of the peer */
+    struct sockaddr_storage addr;
+
+    /*! length of the peer address */
+    socklen_t addrlen;
+
+    /*! monotonic time in milliseconds of the next connection attempt,
+        or of the connection timeout while connecting */
+    uint64_t retryAt;
+
+    /*! delay before the next connection attempt in milliseconds */
+    uint32_t backoff;
+
+    /*! queued message data */
+    MsgBuf queue;
+
+    /*! number of bytes at the start of the queue which have been sent */
+    size_t sent;
+
+    /*! end offset of each queued message in the queue */
+    size_t *pEnds;
+
+    /*! number of queued messages */
+    size_t n;
+
+    /*! number of end offsets allocated */
+    size_t size;
+
+    /*! index of the first queued message which has not been sent
+        completely */
+    size_t first;
+
+} NetConn;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int NETCONN_Open( NetConn *pConn, NetConnType type, const char *address );
+int NETCONN_Write( NetConn *pConn, const char *pData, size_t len );
+int NETCONN_Flush( NetConn *pConn );
+uint64_t NETCONN_RetryAt( NetConn *pConn );
+void NETCONN_Close( NetConn *pConn );
+
+#endif
@@ -0,0 +1,122 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef OUTQ_H
+#define OUTQ_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include "ring.h"
+#include "sink.h"
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef EOK
+/*! success response */
+#define EOK 0
+#endif
+
+/*! The OutQPolicy specifies what happens when a message is written
+    to a full output queue */
+typedef enum _outQPolicy
+{
+    /*! wait for the writer to make room in the queue */
+    OUTQ_POLICY_BLOCK = 0,
+
+    /*! discard the oldest queued message to make room */
+    OUTQ_POLICY_DROP_OLDEST,
+
+    /*! discard the message being written */
+    OUTQ_POLICY_DROP_NEWEST
+
+} OutQPolicy;
+
+/*! The OutQItem object is a finished message waiting to be written
+    to its sink */
+typedef struct _outQItem
+{
+    /*! sink the message is written to */
+    MsgSink *pSink;
+
+    /*! counter incremented if the message is discarded */
+    uint32_t *pDropped;
+
+    /*! length of the message */
+    size_t len;
+
+    /*! message data */
+    char data[];
+
+} OutQItem;
+
+/*! The OutQ object is a bounded queue of finished messages which
+    are written to their sinks by a dedicated writer thread */
+typedef struct _outQ
+{
+    /*! ring of pointers to queued items */
+    Ring ring;
+
+    /*! counts the free slots in the ring */
+    sem_t slots;
+
+    /*! counts the queued items in the ring */
+    sem_t items;
+
+    /*! posted when the writer reaches a sync marker */
+    sem_t synced;
+
+    /*! full queue policy */
+    OutQPolicy policy;
+
+    /*! held while a producer discards the oldest message */
+    pthread_mutex_t dropLock;
+
+    /*! writer thread */
+    pthread_t writer;
+
+} OutQ;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+OutQ *OUTQ_Create( size_t depth, OutQPolicy policy );
+int OUTQ_Write( OutQ *pOutQ,
+                MsgSink *pSink,
+                const char *pData,
+                size_t len,
+                uint32_t *pDropped );
+int OUTQ_Sync( OutQ *pOutQ );
+size_t OUTQ_Depth( OutQ *pOutQ );
+int OUTQ_ParsePolicy( const char *name, OutQPolicy *pPolicy );
+
+#endif
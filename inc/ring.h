@@ -0,0 +1,95 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef RING_H
+#define RING_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef EOK
+/*! success response */
+#define EOK 0
+#endif
+
+/*! size of a cache line, used to keep the ring positions apart */
+#define RING_CACHE_LINE     ( 64 )
+
+/*! The RingCell object is one slot in the ring */
+typedef struct _ringCell
+{
+    /*! sequence number used to synchronize producers and consumers */
+    size_t seq;
+
+    /*! pointer stored in the slot */
+    void *pData;
+
+} RingCell;
+
+/*! The Ring object is a bounded lock-free multi-producer multi-consumer
+    queue of pointers */
+typedef struct _ring
+{
+    /*! array of ring slots */
+    RingCell *pCells;
+
+    /*! number of slots minus one ( the number of slots is a power of two ) */
+    size_t mask;
+
+    /*! padding to keep the enqueue position on its own cache line */
+    char pad0[RING_CACHE_LINE];
+
+    /*! enqueue position */
+    size_t head;
+
+    /*! padding to keep the dequeue position on its own cache line */
+    char pad1[RING_CACHE_LINE];
+
+    /*! dequeue position */
+    size_t tail;
+
+    /*! padding after the dequeue position */
+    char pad2[RING_CACHE_LINE];
+
+} Ring;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int RING_Init( Ring *pRing, size_t size );
+bool RING_Push( Ring *pRing, void *pData );
+bool RING_Pop( Ring *pRing, void **ppData );
+size_t RING_Size( Ring *pRing );
+void RING_Free( Ring *pRing );
+
+#endif
@@ -0,0 +1,94 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef EOK
+/*! success response */
+#define EOK 0
+#endif
+
+/*! heap position of an item which is not scheduled */
+#define SCHED_NONE  ( (size_t)-1 )
+
+/*! The SchedItem object is a single scheduled event.  It is embedded
+    in the object which owns the event, and must be initialized with
+    SCHED_InitItem before it is used */
+typedef struct _schedItem
+{
+    /*! time the item is due */
+    uint64_t due;
+
+    /*! type of the event, for use by the owner */
+    uint32_t type;
+
+    /*! pointer to the object which owns the event */
+    void *pData;
+
+    /*! position of the item in the heap, or SCHED_NONE */
+    size_t pos;
+
+} SchedItem;
+
+/*! The Sched object is a binary min-heap of scheduled items ordered
+    by their due time */
+typedef struct _sched
+{
+    /*! array of pointers to the scheduled items */
+    SchedItem **ppHeap;
+
+    /*! number of scheduled items */
+    size_t n;
+
+    /*! number of heap entries allocated */
+    size_t size;
+
+} Sched;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int SCHED_Init( Sched *pSched, size_t size );
+void SCHED_InitItem( SchedItem *pItem, uint32_t type, void *pData );
+int SCHED_Insert( Sched *pSched, SchedItem *pItem, uint64_t due );
+int SCHED_Remove( Sched *pSched, SchedItem *pItem );
+SchedItem *SCHED_Top( Sched *pSched );
+bool SCHED_IsScheduled( SchedItem *pItem );
+void SCHED_Free( Sched *pSched );
+
+#endif
@@ -0,0 +1,86 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef SHED_H
+#define SHED_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef EOK
+/*! success response */
+#define EOK 0
+#endif
+
+/*! highest shed level.  Level 0 does not shed any messages */
+#define SHED_LEVEL_MAX          ( 3 )
+
+/*! lowest message priority.  Priority 0 messages are never shed */
+#define SHED_PRIORITY_LOWEST    ( 3 )
+
+/*! The ShedCtl object decides how much of the message load is shed.
+    It compares the measured render time with a render time budget,
+    raises the shed level while the budget is exceeded, and lowers it
+    again once the load has dropped.  An operator can override the
+    automatic shed level */
+typedef struct _shedCtl
+{
+    /*! render time budget in microseconds per second, or zero if the
+        shed level is not controlled automatically */
+    uint32_t budget;
+
+    /*! current shed level, from zero to SHED_LEVEL_MAX */
+    uint32_t level;
+
+    /*! shed level set by an operator, or -1 for automatic control */
+    int32_t override;
+
+    /*! number of consecutive measurements well under the budget */
+    uint32_t calm;
+
+    /*! render time in microseconds per second of the most recent
+        measurement */
+    uint64_t load;
+
+} ShedCtl;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+void SHED_Init( ShedCtl *pCtl, uint32_t budget );
+bool SHED_Update( ShedCtl *pCtl, uint64_t renderUs, uint64_t elapsedMs );
+bool SHED_Override( ShedCtl *pCtl, int32_t level );
+uint32_t SHED_Factor( ShedCtl *pCtl, uint32_t priority );
+
+#endif
@@ -0,0 +1,155 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef SHMRING_H
+#define SHMRING_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef EOK
+/*! success response */
+#define EOK 0
+#endif
+
+/*! magic number at the start of a shared memory ring ("VMSR") */
+#define SHMRING_MAGIC           ( 0x524D5356 )
+
+/*! version of the shared memory ring layout */
+#define SHMRING_VERSION         ( 1 )
+
+/*! size of the ring header.  The message data starts at this offset
+    from the start of the shared memory object */
+#define SHMRING_HEADER_SIZE     ( 4096 )
+
+/*! alignment of the records in the ring */
+#define SHMRING_ALIGN           ( 8 )
+
+/*! record flag indicating that the rest of the ring up to the wrap
+    point is padding, and the next record is at the start of the ring */
+#define SHMRING_REC_PAD         ( 1 )
+
+/*! The ShmRingHeader object is at the start of the shared memory
+    object.  The producer and consumer positions are byte counts which
+    increase forever, and are reduced modulo the ring size to find
+    their offset in the data area.  Each position is on its own cache
+    line. */
+typedef struct _shmRingHeader
+{
+    /*! SHMRING_MAGIC */
+    uint32_t magic;
+
+    /*! SHMRING_VERSION */
+    uint32_t version;
+
+    /*! size of the data area in bytes ( a power of two ) */
+    uint64_t size;
+
+    /*! number of messages which were dropped because the ring
+        was full */
+    uint64_t dropped;
+
+    /*! padding to the next cache line */
+    uint8_t pad0[40];
+
+    /*! producer position: the end of the last published record.
+        This is written with release semantics by the producer */
+    uint64_t head;
+
+    /*! padding to the next cache line */
+    uint8_t pad1[56];
+
+    /*! consumer position: the end of the last consumed record.
+        This is written with release semantics by the consumer */
+    uint64_t tail;
+
+    /*! padding to the next cache line */
+    uint8_t pad2[56];
+
+    /*! doorbell futex word, incremented by the producer when new
+        records have been published */
+    uint32_t doorbell;
+
+    /*! number of consumers sleeping on the doorbell.  The producer
+        only makes the wake up system call if this is not zero */
+    uint32_t waiters;
+
+} ShmRingHeader;
+
+/*! The ShmRingRecord object is the header of each record in the ring.
+    Records start on an SHMRING_ALIGN boundary and are padded to the
+    next boundary */
+typedef struct _shmRingRecord
+{
+    /*! length of the message data following the record header */
+    uint32_t len;
+
+    /*! record flags */
+    uint32_t flags;
+
+} ShmRingRecord;
+
+/*! The ShmRing object is a process local handle to a mapped
+    shared memory ring */
+typedef struct _shmRing
+{
+    /*! pointer to the mapped ring header */
+    ShmRingHeader *pHeader;
+
+    /*! pointer to the data area of the ring */
+    uint8_t *pData;
+
+    /*! size of the mapping */
+    size_t mapsize;
+
+    /*! producer position when the doorbell was last rung */
+    uint64_t rung;
+
+    /*! consumer position after the record returned by SHMRING_Read */
+    uint64_t next;
+
+} ShmRing;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int SHMRING_Create( ShmRing *pRing, const char *name, size_t size );
+int SHMRING_Attach( ShmRing *pRing, const char *name );
+int SHMRING_Write( ShmRing *pRing, const char *pData, size_t len );
+void SHMRING_Notify( ShmRing *pRing );
+int SHMRING_Read( ShmRing *pRing, const char **ppData, size_t *pLen );
+void SHMRING_Release( ShmRing *pRing );
+int SHMRING_Wait( ShmRing *pRing );
+void SHMRING_Close( ShmRing *pRing );
+
+#endif
@@ -0,0 +1,144 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef SINK_H
+#define SINK_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <mqueue.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include "msgbuf.h"
+#include "compress.h"
+#include "shmring.h"
+#include "netconn.h"
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+/*! The MsgOutputType specifies the type of output target to write to */
+typedef enum _msgOutputType
+{
+    /*! output disabled */
+    VARMSG_OUTPUT_DISABLED = 0,
+
+    /*! output to stdout */
+    VARMSG_OUTPUT_STDOUT,
+
+    /*! output to message queue */
+    VARMSG_OUTPUT_MQUEUE,
+
+    /*! output to file */
+    VARMSG_OUTPUT_FILE,
+
+    /*! output to a shared memory ring */
+    VARMSG_OUTPUT_SHM,
+
+    /*! output to a UDP peer */
+    VARMSG_OUTPUT_UDP,
+
+    /*! output to a TCP peer */
+    VARMSG_OUTPUT_TCP
+
+} MsgOutputType;
+
+/*! The MsgSink object manages an open output target.  Sinks are opened
+    once and shared by all of the messages which write to the same
+    output */
+typedef struct _msgSink
+{
+    /*! type of output */
+    MsgOutputType type;
+
+    /*! name of the output (file, message queue or shared memory name,
+        or network peer address) */
+    char *name;
+
+    /*! output file descriptor for stdout and file outputs */
+    int fd;
+
+    /*! device of the stdout or file output, used to find a file which
+        is opened again by another name */
+    dev_t dev;
+
+    /*! inode of the stdout or file output */
+    ino_t ino;
+
+    /*! message queue descriptor for message queue outputs */
+    mqd_t mq;
+
+    /*! shared memory ring for shared memory outputs */
+    ShmRing shm;
+
+    /*! network connection for UDP and TCP outputs */
+    NetConn net;
+
+    /*! maximum size of a message queue message */
+    size_t msgsize;
+
+    /*! messages waiting to be sent to the message queue, or compressed
+        data waiting to be written to the file */
+    MsgBuf batch;
+
+    /*! streaming compressor for compressed outputs */
+    Compressor compressor;
+
+    /*! number of messages using this sink */
+    size_t refCount;
+
+    /*! indicates if a flush retry has been signalled since the retry
+        times were last collected by SINK_FlushDue */
+    bool retry;
+
+    /*! serializes writes from multiple render threads */
+    pthread_mutex_t lock;
+
+    /*! pointer to the next open sink */
+    struct _msgSink *pNext;
+
+} MsgSink;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+MsgSink *SINK_Open( MsgOutputType type,
+                    char *name,
+                    CompressType compression );
+int SINK_Write( MsgSink *pSink, const char *pData, size_t len );
+int SINK_Flush( MsgSink *pSink );
+int SINK_FlushAll( void );
+uint64_t SINK_FlushDue( void );
+void SINK_SetNotify( int fd );
+void SINK_Close( MsgSink *pSink );
+void SINK_CloseAll( void );
+
+#endif
@@ -0,0 +1,66 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef STRSCAN_H
+#define STRSCAN_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+/*! The StrScan object holds the result of scanning a string value
+    before it is output as a JSON value */
+typedef struct _strScan
+{
+    /*! length of the string */
+    size_t len;
+
+    /*! offset of the first non-whitespace character, or len if the
+        string contains only whitespace */
+    size_t first;
+
+    /*! offset of the last non-whitespace character, or len if the
+        string contains only whitespace */
+    size_t last;
+
+    /*! the string contains characters which must be escaped in
+        a JSON string */
+    bool escape;
+
+} StrScan;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+void STRSCAN_Scan( const char *str, StrScan *pScan );
+
+#endif
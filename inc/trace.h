@@ -0,0 +1,84 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#ifdef VARMSG_HAVE_SDT
+#include <sys/sdt.h>
+#endif
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+/*! The VARMSG_TRACEn macros define static tracepoints in the "varmsg"
+    provider.  When the build finds sys/sdt.h, which defines
+    VARMSG_HAVE_SDT, each tracepoint is compiled into a single nop
+    instruction with an ELF note describing its arguments, which
+    tracers such as bpftrace, perf and SystemTap can attach to at
+    runtime.  The arguments of a tracepoint should be values which are
+    already at hand, since they are evaluated whether or not a tracer
+    is attached.  Without sys/sdt.h the tracepoints compile to nothing */
+#ifdef VARMSG_HAVE_SDT
+
+#define VARMSG_TRACE1( name, a ) \
+    DTRACE_PROBE1( varmsg, name, a )
+
+#define VARMSG_TRACE2( name, a, b ) \
+    DTRACE_PROBE2( varmsg, name, a, b )
+
+#define VARMSG_TRACE3( name, a, b, c ) \
+    DTRACE_PROBE3( varmsg, name, a, b, c )
+
+#define VARMSG_TRACE4( name, a, b, c, d ) \
+    DTRACE_PROBE4( varmsg, name, a, b, c, d )
+
+#define VARMSG_TRACE5( name, a, b, c, d, e ) \
+    DTRACE_PROBE5( varmsg, name, a, b, c, d, e )
+
+#else
+
+#define VARMSG_TRACE1( name, a ) \
+    do { (void)(a); } while ( 0 )
+
+#define VARMSG_TRACE2( name, a, b ) \
+    do { (void)(a); (void)(b); } while ( 0 )
+
+#define VARMSG_TRACE3( name, a, b, c ) \
+    do { (void)(a); (void)(b); (void)(c); } while ( 0 )
+
+#define VARMSG_TRACE4( name, a, b, c, d ) \
+    do { (void)(a); (void)(b); (void)(c); (void)(d); } while ( 0 )
+
+#define VARMSG_TRACE5( name, a, b, c, d, e ) \
+    do { (void)(a); (void)(b); (void)(c); (void)(d); (void)(e); } while ( 0 )
+
+#endif
+
+#endif
@@ -0,0 +1,108 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+#ifndef VALCACHE_H
+#define VALCACHE_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <varserver/varserver.h>
+#include "msgbuf.h"
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef EOK
+/*! success response */
+#define EOK 0
+#endif
+
+/*! The ValCacheEntry object locates the formatted value of one
+    variable in the value cache data buffer */
+typedef struct _valCacheEntry
+{
+    /*! handle of the variable */
+    VAR_HANDLE hVar;
+
+    /*! identifies how the value was formatted */
+    uint32_t tag;
+
+    /*! epoch the value was stored in */
+    uint64_t epoch;
+
+    /*! offset of the formatted value in the data buffer */
+    size_t offset;
+
+    /*! length of the formatted value */
+    size_t len;
+
+} ValCacheEntry;
+
+/*! The ValCache object is an open addressed hash table which holds
+    the formatted values of variables for a single epoch.  Starting a
+    new epoch discards all of the stored values */
+typedef struct _valCache
+{
+    /*! array of hash table slots */
+    ValCacheEntry *pEntries;
+
+    /*! number of hash table slots ( always a power of two ) */
+    size_t size;
+
+    /*! number of values stored in the current epoch */
+    size_t count;
+
+    /*! current epoch, or zero if the cache is not in use */
+    uint64_t epoch;
+
+    /*! buffer containing the formatted values */
+    MsgBuf data;
+
+} ValCache;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int VALCACHE_Init( ValCache *pCache, size_t size );
+void VALCACHE_Begin( ValCache *pCache, uint64_t epoch );
+int VALCACHE_Find( ValCache *pCache,
+                   VAR_HANDLE hVar,
+                   uint32_t tag,
+                   const char **ppData,
+                   size_t *pLen );
+int VALCACHE_Add( ValCache *pCache,
+                  VAR_HANDLE hVar,
+                  uint32_t tag,
+                  const char *pData,
+                  size_t len );
+void VALCACHE_Free( ValCache *pCache );
+
+#endif
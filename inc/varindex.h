@@ -0,0 +1,100 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef VARINDEX_H
+#define VARINDEX_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <varserver/varserver.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef EOK
+/*! success response */
+#define EOK 0
+#endif
+
+/*! The VarIndexEntry object associates a variable handle with one
+    object which is interested in that variable */
+typedef struct _varIndexEntry
+{
+    /*! handle of the indexed variable */
+    VAR_HANDLE hVar;
+
+    /*! role of the variable for the associated object */
+    uint32_t role;
+
+    /*! position of the variable within the associated object */
+    size_t idx;
+
+    /*! pointer to the associated object */
+    void *pData;
+
+    /*! pointer to the next entry in the same hash bucket */
+    struct _varIndexEntry *pNext;
+
+} VarIndexEntry;
+
+/*! The VarIndex object is a hash table which maps a variable handle
+    to the list of objects which are interested in the variable */
+typedef struct _varIndex
+{
+    /*! array of hash buckets */
+    VarIndexEntry **ppBuckets;
+
+    /*! number of hash buckets ( always a power of two ) */
+    size_t numBuckets;
+
+    /*! number of entries in the index */
+    size_t count;
+
+} VarIndex;
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int VARINDEX_Init( VarIndex *pIndex, size_t numBuckets );
+int VARINDEX_Add( VarIndex *pIndex,
+                  VAR_HANDLE hVar,
+                  uint32_t role,
+                  size_t idx,
+                  void *pData );
+int VARINDEX_Remove( VarIndex *pIndex,
+                     VAR_HANDLE hVar,
+                     uint32_t role,
+                     void *pData );
+size_t VARINDEX_RemoveAll( VarIndex *pIndex, void *pData );
+VarIndexEntry *VARINDEX_Find( VarIndex *pIndex, VAR_HANDLE hVar );
+VarIndexEntry *VARINDEX_Next( VarIndexEntry *pEntry );
+void VARINDEX_Free( VarIndex *pIndex );
+
+#endif
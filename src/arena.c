@@ -0,0 +1,386 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup arena Memory Arena
+ * @brief Block allocator for objects which share a lifetime
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file arena.c
+
+    Memory Arena
+
+    The Memory Arena carves small allocations out of large blocks of
+    memory.  It is used for objects which are created together and
+    released together, such as everything belonging to one message
+    configuration.  Allocation is a pointer bump, related objects are
+    packed next to each other, and all of them are released with a
+    single call to ARENA_Free.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include "arena.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! default number of data bytes in an arena block */
+#define ARENA_SIZE_DEFAULT      ( 4096 )
+
+/*! size of a block header, rounded so the block data stays aligned */
+#define ARENA_HDR_SIZE          ( ARENA_ROUND( sizeof( ArenaBlock ) ) )
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static ArenaBlock *NewBlock( Arena *pArena, size_t size );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  ARENA_Create                                                              */
+/*!
+    Create a memory arena
+
+    The ARENA_Create function allocates the first block of a new arena
+    and places the Arena object at the start of it.  Allocations which
+    do not fit in the current block cause a new block of the same size
+    to be added to the arena.
+
+    @param[in]
+        size
+            number of data bytes in each arena block.  If zero is
+            specified a default size is used.
+
+    @retval pointer to the new arena
+    @retval NULL memory allocation failure
+
+==============================================================================*/
+Arena *ARENA_Create( size_t size )
+{
+    Arena *pArena = NULL;
+    ArenaBlock *pBlock;
+    size_t len;
+
+    if ( size == 0 )
+    {
+        size = ARENA_SIZE_DEFAULT;
+    }
+
+    /* the arena object is the first allocation in the first block */
+    len = ARENA_ROUND( sizeof( Arena ) ) + ARENA_ROUND( size );
+    pBlock = malloc( ARENA_HDR_SIZE + len );
+    if ( pBlock != NULL )
+    {
+        pBlock->pNext = NULL;
+        pBlock->size = len;
+        pBlock->used = ARENA_ROUND( sizeof( Arena ) );
+
+        pArena = (Arena *)( (char *)pBlock + ARENA_HDR_SIZE );
+        pArena->pBlocks = pBlock;
+        pArena->blockSize = ARENA_ROUND( size );
+        pArena->total = ARENA_HDR_SIZE + len;
+    }
+
+    return pArena;
+}
+
+/*============================================================================*/
+/*  ARENA_Alloc                                                               */
+/*!
+    Allocate memory from an arena
+
+    The ARENA_Alloc function returns the next suitably aligned free
+    space in the arena's current block.  When the current block is
+    full a new block is started.  Requests larger than the arena's
+    block size are given a block of their own which is linked in
+    behind the current block, so the free space in the current block
+    is not wasted.
+
+    @param[in]
+        pArena
+            pointer to the arena to allocate from
+
+    @param[in]
+        len
+            number of bytes to allocate
+
+    @retval pointer to the allocated memory
+    @retval NULL memory allocation failure or invalid arguments
+
+==============================================================================*/
+void *ARENA_Alloc( Arena *pArena, size_t len )
+{
+    void *p = NULL;
+    ArenaBlock *pBlock;
+
+    if ( pArena != NULL )
+    {
+        len = ARENA_ROUND( len );
+        pBlock = pArena->pBlocks;
+
+        if ( ( pBlock->size - pBlock->used ) < len )
+        {
+            if ( len > pArena->blockSize )
+            {
+                /* dedicated block behind the current block */
+                pBlock = NewBlock( pArena, len );
+                if ( pBlock != NULL )
+                {
+                    pBlock->pNext = pArena->pBlocks->pNext;
+                    pArena->pBlocks->pNext = pBlock;
+                }
+            }
+            else
+            {
+                /* start a new current block */
+                pBlock = NewBlock( pArena, pArena->blockSize );
+                if ( pBlock != NULL )
+                {
+                    pBlock->pNext = pArena->pBlocks;
+                    pArena->pBlocks = pBlock;
+                }
+            }
+        }
+
+        if ( pBlock != NULL )
+        {
+            p = (char *)pBlock + ARENA_HDR_SIZE + pBlock->used;
+            pBlock->used += len;
+        }
+    }
+
+    return p;
+}
+
+/*============================================================================*/
+/*  ARENA_Calloc                                                              */
+/*!
+    Allocate zeroed memory for an array from an arena
+
+    @param[in]
+        pArena
+            pointer to the arena to allocate from
+
+    @param[in]
+        n
+            number of array elements
+
+    @param[in]
+        size
+            size of each array element
+
+    @retval pointer to the zeroed memory
+    @retval NULL memory allocation failure or invalid arguments
+
+==============================================================================*/
+void *ARENA_Calloc( Arena *pArena, size_t n, size_t size )
+{
+    void *p = NULL;
+
+    if ( ( size == 0 ) ||
+         ( n <= SIZE_MAX / size ) )
+    {
+        p = ARENA_Alloc( pArena, n * size );
+        if ( p != NULL )
+        {
+            memset( p, 0, n * size );
+        }
+    }
+
+    return p;
+}
+
+/*============================================================================*/
+/*  ARENA_Dup                                                                 */
+/*!
+    Copy a block of memory into an arena
+
+    @param[in]
+        pArena
+            pointer to the arena to allocate from
+
+    @param[in]
+        pData
+            pointer to the data to copy
+
+    @param[in]
+        len
+            number of bytes to copy
+
+    @retval pointer to the copy of the data
+    @retval NULL memory allocation failure or invalid arguments
+
+==============================================================================*/
+void *ARENA_Dup( Arena *pArena, const void *pData, size_t len )
+{
+    void *p = NULL;
+
+    if ( pData != NULL )
+    {
+        p = ARENA_Alloc( pArena, len );
+        if ( p != NULL )
+        {
+            memcpy( p, pData, len );
+        }
+    }
+
+    return p;
+}
+
+/*============================================================================*/
+/*  ARENA_StrDup                                                              */
+/*!
+    Copy a NUL terminated string into an arena
+
+    @param[in]
+        pArena
+            pointer to the arena to allocate from
+
+    @param[in]
+        str
+            pointer to the string to copy.  May be NULL.
+
+    @retval pointer to the copy of the string
+    @retval NULL the string was NULL, or memory allocation failure
+
+==============================================================================*/
+char *ARENA_StrDup( Arena *pArena, const char *str )
+{
+    char *p = NULL;
+
+    if ( str != NULL )
+    {
+        p = ARENA_Dup( pArena, str, strlen( str ) + 1 );
+    }
+
+    return p;
+}
+
+/*============================================================================*/
+/*  ARENA_Size                                                                */
+/*!
+    Get the number of bytes an arena has allocated from the system
+
+    @param[in]
+        pArena
+            pointer to the arena
+
+    @retval total size of the arena blocks
+
+==============================================================================*/
+size_t ARENA_Size( Arena *pArena )
+{
+    return ( pArena != NULL ) ? pArena->total : 0;
+}
+
+/*============================================================================*/
+/*  ARENA_Free                                                                */
+/*!
+    Release a memory arena
+
+    The ARENA_Free function releases every block of the arena, and
+    with it every allocation made from the arena and the Arena object
+    itself.
+
+    @param[in]
+        pArena
+            pointer to the arena to free
+
+==============================================================================*/
+void ARENA_Free( Arena *pArena )
+{
+    ArenaBlock *pBlock;
+    ArenaBlock *pNext;
+
+    if ( pArena != NULL )
+    {
+        /* the arena object lives in one of the blocks, so read the list
+           head before any block is released */
+        pBlock = pArena->pBlocks;
+        while ( pBlock != NULL )
+        {
+            pNext = pBlock->pNext;
+            free( pBlock );
+            pBlock = pNext;
+        }
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  NewBlock                                                                  */
+/*!
+    Allocate a new arena block
+
+    @param[in]
+        pArena
+            pointer to the arena the block belongs to
+
+    @param[in]
+        size
+            number of data bytes in the block
+
+    @retval pointer to the new block, which is not yet linked in
+    @retval NULL memory allocation failure
+
+==============================================================================*/
+static ArenaBlock *NewBlock( Arena *pArena, size_t size )
+{
+    ArenaBlock *pBlock;
+
+    pBlock = malloc( ARENA_HDR_SIZE + size );
+    if ( pBlock != NULL )
+    {
+        pBlock->pNext = NULL;
+        pBlock->size = size;
+        pBlock->used = 0;
+        pArena->total += ARENA_HDR_SIZE + size;
+    }
+
+    return pBlock;
+}
+
+/*! @}
+ * end of arena group */
@@ -0,0 +1,358 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup cbor CBOR Encoder
+ * @brief Encode message values in the Concise Binary Object Representation
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file cbor.c
+
+    CBOR Encoder
+
+    The CBOR Encoder appends RFC 8949 Concise Binary Object Representation
+    items to a message buffer.  Every item starts with a head containing
+    its major type and an argument, which is the value of an integer,
+    the length of a string, or the number of entries in a map.  Arguments
+    are always encoded in the shortest form.
+
+    Messages are encoded as indefinite length maps, so the number of
+    variables in a message does not need to be known before the message
+    is rendered.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include "cbor.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! additional information value for a one byte argument */
+#define CBOR_AI_1BYTE       ( 24 )
+
+/*! additional information value for a two byte argument */
+#define CBOR_AI_2BYTE       ( 25 )
+
+/*! additional information value for a four byte argument */
+#define CBOR_AI_4BYTE       ( 26 )
+
+/*! additional information value for an eight byte argument */
+#define CBOR_AI_8BYTE       ( 27 )
+
+/*! additional information value for an indefinite length item */
+#define CBOR_AI_INDEFINITE  ( 31 )
+
+/*! initial byte of a single precision float */
+#define CBOR_FLOAT32        ( ( CBOR_MAJOR_SIMPLE << 5 ) | CBOR_AI_4BYTE )
+
+/*! the break code which ends an indefinite length item */
+#define CBOR_BREAK          ( 0xFF )
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  CBOR_AppendHead                                                           */
+/*!
+    Append a CBOR item head to a message buffer
+
+    The CBOR_AppendHead function appends the initial byte of a CBOR item,
+    followed by its argument in the shortest big-endian form.
+
+    @param[in]
+        pMsgBuf
+            pointer to the message buffer
+
+    @param[in]
+        major
+            major type of the item
+
+    @param[in]
+        value
+            argument of the item
+
+    @retval EOK the head was appended
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int CBOR_AppendHead( MsgBuf *pMsgBuf, uint8_t major, uint64_t value )
+{
+    int result = EINVAL;
+    unsigned char *p;
+    size_t n;
+    uint8_t ai;
+
+    if ( ( pMsgBuf != NULL ) &&
+         ( major <= CBOR_MAJOR_SIMPLE ) )
+    {
+        result = MSGBUF_Reserve( pMsgBuf, CBOR_HEAD_MAX_LEN );
+        if ( result == EOK )
+        {
+            if ( value < CBOR_AI_1BYTE )
+            {
+                ai = (uint8_t)value;
+                n = 0;
+            }
+            else if ( value <= UINT8_MAX )
+            {
+                ai = CBOR_AI_1BYTE;
+                n = 1;
+            }
+            else if ( value <= UINT16_MAX )
+            {
+                ai = CBOR_AI_2BYTE;
+                n = 2;
+            }
+            else if ( value <= UINT32_MAX )
+            {
+                ai = CBOR_AI_4BYTE;
+                n = 4;
+            }
+            else
+            {
+                ai = CBOR_AI_8BYTE;
+                n = 8;
+            }
+
+            p = (unsigned char *)&pMsgBuf->pData[pMsgBuf->len];
+            *p++ = ( major << 5 ) | ai;
+            pMsgBuf->len += n + 1;
+
+            /* store the argument in network byte order */
+            while ( n > 0 )
+            {
+                n--;
+                p[n] = (unsigned char)( value & 0xFF );
+                value >>= 8;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CBOR_AppendUInt                                                           */
+/*!
+    Append an unsigned integer to a message buffer
+
+    @param[in]
+        pMsgBuf
+            pointer to the message buffer
+
+    @param[in]
+        value
+            value to append
+
+    @retval EOK the value was appended
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int CBOR_AppendUInt( MsgBuf *pMsgBuf, uint64_t value )
+{
+    return CBOR_AppendHead( pMsgBuf, CBOR_MAJOR_UINT, value );
+}
+
+/*============================================================================*/
+/*  CBOR_AppendInt                                                            */
+/*!
+    Append a signed integer to a message buffer
+
+    Negative values are encoded as the negative integer major type,
+    whose argument is -1 minus the value.
+
+    @param[in]
+        pMsgBuf
+            pointer to the message buffer
+
+    @param[in]
+        value
+            value to append
+
+    @retval EOK the value was appended
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int CBOR_AppendInt( MsgBuf *pMsgBuf, int64_t value )
+{
+    int result;
+
+    if ( value < 0 )
+    {
+        /* -1 - value, computed without overflowing INT64_MIN */
+        result = CBOR_AppendHead( pMsgBuf,
+                                  CBOR_MAJOR_NEGINT,
+                                  ~(uint64_t)value );
+    }
+    else
+    {
+        result = CBOR_AppendHead( pMsgBuf, CBOR_MAJOR_UINT, (uint64_t)value );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CBOR_AppendFloat                                                          */
+/*!
+    Append a single precision float to a message buffer
+
+    @param[in]
+        pMsgBuf
+            pointer to the message buffer
+
+    @param[in]
+        value
+            value to append
+
+    @retval EOK the value was appended
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int CBOR_AppendFloat( MsgBuf *pMsgBuf, float value )
+{
+    int result = EINVAL;
+    unsigned char *p;
+    uint32_t bits;
+
+    if ( pMsgBuf != NULL )
+    {
+        result = MSGBUF_Reserve( pMsgBuf, 5 );
+        if ( result == EOK )
+        {
+            memcpy( &bits, &value, sizeof( bits ) );
+
+            p = (unsigned char *)&pMsgBuf->pData[pMsgBuf->len];
+            p[0] = CBOR_FLOAT32;
+            p[1] = (unsigned char)( bits >> 24 );
+            p[2] = (unsigned char)( bits >> 16 );
+            p[3] = (unsigned char)( bits >> 8 );
+            p[4] = (unsigned char)bits;
+            pMsgBuf->len += 5;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CBOR_AppendText                                                           */
+/*!
+    Append a text string to a message buffer
+
+    @param[in]
+        pMsgBuf
+            pointer to the message buffer
+
+    @param[in]
+        str
+            pointer to the UTF-8 characters to append
+
+    @param[in]
+        len
+            number of bytes to append
+
+    @retval EOK the text string was appended
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int CBOR_AppendText( MsgBuf *pMsgBuf, const char *str, size_t len )
+{
+    int result = EINVAL;
+
+    if ( str != NULL )
+    {
+        result = CBOR_AppendHead( pMsgBuf, CBOR_MAJOR_TEXT, len );
+        if ( result == EOK )
+        {
+            result = MSGBUF_Append( pMsgBuf, str, len );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CBOR_BeginMap                                                             */
+/*!
+    Start an indefinite length map
+
+    The map must be ended with CBOR_AppendBreak once all of its
+    keys and values have been appended.
+
+    @param[in]
+        pMsgBuf
+            pointer to the message buffer
+
+    @retval EOK the map was started
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int CBOR_BeginMap( MsgBuf *pMsgBuf )
+{
+    return MSGBUF_AppendChar( pMsgBuf,
+                              (char)( ( CBOR_MAJOR_MAP << 5 ) |
+                                      CBOR_AI_INDEFINITE ) );
+}
+
+/*============================================================================*/
+/*  CBOR_AppendBreak                                                          */
+/*!
+    End an indefinite length item
+
+    @param[in]
+        pMsgBuf
+            pointer to the message buffer
+
+    @retval EOK the break code was appended
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int CBOR_AppendBreak( MsgBuf *pMsgBuf )
+{
+    return MSGBUF_AppendChar( pMsgBuf, (char)CBOR_BREAK );
+}
+
+/*! @}
+ * end of cbor group */
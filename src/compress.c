@@ -0,0 +1,748 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup compress Compressor
+ * @brief Streaming compression of sink output
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file compress.c
+
+    Compressor
+
+    The Compressor wraps a long-lived LZ4 frame or Zstandard streaming
+    compression context.  Messages written to a compressed sink are fed
+    into the current frame as they arrive.
+
+    When the sink is flushed, the compressor is flushed too, so all of
+    the data written so far can be decoded by a streaming decoder while
+    the frame keeps its compression history.  Once a frame has grown
+    large enough it is ended instead, so the output is a sequence of
+    independent frames which a consumer can start decoding from.
+    Since a sink is only flushed between messages, every flush and
+    every frame ends on a message boundary.  Concatenated frames form
+    a valid LZ4 or Zstandard stream.
+
+    Support for each compression library is compiled in when the
+    build finds the library, which defines VARMSG_HAVE_LZ4 and
+    VARMSG_HAVE_ZSTD respectively.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "compress.h"
+
+#ifdef VARMSG_HAVE_LZ4
+#include <lz4frame.h>
+#endif
+
+#ifdef VARMSG_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! Zstandard compression level */
+#define COMPRESS_ZSTD_LEVEL     ( 3 )
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+#ifdef VARMSG_HAVE_LZ4
+static int LZ4Write( Compressor *pCompressor,
+                     const char *pData,
+                     size_t len,
+                     MsgBuf *pOut );
+static int LZ4EndFrame( Compressor *pCompressor,
+                        MsgBuf *pOut,
+                        bool end );
+#endif
+
+#ifdef VARMSG_HAVE_ZSTD
+static int ZSTDStream( Compressor *pCompressor,
+                       const char *pData,
+                       size_t len,
+                       ZSTD_EndDirective mode,
+                       MsgBuf *pOut );
+#endif
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! names of the compression types.  These must be in the same order
+    as the CompressType enumeration */
+static const char *compressTypes[] = {
+    "none",
+    "lz4",
+    "zstd",
+    NULL
+};
+
+#ifdef VARMSG_HAVE_LZ4
+/*! LZ4 frame preferences: 64KB linked blocks with a content checksum */
+static const LZ4F_preferences_t lz4Prefs = {
+    .frameInfo = {
+        .blockSizeID = LZ4F_max64KB,
+        .blockMode = LZ4F_blockLinked,
+        .contentChecksumFlag = LZ4F_contentChecksumEnabled
+    }
+};
+#endif
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  COMPRESS_ParseType                                                        */
+/*!
+    Convert a compression name to a compression type
+
+    @param[in]
+        name
+            name of the compression: none, lz4 or zstd.  If NULL, no
+            compression is used.
+
+    @param[out]
+        pType
+            pointer to the location to store the compression type
+
+    @retval EOK the compression type was converted
+    @retval ENOTSUP the compression is unknown or was not compiled in
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int COMPRESS_ParseType( const char *name, CompressType *pType )
+{
+    int result = EINVAL;
+    int i = 0;
+
+    if ( pType != NULL )
+    {
+        *pType = COMPRESS_NONE;
+        result = EOK;
+
+        if ( name != NULL )
+        {
+            result = ENOTSUP;
+
+            while ( compressTypes[i] != NULL )
+            {
+                if ( strcmp( compressTypes[i], name ) == 0 )
+                {
+                    *pType = (CompressType)i;
+                    result = EOK;
+                    break;
+                }
+
+                i++;
+            }
+        }
+
+#ifndef VARMSG_HAVE_LZ4
+        if ( *pType == COMPRESS_LZ4 )
+        {
+            result = ENOTSUP;
+        }
+#endif
+
+#ifndef VARMSG_HAVE_ZSTD
+        if ( *pType == COMPRESS_ZSTD )
+        {
+            result = ENOTSUP;
+        }
+#endif
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  COMPRESS_Init                                                             */
+/*!
+    Initialize a compressor
+
+    The COMPRESS_Init function creates the compression library context
+    which is used for the lifetime of the compressor.
+
+    @param[in]
+        pCompressor
+            pointer to the compressor to initialize
+
+    @param[in]
+        type
+            type of compression
+
+    @retval EOK the compressor was initialized
+    @retval ENOMEM the compression context could not be created
+    @retval ENOTSUP the compression was not compiled in
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int COMPRESS_Init( Compressor *pCompressor, CompressType type )
+{
+    int result = EINVAL;
+
+    if ( pCompressor != NULL )
+    {
+        pCompressor->type = type;
+        pCompressor->pCtx = NULL;
+        pCompressor->inFrame = false;
+        pCompressor->frameLen = 0;
+
+        switch( type )
+        {
+            case COMPRESS_NONE:
+                result = EOK;
+                break;
+
+#ifdef VARMSG_HAVE_LZ4
+            case COMPRESS_LZ4:
+                result = LZ4F_isError(
+                            LZ4F_createCompressionContext(
+                                (LZ4F_cctx **)&pCompressor->pCtx,
+                                LZ4F_VERSION ) ) ? ENOMEM : EOK;
+                break;
+#endif
+
+#ifdef VARMSG_HAVE_ZSTD
+            case COMPRESS_ZSTD:
+                pCompressor->pCtx = ZSTD_createCCtx();
+                if ( pCompressor->pCtx != NULL )
+                {
+                    ZSTD_CCtx_setParameter( pCompressor->pCtx,
+                                            ZSTD_c_compressionLevel,
+                                            COMPRESS_ZSTD_LEVEL );
+                    ZSTD_CCtx_setParameter( pCompressor->pCtx,
+                                            ZSTD_c_checksumFlag,
+                                            1 );
+                    result = EOK;
+                }
+                else
+                {
+                    result = ENOMEM;
+                }
+                break;
+#endif
+
+            default:
+                result = ENOTSUP;
+                break;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  COMPRESS_Write                                                            */
+/*!
+    Compress data into the current frame
+
+    The COMPRESS_Write function feeds the data into the current frame,
+    starting a new frame if necessary, and appends any compressed output
+    produced by the compression library to the output buffer.  The
+    library may hold back some of the data until the frame is ended.
+
+    @param[in]
+        pCompressor
+            pointer to the compressor
+
+    @param[in]
+        pData
+            pointer to the data to compress
+
+    @param[in]
+        len
+            length of the data to compress
+
+    @param[in]
+        pOut
+            pointer to the buffer to append the compressed output to
+
+    @retval EOK the data was compressed
+    @retval ENOMEM memory allocation failure
+    @retval EIO compression failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int COMPRESS_Write( Compressor *pCompressor,
+                    const char *pData,
+                    size_t len,
+                    MsgBuf *pOut )
+{
+    int result = EINVAL;
+
+    if ( ( pCompressor != NULL ) &&
+         ( pData != NULL ) &&
+         ( pOut != NULL ) )
+    {
+        switch( pCompressor->type )
+        {
+            case COMPRESS_NONE:
+                result = MSGBUF_Append( pOut, pData, len );
+                break;
+
+#ifdef VARMSG_HAVE_LZ4
+            case COMPRESS_LZ4:
+                result = LZ4Write( pCompressor, pData, len, pOut );
+                break;
+#endif
+
+#ifdef VARMSG_HAVE_ZSTD
+            case COMPRESS_ZSTD:
+                result = ZSTDStream( pCompressor,
+                                     pData,
+                                     len,
+                                     ZSTD_e_continue,
+                                     pOut );
+                break;
+#endif
+
+            default:
+                result = ENOTSUP;
+                break;
+        }
+
+        pCompressor->frameLen += len;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  COMPRESS_Flush                                                            */
+/*!
+    Flush the current frame
+
+    The COMPRESS_Flush function appends all of the data held back by
+    the compression library to the output buffer without ending the
+    current frame, so everything written so far can be decoded.
+
+    @param[in]
+        pCompressor
+            pointer to the compressor
+
+    @param[in]
+        pOut
+            pointer to the buffer to append the compressed output to
+
+    @retval EOK the frame was flushed
+    @retval ENOMEM memory allocation failure
+    @retval EIO compression failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int COMPRESS_Flush( Compressor *pCompressor, MsgBuf *pOut )
+{
+    int result = EINVAL;
+
+    if ( ( pCompressor != NULL ) &&
+         ( pOut != NULL ) )
+    {
+        result = EOK;
+
+        if ( pCompressor->inFrame == true )
+        {
+            switch( pCompressor->type )
+            {
+#ifdef VARMSG_HAVE_LZ4
+                case COMPRESS_LZ4:
+                    result = LZ4EndFrame( pCompressor, pOut, false );
+                    break;
+#endif
+
+#ifdef VARMSG_HAVE_ZSTD
+                case COMPRESS_ZSTD:
+                    result = ZSTDStream( pCompressor,
+                                         NULL,
+                                         0,
+                                         ZSTD_e_flush,
+                                         pOut );
+                    break;
+#endif
+
+                default:
+                    break;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  COMPRESS_EndFrame                                                         */
+/*!
+    End the current frame
+
+    The COMPRESS_EndFrame function appends the remainder of the current
+    frame, including its end mark and checksum, to the output buffer.
+    Nothing is appended if no frame has been started.
+
+    @param[in]
+        pCompressor
+            pointer to the compressor
+
+    @param[in]
+        pOut
+            pointer to the buffer to append the compressed output to
+
+    @retval EOK the frame was ended
+    @retval ENOMEM memory allocation failure
+    @retval EIO compression failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int COMPRESS_EndFrame( Compressor *pCompressor, MsgBuf *pOut )
+{
+    int result = EINVAL;
+
+    if ( ( pCompressor != NULL ) &&
+         ( pOut != NULL ) )
+    {
+        result = EOK;
+
+        if ( pCompressor->inFrame == true )
+        {
+            switch( pCompressor->type )
+            {
+#ifdef VARMSG_HAVE_LZ4
+                case COMPRESS_LZ4:
+                    result = LZ4EndFrame( pCompressor, pOut, true );
+                    break;
+#endif
+
+#ifdef VARMSG_HAVE_ZSTD
+                case COMPRESS_ZSTD:
+                    result = ZSTDStream( pCompressor,
+                                         NULL,
+                                         0,
+                                         ZSTD_e_end,
+                                         pOut );
+                    break;
+#endif
+
+                default:
+                    break;
+            }
+
+            pCompressor->inFrame = false;
+            pCompressor->frameLen = 0;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  COMPRESS_Free                                                             */
+/*!
+    Release a compressor
+
+    The COMPRESS_Free function releases the compression library context.
+    Any frame which has not been ended is discarded.
+
+    @param[in]
+        pCompressor
+            pointer to the compressor to release
+
+==============================================================================*/
+void COMPRESS_Free( Compressor *pCompressor )
+{
+    if ( pCompressor != NULL )
+    {
+        switch( pCompressor->type )
+        {
+#ifdef VARMSG_HAVE_LZ4
+            case COMPRESS_LZ4:
+                LZ4F_freeCompressionContext( pCompressor->pCtx );
+                break;
+#endif
+
+#ifdef VARMSG_HAVE_ZSTD
+            case COMPRESS_ZSTD:
+                ZSTD_freeCCtx( pCompressor->pCtx );
+                break;
+#endif
+
+            default:
+                break;
+        }
+
+        pCompressor->pCtx = NULL;
+        pCompressor->inFrame = false;
+        pCompressor->frameLen = 0;
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+#ifdef VARMSG_HAVE_LZ4
+/*============================================================================*/
+/*  LZ4Write                                                                  */
+/*!
+    Compress data into the current LZ4 frame
+
+    @param[in]
+        pCompressor
+            pointer to the compressor
+
+    @param[in]
+        pData
+            pointer to the data to compress
+
+    @param[in]
+        len
+            length of the data to compress
+
+    @param[in]
+        pOut
+            pointer to the buffer to append the compressed output to
+
+    @retval EOK the data was compressed
+    @retval ENOMEM memory allocation failure
+    @retval EIO compression failure
+
+==============================================================================*/
+static int LZ4Write( Compressor *pCompressor,
+                     const char *pData,
+                     size_t len,
+                     MsgBuf *pOut )
+{
+    int result = EOK;
+    size_t n;
+
+    if ( pCompressor->inFrame == false )
+    {
+        /* start a new frame */
+        result = MSGBUF_Reserve( pOut, LZ4F_HEADER_SIZE_MAX );
+        if ( result == EOK )
+        {
+            n = LZ4F_compressBegin( pCompressor->pCtx,
+                                    &pOut->pData[pOut->len],
+                                    pOut->size - pOut->len,
+                                    &lz4Prefs );
+            if ( LZ4F_isError( n ) )
+            {
+                result = EIO;
+            }
+            else
+            {
+                pOut->len += n;
+                pCompressor->inFrame = true;
+            }
+        }
+    }
+
+    if ( result == EOK )
+    {
+        result = MSGBUF_Reserve( pOut, LZ4F_compressBound( len, &lz4Prefs ) );
+    }
+
+    if ( result == EOK )
+    {
+        n = LZ4F_compressUpdate( pCompressor->pCtx,
+                                 &pOut->pData[pOut->len],
+                                 pOut->size - pOut->len,
+                                 pData,
+                                 len,
+                                 NULL );
+        if ( LZ4F_isError( n ) )
+        {
+            result = EIO;
+        }
+        else
+        {
+            pOut->len += n;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  LZ4EndFrame                                                               */
+/*!
+    Flush or end the current LZ4 frame
+
+    @param[in]
+        pCompressor
+            pointer to the compressor
+
+    @param[in]
+        pOut
+            pointer to the buffer to append the compressed output to
+
+    @param[in]
+        end
+            true to end the frame, false to flush it
+
+    @retval EOK the frame was flushed or ended
+    @retval ENOMEM memory allocation failure
+    @retval EIO compression failure
+
+==============================================================================*/
+static int LZ4EndFrame( Compressor *pCompressor,
+                        MsgBuf *pOut,
+                        bool end )
+{
+    int result;
+    size_t n;
+
+    result = MSGBUF_Reserve( pOut, LZ4F_compressBound( 0, &lz4Prefs ) );
+    if ( ( result == EOK ) && ( end == true ) )
+    {
+        n = LZ4F_compressEnd( pCompressor->pCtx,
+                              &pOut->pData[pOut->len],
+                              pOut->size - pOut->len,
+                              NULL );
+        if ( LZ4F_isError( n ) )
+        {
+            result = EIO;
+        }
+        else
+        {
+            pOut->len += n;
+        }
+    }
+    else if ( result == EOK )
+    {
+        n = LZ4F_flush( pCompressor->pCtx,
+                        &pOut->pData[pOut->len],
+                        pOut->size - pOut->len,
+                        NULL );
+        if ( LZ4F_isError( n ) )
+        {
+            result = EIO;
+        }
+        else
+        {
+            pOut->len += n;
+        }
+    }
+
+    return result;
+}
+#endif
+
+#ifdef VARMSG_HAVE_ZSTD
+/*============================================================================*/
+/*  ZSTDStream                                                                */
+/*!
+    Stream data through the Zstandard compressor
+
+    The ZSTDStream function feeds the data into the current Zstandard
+    frame, and appends the compressed output to the output buffer until
+    all of the input has been consumed.  When the mode is ZSTD_e_flush
+    or ZSTD_e_end, the frame is flushed or completed as well.
+
+    @param[in]
+        pCompressor
+            pointer to the compressor
+
+    @param[in]
+        pData
+            pointer to the data to compress, or NULL if there is none
+
+    @param[in]
+        len
+            length of the data to compress
+
+    @param[in]
+        mode
+            ZSTD_e_continue to add to the frame, ZSTD_e_flush to flush
+            it, or ZSTD_e_end to end it
+
+    @param[in]
+        pOut
+            pointer to the buffer to append the compressed output to
+
+    @retval EOK the data was compressed
+    @retval ENOMEM memory allocation failure
+    @retval EIO compression failure
+
+==============================================================================*/
+static int ZSTDStream( Compressor *pCompressor,
+                       const char *pData,
+                       size_t len,
+                       ZSTD_EndDirective mode,
+                       MsgBuf *pOut )
+{
+    int result = EOK;
+    ZSTD_inBuffer in = { pData, len, 0 };
+    ZSTD_outBuffer out;
+    size_t chunk = ZSTD_CStreamOutSize();
+    size_t remaining = 1;
+
+    pCompressor->inFrame = true;
+
+    while ( ( result == EOK ) &&
+            ( ( in.pos < in.size ) ||
+              ( ( mode != ZSTD_e_continue ) && ( remaining != 0 ) ) ) )
+    {
+        result = MSGBUF_Reserve( pOut, chunk );
+        if ( result == EOK )
+        {
+            out.dst = &pOut->pData[pOut->len];
+            out.size = pOut->size - pOut->len;
+            out.pos = 0;
+
+            remaining = ZSTD_compressStream2( pCompressor->pCtx,
+                                              &out,
+                                              &in,
+                                              mode );
+            if ( ZSTD_isError( remaining ) )
+            {
+                result = EIO;
+            }
+            else
+            {
+                pOut->len += out.pos;
+            }
+        }
+    }
+
+    return result;
+}
+#endif
+
+/*! @}
+ * end of compress group */
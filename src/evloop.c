@@ -0,0 +1,274 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup evloop Event Loop
+ * @brief epoll based event loop for file descriptor event sources
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file evloop.c
+
+    Event Loop
+
+    The Event Loop waits for any of a set of file descriptors, such as
+    a signalfd, a timerfd or an inotify descriptor, to become ready,
+    and calls the handler of each ready source.  Each wait dispatches
+    every source which is ready, so the caller can process all of the
+    events which arrived together in a single pass.
+
+    Sources are level triggered, so a handler which leaves data unread
+    is called again on the next wait.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "evloop.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! maximum number of ready sources returned by each wait */
+#define EVLOOP_MAX_EVENTS       ( 16 )
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  EVLOOP_Init                                                               */
+/*!
+    Initialize an event loop
+
+    @param[in]
+        pLoop
+            pointer to the event loop to initialize
+
+    @retval EOK the event loop was initialized
+    @retval EINVAL invalid arguments
+    @retval other error from epoll_create1()
+
+==============================================================================*/
+int EVLOOP_Init( EvLoop *pLoop )
+{
+    int result = EINVAL;
+
+    if ( pLoop != NULL )
+    {
+        pLoop->epfd = epoll_create1( EPOLL_CLOEXEC );
+        result = ( pLoop->epfd != -1 ) ? EOK : errno;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  EVLOOP_Add                                                                */
+/*!
+    Add an event source to an event loop
+
+    @param[in]
+        pLoop
+            pointer to the event loop
+
+    @param[in]
+        pSource
+            pointer to the caller owned event source object
+
+    @param[in]
+        fd
+            file descriptor to watch
+
+    @param[in]
+        events
+            events to watch for (EVLOOP_READ and/or EVLOOP_WRITE)
+
+    @param[in]
+        handler
+            function to call when the file descriptor is ready
+
+    @param[in]
+        arg
+            argument to pass to the handler
+
+    @retval EOK the event source was added
+    @retval EINVAL invalid arguments
+    @retval other error from epoll_ctl()
+
+==============================================================================*/
+int EVLOOP_Add( EvLoop *pLoop,
+                EvSource *pSource,
+                int fd,
+                uint32_t events,
+                EvHandler handler,
+                void *arg )
+{
+    int result = EINVAL;
+    struct epoll_event ev;
+
+    if ( ( pLoop != NULL ) &&
+         ( pSource != NULL ) &&
+         ( fd != -1 ) &&
+         ( handler != NULL ) )
+    {
+        pSource->fd = fd;
+        pSource->handler = handler;
+        pSource->arg = arg;
+
+        memset( &ev, 0, sizeof( ev ) );
+        ev.events = events;
+        ev.data.ptr = pSource;
+        result = ( epoll_ctl( pLoop->epfd, EPOLL_CTL_ADD, fd, &ev ) == 0 )
+                 ? EOK
+                 : errno;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  EVLOOP_Remove                                                             */
+/*!
+    Remove an event source from an event loop
+
+    @param[in]
+        pLoop
+            pointer to the event loop
+
+    @param[in]
+        pSource
+            pointer to the event source to remove
+
+    @retval EOK the event source was removed
+    @retval EINVAL invalid arguments
+    @retval other error from epoll_ctl()
+
+==============================================================================*/
+int EVLOOP_Remove( EvLoop *pLoop, EvSource *pSource )
+{
+    int result = EINVAL;
+
+    if ( ( pLoop != NULL ) &&
+         ( pSource != NULL ) )
+    {
+        result = ( epoll_ctl( pLoop->epfd,
+                              EPOLL_CTL_DEL,
+                              pSource->fd,
+                              NULL ) == 0 ) ? EOK : errno;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  EVLOOP_Wait                                                               */
+/*!
+    Wait for event sources to become ready
+
+    The EVLOOP_Wait function waits until at least one event source is
+    ready, or the timeout expires, and then calls the handler of every
+    ready event source.
+
+    @param[in]
+        pLoop
+            pointer to the event loop
+
+    @param[in]
+        timeout
+            maximum time to wait in milliseconds, or -1 to wait forever
+
+    @retval EOK one or more event sources were dispatched
+    @retval ETIMEDOUT no event source became ready
+    @retval EINVAL invalid arguments
+    @retval other error from epoll_wait(), such as EINTR
+
+==============================================================================*/
+int EVLOOP_Wait( EvLoop *pLoop, int timeout )
+{
+    int result = EINVAL;
+    struct epoll_event events[EVLOOP_MAX_EVENTS];
+    EvSource *pSource;
+    int n;
+    int i;
+
+    if ( pLoop != NULL )
+    {
+        n = epoll_wait( pLoop->epfd, events, EVLOOP_MAX_EVENTS, timeout );
+        if ( n > 0 )
+        {
+            for ( i = 0; i < n; i++ )
+            {
+                pSource = (EvSource *)events[i].data.ptr;
+                pSource->handler( pSource->fd,
+                                  events[i].events,
+                                  pSource->arg );
+            }
+
+            result = EOK;
+        }
+        else
+        {
+            result = ( n == 0 ) ? ETIMEDOUT : errno;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  EVLOOP_Free                                                               */
+/*!
+    Release an event loop
+
+    The event sources are not closed.
+
+    @param[in]
+        pLoop
+            pointer to the event loop to release
+
+==============================================================================*/
+void EVLOOP_Free( EvLoop *pLoop )
+{
+    if ( ( pLoop != NULL ) &&
+         ( pLoop->epfd != -1 ) )
+    {
+        close( pLoop->epfd );
+        pLoop->epfd = -1;
+    }
+}
+
+/*! @}
+ * end of evloop group */
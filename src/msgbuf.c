@@ -0,0 +1,499 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup msgbuf Message Buffer
+ * @brief Growable buffer for assembling a complete message in memory
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file msgbuf.c
+
+    Message Buffer
+
+    The Message Buffer is a growable memory buffer which is used to
+    assemble a complete variable message before it is sent to its
+    output.  Building the whole message in memory allows it to be
+    sent with a single write, so a consumer never sees a partially
+    written message.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "msgbuf.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! default initial size of a message buffer */
+#define MSGBUF_SIZE_DEFAULT     ( 4096 )
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  MSGBUF_Init                                                               */
+/*!
+    Initialize a message buffer
+
+    The MSGBUF_Init function allocates the initial storage for a
+    message buffer.  The buffer will grow as required when data
+    is appended to it.
+
+    @param[in]
+        pMsgBuf
+            pointer to the message buffer to initialize
+
+    @param[in]
+        size
+            initial size of the message buffer.  If zero is specified
+            a default size is used.
+
+    @retval EOK the message buffer was initialized
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int MSGBUF_Init( MsgBuf *pMsgBuf, size_t size )
+{
+    int result = EINVAL;
+
+    if ( pMsgBuf != NULL )
+    {
+        if ( size == 0 )
+        {
+            size = MSGBUF_SIZE_DEFAULT;
+        }
+
+        pMsgBuf->len = 0;
+        pMsgBuf->pData = malloc( size );
+        if ( pMsgBuf->pData != NULL )
+        {
+            pMsgBuf->size = size;
+            result = EOK;
+        }
+        else
+        {
+            pMsgBuf->size = 0;
+            result = ENOMEM;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  MSGBUF_Reset                                                              */
+/*!
+    Reset a message buffer
+
+    The MSGBUF_Reset function discards the content of the message buffer
+    so it can be used to assemble a new message.  The allocated storage
+    is retained.
+
+    @param[in]
+        pMsgBuf
+            pointer to the message buffer to reset
+
+==============================================================================*/
+void MSGBUF_Reset( MsgBuf *pMsgBuf )
+{
+    if ( pMsgBuf != NULL )
+    {
+        pMsgBuf->len = 0;
+    }
+}
+
+/*============================================================================*/
+/*  MSGBUF_Reserve                                                            */
+/*!
+    Reserve space in a message buffer
+
+    The MSGBUF_Reserve function makes sure there is at least the
+    specified number of free bytes available at the end of the
+    message buffer, growing the buffer if necessary.
+
+    @param[in]
+        pMsgBuf
+            pointer to the message buffer
+
+    @param[in]
+        len
+            number of free bytes required
+
+    @retval EOK the space is available
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int MSGBUF_Reserve( MsgBuf *pMsgBuf, size_t len )
+{
+    int result = EINVAL;
+    size_t size;
+    char *p;
+
+    if ( pMsgBuf != NULL )
+    {
+        result = EOK;
+
+        if ( ( pMsgBuf->size - pMsgBuf->len ) < len )
+        {
+            /* double the buffer until the data fits */
+            size = ( pMsgBuf->size > 0 ) ? pMsgBuf->size : MSGBUF_SIZE_DEFAULT;
+            while ( ( size - pMsgBuf->len ) < len )
+            {
+                size *= 2;
+            }
+
+            p = realloc( pMsgBuf->pData, size );
+            if ( p != NULL )
+            {
+                pMsgBuf->pData = p;
+                pMsgBuf->size = size;
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  MSGBUF_Append                                                             */
+/*!
+    Append data to a message buffer
+
+    The MSGBUF_Append function copies the specified data onto the end
+    of the message buffer.
+
+    @param[in]
+        pMsgBuf
+            pointer to the message buffer
+
+    @param[in]
+        pData
+            pointer to the data to append
+
+    @param[in]
+        len
+            number of bytes to append
+
+    @retval EOK the data was appended
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int MSGBUF_Append( MsgBuf *pMsgBuf, const void *pData, size_t len )
+{
+    int result = EINVAL;
+
+    if ( ( pMsgBuf != NULL ) &&
+         ( pData != NULL ) )
+    {
+        result = MSGBUF_Reserve( pMsgBuf, len );
+        if ( result == EOK )
+        {
+            memcpy( &pMsgBuf->pData[pMsgBuf->len], pData, len );
+            pMsgBuf->len += len;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  MSGBUF_AppendChar                                                         */
+/*!
+    Append a single character to a message buffer
+
+    @param[in]
+        pMsgBuf
+            pointer to the message buffer
+
+    @param[in]
+        c
+            character to append
+
+    @retval EOK the character was appended
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int MSGBUF_AppendChar( MsgBuf *pMsgBuf, char c )
+{
+    int result = EINVAL;
+
+    if ( pMsgBuf != NULL )
+    {
+        result = MSGBUF_Reserve( pMsgBuf, 1 );
+        if ( result == EOK )
+        {
+            pMsgBuf->pData[pMsgBuf->len++] = c;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  MSGBUF_AppendStr                                                          */
+/*!
+    Append a NUL terminated string to a message buffer
+
+    The MSGBUF_AppendStr function appends the characters of the string
+    to the message buffer.  The NUL terminator is not appended.
+
+    @param[in]
+        pMsgBuf
+            pointer to the message buffer
+
+    @param[in]
+        str
+            pointer to the NUL terminated string to append
+
+    @retval EOK the string was appended
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int MSGBUF_AppendStr( MsgBuf *pMsgBuf, const char *str )
+{
+    int result = EINVAL;
+
+    if ( str != NULL )
+    {
+        result = MSGBUF_Append( pMsgBuf, str, strlen( str ) );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  MSGBUF_AppendEscaped                                                      */
+/*!
+    Append a string to a message buffer with JSON escaping
+
+    The MSGBUF_AppendEscaped function appends the specified characters
+    to the message buffer, escaping any characters which are not
+    permitted inside a JSON string.  Quotes and backslashes are
+    escaped with a backslash, and control characters are output
+    using their short escape sequence, or a \u00XX sequence.
+    The surrounding quotes are not appended.
+
+    @param[in]
+        pMsgBuf
+            pointer to the message buffer
+
+    @param[in]
+        str
+            pointer to the characters to append
+
+    @param[in]
+        len
+            number of characters to append
+
+    @retval EOK the string was appended
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int MSGBUF_AppendEscaped( MsgBuf *pMsgBuf, const char *str, size_t len )
+{
+    static const char hex[] = "0123456789abcdef";
+    int result = EINVAL;
+    unsigned char c;
+    char *p;
+    size_t i;
+
+    if ( ( pMsgBuf != NULL ) &&
+         ( str != NULL ) )
+    {
+        /* each character expands to at most six characters */
+        result = MSGBUF_Reserve( pMsgBuf, len * 6 );
+        if ( result == EOK )
+        {
+            p = &pMsgBuf->pData[pMsgBuf->len];
+
+            for ( i = 0; i < len; i++ )
+            {
+                c = (unsigned char)str[i];
+                if ( ( c == '"' ) || ( c == '\\' ) )
+                {
+                    *p++ = '\\';
+                    *p++ = c;
+                }
+                else if ( c >= 0x20 )
+                {
+                    *p++ = c;
+                }
+                else
+                {
+                    *p++ = '\\';
+                    switch( c )
+                    {
+                        case '\b':
+                            *p++ = 'b';
+                            break;
+
+                        case '\f':
+                            *p++ = 'f';
+                            break;
+
+                        case '\n':
+                            *p++ = 'n';
+                            break;
+
+                        case '\r':
+                            *p++ = 'r';
+                            break;
+
+                        case '\t':
+                            *p++ = 't';
+                            break;
+
+                        default:
+                            *p++ = 'u';
+                            *p++ = '0';
+                            *p++ = '0';
+                            *p++ = hex[c >> 4];
+                            *p++ = hex[c & 0x0F];
+                            break;
+                    }
+                }
+            }
+
+            pMsgBuf->len = p - pMsgBuf->pData;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  MSGBUF_Printf                                                             */
+/*!
+    Append formatted output to a message buffer
+
+    The MSGBUF_Printf function formats its arguments according to the
+    format string and appends the result to the message buffer.
+
+    @param[in]
+        pMsgBuf
+            pointer to the message buffer
+
+    @param[in]
+        fmt
+            printf style format string
+
+    @retval EOK the formatted output was appended
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int MSGBUF_Printf( MsgBuf *pMsgBuf, const char *fmt, ... )
+{
+    int result = EINVAL;
+    va_list args;
+    size_t avail;
+    int n;
+
+    if ( ( pMsgBuf != NULL ) &&
+         ( fmt != NULL ) )
+    {
+        avail = pMsgBuf->size - pMsgBuf->len;
+
+        /* try to format directly into the free space */
+        va_start( args, fmt );
+        n = vsnprintf( &pMsgBuf->pData[pMsgBuf->len], avail, fmt, args );
+        va_end( args );
+
+        if ( n < 0 )
+        {
+            result = EINVAL;
+        }
+        else if ( (size_t)n < avail )
+        {
+            pMsgBuf->len += n;
+            result = EOK;
+        }
+        else
+        {
+            /* grow the buffer and format again */
+            result = MSGBUF_Reserve( pMsgBuf, (size_t)n + 1 );
+            if ( result == EOK )
+            {
+                va_start( args, fmt );
+                vsnprintf( &pMsgBuf->pData[pMsgBuf->len],
+                           (size_t)n + 1,
+                           fmt,
+                           args );
+                va_end( args );
+
+                pMsgBuf->len += n;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  MSGBUF_Free                                                               */
+/*!
+    Release the storage used by a message buffer
+
+    @param[in]
+        pMsgBuf
+            pointer to the message buffer to free
+
+==============================================================================*/
+void MSGBUF_Free( MsgBuf *pMsgBuf )
+{
+    if ( pMsgBuf != NULL )
+    {
+        free( pMsgBuf->pData );
+        pMsgBuf->pData = NULL;
+        pMsgBuf->len = 0;
+        pMsgBuf->size = 0;
+    }
+}
+
+/*! @}
+ * end of msgbuf group */
@@ -0,0 +1,265 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup msgstats Message Statistics
+ * @brief Lock free message performance counters
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file msgstats.c
+
+    Message Statistics
+
+    The Message Statistics functions maintain the performance counters
+    of a message, and latency histograms.  The counters are updated by
+    the render threads with atomic operations, and read by the thread
+    which publishes them, so recording a render never takes a lock.
+
+    A snapshot reads the counters and starts a new window for the
+    average and maximum values.  Since the counters are updated
+    independently, a snapshot taken during a render may be off by one
+    render, which is acceptable for statistics.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include "msgstats.h"
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  MSGSTATS_Record                                                           */
+/*!
+    Record a message render
+
+    The MSGSTATS_Record function adds the measurements of one render
+    of a message to its performance counters.
+
+    @param[in]
+        pStats
+            pointer to the message performance counters
+
+    @param[in]
+        renderUs
+            time taken to render the message in microseconds
+
+    @param[in]
+        sinkUs
+            time taken to write the message to its output in microseconds
+
+    @param[in]
+        bytes
+            size of the message in bytes
+
+    @param[in]
+        vars
+            number of variables in the message
+
+==============================================================================*/
+void MSGSTATS_Record( MsgStats *pStats,
+                      uint32_t renderUs,
+                      uint32_t sinkUs,
+                      size_t bytes,
+                      size_t vars )
+{
+    uint32_t max;
+
+    if ( pStats != NULL )
+    {
+        __atomic_store_n( &pStats->lastRender, renderUs, __ATOMIC_RELAXED );
+        __atomic_add_fetch( &pStats->renderTotal, renderUs, __ATOMIC_RELAXED );
+        __atomic_add_fetch( &pStats->renderCount, 1, __ATOMIC_RELAXED );
+        __atomic_add_fetch( &pStats->sinkTotal, sinkUs, __ATOMIC_RELAXED );
+        __atomic_add_fetch( &pStats->bytes, bytes, __ATOMIC_RELAXED );
+        __atomic_add_fetch( &pStats->vars, vars, __ATOMIC_RELAXED );
+
+        /* raise the window maximum */
+        max = __atomic_load_n( &pStats->renderMax, __ATOMIC_RELAXED );
+        while ( ( renderUs > max ) &&
+                ( __atomic_compare_exchange_n( &pStats->renderMax,
+                                               &max,
+                                               renderUs,
+                                               true,
+                                               __ATOMIC_RELAXED,
+                                               __ATOMIC_RELAXED ) == false ) )
+        {
+            /* max now holds the current value, so try again */
+        }
+    }
+}
+
+/*============================================================================*/
+/*  MSGSTATS_Snapshot                                                         */
+/*!
+    Take a snapshot of the message performance counters
+
+    The MSGSTATS_Snapshot function reads the performance counters of a
+    message and starts a new window.  The averages and the maximum are
+    zero if the message was not rendered during the window.
+
+    @param[in]
+        pStats
+            pointer to the message performance counters
+
+    @param[out]
+        pSnapshot
+            pointer to the location to store the snapshot
+
+==============================================================================*/
+void MSGSTATS_Snapshot( MsgStats *pStats, MsgStatsSnapshot *pSnapshot )
+{
+    uint64_t renderTotal;
+    uint64_t sinkTotal;
+    uint32_t count;
+
+    if ( ( pStats != NULL ) &&
+         ( pSnapshot != NULL ) )
+    {
+        count = __atomic_exchange_n( &pStats->renderCount,
+                                     0,
+                                     __ATOMIC_RELAXED );
+        renderTotal = __atomic_exchange_n( &pStats->renderTotal,
+                                           0,
+                                           __ATOMIC_RELAXED );
+        sinkTotal = __atomic_exchange_n( &pStats->sinkTotal,
+                                         0,
+                                         __ATOMIC_RELAXED );
+
+        pSnapshot->lastRender = __atomic_load_n( &pStats->lastRender,
+                                                 __ATOMIC_RELAXED );
+        pSnapshot->maxRender = __atomic_exchange_n( &pStats->renderMax,
+                                                    0,
+                                                    __ATOMIC_RELAXED );
+        pSnapshot->avgRender = ( count > 0 ) ? renderTotal / count : 0;
+        pSnapshot->avgSink = ( count > 0 ) ? sinkTotal / count : 0;
+        pSnapshot->bytes = __atomic_load_n( &pStats->bytes, __ATOMIC_RELAXED );
+        pSnapshot->vars = __atomic_load_n( &pStats->vars, __ATOMIC_RELAXED );
+    }
+}
+
+/*============================================================================*/
+/*  MSGSTATS_HistAdd                                                          */
+/*!
+    Add a latency to a latency histogram
+
+    @param[in]
+        pHist
+            pointer to the latency histogram
+
+    @param[in]
+        us
+            latency in microseconds
+
+==============================================================================*/
+void MSGSTATS_HistAdd( LatencyHist *pHist, uint32_t us )
+{
+    uint32_t bucket;
+
+    if ( pHist != NULL )
+    {
+        /* the bucket is the number of significant bits in the latency */
+        bucket = ( us > 0 ) ? 32 - __builtin_clz( us ) : 0;
+        if ( bucket >= MSGSTATS_HIST_BUCKETS )
+        {
+            bucket = MSGSTATS_HIST_BUCKETS - 1;
+        }
+
+        __atomic_add_fetch( &pHist->count[bucket], 1, __ATOMIC_RELAXED );
+    }
+}
+
+/*============================================================================*/
+/*  MSGSTATS_HistFormat                                                       */
+/*!
+    Format a latency histogram as a JSON array
+
+    The MSGSTATS_HistFormat function appends the bucket counts of the
+    latency histogram to the message buffer as a JSON array.  Trailing
+    empty buckets are left out.
+
+    @param[in]
+        pHist
+            pointer to the latency histogram
+
+    @param[in]
+        pMsgBuf
+            pointer to the message buffer to append to
+
+    @retval EOK the histogram was formatted
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int MSGSTATS_HistFormat( LatencyHist *pHist, MsgBuf *pMsgBuf )
+{
+    int result = EINVAL;
+    uint64_t count[MSGSTATS_HIST_BUCKETS];
+    size_t n = 0;
+    size_t i;
+
+    if ( ( pHist != NULL ) &&
+         ( pMsgBuf != NULL ) )
+    {
+        for ( i = 0; i < MSGSTATS_HIST_BUCKETS; i++ )
+        {
+            count[i] = __atomic_load_n( &pHist->count[i], __ATOMIC_RELAXED );
+            if ( count[i] != 0 )
+            {
+                n = i + 1;
+            }
+        }
+
+        result = MSGBUF_AppendChar( pMsgBuf, '[' );
+        for ( i = 0; ( result == EOK ) && ( i < n ); i++ )
+        {
+            result = MSGBUF_Printf( pMsgBuf,
+                                    ( i > 0 ) ? ",%llu" : "%llu",
+                                    (unsigned long long)count[i] );
+        }
+
+        if ( result == EOK )
+        {
+            result = MSGBUF_AppendChar( pMsgBuf, ']' );
+        }
+    }
+
+    return result;
+}
+
+/*! @}
+ * end of msgstats group */
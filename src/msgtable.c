@@ -0,0 +1,435 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup msgtable Message Table
+ * @brief Structure of arrays holding the scheduling state of the messages
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file msgtable.c
+
+    Message Table
+
+    The Message Table holds the per-message state which is read on
+    every timer and trigger event, such as the enable flag, the
+    interval and the coalescing windows.  Each field is stored in an
+    array indexed by message identifier, so the state of a message is
+    found without walking the message list, and checking the state of
+    many messages touches few cache lines.
+
+    Message identifiers are handed out by MSGTABLE_Add, and the
+    identifier of a removed message is reused by the next message
+    which is added.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "msgtable.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! default initial number of table entries */
+#define MSGTABLE_SIZE_DEFAULT   ( 64 )
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static int Grow( MsgTable *pTable, size_t size );
+static int GrowArray( void **pp, size_t n, size_t size, size_t elemSize );
+static void Clear( MsgTable *pTable, uint32_t id );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  MSGTABLE_Init                                                             */
+/*!
+    Initialize a message table
+
+    @param[in]
+        pTable
+            pointer to the message table to initialize
+
+    @param[in]
+        size
+            initial number of table entries.  If zero is specified a
+            default size is used.
+
+    @retval EOK the message table was initialized
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int MSGTABLE_Init( MsgTable *pTable, size_t size )
+{
+    int result = EINVAL;
+
+    if ( pTable != NULL )
+    {
+        if ( size == 0 )
+        {
+            size = MSGTABLE_SIZE_DEFAULT;
+        }
+
+        memset( pTable, 0, sizeof( MsgTable ) );
+        result = Grow( pTable, size );
+        if ( result != EOK )
+        {
+            MSGTABLE_Free( pTable );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  MSGTABLE_Add                                                              */
+/*!
+    Add a message to the message table
+
+    The MSGTABLE_Add function allocates an identifier for a message and
+    clears its scheduling state.  The lowest free identifier is used,
+    so the table stays compact when messages are replaced.  The table
+    grows as required.
+
+    @param[in]
+        pTable
+            pointer to the message table
+
+    @param[in]
+        pData
+            opaque pointer to the object owning the message
+
+    @param[out]
+        pId
+            location to store the message identifier
+
+    @retval EOK the message was added
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int MSGTABLE_Add( MsgTable *pTable, void *pData, uint32_t *pId )
+{
+    int result = EINVAL;
+    size_t id;
+
+    if ( ( pTable != NULL ) &&
+         ( pData != NULL ) &&
+         ( pId != NULL ) )
+    {
+        result = EOK;
+
+        /* find the lowest free identifier */
+        for ( id = 0; id < pTable->n; id++ )
+        {
+            if ( pTable->ppData[id] == NULL )
+            {
+                break;
+            }
+        }
+
+        if ( id == pTable->size )
+        {
+            /* double the table */
+            result = Grow( pTable, pTable->size * 2 );
+        }
+
+        if ( result == EOK )
+        {
+            if ( id == pTable->n )
+            {
+                pTable->n++;
+            }
+
+            Clear( pTable, id );
+            pTable->ppData[id] = pData;
+            *pId = id;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  MSGTABLE_Remove                                                           */
+/*!
+    Remove a message from the message table
+
+    The MSGTABLE_Remove function releases the message identifier so it
+    can be given to another message.
+
+    @param[in]
+        pTable
+            pointer to the message table
+
+    @param[in]
+        id
+            identifier of the message to remove
+
+==============================================================================*/
+void MSGTABLE_Remove( MsgTable *pTable, uint32_t id )
+{
+    if ( ( pTable != NULL ) &&
+         ( id < pTable->n ) )
+    {
+        Clear( pTable, id );
+
+        /* give back trailing identifiers */
+        while ( ( pTable->n > 0 ) &&
+                ( pTable->ppData[pTable->n - 1] == NULL ) )
+        {
+            pTable->n--;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  MSGTABLE_Free                                                             */
+/*!
+    Release the storage used by a message table
+
+    @param[in]
+        pTable
+            pointer to the message table to free
+
+==============================================================================*/
+void MSGTABLE_Free( MsgTable *pTable )
+{
+    if ( pTable != NULL )
+    {
+        free( pTable->ppData );
+        free( pTable->pEnabled );
+        free( pTable->pRescan );
+        free( pTable->pInterval );
+        free( pTable->pRescanInterval );
+        free( pTable->pMinInterval );
+        free( pTable->pDebounce );
+        free( pTable->pLastSent );
+        free( pTable->pPriority );
+        free( pTable->pSampled );
+        memset( pTable, 0, sizeof( MsgTable ) );
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  Grow                                                                      */
+/*!
+    Grow the arrays of a message table
+
+    The table size is only updated once all of the arrays have been
+    grown, so a failure leaves the table usable at its previous size.
+
+    @param[in]
+        pTable
+            pointer to the message table
+
+    @param[in]
+        size
+            new number of table entries
+
+    @retval EOK the table was grown
+    @retval ENOMEM memory allocation failure
+
+==============================================================================*/
+static int Grow( MsgTable *pTable, size_t size )
+{
+    int result;
+
+    result = GrowArray( (void **)&pTable->ppData,
+                        pTable->size,
+                        size,
+                        sizeof( void * ) );
+    if ( result == EOK )
+    {
+        result = GrowArray( (void **)&pTable->pEnabled,
+                            pTable->size,
+                            size,
+                            sizeof( bool ) );
+    }
+
+    if ( result == EOK )
+    {
+        result = GrowArray( (void **)&pTable->pRescan,
+                            pTable->size,
+                            size,
+                            sizeof( bool ) );
+    }
+
+    if ( result == EOK )
+    {
+        result = GrowArray( (void **)&pTable->pInterval,
+                            pTable->size,
+                            size,
+                            sizeof( uint32_t ) );
+    }
+
+    if ( result == EOK )
+    {
+        result = GrowArray( (void **)&pTable->pRescanInterval,
+                            pTable->size,
+                            size,
+                            sizeof( uint32_t ) );
+    }
+
+    if ( result == EOK )
+    {
+        result = GrowArray( (void **)&pTable->pMinInterval,
+                            pTable->size,
+                            size,
+                            sizeof( uint32_t ) );
+    }
+
+    if ( result == EOK )
+    {
+        result = GrowArray( (void **)&pTable->pDebounce,
+                            pTable->size,
+                            size,
+                            sizeof( uint32_t ) );
+    }
+
+    if ( result == EOK )
+    {
+        result = GrowArray( (void **)&pTable->pLastSent,
+                            pTable->size,
+                            size,
+                            sizeof( uint64_t ) );
+    }
+
+    if ( result == EOK )
+    {
+        result = GrowArray( (void **)&pTable->pPriority,
+                            pTable->size,
+                            size,
+                            sizeof( uint32_t ) );
+    }
+
+    if ( result == EOK )
+    {
+        result = GrowArray( (void **)&pTable->pSampled,
+                            pTable->size,
+                            size,
+                            sizeof( uint32_t ) );
+    }
+
+    if ( result == EOK )
+    {
+        pTable->size = size;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  GrowArray                                                                 */
+/*!
+    Grow one array of a message table
+
+    The new entries of the array are zeroed.
+
+    @param[in,out]
+        pp
+            pointer to the array pointer to update
+
+    @param[in]
+        n
+            current number of array entries
+
+    @param[in]
+        size
+            new number of array entries
+
+    @param[in]
+        elemSize
+            size of each array entry
+
+    @retval EOK the array was grown
+    @retval ENOMEM memory allocation failure
+
+==============================================================================*/
+static int GrowArray( void **pp, size_t n, size_t size, size_t elemSize )
+{
+    int result = ENOMEM;
+    char *p;
+
+    p = realloc( *pp, size * elemSize );
+    if ( p != NULL )
+    {
+        memset( &p[n * elemSize], 0, ( size - n ) * elemSize );
+        *pp = p;
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  Clear                                                                     */
+/*!
+    Clear the state of a message table entry
+
+    @param[in]
+        pTable
+            pointer to the message table
+
+    @param[in]
+        id
+            identifier of the entry to clear
+
+==============================================================================*/
+static void Clear( MsgTable *pTable, uint32_t id )
+{
+    pTable->ppData[id] = NULL;
+    pTable->pEnabled[id] = false;
+    pTable->pRescan[id] = false;
+    pTable->pInterval[id] = 0;
+    pTable->pRescanInterval[id] = 0;
+    pTable->pMinInterval[id] = 0;
+    pTable->pDebounce[id] = 0;
+    pTable->pLastSent[id] = 0;
+    pTable->pPriority[id] = 0;
+    pTable->pSampled[id] = 0;
+}
+
+/*! @}
+ * end of msgtable group */
@@ -0,0 +1,431 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup msgtmpl Message Template
+ * @brief Message templates compiled into text segments and variable slots
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file msgtmpl.c
+
+    Message Template
+
+    A Message Template describes the envelope a message is wrapped in.
+    It is plain text in which ${name} is replaced with the value of the
+    variable called name, and ${*} is replaced with the message body.
+
+    The template is compiled once when it is loaded into a sequence of
+    static text segments and slots, so rendering a message is a single
+    pass over the parts which copies the segments and fills the slots,
+    without parsing the template again.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "msgtmpl.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! name of the slot which is filled with the message body */
+#define MSGTMPL_BODY_NAME       "*"
+
+/*! maximum size of a template file */
+#define MSGTMPL_MAX_FILE_SIZE   ( 64 * 1024 )
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static int AddPart( MsgTemplate *pTmpl,
+                    MsgTmplPartType type,
+                    const char *pData,
+                    size_t len );
+static const char *FindSlot( const char *p, const char *pEnd );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  MSGTMPL_Compile                                                           */
+/*!
+    Compile a message template
+
+    The MSGTMPL_Compile function splits the template text into static
+    text segments, variable slots and the message body slot.  The slot
+    variables are not resolved.
+
+    @param[in]
+        pTmpl
+            pointer to the message template to compile into
+
+    @param[in]
+        pText
+            pointer to the template text
+
+    @param[in]
+        len
+            length of the template text
+
+    @retval EOK the template was compiled
+    @retval EINVAL the template contains an unterminated or empty slot,
+            more than one body slot, or the arguments are invalid
+    @retval ENOMEM memory allocation failure
+
+==============================================================================*/
+int MSGTMPL_Compile( MsgTemplate *pTmpl, const char *pText, size_t len )
+{
+    int result = EINVAL;
+    const char *p = pText;
+    const char *pEnd = pText + len;
+    const char *pSlot;
+    const char *pName;
+    const char *pClose;
+    size_t count = 0;
+
+    if ( ( pTmpl != NULL ) &&
+         ( pText != NULL ) )
+    {
+        memset( pTmpl, 0, sizeof( MsgTemplate ) );
+
+        /* each slot splits the text, so there are at most two parts
+           for each slot plus the text after the last one */
+        for ( pSlot = FindSlot( p, pEnd );
+              pSlot != NULL;
+              pSlot = FindSlot( pSlot + 2, pEnd ) )
+        {
+            count++;
+        }
+
+        pTmpl->pParts = calloc( ( count * 2 ) + 1, sizeof( MsgTmplPart ) );
+        if ( pTmpl->pParts != NULL )
+        {
+            result = MSGBUF_Init( &pTmpl->text, len + count + 1 );
+        }
+        else
+        {
+            result = ENOMEM;
+        }
+
+        while ( ( result == EOK ) && ( p < pEnd ) )
+        {
+            pSlot = FindSlot( p, pEnd );
+            if ( pSlot == NULL )
+            {
+                /* the rest of the template is static text */
+                result = AddPart( pTmpl, MSGTMPL_TEXT, p, pEnd - p );
+                p = pEnd;
+            }
+            else
+            {
+                result = AddPart( pTmpl, MSGTMPL_TEXT, p, pSlot - p );
+
+                pName = pSlot + 2;
+                pClose = memchr( pName, '}', pEnd - pName );
+                if ( ( result != EOK ) ||
+                     ( pClose == NULL ) ||
+                     ( pClose == pName ) )
+                {
+                    /* unterminated or empty slot */
+                    result = ( result == EOK ) ? EINVAL : result;
+                }
+                else if ( ( (size_t)( pClose - pName ) ==
+                                strlen( MSGTMPL_BODY_NAME ) ) &&
+                          ( strncmp( pName,
+                                     MSGTMPL_BODY_NAME,
+                                     pClose - pName ) == 0 ) )
+                {
+                    result = AddPart( pTmpl, MSGTMPL_BODY, NULL, 0 );
+                }
+                else
+                {
+                    result = AddPart( pTmpl,
+                                      MSGTMPL_VAR,
+                                      pName,
+                                      pClose - pName );
+                }
+
+                p = ( pClose != NULL ) ? pClose + 1 : pEnd;
+            }
+        }
+
+        if ( ( result == EOK ) &&
+             ( pTmpl->pParts[pTmpl->bodyIdx].type != MSGTMPL_BODY ) )
+        {
+            /* the body follows the template */
+            pTmpl->bodyIdx = pTmpl->n;
+        }
+
+        if ( result != EOK )
+        {
+            MSGTMPL_Free( pTmpl );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  MSGTMPL_Load                                                              */
+/*!
+    Load and compile a message template file
+
+    The MSGTMPL_Load function reads the specified template file and
+    compiles it.  A single newline at the end of the file is not part
+    of the template, since each message is terminated with a newline.
+
+    @param[in]
+        pTmpl
+            pointer to the message template to compile into
+
+    @param[in]
+        pFileName
+            name of the template file
+
+    @retval EOK the template was loaded
+    @retval ENOENT the template file could not be opened
+    @retval EFBIG the template file is too large
+    @retval EIO the template file could not be read
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid template or arguments
+
+==============================================================================*/
+int MSGTMPL_Load( MsgTemplate *pTmpl, const char *pFileName )
+{
+    int result = EINVAL;
+    FILE *fp;
+    char *pText;
+    long size;
+    size_t len;
+
+    if ( ( pTmpl != NULL ) &&
+         ( pFileName != NULL ) )
+    {
+        fp = fopen( pFileName, "r" );
+        if ( fp != NULL )
+        {
+            result = EIO;
+            if ( ( fseek( fp, 0, SEEK_END ) == 0 ) &&
+                 ( ( size = ftell( fp ) ) >= 0 ) &&
+                 ( fseek( fp, 0, SEEK_SET ) == 0 ) )
+            {
+                result = ( size <= MSGTMPL_MAX_FILE_SIZE ) ? EOK : EFBIG;
+            }
+
+            if ( result == EOK )
+            {
+                pText = malloc( size + 1 );
+                if ( pText == NULL )
+                {
+                    result = ENOMEM;
+                }
+                else if ( fread( pText, 1, size, fp ) != (size_t)size )
+                {
+                    result = EIO;
+                }
+                else
+                {
+                    len = size;
+                    if ( ( len > 0 ) && ( pText[len - 1] == '\n' ) )
+                    {
+                        len--;
+                    }
+
+                    result = MSGTMPL_Compile( pTmpl, pText, len );
+                }
+
+                free( pText );
+            }
+
+            fclose( fp );
+        }
+        else
+        {
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  MSGTMPL_Free                                                              */
+/*!
+    Release the storage used by a message template
+
+    @param[in]
+        pTmpl
+            pointer to the message template to free
+
+==============================================================================*/
+void MSGTMPL_Free( MsgTemplate *pTmpl )
+{
+    if ( pTmpl != NULL )
+    {
+        free( pTmpl->pParts );
+        pTmpl->pParts = NULL;
+        pTmpl->n = 0;
+        pTmpl->bodyIdx = 0;
+        MSGBUF_Free( &pTmpl->text );
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  AddPart                                                                   */
+/*!
+    Add a part to a message template
+
+    The AddPart function appends a part to the template.  The text of
+    a static text part, and the NUL terminated name of a variable slot,
+    are copied into the template text buffer.  Empty static text parts
+    are not added.
+
+    @param[in]
+        pTmpl
+            pointer to the message template
+
+    @param[in]
+        type
+            type of part to add
+
+    @param[in]
+        pData
+            pointer to the static text or variable name
+
+    @param[in]
+        len
+            length of the static text or variable name
+
+    @retval EOK the part was added
+    @retval EINVAL the template already has a body slot
+    @retval ENOMEM memory allocation failure
+
+==============================================================================*/
+static int AddPart( MsgTemplate *pTmpl,
+                    MsgTmplPartType type,
+                    const char *pData,
+                    size_t len )
+{
+    int result = EOK;
+    MsgTmplPart *pPart;
+
+    if ( ( type == MSGTMPL_BODY ) &&
+         ( pTmpl->n > 0 ) &&
+         ( pTmpl->pParts[pTmpl->bodyIdx].type == MSGTMPL_BODY ) )
+    {
+        /* only one body slot is allowed */
+        result = EINVAL;
+    }
+    else if ( ( type != MSGTMPL_TEXT ) || ( len > 0 ) )
+    {
+        pPart = &pTmpl->pParts[pTmpl->n];
+        pPart->type = type;
+        pPart->offset = pTmpl->text.len;
+        pPart->len = len;
+        pPart->hVar = VAR_INVALID;
+        pPart->typed = false;
+
+        if ( len > 0 )
+        {
+            result = MSGBUF_Append( &pTmpl->text, pData, len );
+        }
+
+        if ( ( result == EOK ) && ( type == MSGTMPL_VAR ) )
+        {
+            result = MSGBUF_AppendChar( &pTmpl->text, '\0' );
+        }
+
+        if ( result == EOK )
+        {
+            if ( type == MSGTMPL_BODY )
+            {
+                pTmpl->bodyIdx = pTmpl->n;
+            }
+
+            pTmpl->n++;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  FindSlot                                                                  */
+/*!
+    Find the start of the next slot in the template text
+
+    @param[in]
+        p
+            pointer to the template text to search
+
+    @param[in]
+        pEnd
+            pointer to the end of the template text
+
+    @retval pointer to the next "${" in the text
+    @retval NULL there are no more slots
+
+==============================================================================*/
+static const char *FindSlot( const char *p, const char *pEnd )
+{
+    const char *pSlot = NULL;
+
+    while ( ( pSlot == NULL ) &&
+            ( p != NULL ) &&
+            ( p + 1 < pEnd ) )
+    {
+        p = memchr( p, '$', ( pEnd - p ) - 1 );
+        if ( ( p != NULL ) && ( p[1] == '{' ) )
+        {
+            pSlot = p;
+        }
+        else if ( p != NULL )
+        {
+            p++;
+        }
+    }
+
+    return pSlot;
+}
+
+/*! @}
+ * end of msgtmpl group */
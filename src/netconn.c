@@ -0,0 +1,878 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup netconn Network Connection
+ * @brief Persistent UDP or TCP connection with batched sends
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file netconn.c
+
+    Network Connection
+
+    The Network Connection sends variable messages to a network peer
+    given as "host:port", or "[address]:port" for an IPv6 address.  The
+    peer address is resolved once when the connection is opened.
+
+    Messages are queued by NETCONN_Write and are sent when the
+    connection is flushed, so all of the messages generated in one
+    processing cycle are sent with as few system calls as possible.
+    UDP messages are sent as one datagram each with sendmmsg.  TCP
+    messages are stored back to back in one buffer which is sent with
+    a single send call.
+
+    The socket is non-blocking so the caller is never held up by the
+    network.  A TCP connection is made in the background, and queued
+    messages are kept while it is being made.  Data which the socket
+    cannot take yet is sent by the next flush.  If the connection fails
+    it is re-established by a later flush, with a delay which doubles
+    after each failed attempt.  A message which was partly sent when
+    the connection failed is discarded, so each new connection starts
+    at a message boundary.  The queue is bounded, and messages which
+    do not fit are rejected.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include "netconn.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! maximum length of the host part of a peer address */
+#define NETCONN_HOST_LEN        ( 256 )
+
+/*! maximum number of bytes waiting to be sent */
+#define NETCONN_BACKLOG         ( 1024 * 1024 )
+
+/*! maximum size of a UDP datagram */
+#define NETCONN_MAX_DATAGRAM    ( 65507 )
+
+/*! maximum number of datagrams sent by one sendmmsg call */
+#define NETCONN_MMSG            ( 64 )
+
+/*! initial size of the message queue */
+#define NETCONN_QUEUE_SIZE      ( 64 * 1024 )
+
+/*! initial number of message end offsets */
+#define NETCONN_ENDS_SIZE       ( 64 )
+
+/*! delay before the first reconnection attempt in milliseconds */
+#define NETCONN_BACKOFF_MIN     ( 100 )
+
+/*! maximum delay between reconnection attempts in milliseconds */
+#define NETCONN_BACKOFF_MAX     ( 30 * 1000 )
+
+/*! time allowed for a TCP connection to be made in milliseconds */
+#define NETCONN_CONNECT_TIMEOUT ( 5 * 1000 )
+
+/*! delay before a connection which is waiting for its socket is
+    flushed again in milliseconds */
+#define NETCONN_POLL_INTERVAL   ( 10 )
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static int Resolve( NetConn *pConn, const char *address );
+static void Connect( NetConn *pConn, uint64_t now );
+static void CheckConnect( NetConn *pConn, uint64_t now );
+static void Disconnect( NetConn *pConn, uint64_t now );
+static int SendStream( NetConn *pConn, uint64_t now );
+static int SendDatagrams( NetConn *pConn );
+static void Advance( NetConn *pConn );
+static void Compact( NetConn *pConn );
+static size_t MessageStart( NetConn *pConn, size_t idx );
+static uint64_t Now( void );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  NETCONN_Open                                                              */
+/*!
+    Open a network connection
+
+    The NETCONN_Open function resolves the peer address and starts the
+    first connection attempt.  A TCP connection which cannot be made
+    straight away is retried by NETCONN_Flush, so the peer does not
+    need to be running when the connection is opened.
+
+    @param[in]
+        pConn
+            pointer to the connection to open
+
+    @param[in]
+        type
+            transport used to send the messages
+
+    @param[in]
+        address
+            peer address in the form host:port
+
+    @retval EOK the connection was opened
+    @retval EINVAL invalid arguments or peer address
+    @retval ENOENT the peer address could not be resolved
+    @retval ENOMEM memory allocation failure
+
+==============================================================================*/
+int NETCONN_Open( NetConn *pConn, NetConnType type, const char *address )
+{
+    int result = EINVAL;
+
+    if ( ( pConn != NULL ) &&
+         ( address != NULL ) )
+    {
+        memset( pConn, 0, sizeof( NetConn ) );
+        pConn->type = type;
+        pConn->fd = -1;
+        pConn->backoff = NETCONN_BACKOFF_MIN;
+
+        result = Resolve( pConn, address );
+        if ( result == EOK )
+        {
+            result = MSGBUF_Init( &pConn->queue, NETCONN_QUEUE_SIZE );
+        }
+
+        if ( result == EOK )
+        {
+            pConn->pEnds = malloc( NETCONN_ENDS_SIZE * sizeof( size_t ) );
+            if ( pConn->pEnds != NULL )
+            {
+                pConn->size = NETCONN_ENDS_SIZE;
+                Connect( pConn, Now() );
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+
+        if ( result != EOK )
+        {
+            MSGBUF_Free( &pConn->queue );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  NETCONN_Write                                                             */
+/*!
+    Queue a message on a network connection
+
+    The NETCONN_Write function adds a complete message to the queue of
+    messages which are sent by the next NETCONN_Flush.
+
+    @param[in]
+        pConn
+            pointer to the connection
+
+    @param[in]
+        pData
+            pointer to the message data
+
+    @param[in]
+        len
+            length of the message data
+
+    @retval EOK the message was queued
+    @retval EMSGSIZE the message is too big for a UDP datagram
+    @retval ENOBUFS the queue is full
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int NETCONN_Write( NetConn *pConn, const char *pData, size_t len )
+{
+    int result = EINVAL;
+    size_t *pEnds;
+    size_t size;
+
+    if ( ( pConn != NULL ) &&
+         ( pData != NULL ) )
+    {
+        result = EOK;
+
+        if ( ( pConn->type == NETCONN_UDP ) &&
+             ( len > NETCONN_MAX_DATAGRAM ) )
+        {
+            result = EMSGSIZE;
+        }
+        else if ( ( pConn->queue.len - pConn->sent + len ) > NETCONN_BACKLOG )
+        {
+            /* the peer is not keeping up, or is not connected */
+            result = ENOBUFS;
+        }
+        else if ( pConn->n == pConn->size )
+        {
+            size = pConn->size * 2;
+            pEnds = realloc( pConn->pEnds, size * sizeof( size_t ) );
+            if ( pEnds != NULL )
+            {
+                pConn->pEnds = pEnds;
+                pConn->size = size;
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+
+        if ( result == EOK )
+        {
+            result = MSGBUF_Append( &pConn->queue, pData, len );
+        }
+
+        if ( result == EOK )
+        {
+            pConn->pEnds[pConn->n++] = pConn->queue.len;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  NETCONN_Flush                                                             */
+/*!
+    Send the queued messages
+
+    The NETCONN_Flush function makes a connection attempt if one is
+    due, and sends as many of the queued messages as the socket will
+    take.  UDP datagrams which cannot be sent are discarded, since the
+    transport does not guarantee delivery anyway.  TCP data which cannot
+    be sent stays queued for the next flush.
+
+    @param[in]
+        pConn
+            pointer to the connection to flush
+
+    @retval EOK the queued messages were sent, or were kept for later
+    @retval EINVAL invalid arguments
+    @retval other error from send() or sendmmsg()
+
+==============================================================================*/
+int NETCONN_Flush( NetConn *pConn )
+{
+    int result = EINVAL;
+    uint64_t now;
+
+    if ( pConn != NULL )
+    {
+        result = EOK;
+        now = Now();
+
+        if ( ( pConn->state == NETCONN_IDLE ) &&
+             ( now >= pConn->retryAt ) )
+        {
+            Connect( pConn, now );
+        }
+
+        if ( pConn->state == NETCONN_CONNECTING )
+        {
+            CheckConnect( pConn, now );
+        }
+
+        if ( ( pConn->state == NETCONN_CONNECTED ) &&
+             ( pConn->first < pConn->n ) )
+        {
+            if ( pConn->type == NETCONN_UDP )
+            {
+                result = SendDatagrams( pConn );
+            }
+            else
+            {
+                result = SendStream( pConn, now );
+            }
+        }
+
+        Compact( pConn );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  NETCONN_RetryAt                                                           */
+/*!
+    Get the time at which the connection needs to be flushed again
+
+    The NETCONN_RetryAt function reports when a connection has work
+    which NETCONN_Flush could not finish.  A connection which is waiting
+    for its next connection attempt with messages queued is due at the
+    end of its backoff delay.  A connection attempt which is in progress,
+    or queued data which the socket would not take, is polled again
+    after a short delay.
+
+    @param[in]
+        pConn
+            pointer to the connection
+
+    @retval monotonic time in milliseconds of the next flush
+    @retval 0 the connection does not need to be flushed until more
+            messages are written
+
+==============================================================================*/
+uint64_t NETCONN_RetryAt( NetConn *pConn )
+{
+    uint64_t due = 0;
+
+    if ( pConn != NULL )
+    {
+        if ( pConn->state == NETCONN_CONNECTING )
+        {
+            due = Now() + NETCONN_POLL_INTERVAL;
+            if ( pConn->retryAt < due )
+            {
+                /* the connection attempt times out first */
+                due = pConn->retryAt;
+            }
+        }
+        else if ( pConn->first < pConn->n )
+        {
+            due = ( pConn->state == NETCONN_IDLE )
+                  ? pConn->retryAt
+                  : Now() + NETCONN_POLL_INTERVAL;
+        }
+    }
+
+    return due;
+}
+
+/*============================================================================*/
+/*  NETCONN_Close                                                             */
+/*!
+    Close a network connection
+
+    The NETCONN_Close function closes the socket and discards any
+    messages which have not been sent.
+
+    @param[in]
+        pConn
+            pointer to the connection to close
+
+==============================================================================*/
+void NETCONN_Close( NetConn *pConn )
+{
+    if ( pConn != NULL )
+    {
+        if ( pConn->fd != -1 )
+        {
+            close( pConn->fd );
+            pConn->fd = -1;
+        }
+
+        pConn->state = NETCONN_IDLE;
+        MSGBUF_Free( &pConn->queue );
+        free( pConn->pEnds );
+        pConn->pEnds = NULL;
+        pConn->n = 0;
+        pConn->size = 0;
+        pConn->first = 0;
+        pConn->sent = 0;
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  Resolve                                                                   */
+/*!
+    Resolve the peer address of a connection
+
+    @param[in]
+        pConn
+            pointer to the connection
+
+    @param[in]
+        address
+            peer address in the form host:port or [address]:port
+
+    @retval EOK the address was resolved
+    @retval EINVAL the address is not valid
+    @retval ENOENT the address could not be resolved
+
+==============================================================================*/
+static int Resolve( NetConn *pConn, const char *address )
+{
+    int result = EINVAL;
+    char host[NETCONN_HOST_LEN];
+    struct addrinfo hints;
+    struct addrinfo *pInfo = NULL;
+    const char *port;
+    const char *start = address;
+    size_t len;
+
+    port = strrchr( address, ':' );
+    if ( port != NULL )
+    {
+        len = port - address;
+        if ( ( address[0] == '[' ) &&
+             ( len >= 2 ) &&
+             ( address[len - 1] == ']' ) )
+        {
+            /* strip the brackets from an IPv6 address */
+            start = &address[1];
+            len -= 2;
+        }
+
+        if ( ( len > 0 ) &&
+             ( len < sizeof( host ) ) &&
+             ( port[1] != '\0' ) )
+        {
+            memcpy( host, start, len );
+            host[len] = '\0';
+            port++;
+
+            memset( &hints, 0, sizeof( hints ) );
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = ( pConn->type == NETCONN_UDP ) ? SOCK_DGRAM
+                                                               : SOCK_STREAM;
+            hints.ai_flags = AI_NUMERICSERV;
+
+            if ( ( getaddrinfo( host, port, &hints, &pInfo ) == 0 ) &&
+                 ( pInfo != NULL ) &&
+                 ( pInfo->ai_addrlen <= sizeof( pConn->addr ) ) )
+            {
+                memcpy( &pConn->addr, pInfo->ai_addr, pInfo->ai_addrlen );
+                pConn->addrlen = pInfo->ai_addrlen;
+                result = EOK;
+            }
+            else
+            {
+                result = ENOENT;
+            }
+
+            if ( pInfo != NULL )
+            {
+                freeaddrinfo( pInfo );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  Connect                                                                   */
+/*!
+    Start a connection attempt
+
+    The Connect function creates a non-blocking socket and connects it
+    to the peer.  A UDP socket is connected immediately.  A TCP
+    connection which is still being made is completed by CheckConnect.
+    If the attempt fails another attempt is scheduled.
+
+    @param[in]
+        pConn
+            pointer to the connection
+
+    @param[in]
+        now
+            current monotonic time in milliseconds
+
+==============================================================================*/
+static void Connect( NetConn *pConn, uint64_t now )
+{
+    int type;
+
+    type = ( pConn->type == NETCONN_UDP ) ? SOCK_DGRAM : SOCK_STREAM;
+
+    pConn->fd = socket( pConn->addr.ss_family,
+                        type | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        0 );
+    if ( pConn->fd == -1 )
+    {
+        Disconnect( pConn, now );
+    }
+    else if ( connect( pConn->fd,
+                       (struct sockaddr *)&pConn->addr,
+                       pConn->addrlen ) == 0 )
+    {
+        pConn->state = NETCONN_CONNECTED;
+        pConn->backoff = NETCONN_BACKOFF_MIN;
+    }
+    else if ( errno == EINPROGRESS )
+    {
+        pConn->state = NETCONN_CONNECTING;
+        pConn->retryAt = now + NETCONN_CONNECT_TIMEOUT;
+    }
+    else
+    {
+        Disconnect( pConn, now );
+    }
+}
+
+/*============================================================================*/
+/*  CheckConnect                                                              */
+/*!
+    Check whether a TCP connection attempt has completed
+
+    @param[in]
+        pConn
+            pointer to the connection
+
+    @param[in]
+        now
+            current monotonic time in milliseconds
+
+==============================================================================*/
+static void CheckConnect( NetConn *pConn, uint64_t now )
+{
+    struct pollfd pfd;
+    socklen_t len = sizeof( int );
+    int err = 0;
+
+    pfd.fd = pConn->fd;
+    pfd.events = POLLOUT;
+    pfd.revents = 0;
+
+    if ( poll( &pfd, 1, 0 ) > 0 )
+    {
+        if ( ( getsockopt( pConn->fd,
+                           SOL_SOCKET,
+                           SO_ERROR,
+                           &err,
+                           &len ) == 0 ) &&
+             ( err == 0 ) )
+        {
+            pConn->state = NETCONN_CONNECTED;
+            pConn->backoff = NETCONN_BACKOFF_MIN;
+        }
+        else
+        {
+            Disconnect( pConn, now );
+        }
+    }
+    else if ( now >= pConn->retryAt )
+    {
+        /* the connection attempt timed out */
+        Disconnect( pConn, now );
+    }
+}
+
+/*============================================================================*/
+/*  Disconnect                                                                */
+/*!
+    Close a failed connection and schedule the next attempt
+
+    The Disconnect function closes the socket, discards any message
+    which was partly sent, and schedules the next connection attempt.
+    The delay before the attempt doubles each time, up to a maximum.
+
+    @param[in]
+        pConn
+            pointer to the connection
+
+    @param[in]
+        now
+            current monotonic time in milliseconds
+
+==============================================================================*/
+static void Disconnect( NetConn *pConn, uint64_t now )
+{
+    if ( pConn->fd != -1 )
+    {
+        close( pConn->fd );
+        pConn->fd = -1;
+    }
+
+    if ( ( pConn->first < pConn->n ) &&
+         ( pConn->sent > MessageStart( pConn, pConn->first ) ) )
+    {
+        /* the peer cannot use the rest of a partly sent message */
+        pConn->sent = pConn->pEnds[pConn->first];
+        pConn->first++;
+    }
+
+    pConn->state = NETCONN_IDLE;
+    pConn->retryAt = now + pConn->backoff;
+
+    pConn->backoff *= 2;
+    if ( pConn->backoff > NETCONN_BACKOFF_MAX )
+    {
+        pConn->backoff = NETCONN_BACKOFF_MAX;
+    }
+}
+
+/*============================================================================*/
+/*  SendStream                                                                */
+/*!
+    Send the queued messages on a TCP connection
+
+    The SendStream function sends the unsent part of the queue with as
+    few send calls as possible.  Sending stops when the socket buffer
+    is full, and the rest of the queue is sent by the next flush.  If
+    the connection has failed it is closed and re-established later.
+
+    @param[in]
+        pConn
+            pointer to the connection
+
+    @param[in]
+        now
+            current monotonic time in milliseconds
+
+    @retval EOK the queue was sent, or the rest of it was kept for later
+    @retval other error from send()
+
+==============================================================================*/
+static int SendStream( NetConn *pConn, uint64_t now )
+{
+    int result = EOK;
+    ssize_t n;
+
+    while ( pConn->sent < pConn->queue.len )
+    {
+        n = send( pConn->fd,
+                  &pConn->queue.pData[pConn->sent],
+                  pConn->queue.len - pConn->sent,
+                  MSG_NOSIGNAL );
+        if ( n > 0 )
+        {
+            pConn->sent += n;
+        }
+        else if ( ( n < 0 ) && ( errno == EINTR ) )
+        {
+            /* try again */
+        }
+        else if ( ( n < 0 ) &&
+                  ( ( errno == EAGAIN ) || ( errno == EWOULDBLOCK ) ) )
+        {
+            /* the socket buffer is full */
+            break;
+        }
+        else
+        {
+            result = ( n < 0 ) ? errno : EIO;
+            Advance( pConn );
+            Disconnect( pConn, now );
+            break;
+        }
+    }
+
+    Advance( pConn );
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SendDatagrams                                                             */
+/*!
+    Send the queued messages as UDP datagrams
+
+    The SendDatagrams function sends each queued message as one
+    datagram, passing up to NETCONN_MMSG datagrams to each sendmmsg
+    call.  If the datagrams cannot be sent the rest of the queue is
+    discarded.
+
+    @param[in]
+        pConn
+            pointer to the connection
+
+    @retval EOK the queued messages were sent
+    @retval other error from sendmmsg()
+
+==============================================================================*/
+static int SendDatagrams( NetConn *pConn )
+{
+    int result = EOK;
+    struct mmsghdr msgs[NETCONN_MMSG];
+    struct iovec iov[NETCONN_MMSG];
+    size_t start;
+    size_t count;
+    size_t i;
+    int n;
+
+    while ( ( result == EOK ) &&
+            ( pConn->first < pConn->n ) )
+    {
+        count = pConn->n - pConn->first;
+        if ( count > NETCONN_MMSG )
+        {
+            count = NETCONN_MMSG;
+        }
+
+        memset( msgs, 0, count * sizeof( struct mmsghdr ) );
+        for ( i = 0; i < count; i++ )
+        {
+            start = MessageStart( pConn, pConn->first + i );
+            iov[i].iov_base = &pConn->queue.pData[start];
+            iov[i].iov_len = pConn->pEnds[pConn->first + i] - start;
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        n = sendmmsg( pConn->fd, msgs, count, MSG_NOSIGNAL );
+        if ( n > 0 )
+        {
+            pConn->first += n;
+            pConn->sent = pConn->pEnds[pConn->first - 1];
+        }
+        else if ( ( n < 0 ) && ( errno == EINTR ) )
+        {
+            /* try again */
+        }
+        else
+        {
+            /* datagrams are not retried */
+            result = ( n < 0 ) ? errno : EIO;
+            pConn->first = pConn->n;
+            pConn->sent = pConn->queue.len;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  Advance                                                                   */
+/*!
+    Skip the queued messages which have been sent completely
+
+    @param[in]
+        pConn
+            pointer to the connection
+
+==============================================================================*/
+static void Advance( NetConn *pConn )
+{
+    while ( ( pConn->first < pConn->n ) &&
+            ( pConn->pEnds[pConn->first] <= pConn->sent ) )
+    {
+        pConn->first++;
+    }
+}
+
+/*============================================================================*/
+/*  Compact                                                                   */
+/*!
+    Remove the sent messages from the queue
+
+    The Compact function moves the messages which have not been sent
+    completely to the start of the queue.
+
+    @param[in]
+        pConn
+            pointer to the connection
+
+==============================================================================*/
+static void Compact( NetConn *pConn )
+{
+    size_t base;
+    size_t i;
+
+    if ( pConn->first == pConn->n )
+    {
+        MSGBUF_Reset( &pConn->queue );
+        pConn->n = 0;
+        pConn->first = 0;
+        pConn->sent = 0;
+    }
+    else if ( pConn->first > 0 )
+    {
+        base = pConn->pEnds[pConn->first - 1];
+        memmove( pConn->queue.pData,
+                 &pConn->queue.pData[base],
+                 pConn->queue.len - base );
+        pConn->queue.len -= base;
+        pConn->sent -= base;
+
+        for ( i = pConn->first; i < pConn->n; i++ )
+        {
+            pConn->pEnds[i - pConn->first] = pConn->pEnds[i] - base;
+        }
+
+        pConn->n -= pConn->first;
+        pConn->first = 0;
+    }
+}
+
+/*============================================================================*/
+/*  MessageStart                                                              */
+/*!
+    Get the offset of a queued message in the queue
+
+    @param[in]
+        pConn
+            pointer to the connection
+
+    @param[in]
+        idx
+            index of the queued message
+
+    @retval offset of the start of the message
+
+==============================================================================*/
+static size_t MessageStart( NetConn *pConn, size_t idx )
+{
+    return ( idx > 0 ) ? pConn->pEnds[idx - 1] : 0;
+}
+
+/*============================================================================*/
+/*  Now                                                                       */
+/*!
+    Get the monotonic clock time in milliseconds
+
+    @retval the current monotonic clock time in milliseconds
+
+==============================================================================*/
+static uint64_t Now( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( (uint64_t)ts.tv_sec * 1000 ) + ( ts.tv_nsec / 1000000 );
+}
+
+/*! @}
+ * end of netconn group */
@@ -0,0 +1,352 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup numfmt Number Formatting
+ * @brief Fast conversion of numeric values to ASCII text
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file numfmt.c
+
+    Number Formatting
+
+    The Number Formatting functions convert integer and floating point
+    values to their decimal text representation without going through
+    the printf machinery.  Integers are converted two digits at a time
+    using a lookup table.
+
+    The output of each function is identical to the corresponding
+    printf conversion ( %llu, %lld and %f ) so numbers formatted here
+    are indistinguishable from numbers printed by the variable server.
+
+    Each function writes a NUL terminated string to the output buffer,
+    which must be at least NUMFMT_MAX_LEN bytes long, and returns the
+    length of the string, not including the NUL terminator.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "numfmt.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! number of fractional digits output for a floating point value.
+    This matches the default precision of the %f conversion */
+#define NUMFMT_FLOAT_PRECISION  ( 6 )
+
+/*! scale factor for the fractional part of a floating point value */
+#define NUMFMT_FLOAT_SCALE      ( 1000000.0 )
+
+/*! magnitude above which floating point values are handed to snprintf */
+#define NUMFMT_FLOAT_MAX        ( 1.0e15 )
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! lookup table of all two digit decimal numbers */
+static const char digitPairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static size_t CountDigits( uint64_t value );
+static void WriteDigits( char *end, uint64_t value );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  NUMFMT_U64                                                                */
+/*!
+    Format an unsigned integer
+
+    The NUMFMT_U64 function writes the decimal representation of an
+    unsigned 64 bit integer to the output buffer.
+
+    @param[in,out]
+        buf
+            pointer to an output buffer of at least NUMFMT_MAX_LEN bytes
+
+    @param[in]
+        value
+            value to format
+
+    @retval length of the formatted string
+
+==============================================================================*/
+size_t NUMFMT_U64( char *buf, uint64_t value )
+{
+    size_t len = 0;
+
+    if ( buf != NULL )
+    {
+        len = CountDigits( value );
+        WriteDigits( &buf[len], value );
+        buf[len] = '\0';
+    }
+
+    return len;
+}
+
+/*============================================================================*/
+/*  NUMFMT_I64                                                                */
+/*!
+    Format a signed integer
+
+    The NUMFMT_I64 function writes the decimal representation of a
+    signed 64 bit integer to the output buffer.
+
+    @param[in,out]
+        buf
+            pointer to an output buffer of at least NUMFMT_MAX_LEN bytes
+
+    @param[in]
+        value
+            value to format
+
+    @retval length of the formatted string
+
+==============================================================================*/
+size_t NUMFMT_I64( char *buf, int64_t value )
+{
+    size_t len = 0;
+    uint64_t magnitude;
+
+    if ( buf != NULL )
+    {
+        if ( value < 0 )
+        {
+            /* negate as unsigned so INT64_MIN is handled correctly */
+            magnitude = ( ~(uint64_t)value ) + 1;
+            buf[0] = '-';
+            len = 1 + NUMFMT_U64( &buf[1], magnitude );
+        }
+        else
+        {
+            len = NUMFMT_U64( buf, (uint64_t)value );
+        }
+    }
+
+    return len;
+}
+
+/*============================================================================*/
+/*  NUMFMT_Float                                                              */
+/*!
+    Format a floating point value
+
+    The NUMFMT_Float function writes the decimal representation of a
+    single precision floating point value to the output buffer using
+    six fractional digits, in the same way as the %f printf conversion.
+
+    A float has at most 24 significant bits, so scaling its fractional
+    part by 10^6 is exact in double precision.  This allows the
+    fraction to be rounded (half to even, as printf does) without any
+    loss of accuracy.  Non-finite and very large values are passed
+    to snprintf.
+
+    @param[in,out]
+        buf
+            pointer to an output buffer of at least NUMFMT_MAX_LEN bytes
+
+    @param[in]
+        value
+            value to format
+
+    @retval length of the formatted string
+
+==============================================================================*/
+size_t NUMFMT_Float( char *buf, float value )
+{
+    size_t len = 0;
+    double d = value;
+    double scaled;
+    double rem;
+    uint64_t ipart;
+    uint64_t fpart;
+    int n;
+
+    if ( buf == NULL )
+    {
+        return 0;
+    }
+
+    if ( ( isfinite( d ) == 0 ) ||
+         ( fabs( d ) >= NUMFMT_FLOAT_MAX ) )
+    {
+        n = snprintf( buf, NUMFMT_MAX_LEN, "%f", d );
+        return ( n > 0 ) ? (size_t)n : 0;
+    }
+
+    if ( signbit( d ) )
+    {
+        buf[len++] = '-';
+        d = -d;
+    }
+
+    /* split into integer and fractional parts */
+    ipart = (uint64_t)d;
+    scaled = ( d - (double)ipart ) * NUMFMT_FLOAT_SCALE;
+    fpart = (uint64_t)scaled;
+    rem = scaled - (double)fpart;
+
+    /* round half to even */
+    if ( ( rem > 0.5 ) ||
+         ( ( rem == 0.5 ) && ( fpart & 1 ) ) )
+    {
+        fpart++;
+        if ( fpart == (uint64_t)NUMFMT_FLOAT_SCALE )
+        {
+            fpart = 0;
+            ipart++;
+        }
+    }
+
+    len += NUMFMT_U64( &buf[len], ipart );
+    buf[len++] = '.';
+
+    /* the fractional part is zero padded to the full precision */
+    WriteDigits( &buf[len + NUMFMT_FLOAT_PRECISION], fpart );
+    n = NUMFMT_FLOAT_PRECISION - (int)CountDigits( fpart );
+    if ( n > 0 )
+    {
+        memset( &buf[len], '0', n );
+    }
+
+    len += NUMFMT_FLOAT_PRECISION;
+    buf[len] = '\0';
+
+    return len;
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  CountDigits                                                               */
+/*!
+    Count the decimal digits in a value
+
+    @param[in]
+        value
+            value to count the digits of
+
+    @retval number of decimal digits required to represent the value
+
+==============================================================================*/
+static size_t CountDigits( uint64_t value )
+{
+    size_t n = 1;
+
+    while ( value >= 10000 )
+    {
+        value /= 10000;
+        n += 4;
+    }
+
+    if ( value >= 1000 )
+    {
+        n += 3;
+    }
+    else if ( value >= 100 )
+    {
+        n += 2;
+    }
+    else if ( value >= 10 )
+    {
+        n += 1;
+    }
+
+    return n;
+}
+
+/*============================================================================*/
+/*  WriteDigits                                                               */
+/*!
+    Write the decimal digits of a value backwards from a buffer position
+
+    The WriteDigits function writes the digits of the value into the
+    bytes immediately preceding the end pointer, two digits at a time.
+
+    @param[in]
+        end
+            pointer to the byte following the last digit
+
+    @param[in]
+        value
+            value to write
+
+==============================================================================*/
+static void WriteDigits( char *end, uint64_t value )
+{
+    unsigned int i;
+
+    while ( value >= 100 )
+    {
+        i = (unsigned int)( value % 100 ) * 2;
+        value /= 100;
+        *--end = digitPairs[i + 1];
+        *--end = digitPairs[i];
+    }
+
+    if ( value >= 10 )
+    {
+        i = (unsigned int)value * 2;
+        *--end = digitPairs[i + 1];
+        *--end = digitPairs[i];
+    }
+    else
+    {
+        *--end = (char)( '0' + value );
+    }
+}
+
+/*! @}
+ * end of numfmt group */
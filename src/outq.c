@@ -0,0 +1,574 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup outq Output Queue
+ * @brief Asynchronous output of finished messages
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file outq.c
+
+    Output Queue
+
+    The Output Queue decouples message rendering from sink I/O.  Render
+    threads copy each finished message into a queue item and push it onto
+    a bounded lock-free ring, and a dedicated writer thread pops the items
+    and writes them to their sinks.  The writer flushes the sinks whenever
+    the queue becomes empty.
+
+    Two semaphores count the free and filled slots in the ring, so the
+    writer sleeps while the queue is empty, and a render thread can wait
+    for room when the queue is full.  What happens when the queue is full
+    is set by the queue policy:
+
+    - block : wait for the writer to make room
+    - drop-oldest : discard the oldest queued message
+    - drop-newest : discard the message being written
+
+    Every discarded message increments the dropped counter supplied
+    with it.  A message which the writer fails to write to its sink is
+    counted as dropped too.
+
+    OUTQ_Sync queues a marker item with no sink and waits for the writer
+    to reach it, so a sink can be closed once every message queued for
+    it has been written.  A sync marker is never discarded by the
+    drop-oldest policy.  A producer which finds a marker at the head of
+    a full queue puts the marker back and discards its own message
+    instead.  Producers discard the oldest message while holding the
+    drop lock, and the writer takes the drop lock when it reaches a
+    marker, so a message taken from the queue ahead of the marker has
+    been counted before the thread waiting for the marker is released.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <sched.h>
+#include "outq.h"
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static void *Writer( void *arg );
+static OutQItem *PopItem( OutQ *pOutQ );
+static void DropItem( OutQItem *pItem );
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! names of the queue policies.  These must be in the same order
+    as the OutQPolicy enumeration */
+static const char *policies[] = {
+    "block",
+    "drop-oldest",
+    "drop-newest"
+};
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  OUTQ_Create                                                               */
+/*!
+    Create an output queue
+
+    The OUTQ_Create function creates an output queue and starts its
+    writer thread.  The writer is started with all asynchronous signals
+    blocked so signals continue to be received by the main thread.
+
+    @param[in]
+        depth
+            maximum number of messages in the queue
+
+    @param[in]
+        policy
+            policy applied when a message is written to a full queue
+
+    @retval pointer to the new output queue
+    @retval NULL if the output queue could not be created
+
+==============================================================================*/
+OutQ *OUTQ_Create( size_t depth, OutQPolicy policy )
+{
+    OutQ *pOutQ = NULL;
+    sigset_t mask;
+    sigset_t oldmask;
+    int rc;
+
+    if ( depth > 0 )
+    {
+        pOutQ = calloc( 1, sizeof( OutQ ) );
+    }
+
+    if ( pOutQ != NULL )
+    {
+        pOutQ->policy = policy;
+
+        rc = RING_Init( &pOutQ->ring, depth );
+        if ( rc == EOK )
+        {
+            /* the ring may have been rounded up, but only depth
+               slots are used */
+            sem_init( &pOutQ->slots, 0, depth );
+            sem_init( &pOutQ->items, 0, 0 );
+            sem_init( &pOutQ->synced, 0, 0 );
+            pthread_mutex_init( &pOutQ->dropLock, NULL );
+
+            sigfillset( &mask );
+            sigdelset( &mask, SIGSEGV );
+            sigdelset( &mask, SIGBUS );
+            sigdelset( &mask, SIGFPE );
+            sigdelset( &mask, SIGILL );
+            pthread_sigmask( SIG_BLOCK, &mask, &oldmask );
+
+            rc = pthread_create( &pOutQ->writer, NULL, Writer, pOutQ );
+
+            pthread_sigmask( SIG_SETMASK, &oldmask, NULL );
+
+            if ( rc != EOK )
+            {
+                sem_destroy( &pOutQ->slots );
+                sem_destroy( &pOutQ->items );
+                sem_destroy( &pOutQ->synced );
+                pthread_mutex_destroy( &pOutQ->dropLock );
+                RING_Free( &pOutQ->ring );
+            }
+        }
+
+        if ( rc != EOK )
+        {
+            free( pOutQ );
+            pOutQ = NULL;
+        }
+    }
+
+    return pOutQ;
+}
+
+/*============================================================================*/
+/*  OUTQ_Write                                                                */
+/*!
+    Queue a message to be written to a sink
+
+    The OUTQ_Write function copies a finished message into a queue item
+    and adds it to the output queue.  If the queue is full the queue
+    policy is applied.  A message which is discarded by the policy is
+    counted in its dropped counter and is not an error.
+
+    @param[in]
+        pOutQ
+            pointer to the output queue
+
+    @param[in]
+        pSink
+            pointer to the sink to write the message to
+
+    @param[in]
+        pData
+            pointer to the message data
+
+    @param[in]
+        len
+            length of the message data
+
+    @param[in]
+        pDropped
+            pointer to the counter to increment if the message is
+            discarded.  The counter is updated atomically.
+
+    @retval EOK the message was queued or discarded by the queue policy
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int OUTQ_Write( OutQ *pOutQ,
+                MsgSink *pSink,
+                const char *pData,
+                size_t len,
+                uint32_t *pDropped )
+{
+    int result = EINVAL;
+    OutQItem *pItem;
+    OutQItem *pOldest;
+    bool room = false;
+
+    if ( ( pOutQ != NULL ) &&
+         ( pSink != NULL ) &&
+         ( pData != NULL ) &&
+         ( pDropped != NULL ) )
+    {
+        pItem = malloc( sizeof( OutQItem ) + len );
+        if ( pItem != NULL )
+        {
+            pItem->pSink = pSink;
+            pItem->pDropped = pDropped;
+            pItem->len = len;
+            memcpy( pItem->data, pData, len );
+            result = EOK;
+
+            while ( room == false )
+            {
+                if ( sem_trywait( &pOutQ->slots ) == 0 )
+                {
+                    room = true;
+                }
+                else if ( pOutQ->policy == OUTQ_POLICY_DROP_NEWEST )
+                {
+                    DropItem( pItem );
+                    break;
+                }
+                else if ( pOutQ->policy == OUTQ_POLICY_DROP_OLDEST )
+                {
+                    /* hold off a sync until the oldest message has
+                       been counted */
+                    pthread_mutex_lock( &pOutQ->dropLock );
+
+                    if ( sem_trywait( &pOutQ->items ) == 0 )
+                    {
+                        pOldest = PopItem( pOutQ );
+                        if ( pOldest->pSink == NULL )
+                        {
+                            /* a sync marker must reach the writer, so it
+                               is put back and the new message is
+                               discarded instead */
+                            while ( RING_Push( &pOutQ->ring,
+                                               pOldest ) == false )
+                            {
+                                sched_yield();
+                            }
+
+                            sem_post( &pOutQ->items );
+                            DropItem( pItem );
+                            pItem = NULL;
+                        }
+                        else
+                        {
+                            /* take over the slot of the oldest message */
+                            DropItem( pOldest );
+                            room = true;
+                        }
+                    }
+
+                    pthread_mutex_unlock( &pOutQ->dropLock );
+
+                    if ( pItem == NULL )
+                    {
+                        break;
+                    }
+                    else if ( room == false )
+                    {
+                        /* the writer is between taking an item and
+                           releasing its slot */
+                        sched_yield();
+                    }
+                }
+                else if ( sem_wait( &pOutQ->slots ) == 0 )
+                {
+                    room = true;
+                }
+            }
+
+            if ( room == true )
+            {
+                /* a slot is reserved, so the push cannot fail for long */
+                while ( RING_Push( &pOutQ->ring, pItem ) == false )
+                {
+                    sched_yield();
+                }
+
+                sem_post( &pOutQ->items );
+            }
+        }
+        else
+        {
+            result = ENOMEM;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  OUTQ_Sync                                                                 */
+/*!
+    Wait for the queued messages to be written
+
+    The OUTQ_Sync function queues a sync marker and waits for the writer
+    to reach it, so every message which was queued before the call has
+    been written to its sink or discarded when it returns.  This is used
+    before a sink or a dropped counter which may be referred to by a
+    queued message is released.  The marker waits for room in the queue
+    regardless of the queue policy.
+
+    @param[in]
+        pOutQ
+            pointer to the output queue
+
+    @retval EOK the queued messages have been written
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int OUTQ_Sync( OutQ *pOutQ )
+{
+    int result = EINVAL;
+    OutQItem *pItem;
+
+    if ( pOutQ != NULL )
+    {
+        /* the sync marker is an item without a sink */
+        pItem = calloc( 1, sizeof( OutQItem ) );
+        if ( pItem != NULL )
+        {
+            while ( sem_wait( &pOutQ->slots ) != 0 )
+            {
+                /* interrupted, try again */
+            }
+
+            while ( RING_Push( &pOutQ->ring, pItem ) == false )
+            {
+                sched_yield();
+            }
+
+            sem_post( &pOutQ->items );
+
+            while ( sem_wait( &pOutQ->synced ) != 0 )
+            {
+                /* interrupted, try again */
+            }
+
+            result = EOK;
+        }
+        else
+        {
+            result = ENOMEM;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  OUTQ_Depth                                                                */
+/*!
+    Get the number of messages waiting in the output queue
+
+    @param[in]
+        pOutQ
+            pointer to the output queue
+
+    @retval number of messages waiting in the output queue
+
+==============================================================================*/
+size_t OUTQ_Depth( OutQ *pOutQ )
+{
+    size_t depth = 0;
+
+    if ( pOutQ != NULL )
+    {
+        depth = RING_Size( &pOutQ->ring );
+    }
+
+    return depth;
+}
+
+/*============================================================================*/
+/*  OUTQ_ParsePolicy                                                          */
+/*!
+    Convert a policy name to an output queue policy
+
+    @param[in]
+        name
+            name of the policy: block, drop-oldest or drop-newest
+
+    @param[out]
+        pPolicy
+            pointer to the location to store the policy
+
+    @retval EOK the policy was converted
+    @retval ENOENT unknown policy name
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int OUTQ_ParsePolicy( const char *name, OutQPolicy *pPolicy )
+{
+    int result = EINVAL;
+    size_t n = sizeof( policies ) / sizeof( policies[0] );
+    size_t i;
+
+    if ( ( name != NULL ) &&
+         ( pPolicy != NULL ) )
+    {
+        result = ENOENT;
+
+        for ( i = 0; i < n; i++ )
+        {
+            if ( strcmp( name, policies[i] ) == 0 )
+            {
+                *pPolicy = (OutQPolicy)i;
+                result = EOK;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  Writer                                                                    */
+/*!
+    Output queue writer thread
+
+    The Writer function writes the queued messages to their sinks in
+    the order they were queued.  When the queue is empty the sinks are
+    flushed before the writer waits for more messages.
+
+    @param[in]
+        arg
+            pointer to the output queue
+
+    @retval NULL
+
+==============================================================================*/
+static void *Writer( void *arg )
+{
+    OutQ *pOutQ = (OutQ *)arg;
+    OutQItem *pItem;
+    int rc;
+
+    while ( 1 )
+    {
+        if ( sem_trywait( &pOutQ->items ) != 0 )
+        {
+            /* send the batched output before going idle */
+            SINK_FlushAll();
+
+            while ( sem_wait( &pOutQ->items ) != 0 )
+            {
+                /* interrupted, try again */
+            }
+        }
+
+        pItem = PopItem( pOutQ );
+        sem_post( &pOutQ->slots );
+
+        if ( pItem->pSink == NULL )
+        {
+            /* every message queued before the sync marker has been
+               written, or is being discarded by a producer which took
+               it from the queue, so wait for that producer */
+            pthread_mutex_lock( &pOutQ->dropLock );
+            pthread_mutex_unlock( &pOutQ->dropLock );
+
+            sem_post( &pOutQ->synced );
+            free( pItem );
+        }
+        else
+        {
+            rc = SINK_Write( pItem->pSink, pItem->data, pItem->len );
+            if ( rc == EOK )
+            {
+                free( pItem );
+            }
+            else
+            {
+                DropItem( pItem );
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/*============================================================================*/
+/*  PopItem                                                                   */
+/*!
+    Remove the oldest item from the output queue
+
+    The PopItem function must only be called after an item has been
+    claimed by decrementing the items semaphore.  A producer may have
+    reserved the oldest slot without filling it yet, so the ring is
+    retried until the item appears.
+
+    @param[in]
+        pOutQ
+            pointer to the output queue
+
+    @retval pointer to the removed item
+
+==============================================================================*/
+static OutQItem *PopItem( OutQ *pOutQ )
+{
+    void *pData = NULL;
+
+    while ( RING_Pop( &pOutQ->ring, &pData ) == false )
+    {
+        sched_yield();
+    }
+
+    return (OutQItem *)pData;
+}
+
+/*============================================================================*/
+/*  DropItem                                                                  */
+/*!
+    Discard an output queue item
+
+    The DropItem function counts a discarded message in its dropped
+    counter and releases it.  Sync markers are never discarded.
+
+    @param[in]
+        pItem
+            pointer to the item to discard
+
+==============================================================================*/
+static void DropItem( OutQItem *pItem )
+{
+    if ( pItem != NULL )
+    {
+        __atomic_add_fetch( pItem->pDropped, 1, __ATOMIC_RELAXED );
+        free( pItem );
+    }
+}
+
+/*! @}
+ * end of outq group */
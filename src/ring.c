@@ -0,0 +1,295 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup ring Ring
+ * @brief Bounded lock-free multi-producer multi-consumer queue
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file ring.c
+
+    Ring
+
+    The Ring is a bounded queue of pointers which may be used by any
+    number of producer and consumer threads without locks.  Each slot
+    has a sequence number which tells a producer when the slot is free
+    and a consumer when the slot has been filled.  Producers and
+    consumers claim slots by advancing the enqueue and dequeue positions
+    with a compare and swap.
+
+    The ring never blocks.  RING_Push fails if the ring is full and
+    RING_Pop fails if it is empty, so callers which need to wait must
+    provide their own signalling.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include "ring.h"
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  RING_Init                                                                 */
+/*!
+    Initialize a ring
+
+    The RING_Init function allocates the slots for an empty ring.
+
+    @param[in]
+        pRing
+            pointer to the ring to initialize
+
+    @param[in]
+        size
+            number of slots in the ring.  This is rounded up to a
+            power of two.
+
+    @retval EOK the ring was initialized
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int RING_Init( Ring *pRing, size_t size )
+{
+    int result = EINVAL;
+    size_t n = 2;
+    size_t i;
+
+    if ( ( pRing != NULL ) &&
+         ( size > 0 ) &&
+         ( size <= ( SIZE_MAX / 2 ) ) )
+    {
+        while ( n < size )
+        {
+            n <<= 1;
+        }
+
+        pRing->pCells = malloc( n * sizeof( RingCell ) );
+        if ( pRing->pCells != NULL )
+        {
+            for ( i = 0; i < n; i++ )
+            {
+                pRing->pCells[i].seq = i;
+                pRing->pCells[i].pData = NULL;
+            }
+
+            pRing->mask = n - 1;
+            pRing->head = 0;
+            pRing->tail = 0;
+            result = EOK;
+        }
+        else
+        {
+            result = ENOMEM;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RING_Push                                                                 */
+/*!
+    Add a pointer to the ring
+
+    @param[in]
+        pRing
+            pointer to the ring
+
+    @param[in]
+        pData
+            pointer to add to the ring
+
+    @retval true the pointer was added
+    @retval false the ring is full
+
+==============================================================================*/
+bool RING_Push( Ring *pRing, void *pData )
+{
+    bool result = false;
+    RingCell *pCell;
+    size_t pos;
+    size_t seq;
+    intptr_t diff;
+
+    pos = __atomic_load_n( &pRing->head, __ATOMIC_RELAXED );
+    while ( 1 )
+    {
+        pCell = &pRing->pCells[pos & pRing->mask];
+        seq = __atomic_load_n( &pCell->seq, __ATOMIC_ACQUIRE );
+        diff = (intptr_t)seq - (intptr_t)pos;
+
+        if ( diff == 0 )
+        {
+            /* the slot is free, so try to claim it */
+            if ( __atomic_compare_exchange_n( &pRing->head,
+                                              &pos,
+                                              pos + 1,
+                                              true,
+                                              __ATOMIC_RELAXED,
+                                              __ATOMIC_RELAXED ) )
+            {
+                pCell->pData = pData;
+                __atomic_store_n( &pCell->seq, pos + 1, __ATOMIC_RELEASE );
+                result = true;
+                break;
+            }
+        }
+        else if ( diff < 0 )
+        {
+            /* the slot has not been consumed yet, so the ring is full */
+            break;
+        }
+        else
+        {
+            /* another producer claimed the slot */
+            pos = __atomic_load_n( &pRing->head, __ATOMIC_RELAXED );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RING_Pop                                                                  */
+/*!
+    Remove the oldest pointer from the ring
+
+    @param[in]
+        pRing
+            pointer to the ring
+
+    @param[out]
+        ppData
+            pointer to the location to store the removed pointer
+
+    @retval true a pointer was removed
+    @retval false the ring is empty
+
+==============================================================================*/
+bool RING_Pop( Ring *pRing, void **ppData )
+{
+    bool result = false;
+    RingCell *pCell;
+    size_t pos;
+    size_t seq;
+    intptr_t diff;
+
+    pos = __atomic_load_n( &pRing->tail, __ATOMIC_RELAXED );
+    while ( 1 )
+    {
+        pCell = &pRing->pCells[pos & pRing->mask];
+        seq = __atomic_load_n( &pCell->seq, __ATOMIC_ACQUIRE );
+        diff = (intptr_t)seq - (intptr_t)( pos + 1 );
+
+        if ( diff == 0 )
+        {
+            /* the slot is filled, so try to claim it */
+            if ( __atomic_compare_exchange_n( &pRing->tail,
+                                              &pos,
+                                              pos + 1,
+                                              true,
+                                              __ATOMIC_RELAXED,
+                                              __ATOMIC_RELAXED ) )
+            {
+                *ppData = pCell->pData;
+                __atomic_store_n( &pCell->seq,
+                                  pos + pRing->mask + 1,
+                                  __ATOMIC_RELEASE );
+                result = true;
+                break;
+            }
+        }
+        else if ( diff < 0 )
+        {
+            /* the slot has not been filled yet, so the ring is empty */
+            break;
+        }
+        else
+        {
+            /* another consumer claimed the slot */
+            pos = __atomic_load_n( &pRing->tail, __ATOMIC_RELAXED );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RING_Size                                                                 */
+/*!
+    Get the approximate number of pointers in the ring
+
+    The value returned may be out of date by the time it is used if
+    other threads are using the ring.
+
+    @param[in]
+        pRing
+            pointer to the ring
+
+    @retval number of pointers in the ring
+
+==============================================================================*/
+size_t RING_Size( Ring *pRing )
+{
+    size_t head = __atomic_load_n( &pRing->head, __ATOMIC_RELAXED );
+    size_t tail = __atomic_load_n( &pRing->tail, __ATOMIC_RELAXED );
+
+    return ( head > tail ) ? ( head - tail ) : 0;
+}
+
+/*============================================================================*/
+/*  RING_Free                                                                 */
+/*!
+    Release the storage used by a ring
+
+    @param[in]
+        pRing
+            pointer to the ring to free
+
+==============================================================================*/
+void RING_Free( Ring *pRing )
+{
+    if ( pRing != NULL )
+    {
+        free( pRing->pCells );
+        pRing->pCells = NULL;
+        pRing->mask = 0;
+    }
+}
+
+/*! @}
+ * end of ring group */
@@ -0,0 +1,486 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup sched Scheduler
+ * @brief Min-heap of timed events
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file schedule.c
+
+    Scheduler
+
+    The Scheduler keeps a set of timed events in a binary min-heap
+    ordered by their due time, so the next event to expire is always
+    available without searching.  Inserting, rescheduling and removing
+    an event are O(log n) operations.
+
+    The scheduler does not interpret the due times.  The caller decides
+    on the clock and the units, and is responsible for arranging to be
+    woken up when the item at the top of the heap is due.
+
+    Each event is a SchedItem embedded in the object which owns it.
+    The item records its own heap position so it can be rescheduled
+    or removed directly.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdlib.h>
+#include <errno.h>
+#include "schedule.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! default initial number of heap entries */
+#define SCHED_SIZE_DEFAULT      ( 64 )
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static void SiftUp( Sched *pSched, size_t pos );
+static void SiftDown( Sched *pSched, size_t pos );
+static void Place( Sched *pSched, SchedItem *pItem, size_t pos );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  SCHED_Init                                                                */
+/*!
+    Initialize a scheduler
+
+    The SCHED_Init function allocates the heap for an empty scheduler.
+    The heap grows as required when items are inserted.
+
+    @param[in]
+        pSched
+            pointer to the scheduler to initialize
+
+    @param[in]
+        size
+            initial number of heap entries.  If zero is specified
+            a default size is used.
+
+    @retval EOK the scheduler was initialized
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int SCHED_Init( Sched *pSched, size_t size )
+{
+    int result = EINVAL;
+
+    if ( pSched != NULL )
+    {
+        if ( size == 0 )
+        {
+            size = SCHED_SIZE_DEFAULT;
+        }
+
+        pSched->n = 0;
+        pSched->ppHeap = malloc( size * sizeof( SchedItem * ) );
+        if ( pSched->ppHeap != NULL )
+        {
+            pSched->size = size;
+            result = EOK;
+        }
+        else
+        {
+            pSched->size = 0;
+            result = ENOMEM;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SCHED_InitItem                                                            */
+/*!
+    Initialize a scheduler item
+
+    @param[in]
+        pItem
+            pointer to the item to initialize
+
+    @param[in]
+        type
+            type of the event, for use by the owner
+
+    @param[in]
+        pData
+            pointer to the object which owns the event
+
+==============================================================================*/
+void SCHED_InitItem( SchedItem *pItem, uint32_t type, void *pData )
+{
+    if ( pItem != NULL )
+    {
+        pItem->due = 0;
+        pItem->type = type;
+        pItem->pData = pData;
+        pItem->pos = SCHED_NONE;
+    }
+}
+
+/*============================================================================*/
+/*  SCHED_Insert                                                              */
+/*!
+    Schedule an item
+
+    The SCHED_Insert function schedules an item at the specified time.
+    If the item is already scheduled it is moved to its new time.
+
+    @param[in]
+        pSched
+            pointer to the scheduler
+
+    @param[in]
+        pItem
+            pointer to the item to schedule
+
+    @param[in]
+        due
+            time the item is due
+
+    @retval EOK the item was scheduled
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int SCHED_Insert( Sched *pSched, SchedItem *pItem, uint64_t due )
+{
+    int result = EINVAL;
+    SchedItem **ppHeap;
+    size_t size;
+    uint64_t old;
+
+    if ( ( pSched != NULL ) &&
+         ( pItem != NULL ) )
+    {
+        result = EOK;
+
+        if ( pItem->pos != SCHED_NONE )
+        {
+            /* move an existing item */
+            old = pItem->due;
+            pItem->due = due;
+            if ( due < old )
+            {
+                SiftUp( pSched, pItem->pos );
+            }
+            else
+            {
+                SiftDown( pSched, pItem->pos );
+            }
+        }
+        else
+        {
+            if ( pSched->n == pSched->size )
+            {
+                size = ( pSched->size > 0 ) ? pSched->size * 2
+                                            : SCHED_SIZE_DEFAULT;
+                ppHeap = realloc( pSched->ppHeap,
+                                  size * sizeof( SchedItem * ) );
+                if ( ppHeap != NULL )
+                {
+                    pSched->ppHeap = ppHeap;
+                    pSched->size = size;
+                }
+                else
+                {
+                    result = ENOMEM;
+                }
+            }
+
+            if ( result == EOK )
+            {
+                pItem->due = due;
+                Place( pSched, pItem, pSched->n++ );
+                SiftUp( pSched, pItem->pos );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SCHED_Remove                                                              */
+/*!
+    Remove an item from the scheduler
+
+    @param[in]
+        pSched
+            pointer to the scheduler
+
+    @param[in]
+        pItem
+            pointer to the item to remove
+
+    @retval EOK the item was removed
+    @retval ENOENT the item was not scheduled
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int SCHED_Remove( Sched *pSched, SchedItem *pItem )
+{
+    int result = EINVAL;
+    SchedItem *pLast;
+    size_t pos;
+
+    if ( ( pSched != NULL ) &&
+         ( pItem != NULL ) )
+    {
+        pos = pItem->pos;
+        if ( ( pos != SCHED_NONE ) &&
+             ( pos < pSched->n ) &&
+             ( pSched->ppHeap[pos] == pItem ) )
+        {
+            pItem->pos = SCHED_NONE;
+            pSched->n--;
+
+            if ( pos != pSched->n )
+            {
+                /* fill the hole with the last item */
+                pLast = pSched->ppHeap[pSched->n];
+                Place( pSched, pLast, pos );
+                if ( pLast->due < pItem->due )
+                {
+                    SiftUp( pSched, pos );
+                }
+                else
+                {
+                    SiftDown( pSched, pos );
+                }
+            }
+
+            result = EOK;
+        }
+        else
+        {
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SCHED_Top                                                                 */
+/*!
+    Get the next item to become due
+
+    @param[in]
+        pSched
+            pointer to the scheduler
+
+    @retval pointer to the scheduled item with the earliest due time
+    @retval NULL there are no scheduled items
+
+==============================================================================*/
+SchedItem *SCHED_Top( Sched *pSched )
+{
+    SchedItem *pItem = NULL;
+
+    if ( ( pSched != NULL ) &&
+         ( pSched->n > 0 ) )
+    {
+        pItem = pSched->ppHeap[0];
+    }
+
+    return pItem;
+}
+
+/*============================================================================*/
+/*  SCHED_IsScheduled                                                         */
+/*!
+    Check if an item is scheduled
+
+    @param[in]
+        pItem
+            pointer to the item to check
+
+    @retval true the item is scheduled
+    @retval false the item is not scheduled
+
+==============================================================================*/
+bool SCHED_IsScheduled( SchedItem *pItem )
+{
+    return ( ( pItem != NULL ) && ( pItem->pos != SCHED_NONE ) ) ? true
+                                                                  : false;
+}
+
+/*============================================================================*/
+/*  SCHED_Free                                                                */
+/*!
+    Release the storage used by a scheduler
+
+    The SCHED_Free function releases the heap.  Any items which were
+    still scheduled are marked as not scheduled.
+
+    @param[in]
+        pSched
+            pointer to the scheduler to free
+
+==============================================================================*/
+void SCHED_Free( Sched *pSched )
+{
+    size_t i;
+
+    if ( pSched != NULL )
+    {
+        for ( i = 0; i < pSched->n; i++ )
+        {
+            pSched->ppHeap[i]->pos = SCHED_NONE;
+        }
+
+        free( pSched->ppHeap );
+        pSched->ppHeap = NULL;
+        pSched->n = 0;
+        pSched->size = 0;
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  SiftUp                                                                    */
+/*!
+    Move an item towards the top of the heap
+
+    The SiftUp function swaps an item with its parent until the
+    parent is due no later than the item.
+
+    @param[in]
+        pSched
+            pointer to the scheduler
+
+    @param[in]
+        pos
+            heap position of the item to move
+
+==============================================================================*/
+static void SiftUp( Sched *pSched, size_t pos )
+{
+    SchedItem *pItem = pSched->ppHeap[pos];
+    size_t parent;
+
+    while ( pos > 0 )
+    {
+        parent = ( pos - 1 ) / 2;
+        if ( pSched->ppHeap[parent]->due <= pItem->due )
+        {
+            break;
+        }
+
+        Place( pSched, pSched->ppHeap[parent], pos );
+        pos = parent;
+    }
+
+    Place( pSched, pItem, pos );
+}
+
+/*============================================================================*/
+/*  SiftDown                                                                  */
+/*!
+    Move an item towards the bottom of the heap
+
+    The SiftDown function swaps an item with its earliest child until
+    the item is due no later than both of its children.
+
+    @param[in]
+        pSched
+            pointer to the scheduler
+
+    @param[in]
+        pos
+            heap position of the item to move
+
+==============================================================================*/
+static void SiftDown( Sched *pSched, size_t pos )
+{
+    SchedItem *pItem = pSched->ppHeap[pos];
+    size_t child;
+
+    while ( ( child = ( pos * 2 ) + 1 ) < pSched->n )
+    {
+        if ( ( child + 1 < pSched->n ) &&
+             ( pSched->ppHeap[child + 1]->due < pSched->ppHeap[child]->due ) )
+        {
+            child++;
+        }
+
+        if ( pItem->due <= pSched->ppHeap[child]->due )
+        {
+            break;
+        }
+
+        Place( pSched, pSched->ppHeap[child], pos );
+        pos = child;
+    }
+
+    Place( pSched, pItem, pos );
+}
+
+/*============================================================================*/
+/*  Place                                                                     */
+/*!
+    Store an item at a heap position
+
+    @param[in]
+        pSched
+            pointer to the scheduler
+
+    @param[in]
+        pItem
+            pointer to the item to store
+
+    @param[in]
+        pos
+            heap position to store the item at
+
+==============================================================================*/
+static void Place( Sched *pSched, SchedItem *pItem, size_t pos )
+{
+    pSched->ppHeap[pos] = pItem;
+    pItem->pos = pos;
+}
+
+/*! @}
+ * end of sched group */
@@ -0,0 +1,287 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup shed Load Shedding
+ * @brief Priority based message shedding under overload
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file shed.c
+
+    Load Shedding
+
+    The load shedding controller protects the rest of the system when
+    the message generator is overloaded.  The time spent rendering
+    messages is measured over a window of about a second and compared
+    with a render time budget, given in microseconds of render time
+    per second.
+
+    While the budget is exceeded the shed level rises by one step per
+    measurement, up to SHED_LEVEL_MAX.  Once the load has stayed below
+    half of the budget for SHED_RECOVER measurements in a row the shed
+    level drops by one step, so the level does not flap when the load
+    sits close to the budget.
+
+    Each message has a priority from 0 (highest) to
+    SHED_PRIORITY_LOWEST.  Priority 0 messages are never shed.  The
+    other messages are shed once the shed level reaches
+    SHED_LEVEL_MAX + 1 - priority, and every further level doubles the
+    amount they are sampled down by.  At the highest shed level the
+    lowest priority messages only send one message in eight.
+
+    An operator can set the shed level directly, which suspends the
+    automatic control until the override is released.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "shed.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! number of consecutive measurements under half of the budget
+    before the shed level is lowered */
+#define SHED_RECOVER            ( 3 )
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  SHED_Init                                                                 */
+/*!
+    Initialize a load shedding controller
+
+    @param[in]
+        pCtl
+            pointer to the load shedding controller to initialize
+
+    @param[in]
+        budget
+            render time budget in microseconds per second, or zero to
+            only shed messages when an operator sets the shed level
+
+==============================================================================*/
+void SHED_Init( ShedCtl *pCtl, uint32_t budget )
+{
+    if ( pCtl != NULL )
+    {
+        pCtl->budget = budget;
+        pCtl->level = 0;
+        pCtl->override = -1;
+        pCtl->calm = 0;
+        pCtl->load = 0;
+    }
+}
+
+/*============================================================================*/
+/*  SHED_Update                                                               */
+/*!
+    Update the shed level from a render time measurement
+
+    The SHED_Update function compares the render time measured over a
+    window with the budget, and raises or lowers the shed level by at
+    most one step.  The shed level is not changed while it is
+    overridden.
+
+    @param[in]
+        pCtl
+            pointer to the load shedding controller
+
+    @param[in]
+        renderUs
+            total render time in the window in microseconds
+
+    @param[in]
+        elapsedMs
+            length of the window in milliseconds
+
+    @retval true the shed level has changed
+    @retval false the shed level is unchanged
+
+==============================================================================*/
+bool SHED_Update( ShedCtl *pCtl, uint64_t renderUs, uint64_t elapsedMs )
+{
+    bool changed = false;
+
+    if ( ( pCtl != NULL ) &&
+         ( elapsedMs > 0 ) )
+    {
+        pCtl->load = ( renderUs * 1000 ) / elapsedMs;
+
+        if ( ( pCtl->budget == 0 ) ||
+             ( pCtl->override >= 0 ) )
+        {
+            /* the shed level is not controlled automatically */
+        }
+        else if ( pCtl->load > pCtl->budget )
+        {
+            pCtl->calm = 0;
+            if ( pCtl->level < SHED_LEVEL_MAX )
+            {
+                pCtl->level++;
+                changed = true;
+            }
+        }
+        else if ( pCtl->load < ( pCtl->budget / 2 ) )
+        {
+            pCtl->calm++;
+            if ( ( pCtl->calm >= SHED_RECOVER ) &&
+                 ( pCtl->level > 0 ) )
+            {
+                pCtl->level--;
+                pCtl->calm = 0;
+                changed = true;
+            }
+        }
+        else
+        {
+            /* close to the budget, so hold the current level */
+            pCtl->calm = 0;
+        }
+    }
+
+    return changed;
+}
+
+/*============================================================================*/
+/*  SHED_Override                                                             */
+/*!
+    Override the shed level
+
+    The SHED_Override function sets the shed level to the specified
+    level, up to SHED_LEVEL_MAX, and suspends the automatic control.
+    A negative level releases the override.  The automatic control then
+    continues from the overridden level, or the shed level returns to
+    zero if there is no budget.
+
+    @param[in]
+        pCtl
+            pointer to the load shedding controller
+
+    @param[in]
+        level
+            shed level to set, or a negative value to release the
+            override
+
+    @retval true the shed level has changed
+    @retval false the shed level is unchanged
+
+==============================================================================*/
+bool SHED_Override( ShedCtl *pCtl, int32_t level )
+{
+    bool changed = false;
+    uint32_t old;
+
+    if ( pCtl != NULL )
+    {
+        old = pCtl->level;
+        pCtl->calm = 0;
+
+        if ( level < 0 )
+        {
+            pCtl->override = -1;
+            if ( pCtl->budget == 0 )
+            {
+                pCtl->level = 0;
+            }
+        }
+        else
+        {
+            if ( level > SHED_LEVEL_MAX )
+            {
+                level = SHED_LEVEL_MAX;
+            }
+
+            pCtl->override = level;
+            pCtl->level = level;
+        }
+
+        changed = ( pCtl->level != old );
+    }
+
+    return changed;
+}
+
+/*============================================================================*/
+/*  SHED_Factor                                                               */
+/*!
+    Get the sampling factor of a message
+
+    The SHED_Factor function gets the factor by which a message with
+    the specified priority is sampled down at the current shed level.
+
+    @param[in]
+        pCtl
+            pointer to the load shedding controller
+
+    @param[in]
+        priority
+            priority of the message, from 0 (highest) to
+            SHED_PRIORITY_LOWEST.  Lower priorities are treated as
+            SHED_PRIORITY_LOWEST.
+
+    @retval 1 the message is not shed
+    @retval N only one message in N is sent
+
+==============================================================================*/
+uint32_t SHED_Factor( ShedCtl *pCtl, uint32_t priority )
+{
+    uint32_t factor = 1;
+    uint32_t depth;
+
+    if ( ( pCtl != NULL ) &&
+         ( pCtl->level > 0 ) &&
+         ( priority > 0 ) )
+    {
+        if ( priority > SHED_PRIORITY_LOWEST )
+        {
+            priority = SHED_PRIORITY_LOWEST;
+        }
+
+        depth = priority + pCtl->level;
+        if ( depth > SHED_LEVEL_MAX )
+        {
+            factor = 1U << ( depth - SHED_LEVEL_MAX );
+        }
+    }
+
+    return factor;
+}
+
+/*! @}
+ * end of shed group */
@@ -0,0 +1,636 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup shmring Shared Memory Ring
+ * @brief Message ring shared with local consumer processes
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file shmring.c
+
+    Shared Memory Ring
+
+    The Shared Memory Ring is a named POSIX shared memory object which
+    holds a ring of variable length message records.  The layout is
+    described in shmring.h so consumers can map the ring and read
+    messages in place without any system calls on the data path.
+
+    There is a single producer per ring.  The message sink serializes
+    the render threads which write to it, so it behaves as a multiple
+    producer, single consumer ring.  Each record is written into the
+    ring and then published by advancing the head position with release
+    semantics.  The consumer reads records up to the head position and
+    then advances the tail position to return the space to the producer.
+
+    If there is not enough free space for a message, the message is
+    dropped and counted in the ring header, so a slow or absent consumer
+    never blocks the producer.
+
+    When records have been published the producer increments the
+    doorbell futex word.  It only makes the wake up system call when a
+    consumer has said it is sleeping on the doorbell.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "shmring.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! permissions used when creating the shared memory object */
+#define SHMRING_MODE            ( 0666 )
+
+/*! round a length up to the record alignment */
+#define SHMRING_ALIGN_UP( n ) \
+    ( ( (n) + SHMRING_ALIGN - 1 ) & ~(uint64_t)( SHMRING_ALIGN - 1 ) )
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static int Map( ShmRing *pRing, int fd, size_t mapsize );
+static long Futex( uint32_t *pWord, int op, uint32_t value );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  SHMRING_Create                                                            */
+/*!
+    Create a shared memory ring
+
+    The SHMRING_Create function creates ( or re-creates ) the named
+    shared memory object, maps it and initializes an empty ring.
+
+    @param[in]
+        pRing
+            pointer to the ring handle to initialize
+
+    @param[in]
+        name
+            name of the shared memory object, eg "/varmsg"
+
+    @param[in]
+        size
+            size of the ring data area.  This is rounded up to a
+            power of two.
+
+    @retval EOK the ring was created
+    @retval EINVAL invalid arguments
+    @retval other error from shm_open(), ftruncate() or mmap()
+
+==============================================================================*/
+int SHMRING_Create( ShmRing *pRing, const char *name, size_t size )
+{
+    int result = EINVAL;
+    size_t n = SHMRING_HEADER_SIZE;
+    ShmRingHeader *pHeader;
+    int fd;
+
+    if ( ( pRing != NULL ) &&
+         ( name != NULL ) &&
+         ( size > 0 ) &&
+         ( size <= UINT32_MAX ) )
+    {
+        while ( n < size )
+        {
+            n <<= 1;
+        }
+
+        fd = shm_open( name, O_RDWR | O_CREAT | O_CLOEXEC, SHMRING_MODE );
+        if ( fd == -1 )
+        {
+            result = errno;
+        }
+        else
+        {
+            /* discard any previous content */
+            if ( ( ftruncate( fd, 0 ) == 0 ) &&
+                 ( ftruncate( fd, SHMRING_HEADER_SIZE + n ) == 0 ) )
+            {
+                result = Map( pRing, fd, SHMRING_HEADER_SIZE + n );
+            }
+            else
+            {
+                result = errno;
+            }
+
+            close( fd );
+        }
+
+        if ( result == EOK )
+        {
+            pHeader = pRing->pHeader;
+            pHeader->version = SHMRING_VERSION;
+            pHeader->size = n;
+            pRing->rung = 0;
+
+            /* the magic number tells consumers the ring is ready */
+            __atomic_store_n( &pHeader->magic,
+                              SHMRING_MAGIC,
+                              __ATOMIC_RELEASE );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SHMRING_Attach                                                            */
+/*!
+    Attach a consumer to a shared memory ring
+
+    The SHMRING_Attach function maps an existing shared memory ring
+    so its messages can be read.  The consumer starts reading at the
+    oldest unconsumed message.
+
+    @param[in]
+        pRing
+            pointer to the ring handle to initialize
+
+    @param[in]
+        name
+            name of the shared memory object
+
+    @retval EOK the ring was attached
+    @retval EPROTO the object is not a compatible ring
+    @retval EINVAL invalid arguments
+    @retval other error from shm_open(), fstat() or mmap()
+
+==============================================================================*/
+int SHMRING_Attach( ShmRing *pRing, const char *name )
+{
+    int result = EINVAL;
+    struct stat st;
+    ShmRingHeader *pHeader;
+    int fd;
+
+    if ( ( pRing != NULL ) &&
+         ( name != NULL ) )
+    {
+        fd = shm_open( name, O_RDWR | O_CLOEXEC, 0 );
+        if ( fd == -1 )
+        {
+            result = errno;
+        }
+        else
+        {
+            if ( fstat( fd, &st ) != 0 )
+            {
+                result = errno;
+            }
+            else if ( (size_t)st.st_size <= SHMRING_HEADER_SIZE )
+            {
+                result = EPROTO;
+            }
+            else
+            {
+                result = Map( pRing, fd, st.st_size );
+            }
+
+            close( fd );
+        }
+
+        if ( result == EOK )
+        {
+            pHeader = pRing->pHeader;
+            if ( ( __atomic_load_n( &pHeader->magic,
+                                    __ATOMIC_ACQUIRE ) != SHMRING_MAGIC ) ||
+                 ( pHeader->version != SHMRING_VERSION ) ||
+                 ( ( SHMRING_HEADER_SIZE + pHeader->size ) !=
+                   pRing->mapsize ) )
+            {
+                SHMRING_Close( pRing );
+                result = EPROTO;
+            }
+            else
+            {
+                pRing->next = __atomic_load_n( &pHeader->tail,
+                                               __ATOMIC_ACQUIRE );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SHMRING_Write                                                             */
+/*!
+    Write a message to a shared memory ring
+
+    The SHMRING_Write function copies a message into the next record in
+    the ring and publishes it.  If the record does not fit in the space
+    left before the end of the ring, the space is filled with a padding
+    record and the message is written at the start of the ring.
+
+    Consumers are not woken up until SHMRING_Notify is called, so a
+    batch of messages costs at most one wake up.
+
+    @param[in]
+        pRing
+            pointer to the ring handle
+
+    @param[in]
+        pData
+            pointer to the message data
+
+    @param[in]
+        len
+            length of the message data
+
+    @retval EOK the message was written
+    @retval ENOSPC the ring is full and the message was dropped
+    @retval EMSGSIZE the message can never fit in the ring
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int SHMRING_Write( ShmRing *pRing, const char *pData, size_t len )
+{
+    int result = EINVAL;
+    ShmRingHeader *pHeader;
+    ShmRingRecord *pRecord;
+    uint64_t head;
+    uint64_t tail;
+    uint64_t size;
+    uint64_t offset;
+    uint64_t need;
+    uint64_t pad = 0;
+
+    if ( ( pRing != NULL ) &&
+         ( pRing->pHeader != NULL ) &&
+         ( pData != NULL ) )
+    {
+        pHeader = pRing->pHeader;
+        size = pHeader->size;
+        need = SHMRING_ALIGN_UP( sizeof( ShmRingRecord ) + len );
+
+        head = pHeader->head;
+        tail = __atomic_load_n( &pHeader->tail, __ATOMIC_ACQUIRE );
+        offset = head & ( size - 1 );
+
+        if ( ( offset + need ) > size )
+        {
+            /* the record would wrap, so pad to the end of the ring */
+            pad = size - offset;
+        }
+
+        if ( need > ( size / 2 ) )
+        {
+            result = EMSGSIZE;
+        }
+        else if ( ( head - tail + pad + need ) > size )
+        {
+            __atomic_add_fetch( &pHeader->dropped, 1, __ATOMIC_RELAXED );
+            result = ENOSPC;
+        }
+        else
+        {
+            if ( pad > 0 )
+            {
+                pRecord = (ShmRingRecord *)&pRing->pData[offset];
+                pRecord->len = pad - sizeof( ShmRingRecord );
+                pRecord->flags = SHMRING_REC_PAD;
+                head += pad;
+                offset = 0;
+            }
+
+            pRecord = (ShmRingRecord *)&pRing->pData[offset];
+            pRecord->len = len;
+            pRecord->flags = 0;
+            memcpy( &pRecord[1], pData, len );
+
+            /* publish the record */
+            __atomic_store_n( &pHeader->head, head + need, __ATOMIC_RELEASE );
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SHMRING_Notify                                                            */
+/*!
+    Ring the shared memory ring doorbell
+
+    The SHMRING_Notify function increments the doorbell if any records
+    have been published since the last time it was called, and wakes up
+    the consumers if any of them are sleeping.
+
+    @param[in]
+        pRing
+            pointer to the ring handle
+
+==============================================================================*/
+void SHMRING_Notify( ShmRing *pRing )
+{
+    ShmRingHeader *pHeader;
+    uint64_t head;
+
+    if ( ( pRing != NULL ) &&
+         ( pRing->pHeader != NULL ) )
+    {
+        pHeader = pRing->pHeader;
+        head = pHeader->head;
+
+        if ( head != pRing->rung )
+        {
+            pRing->rung = head;
+            __atomic_add_fetch( &pHeader->doorbell, 1, __ATOMIC_SEQ_CST );
+
+            if ( __atomic_load_n( &pHeader->waiters, __ATOMIC_SEQ_CST ) > 0 )
+            {
+                Futex( &pHeader->doorbell, FUTEX_WAKE, INT_MAX );
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  SHMRING_Read                                                              */
+/*!
+    Get the next message from a shared memory ring
+
+    The SHMRING_Read function gets a pointer to the next message in the
+    ring without copying it.  The message remains valid until
+    SHMRING_Release is called.
+
+    @param[in]
+        pRing
+            pointer to the ring handle
+
+    @param[out]
+        ppData
+            pointer to the location to store the message pointer
+
+    @param[out]
+        pLen
+            pointer to the location to store the message length
+
+    @retval EOK a message was returned
+    @retval ENODATA the ring is empty
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int SHMRING_Read( ShmRing *pRing, const char **ppData, size_t *pLen )
+{
+    int result = EINVAL;
+    ShmRingHeader *pHeader;
+    ShmRingRecord *pRecord;
+    uint64_t tail;
+    uint64_t head;
+    uint64_t mask;
+
+    if ( ( pRing != NULL ) &&
+         ( pRing->pHeader != NULL ) &&
+         ( ppData != NULL ) &&
+         ( pLen != NULL ) )
+    {
+        pHeader = pRing->pHeader;
+        mask = pHeader->size - 1;
+        tail = pHeader->tail;
+        head = __atomic_load_n( &pHeader->head, __ATOMIC_ACQUIRE );
+        result = ENODATA;
+
+        while ( tail != head )
+        {
+            pRecord = (ShmRingRecord *)&pRing->pData[tail & mask];
+            if ( pRecord->flags & SHMRING_REC_PAD )
+            {
+                /* skip to the start of the ring */
+                tail += sizeof( ShmRingRecord ) + pRecord->len;
+                __atomic_store_n( &pHeader->tail, tail, __ATOMIC_RELEASE );
+            }
+            else
+            {
+                *ppData = (const char *)&pRecord[1];
+                *pLen = pRecord->len;
+                pRing->next = tail +
+                              SHMRING_ALIGN_UP( sizeof( ShmRingRecord ) +
+                                                pRecord->len );
+                result = EOK;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SHMRING_Release                                                           */
+/*!
+    Release the message returned by SHMRING_Read
+
+    The SHMRING_Release function returns the space used by the message
+    most recently returned by SHMRING_Read to the producer.
+
+    @param[in]
+        pRing
+            pointer to the ring handle
+
+==============================================================================*/
+void SHMRING_Release( ShmRing *pRing )
+{
+    if ( ( pRing != NULL ) &&
+         ( pRing->pHeader != NULL ) )
+    {
+        __atomic_store_n( &pRing->pHeader->tail,
+                          pRing->next,
+                          __ATOMIC_RELEASE );
+    }
+}
+
+/*============================================================================*/
+/*  SHMRING_Wait                                                              */
+/*!
+    Wait for messages in a shared memory ring
+
+    The SHMRING_Wait function sleeps on the doorbell until the ring
+    contains at least one unconsumed record.
+
+    @param[in]
+        pRing
+            pointer to the ring handle
+
+    @retval EOK the ring contains a record
+    @retval EINTR the wait was interrupted by a signal
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int SHMRING_Wait( ShmRing *pRing )
+{
+    int result = EINVAL;
+    ShmRingHeader *pHeader;
+    uint32_t doorbell;
+
+    if ( ( pRing != NULL ) &&
+         ( pRing->pHeader != NULL ) )
+    {
+        pHeader = pRing->pHeader;
+        result = EOK;
+
+        __atomic_add_fetch( &pHeader->waiters, 1, __ATOMIC_SEQ_CST );
+
+        while ( result == EOK )
+        {
+            doorbell = __atomic_load_n( &pHeader->doorbell, __ATOMIC_SEQ_CST );
+            if ( __atomic_load_n( &pHeader->head, __ATOMIC_ACQUIRE ) !=
+                 pHeader->tail )
+            {
+                break;
+            }
+
+            if ( ( Futex( &pHeader->doorbell, FUTEX_WAIT, doorbell ) != 0 ) &&
+                 ( errno == EINTR ) )
+            {
+                result = EINTR;
+            }
+        }
+
+        __atomic_sub_fetch( &pHeader->waiters, 1, __ATOMIC_SEQ_CST );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SHMRING_Close                                                             */
+/*!
+    Unmap a shared memory ring
+
+    The SHMRING_Close function unmaps the ring.  The shared memory object
+    is left in place so consumers can finish reading it.
+
+    @param[in]
+        pRing
+            pointer to the ring handle
+
+==============================================================================*/
+void SHMRING_Close( ShmRing *pRing )
+{
+    if ( ( pRing != NULL ) &&
+         ( pRing->pHeader != NULL ) )
+    {
+        munmap( pRing->pHeader, pRing->mapsize );
+        pRing->pHeader = NULL;
+        pRing->pData = NULL;
+        pRing->mapsize = 0;
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  Map                                                                       */
+/*!
+    Map a shared memory ring
+
+    @param[in]
+        pRing
+            pointer to the ring handle
+
+    @param[in]
+        fd
+            file descriptor of the shared memory object
+
+    @param[in]
+        mapsize
+            size of the shared memory object
+
+    @retval EOK the ring was mapped
+    @retval other error from mmap()
+
+==============================================================================*/
+static int Map( ShmRing *pRing, int fd, size_t mapsize )
+{
+    int result = EOK;
+    void *p;
+
+    p = mmap( NULL, mapsize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    if ( p != MAP_FAILED )
+    {
+        pRing->pHeader = (ShmRingHeader *)p;
+        pRing->pData = (uint8_t *)p + SHMRING_HEADER_SIZE;
+        pRing->mapsize = mapsize;
+    }
+    else
+    {
+        result = errno;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  Futex                                                                     */
+/*!
+    Perform a shared futex operation
+
+    @param[in]
+        pWord
+            pointer to the futex word in shared memory
+
+    @param[in]
+        op
+            FUTEX_WAIT or FUTEX_WAKE
+
+    @param[in]
+        value
+            expected value for FUTEX_WAIT, number of waiters to wake
+            for FUTEX_WAKE
+
+    @retval result of the futex system call
+
+==============================================================================*/
+static long Futex( uint32_t *pWord, int op, uint32_t value )
+{
+    return syscall( SYS_futex, pWord, op, value, NULL, NULL, 0 );
+}
+
+/*! @}
+ * end of shmring group */
@@ -0,0 +1,1066 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup sink Message Sinks
+ * @brief Persistent output targets for variable messages
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file sink.c
+
+    Message Sinks
+
+    A message sink is an output target which receives rendered
+    variable messages.  The following sink types are supported:
+
+    - standard output
+    - output file ( opened in append mode )
+    - POSIX message queue
+    - shared memory ring
+    - UDP or TCP network peer
+
+    Sinks are opened once when the message configurations are loaded
+    and are kept open for the life of the service.  Messages which
+    specify the same output share a single sink.
+
+    Data written to a message queue sink is batched.  Messages are
+    packed into a single message queue message, up to the maximum
+    message size of the queue, and sent when the batch is full or
+    when the sink is flushed.  The main loop flushes all sinks at
+    the end of each processing cycle, so all of the messages generated
+    in one cycle are sent with as few mq_send calls as possible.
+    Each batched message is terminated by a newline so the consumer
+    can split the batch back into individual messages.
+
+    A shared memory sink copies each message into a named shared memory
+    ring which local consumers map and read in place.  The ring doorbell
+    is rung when the sink is flushed, so consumers are woken at most once
+    per processing cycle.
+
+    A network sink sends messages to a UDP or TCP peer.  Messages are
+    queued on the connection and sent when the sink is flushed, as one
+    datagram per message for UDP, or back to back on the stream for
+    TCP.  A TCP connection which fails is re-established in the
+    background, so a missing peer never blocks the main loop.  Data
+    which a network sink could not send, and connections which are
+    being made or are waiting to reconnect, need another flush which
+    no new message may arrive to trigger.  SINK_FlushDue reports when
+    that flush is due, and the notification descriptor is signalled
+    when a flush on any thread leaves such work behind.
+
+    Standard output and file sinks may be compressed with a streaming
+    LZ4 or Zstandard compressor which lives as long as the sink.  The
+    compressed data is collected in the batch buffer and written when
+    the sink is flushed, or when a large amount of compressed data has
+    accumulated.  Each flush also flushes the compressor, and once the
+    current frame holds enough data the frame is ended, so the output
+    can be decoded up to the last flush, and consumers can start
+    decoding at any frame.
+
+    Each sink has its own lock, so messages rendered by different
+    threads may be written to the same sink concurrently.  The list of
+    open sinks has a read-write lock, so sinks can be opened and closed
+    while other threads are flushing the sinks, for example when a
+    configuration is reloaded.  A sink must not be closed while any
+    thread is still writing to it.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <mqueue.h>
+#include "sink.h"
+#include "trace.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! permissions used when creating an output file or message queue */
+#define SINK_MODE           ( 0666 )
+
+/*! size of the data area of a shared memory ring */
+#define SINK_SHM_SIZE       ( 1024 * 1024 )
+
+/*! amount of compressed data which is collected before it is written */
+#define SINK_COMPRESS_CHUNK ( 64 * 1024 )
+
+/*! amount of uncompressed data after which a compressed frame is ended */
+#define SINK_FRAME_SIZE     ( 1024 * 1024 )
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! list of open sinks */
+static MsgSink *pSinks = NULL;
+
+/*! protects the list of open sinks and the sink reference counts */
+static pthread_rwlock_t sinksLock = PTHREAD_RWLOCK_INITIALIZER;
+
+/*! event file descriptor signalled when a sink needs a flush retry,
+    or -1 if there is none */
+static int notifyFd = -1;
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static MsgSink *FindSink( MsgOutputType type, char *name );
+static int OpenSink( MsgSink *pSink, CompressType compression );
+static int WriteData( int fd, const char *pData, size_t len );
+static int WriteCompressed( MsgSink *pSink, const char *pData, size_t len );
+static int SendBatch( MsgSink *pSink, bool end );
+static void NotifyRetry( MsgSink *pSink );
+static void CloseSink( MsgSink *pSink );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  SINK_Open                                                                 */
+/*!
+    Open a message sink
+
+    The SINK_Open function gets a sink for the specified output.  If the
+    output is already open, the existing sink is shared and its reference
+    count is incremented.  Otherwise, the output is opened and a new sink
+    is created.  A stdout or file output is also found if the same file
+    is opened by another name, for example a relative path or a link.
+    A sink can only be shared by messages which use the same
+    compression, so an output which is already open with a different
+    compression is not opened again and errno is set to EEXIST.
+
+    @param[in]
+        type
+            the type of output to open
+
+    @param[in]
+        name
+            name of the output file or message queue, or address of
+            the network peer in the form host:port.  This is not
+            required for the stdout and disabled outputs.
+
+    @param[in]
+        compression
+            type of compression to apply to the output.  Only stdout
+            and file outputs can be compressed.
+
+    @retval pointer to the opened sink
+    @retval NULL if the sink could not be opened, or conflicts with
+            an open sink
+
+==============================================================================*/
+MsgSink *SINK_Open( MsgOutputType type,
+                    char *name,
+                    CompressType compression )
+{
+    MsgSink *pSink;
+
+    if ( ( ( type == VARMSG_OUTPUT_FILE ) ||
+           ( type == VARMSG_OUTPUT_MQUEUE ) ||
+           ( type == VARMSG_OUTPUT_SHM ) ||
+           ( type == VARMSG_OUTPUT_UDP ) ||
+           ( type == VARMSG_OUTPUT_TCP ) ) &&
+         ( name == NULL ) )
+    {
+        /* a name is required for these output types */
+        return NULL;
+    }
+
+    if ( ( compression != COMPRESS_NONE ) &&
+         ( type != VARMSG_OUTPUT_STDOUT ) &&
+         ( type != VARMSG_OUTPUT_FILE ) )
+    {
+        /* only byte stream outputs can be compressed */
+        return NULL;
+    }
+
+    pthread_rwlock_wrlock( &sinksLock );
+
+    pSink = FindSink( type, name );
+    if ( ( pSink != NULL ) &&
+         ( pSink->compressor.type != compression ) )
+    {
+        /* the output is already open with a different compression */
+        pSink = NULL;
+        errno = EEXIST;
+    }
+    else if ( pSink != NULL )
+    {
+        /* share the existing sink */
+        pSink->refCount++;
+    }
+    else
+    {
+        pSink = calloc( 1, sizeof( MsgSink ) );
+        if ( pSink != NULL )
+        {
+            pSink->type = type;
+            pSink->fd = -1;
+            pSink->mq = (mqd_t)-1;
+            pSink->refCount = 1;
+
+            if ( name != NULL )
+            {
+                pSink->name = strdup( name );
+            }
+
+            if ( ( ( name == NULL ) || ( pSink->name != NULL ) ) &&
+                 ( OpenSink( pSink, compression ) == EOK ) )
+            {
+                pthread_mutex_init( &pSink->lock, NULL );
+
+                /* add the sink to the list of open sinks */
+                pSink->pNext = pSinks;
+                pSinks = pSink;
+            }
+            else
+            {
+                free( pSink->name );
+                free( pSink );
+                pSink = NULL;
+            }
+        }
+    }
+
+    pthread_rwlock_unlock( &sinksLock );
+
+    return pSink;
+}
+
+/*============================================================================*/
+/*  SINK_Write                                                                */
+/*!
+    Write a message to a sink
+
+    The SINK_Write function writes a complete message to the sink.
+    Messages written to stdout and file sinks are written immediately
+    with a single write.  Messages written to message queue sinks
+    are added to the sink's batch, which is sent when it is full or
+    when the sink is flushed.
+
+    @param[in]
+        pSink
+            pointer to the sink to write to
+
+    @param[in]
+        pData
+            pointer to the message data
+
+    @param[in]
+        len
+            length of the message data
+
+    @retval EOK the message was written
+    @retval EMSGSIZE the message is too big for the message queue
+    @retval EINVAL invalid arguments
+    @retval other error from write() or mq_send()
+
+==============================================================================*/
+int SINK_Write( MsgSink *pSink, const char *pData, size_t len )
+{
+    int result = EINVAL;
+
+    if ( ( pSink != NULL ) &&
+         ( pData != NULL ) )
+    {
+        pthread_mutex_lock( &pSink->lock );
+
+        switch( pSink->type )
+        {
+            case VARMSG_OUTPUT_STDOUT:
+            case VARMSG_OUTPUT_FILE:
+                if ( pSink->compressor.type != COMPRESS_NONE )
+                {
+                    result = WriteCompressed( pSink, pData, len );
+                }
+                else
+                {
+                    result = WriteData( pSink->fd, pData, len );
+                }
+                break;
+
+            case VARMSG_OUTPUT_SHM:
+                result = SHMRING_Write( &pSink->shm, pData, len );
+                break;
+
+            case VARMSG_OUTPUT_UDP:
+            case VARMSG_OUTPUT_TCP:
+                result = NETCONN_Write( &pSink->net, pData, len );
+                break;
+
+            case VARMSG_OUTPUT_MQUEUE:
+                if ( len > pSink->msgsize )
+                {
+                    result = EMSGSIZE;
+                }
+                else
+                {
+                    result = EOK;
+
+                    if ( ( pSink->batch.len + len ) > pSink->msgsize )
+                    {
+                        /* the message does not fit in the batch, so send
+                           the current batch first */
+                        result = SendBatch( pSink, false );
+                    }
+
+                    if ( result == EOK )
+                    {
+                        result = MSGBUF_Append( &pSink->batch, pData, len );
+                    }
+                }
+                break;
+
+            case VARMSG_OUTPUT_DISABLED:
+            default:
+                /* output is discarded */
+                result = EOK;
+                break;
+        }
+
+        pthread_mutex_unlock( &pSink->lock );
+
+        VARMSG_TRACE3( sink_write, pSink->type, len, result );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SINK_Flush                                                                */
+/*!
+    Flush a sink
+
+    The SINK_Flush function sends any batched data which is waiting
+    to be sent to the sink output.
+
+    @param[in]
+        pSink
+            pointer to the sink to flush
+
+    @retval EOK the sink was flushed
+    @retval EINVAL invalid arguments
+    @retval other error from mq_send(), send() or sendmmsg()
+
+==============================================================================*/
+int SINK_Flush( MsgSink *pSink )
+{
+    int result = EINVAL;
+
+    if ( pSink != NULL )
+    {
+        pthread_mutex_lock( &pSink->lock );
+        result = SendBatch( pSink, false );
+        pthread_mutex_unlock( &pSink->lock );
+
+        VARMSG_TRACE2( sink_flush, pSink->type, result );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SINK_FlushAll                                                             */
+/*!
+    Flush all open sinks
+
+    The SINK_FlushAll function sends any batched data waiting in
+    any of the open sinks.
+
+    @retval EOK all sinks were flushed
+    @retval other error from the last sink which failed to flush
+
+==============================================================================*/
+int SINK_FlushAll( void )
+{
+    int result = EOK;
+    int rc;
+    MsgSink *pSink;
+
+    pthread_rwlock_rdlock( &sinksLock );
+
+    pSink = pSinks;
+    while ( pSink != NULL )
+    {
+        rc = SINK_Flush( pSink );
+        if ( rc != EOK )
+        {
+            result = rc;
+        }
+
+        pSink = pSink->pNext;
+    }
+
+    pthread_rwlock_unlock( &sinksLock );
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SINK_FlushDue                                                             */
+/*!
+    Get the time at which the sinks need to be flushed again
+
+    The SINK_FlushDue function finds the earliest time at which a
+    network sink needs to be flushed to finish sending its queued
+    messages or to make its next connection attempt.  Collecting the
+    retry times re-arms the flush retry notification of each sink.
+
+    @retval monotonic time in milliseconds of the next flush
+    @retval 0 no sink needs to be flushed until more messages are written
+
+==============================================================================*/
+uint64_t SINK_FlushDue( void )
+{
+    uint64_t due = 0;
+    uint64_t at;
+    MsgSink *pSink;
+
+    pthread_rwlock_rdlock( &sinksLock );
+
+    pSink = pSinks;
+    while ( pSink != NULL )
+    {
+        if ( ( pSink->type == VARMSG_OUTPUT_UDP ) ||
+             ( pSink->type == VARMSG_OUTPUT_TCP ) )
+        {
+            pthread_mutex_lock( &pSink->lock );
+            pSink->retry = false;
+            at = NETCONN_RetryAt( &pSink->net );
+            pthread_mutex_unlock( &pSink->lock );
+
+            if ( ( at != 0 ) &&
+                 ( ( due == 0 ) || ( at < due ) ) )
+            {
+                due = at;
+            }
+        }
+
+        pSink = pSink->pNext;
+    }
+
+    pthread_rwlock_unlock( &sinksLock );
+
+    return due;
+}
+
+/*============================================================================*/
+/*  SINK_SetNotify                                                            */
+/*!
+    Set the flush retry notification descriptor
+
+    The SINK_SetNotify function sets an event file descriptor which is
+    signalled when a flush leaves a network sink with work which needs
+    another flush.  The descriptor is signalled once per sink until the
+    retry times are collected by SINK_FlushDue, so a flush on a render
+    or sink writer thread can wake up the thread which schedules the
+    retries.
+
+    @param[in]
+        fd
+            event file descriptor to signal, or -1 for none
+
+==============================================================================*/
+void SINK_SetNotify( int fd )
+{
+    notifyFd = fd;
+}
+
+/*============================================================================*/
+/*  SINK_Close                                                                */
+/*!
+    Close a sink
+
+    The SINK_Close function releases a reference to a sink.  When the
+    last reference is released, any batched data is flushed, the current
+    compressed frame is ended, and the output is closed.
+
+    @param[in]
+        pSink
+            pointer to the sink to close
+
+==============================================================================*/
+void SINK_Close( MsgSink *pSink )
+{
+    if ( pSink != NULL )
+    {
+        pthread_rwlock_wrlock( &sinksLock );
+
+        if ( ( pSink->refCount > 0 ) &&
+             ( --pSink->refCount == 0 ) )
+        {
+            CloseSink( pSink );
+        }
+
+        pthread_rwlock_unlock( &sinksLock );
+    }
+}
+
+/*============================================================================*/
+/*  SINK_CloseAll                                                             */
+/*!
+    Close all sinks
+
+    The SINK_CloseAll function flushes and closes all of the open
+    sinks regardless of their reference counts.  It is used when
+    the service is shutting down.
+
+==============================================================================*/
+void SINK_CloseAll( void )
+{
+    bool locked;
+
+    /* the list is not locked if it was interrupted by the termination
+       handler while a sink was being opened or closed */
+    locked = ( pthread_rwlock_trywrlock( &sinksLock ) == 0 );
+
+    while ( pSinks != NULL )
+    {
+        pSinks->refCount = 0;
+        CloseSink( pSinks );
+    }
+
+    if ( locked == true )
+    {
+        pthread_rwlock_unlock( &sinksLock );
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  FindSink                                                                  */
+/*!
+    Find an open sink
+
+    The FindSink function searches the list of open sinks for one
+    which writes to the specified output.  Stdout and file outputs
+    are matched by their device and inode if the file exists, so a
+    file which is opened by another name, or is the standard output,
+    is found as well.
+
+    @param[in]
+        type
+            the type of output to search for
+
+    @param[in]
+        name
+            name of the output to search for.  May be NULL.
+
+    @retval pointer to the matching sink
+    @retval NULL if no matching sink was found
+
+==============================================================================*/
+static MsgSink *FindSink( MsgOutputType type, char *name )
+{
+    MsgSink *pSink = pSinks;
+    struct stat st;
+    bool file = false;
+
+    if ( type == VARMSG_OUTPUT_STDOUT )
+    {
+        file = ( fstat( STDOUT_FILENO, &st ) == 0 );
+    }
+    else if ( ( type == VARMSG_OUTPUT_FILE ) &&
+              ( name != NULL ) )
+    {
+        file = ( stat( name, &st ) == 0 );
+    }
+
+    while ( pSink != NULL )
+    {
+        if ( ( file == true ) &&
+             ( ( pSink->type == VARMSG_OUTPUT_STDOUT ) ||
+               ( pSink->type == VARMSG_OUTPUT_FILE ) ) &&
+             ( pSink->dev == st.st_dev ) &&
+             ( pSink->ino == st.st_ino ) )
+        {
+            /* the same file, possibly by another name */
+            break;
+        }
+
+        if ( pSink->type == type )
+        {
+            if ( ( name == NULL ) && ( pSink->name == NULL ) )
+            {
+                break;
+            }
+
+            if ( ( name != NULL ) &&
+                 ( pSink->name != NULL ) &&
+                 ( strcmp( name, pSink->name ) == 0 ) )
+            {
+                break;
+            }
+        }
+
+        pSink = pSink->pNext;
+    }
+
+    return pSink;
+}
+
+/*============================================================================*/
+/*  OpenSink                                                                  */
+/*!
+    Open the output of a sink
+
+    The OpenSink function opens the output described by the sink,
+    records the device and inode of a stdout or file output, and sets
+    up its compressor.
+
+    @param[in]
+        pSink
+            pointer to the sink to open
+
+    @param[in]
+        compression
+            type of compression to apply to the output
+
+    @retval EOK the sink output was opened
+    @retval EINVAL invalid arguments
+    @retval ENOMEM memory allocation failure
+    @retval ENOTSUP the compression is not supported
+    @retval other error from open(), mq_open(), mq_getattr(),
+            SHMRING_Create() or NETCONN_Open()
+
+==============================================================================*/
+static int OpenSink( MsgSink *pSink, CompressType compression )
+{
+    int result = EINVAL;
+    struct mq_attr attr;
+    struct stat st;
+
+    if ( pSink != NULL )
+    {
+        switch( pSink->type )
+        {
+            case VARMSG_OUTPUT_DISABLED:
+                result = EOK;
+                break;
+
+            case VARMSG_OUTPUT_STDOUT:
+                pSink->fd = STDOUT_FILENO;
+                result = EOK;
+                break;
+
+            case VARMSG_OUTPUT_FILE:
+                pSink->fd = open( pSink->name,
+                                  O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+                                  SINK_MODE );
+                result = ( pSink->fd != -1 ) ? EOK : errno;
+                break;
+
+            case VARMSG_OUTPUT_SHM:
+                result = SHMRING_Create( &pSink->shm,
+                                         pSink->name,
+                                         SINK_SHM_SIZE );
+                break;
+
+            case VARMSG_OUTPUT_UDP:
+                result = NETCONN_Open( &pSink->net, NETCONN_UDP, pSink->name );
+                break;
+
+            case VARMSG_OUTPUT_TCP:
+                result = NETCONN_Open( &pSink->net, NETCONN_TCP, pSink->name );
+                break;
+
+            case VARMSG_OUTPUT_MQUEUE:
+                pSink->mq = mq_open( pSink->name,
+                                     O_WRONLY | O_CREAT,
+                                     SINK_MODE,
+                                     NULL );
+                if ( pSink->mq == (mqd_t)-1 )
+                {
+                    result = errno;
+                }
+                else if ( mq_getattr( pSink->mq, &attr ) != 0 )
+                {
+                    result = errno;
+                    mq_close( pSink->mq );
+                }
+                else
+                {
+                    /* allocate a batch buffer the size of one
+                       message queue message */
+                    pSink->msgsize = attr.mq_msgsize;
+                    result = MSGBUF_Init( &pSink->batch, pSink->msgsize );
+                    if ( result != EOK )
+                    {
+                        mq_close( pSink->mq );
+                    }
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        if ( ( result == EOK ) &&
+             ( pSink->fd != -1 ) &&
+             ( fstat( pSink->fd, &st ) == 0 ) )
+        {
+            /* identify the file so it is shared if it is opened by
+               another name */
+            pSink->dev = st.st_dev;
+            pSink->ino = st.st_ino;
+        }
+
+        if ( ( result == EOK ) &&
+             ( compression != COMPRESS_NONE ) )
+        {
+            result = COMPRESS_Init( &pSink->compressor, compression );
+            if ( result == EOK )
+            {
+                result = MSGBUF_Init( &pSink->batch, SINK_COMPRESS_CHUNK );
+            }
+
+            if ( result != EOK )
+            {
+                COMPRESS_Free( &pSink->compressor );
+                if ( pSink->type == VARMSG_OUTPUT_FILE )
+                {
+                    close( pSink->fd );
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  WriteData                                                                 */
+/*!
+    Write a block of data to a file descriptor
+
+    The WriteData function writes the block of data to the file
+    descriptor.  The data is normally written with a single write.
+    Short writes and interrupted writes are retried until all of the
+    data has been written.
+
+    @param[in]
+        fd
+            output file descriptor
+
+    @param[in]
+        pData
+            pointer to the data to write
+
+    @param[in]
+        len
+            number of bytes to write
+
+    @retval EOK the data was written
+    @retval EINVAL invalid arguments
+    @retval other error from write()
+
+==============================================================================*/
+static int WriteData( int fd, const char *pData, size_t len )
+{
+    int result = EINVAL;
+    size_t offset = 0;
+    ssize_t n;
+
+    if ( ( fd != -1 ) &&
+         ( pData != NULL ) )
+    {
+        result = EOK;
+
+        while ( offset < len )
+        {
+            n = write( fd, &pData[offset], len - offset );
+            if ( n > 0 )
+            {
+                offset += n;
+            }
+            else if ( ( n < 0 ) && ( errno == EINTR ) )
+            {
+                continue;
+            }
+            else
+            {
+                result = ( n < 0 ) ? errno : EIO;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  WriteCompressed                                                           */
+/*!
+    Write a message to a compressed sink
+
+    The WriteCompressed function compresses the message into the current
+    frame.  The compressed data is collected in the batch buffer, and is
+    written to the output once a chunk of it has accumulated.  The caller
+    must hold the sink lock.
+
+    @param[in]
+        pSink
+            pointer to the sink to write to
+
+    @param[in]
+        pData
+            pointer to the message data
+
+    @param[in]
+        len
+            length of the message data
+
+    @retval EOK the message was compressed
+    @retval other error from the compressor or from write()
+
+==============================================================================*/
+static int WriteCompressed( MsgSink *pSink, const char *pData, size_t len )
+{
+    int result;
+
+    result = COMPRESS_Write( &pSink->compressor, pData, len, &pSink->batch );
+    if ( ( result == EOK ) &&
+         ( pSink->batch.len >= SINK_COMPRESS_CHUNK ) )
+    {
+        result = WriteData( pSink->fd, pSink->batch.pData, pSink->batch.len );
+        MSGBUF_Reset( &pSink->batch );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SendBatch                                                                 */
+/*!
+    Send the batched data of a sink
+
+    The SendBatch function sends any batched data which is waiting
+    to be sent to a message queue sink, rings the doorbell of a
+    shared memory sink, and sends the messages queued on a network
+    sink.  For a compressed sink, the
+    compressor is flushed, and the current frame is ended if it is
+    large enough or if requested, before the compressed data is written.
+    The caller must hold the sink lock.
+
+    @param[in]
+        pSink
+            pointer to the sink to send
+
+    @param[in]
+        end
+            true to always end the current compressed frame
+
+    @retval EOK the batch was sent, or there was nothing to send
+    @retval other error from mq_send(), write() or the compressor
+
+==============================================================================*/
+static int SendBatch( MsgSink *pSink, bool end )
+{
+    int result = EINVAL;
+    int rc;
+    Compressor *pCompressor;
+
+    if ( pSink != NULL )
+    {
+        result = EOK;
+        pCompressor = &pSink->compressor;
+
+        if ( pCompressor->type != COMPRESS_NONE )
+        {
+            if ( ( end == true ) ||
+                 ( pCompressor->frameLen >= SINK_FRAME_SIZE ) )
+            {
+                result = COMPRESS_EndFrame( pCompressor, &pSink->batch );
+            }
+            else
+            {
+                result = COMPRESS_Flush( pCompressor, &pSink->batch );
+            }
+
+            rc = WriteData( pSink->fd, pSink->batch.pData, pSink->batch.len );
+            if ( rc != EOK )
+            {
+                result = rc;
+            }
+
+            MSGBUF_Reset( &pSink->batch );
+        }
+        else if ( pSink->type == VARMSG_OUTPUT_SHM )
+        {
+            /* wake up the consumers */
+            SHMRING_Notify( &pSink->shm );
+        }
+        else if ( ( pSink->type == VARMSG_OUTPUT_UDP ) ||
+                  ( pSink->type == VARMSG_OUTPUT_TCP ) )
+        {
+            /* send all of the messages queued in this cycle */
+            result = NETCONN_Flush( &pSink->net );
+            NotifyRetry( pSink );
+        }
+        else if ( ( pSink->type == VARMSG_OUTPUT_MQUEUE ) &&
+                  ( pSink->batch.len > 0 ) )
+        {
+            do
+            {
+                rc = mq_send( pSink->mq,
+                              pSink->batch.pData,
+                              pSink->batch.len,
+                              0 );
+            } while ( ( rc != 0 ) && ( errno == EINTR ) );
+
+            if ( rc != 0 )
+            {
+                result = errno;
+            }
+
+            /* the batch is discarded even if it could not be sent,
+               so one bad batch does not block all subsequent messages */
+            MSGBUF_Reset( &pSink->batch );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  NotifyRetry                                                               */
+/*!
+    Signal that a network sink needs another flush
+
+    The NotifyRetry function signals the flush retry notification
+    descriptor if the network connection of the sink still has work
+    to do after it was flushed, and this has not already been signalled
+    since the retry times were last collected.  The caller must hold
+    the sink lock.
+
+    @param[in]
+        pSink
+            pointer to the network sink which was flushed
+
+==============================================================================*/
+static void NotifyRetry( MsgSink *pSink )
+{
+    uint64_t one = 1;
+
+    if ( ( notifyFd != -1 ) &&
+         ( pSink->retry == false ) &&
+         ( NETCONN_RetryAt( &pSink->net ) != 0 ) )
+    {
+        pSink->retry = true;
+        if ( write( notifyFd, &one, sizeof( one ) ) != sizeof( one ) )
+        {
+            /* the counter is already signalled */
+        }
+    }
+}
+
+/*============================================================================*/
+/*  CloseSink                                                                 */
+/*!
+    Release a sink
+
+    The CloseSink function is called once the last reference to a sink
+    has been released.  Any batched data is flushed, the current
+    compressed frame is ended, the sink is removed from the list of
+    open sinks, and the output is closed.  The caller must hold the
+    sink list lock.
+
+    @param[in]
+        pSink
+            pointer to the sink to release
+
+==============================================================================*/
+static void CloseSink( MsgSink *pSink )
+{
+    MsgSink **ppSink;
+
+    /* the sink is not locked if it was interrupted by the
+       termination handler in the middle of a write */
+    if ( pthread_mutex_trylock( &pSink->lock ) == 0 )
+    {
+        SendBatch( pSink, true );
+        pthread_mutex_unlock( &pSink->lock );
+    }
+
+    /* remove the sink from the list of open sinks */
+    ppSink = &pSinks;
+    while ( *ppSink != NULL )
+    {
+        if ( *ppSink == pSink )
+        {
+            *ppSink = pSink->pNext;
+            break;
+        }
+
+        ppSink = &((*ppSink)->pNext);
+    }
+
+    if ( pSink->type == VARMSG_OUTPUT_FILE )
+    {
+        close( pSink->fd );
+    }
+    else if ( pSink->type == VARMSG_OUTPUT_MQUEUE )
+    {
+        mq_close( pSink->mq );
+    }
+    else if ( pSink->type == VARMSG_OUTPUT_SHM )
+    {
+        SHMRING_Close( &pSink->shm );
+    }
+    else if ( ( pSink->type == VARMSG_OUTPUT_UDP ) ||
+              ( pSink->type == VARMSG_OUTPUT_TCP ) )
+    {
+        NETCONN_Close( &pSink->net );
+    }
+
+    pthread_mutex_destroy( &pSink->lock );
+    COMPRESS_Free( &pSink->compressor );
+    MSGBUF_Free( &pSink->batch );
+    free( pSink->name );
+    free( pSink );
+}
+
+/*! @}
+ * end of sink group */
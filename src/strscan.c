@@ -0,0 +1,335 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup strscan String Scanner
+ * @brief Single pass classification of string values
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file strscan.c
+
+    String Scanner
+
+    The String Scanner examines a NUL terminated string value in a single
+    pass, and finds its length, the positions of its first and last
+    non-whitespace characters, and whether it contains any characters
+    which must be escaped inside a JSON string.  This is all of the
+    information needed to decide how the value is output.
+
+    The scan processes 16 bytes at a time using SSE2 or NEON when they are
+    available, and falls back to a byte at a time otherwise.  Vector loads
+    are aligned to 16 bytes, so a load never crosses a page boundary and
+    reading past the terminator is safe.  Bytes after the terminator are
+    masked out of the results.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdint.h>
+#include "strscan.h"
+
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#define STRSCAN_VECTOR
+#elif defined( __ARM_NEON )
+#include <arm_neon.h>
+#define STRSCAN_VECTOR
+#endif
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! size of a vector register in bytes */
+#define STRSCAN_BLOCK       ( 16 )
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static bool ScanBytes( const char *str, size_t n, StrScan *pScan );
+
+#ifdef STRSCAN_VECTOR
+static bool ScanBlock( const char *p, size_t offset, StrScan *pScan );
+#endif
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  STRSCAN_Scan                                                              */
+/*!
+    Scan a string value
+
+    The STRSCAN_Scan function scans a NUL terminated string and fills
+    in the scan result.  Whitespace is classified in the same way as
+    isspace() in the C locale.
+
+    @param[in]
+        str
+            pointer to the NUL terminated string to scan
+
+    @param[out]
+        pScan
+            pointer to the scan result
+
+==============================================================================*/
+void STRSCAN_Scan( const char *str, StrScan *pScan )
+{
+    size_t start;
+    bool done;
+
+    if ( ( str != NULL ) &&
+         ( pScan != NULL ) )
+    {
+        pScan->len = 0;
+        pScan->first = SIZE_MAX;
+        pScan->last = SIZE_MAX;
+        pScan->escape = false;
+
+#ifdef STRSCAN_VECTOR
+        /* scan up to the first 16 byte boundary a byte at a time */
+        start = ( STRSCAN_BLOCK - ( (uintptr_t)str % STRSCAN_BLOCK ) ) %
+                STRSCAN_BLOCK;
+        done = ScanBytes( str, start, pScan );
+
+        /* scan the rest of the string a block at a time */
+        while ( done == false )
+        {
+            done = ScanBlock( &str[pScan->len], pScan->len, pScan );
+        }
+#else
+        start = SIZE_MAX;
+        done = ScanBytes( str, start, pScan );
+#endif
+
+        if ( pScan->first == SIZE_MAX )
+        {
+            /* the string is empty or all whitespace */
+            pScan->first = pScan->len;
+            pScan->last = pScan->len;
+        }
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  ScanBytes                                                                 */
+/*!
+    Scan the start of a string a byte at a time
+
+    The ScanBytes function scans up to the specified number of bytes, or
+    until the terminator is found, and updates the scan result.
+
+    @param[in]
+        str
+            pointer to the NUL terminated string to scan
+
+    @param[in]
+        n
+            maximum number of bytes to scan
+
+    @param[in,out]
+        pScan
+            pointer to the scan result
+
+    @retval true the terminator was found
+    @retval false the terminator was not found in the first n bytes
+
+==============================================================================*/
+static bool ScanBytes( const char *str, size_t n, StrScan *pScan )
+{
+    bool done = false;
+    unsigned char c;
+    size_t i;
+
+    for ( i = 0; i < n; i++ )
+    {
+        c = (unsigned char)str[i];
+        if ( c == '\0' )
+        {
+            done = true;
+            break;
+        }
+
+        if ( ( c != ' ' ) && ( ( c < '\t' ) || ( c > '\r' ) ) )
+        {
+            if ( pScan->first == SIZE_MAX )
+            {
+                pScan->first = i;
+            }
+
+            pScan->last = i;
+        }
+
+        if ( ( c < 0x20 ) || ( c == '"' ) || ( c == '\\' ) )
+        {
+            pScan->escape = true;
+        }
+    }
+
+    pScan->len = i;
+
+    return done;
+}
+
+#ifdef STRSCAN_VECTOR
+/*============================================================================*/
+/*  ScanBlock                                                                 */
+/*!
+    Scan an aligned block of 16 bytes
+
+    The ScanBlock function classifies all of the bytes in a 16 byte
+    aligned block at once, and updates the scan result with the bytes
+    before the terminator.
+
+    @param[in]
+        p
+            pointer to the 16 byte aligned block
+
+    @param[in]
+        offset
+            offset of the block from the start of the string
+
+    @param[in,out]
+        pScan
+            pointer to the scan result
+
+    @retval true the terminator was found in the block
+    @retval false the terminator was not found in the block
+
+==============================================================================*/
+static bool ScanBlock( const char *p, size_t offset, StrScan *pScan )
+{
+    bool done = false;
+    uint32_t zero;
+    uint32_t text;
+    uint32_t escape;
+    uint32_t valid = 0xFFFF;
+
+#if defined( __SSE2__ )
+    __m128i v = _mm_load_si128( (const __m128i *)p );
+    __m128i ws = _mm_sub_epi8( v, _mm_set1_epi8( '\t' ) );
+    __m128i m;
+
+    zero = _mm_movemask_epi8( _mm_cmpeq_epi8( v, _mm_setzero_si128() ) );
+
+    /* whitespace is a space, or between tab and carriage return */
+    m = _mm_or_si128( _mm_cmpeq_epi8( v, _mm_set1_epi8( ' ' ) ),
+                      _mm_cmpeq_epi8( _mm_min_epu8( ws, _mm_set1_epi8( 4 ) ),
+                                      ws ) );
+    text = ~_mm_movemask_epi8( m ) & 0xFFFF;
+
+    /* control characters, quotes and backslashes must be escaped */
+    m = _mm_cmpeq_epi8( _mm_min_epu8( v, _mm_set1_epi8( 0x1F ) ), v );
+    m = _mm_or_si128( m, _mm_cmpeq_epi8( v, _mm_set1_epi8( '"' ) ) );
+    m = _mm_or_si128( m, _mm_cmpeq_epi8( v, _mm_set1_epi8( '\\' ) ) );
+    escape = _mm_movemask_epi8( m );
+#elif defined( __ARM_NEON )
+    static const uint8_t bits[16] = { 1, 2, 4, 8, 16, 32, 64, 128,
+                                      1, 2, 4, 8, 16, 32, 64, 128 };
+    uint8x16_t v = vld1q_u8( (const uint8_t *)p );
+    uint8x16_t b = vld1q_u8( bits );
+    uint8x16_t ws = vsubq_u8( v, vdupq_n_u8( '\t' ) );
+    uint8x16_t mz;
+    uint8x16_t mt;
+    uint8x16_t me;
+    uint8x8_t lo;
+
+    mz = vceqq_u8( v, vdupq_n_u8( 0 ) );
+
+    /* whitespace is a space, or between tab and carriage return */
+    mt = vmvnq_u8( vorrq_u8( vceqq_u8( v, vdupq_n_u8( ' ' ) ),
+                             vcleq_u8( ws, vdupq_n_u8( 4 ) ) ) );
+
+    /* control characters, quotes and backslashes must be escaped */
+    me = vorrq_u8( vcltq_u8( v, vdupq_n_u8( 0x20 ) ),
+                   vorrq_u8( vceqq_u8( v, vdupq_n_u8( '"' ) ),
+                             vceqq_u8( v, vdupq_n_u8( '\\' ) ) ) );
+
+    /* convert each byte mask to a 16 bit mask */
+    mz = vandq_u8( mz, b );
+    lo = vpadd_u8( vget_low_u8( mz ), vget_high_u8( mz ) );
+    lo = vpadd_u8( lo, lo );
+    lo = vpadd_u8( lo, lo );
+    zero = vget_lane_u16( vreinterpret_u16_u8( lo ), 0 );
+
+    mt = vandq_u8( mt, b );
+    lo = vpadd_u8( vget_low_u8( mt ), vget_high_u8( mt ) );
+    lo = vpadd_u8( lo, lo );
+    lo = vpadd_u8( lo, lo );
+    text = vget_lane_u16( vreinterpret_u16_u8( lo ), 0 );
+
+    me = vandq_u8( me, b );
+    lo = vpadd_u8( vget_low_u8( me ), vget_high_u8( me ) );
+    lo = vpadd_u8( lo, lo );
+    lo = vpadd_u8( lo, lo );
+    escape = vget_lane_u16( vreinterpret_u16_u8( lo ), 0 );
+#endif
+
+    if ( zero != 0 )
+    {
+        /* only the bytes before the terminator are part of the string */
+        valid = ( zero & -zero ) - 1;
+        done = true;
+    }
+
+    text &= valid;
+    escape &= valid;
+
+    if ( text != 0 )
+    {
+        if ( pScan->first == SIZE_MAX )
+        {
+            pScan->first = offset + __builtin_ctz( text );
+        }
+
+        pScan->last = offset + 31 - __builtin_clz( text );
+    }
+
+    if ( escape != 0 )
+    {
+        pScan->escape = true;
+    }
+
+    pScan->len = offset + ( ( done == true ) ? __builtin_ctz( zero )
+                                             : STRSCAN_BLOCK );
+
+    return done;
+}
+#endif
+
+/*! @}
+ * end of strscan group */
@@ -0,0 +1,463 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup valcache Value Cache
+ * @brief Short lived cache of formatted variable values
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file valcache.c
+
+    Value Cache
+
+    The Value Cache holds the formatted values of variables which have
+    already been fetched during the current epoch, so a variable which
+    appears in many messages is only fetched and formatted once.
+    Each value is identified by its variable handle and a caller
+    defined tag which describes how it was formatted.
+
+    Values are only valid for the epoch they were stored in.  Calling
+    VALCACHE_Begin with a new epoch discards all of the stored values
+    without touching the hash table, since a slot stamped with an older
+    epoch is treated as empty.
+
+    The table grows automatically to keep it no more than three
+    quarters full.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "valcache.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! minimum number of hash table slots */
+#define VALCACHE_MIN_SIZE       ( 64 )
+
+/*! initial size of the value data buffer */
+#define VALCACHE_DATA_SIZE      ( 4096 )
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static size_t Hash( ValCache *pCache, VAR_HANDLE hVar, uint32_t tag );
+static ValCacheEntry *Lookup( ValCache *pCache,
+                              VAR_HANDLE hVar,
+                              uint32_t tag );
+static int Grow( ValCache *pCache );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  VALCACHE_Init                                                             */
+/*!
+    Initialize a value cache
+
+    The VALCACHE_Init function allocates the hash table and data buffer
+    for an empty value cache.  The cache is not used until an epoch is
+    started with VALCACHE_Begin.
+
+    @param[in]
+        pCache
+            pointer to the value cache to initialize
+
+    @param[in]
+        size
+            initial number of hash table slots.  This is rounded up
+            to a power of two.
+
+    @retval EOK the value cache was initialized
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VALCACHE_Init( ValCache *pCache, size_t size )
+{
+    int result = EINVAL;
+    size_t n = VALCACHE_MIN_SIZE;
+
+    if ( pCache != NULL )
+    {
+        while ( n < size )
+        {
+            n <<= 1;
+        }
+
+        pCache->count = 0;
+        pCache->epoch = 0;
+        pCache->pEntries = calloc( n, sizeof( ValCacheEntry ) );
+        if ( pCache->pEntries != NULL )
+        {
+            pCache->size = n;
+            result = MSGBUF_Init( &pCache->data, VALCACHE_DATA_SIZE );
+        }
+        else
+        {
+            pCache->size = 0;
+            result = ENOMEM;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VALCACHE_Begin                                                            */
+/*!
+    Start a value cache epoch
+
+    The VALCACHE_Begin function makes the specified epoch current.
+    If it differs from the current epoch, all of the stored values
+    are discarded.  An epoch of zero disables the cache.
+
+    @param[in]
+        pCache
+            pointer to the value cache
+
+    @param[in]
+        epoch
+            epoch to make current
+
+==============================================================================*/
+void VALCACHE_Begin( ValCache *pCache, uint64_t epoch )
+{
+    if ( ( pCache != NULL ) &&
+         ( pCache->epoch != epoch ) )
+    {
+        pCache->epoch = epoch;
+        pCache->count = 0;
+        MSGBUF_Reset( &pCache->data );
+    }
+}
+
+/*============================================================================*/
+/*  VALCACHE_Find                                                             */
+/*!
+    Find a formatted value in the value cache
+
+    The VALCACHE_Find function looks up the value stored for the
+    specified variable and tag in the current epoch.  The returned
+    data remains valid until the next call to VALCACHE_Add or
+    VALCACHE_Begin.
+
+    @param[in]
+        pCache
+            pointer to the value cache
+
+    @param[in]
+        hVar
+            handle of the variable to look up
+
+    @param[in]
+        tag
+            tag the value was stored with
+
+    @param[out]
+        ppData
+            location to store a pointer to the formatted value
+
+    @param[out]
+        pLen
+            location to store the length of the formatted value
+
+    @retval EOK the value was found
+    @retval ENOENT there is no value for the variable in this epoch
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VALCACHE_Find( ValCache *pCache,
+                   VAR_HANDLE hVar,
+                   uint32_t tag,
+                   const char **ppData,
+                   size_t *pLen )
+{
+    int result = EINVAL;
+    ValCacheEntry *pEntry;
+
+    if ( ( pCache != NULL ) &&
+         ( ppData != NULL ) &&
+         ( pLen != NULL ) )
+    {
+        result = ENOENT;
+
+        if ( ( pCache->epoch != 0 ) &&
+             ( pCache->count > 0 ) )
+        {
+            pEntry = Lookup( pCache, hVar, tag );
+            if ( pEntry->epoch == pCache->epoch )
+            {
+                *ppData = &pCache->data.pData[pEntry->offset];
+                *pLen = pEntry->len;
+                result = EOK;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VALCACHE_Add                                                              */
+/*!
+    Store a formatted value in the value cache
+
+    The VALCACHE_Add function copies the formatted value of a variable
+    into the value cache for the current epoch.  Nothing is stored if
+    the cache is disabled.
+
+    @param[in]
+        pCache
+            pointer to the value cache
+
+    @param[in]
+        hVar
+            handle of the variable
+
+    @param[in]
+        tag
+            identifies how the value was formatted
+
+    @param[in]
+        pData
+            pointer to the formatted value
+
+    @param[in]
+        len
+            length of the formatted value
+
+    @retval EOK the value was stored
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VALCACHE_Add( ValCache *pCache,
+                  VAR_HANDLE hVar,
+                  uint32_t tag,
+                  const char *pData,
+                  size_t len )
+{
+    int result = EINVAL;
+    ValCacheEntry *pEntry;
+    size_t offset;
+
+    if ( ( pCache != NULL ) &&
+         ( pData != NULL ) )
+    {
+        result = EOK;
+
+        if ( ( pCache->epoch != 0 ) &&
+             ( ( pCache->count + 1 ) * 4 > pCache->size * 3 ) )
+        {
+            result = Grow( pCache );
+        }
+
+        if ( ( result == EOK ) &&
+             ( pCache->epoch != 0 ) )
+        {
+            offset = pCache->data.len;
+            result = MSGBUF_Append( &pCache->data, pData, len );
+            if ( result == EOK )
+            {
+                pEntry = Lookup( pCache, hVar, tag );
+                if ( pEntry->epoch != pCache->epoch )
+                {
+                    pCache->count++;
+                }
+
+                pEntry->hVar = hVar;
+                pEntry->tag = tag;
+                pEntry->epoch = pCache->epoch;
+                pEntry->offset = offset;
+                pEntry->len = len;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VALCACHE_Free                                                             */
+/*!
+    Release the storage used by a value cache
+
+    @param[in]
+        pCache
+            pointer to the value cache to free
+
+==============================================================================*/
+void VALCACHE_Free( ValCache *pCache )
+{
+    if ( pCache != NULL )
+    {
+        free( pCache->pEntries );
+        pCache->pEntries = NULL;
+        pCache->size = 0;
+        pCache->count = 0;
+        pCache->epoch = 0;
+        MSGBUF_Free( &pCache->data );
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  Hash                                                                      */
+/*!
+    Calculate the hash table slot for a variable handle and tag
+
+    @param[in]
+        pCache
+            pointer to the value cache
+
+    @param[in]
+        hVar
+            variable handle to hash
+
+    @param[in]
+        tag
+            value tag to hash
+
+    @retval index of the first slot to probe
+
+==============================================================================*/
+static size_t Hash( ValCache *pCache, VAR_HANDLE hVar, uint32_t tag )
+{
+    uint32_t h = ( (uint32_t)hVar ^ ( tag << 24 ) ) * 2654435761U;
+
+    return (size_t)( h ^ ( h >> 16 ) ) & ( pCache->size - 1 );
+}
+
+/*============================================================================*/
+/*  Lookup                                                                    */
+/*!
+    Find the hash table slot for a variable handle and tag
+
+    The Lookup function probes the hash table for the slot holding the
+    value of the specified variable and tag in the current epoch.  If
+    there is no such value, the first empty slot in the probe sequence
+    is returned.  The table always has at least one empty slot.
+
+    @param[in]
+        pCache
+            pointer to the value cache
+
+    @param[in]
+        hVar
+            variable handle to look up
+
+    @param[in]
+        tag
+            value tag to look up
+
+    @retval pointer to the matching or empty slot
+
+==============================================================================*/
+static ValCacheEntry *Lookup( ValCache *pCache,
+                              VAR_HANDLE hVar,
+                              uint32_t tag )
+{
+    size_t mask = pCache->size - 1;
+    size_t i = Hash( pCache, hVar, tag );
+    ValCacheEntry *pEntry = &pCache->pEntries[i];
+
+    while ( ( pEntry->epoch == pCache->epoch ) &&
+            ( ( pEntry->hVar != hVar ) || ( pEntry->tag != tag ) ) )
+    {
+        i = ( i + 1 ) & mask;
+        pEntry = &pCache->pEntries[i];
+    }
+
+    return pEntry;
+}
+
+/*============================================================================*/
+/*  Grow                                                                      */
+/*!
+    Double the number of hash table slots
+
+    The Grow function doubles the size of the hash table and moves the
+    values of the current epoch into their new slots.
+
+    @param[in]
+        pCache
+            pointer to the value cache
+
+    @retval EOK the table was grown
+    @retval ENOMEM memory allocation failure
+
+==============================================================================*/
+static int Grow( ValCache *pCache )
+{
+    int result = ENOMEM;
+    ValCacheEntry *pOld = pCache->pEntries;
+    size_t oldSize = pCache->size;
+    ValCacheEntry *pEntry;
+    size_t i;
+
+    pCache->pEntries = calloc( oldSize * 2, sizeof( ValCacheEntry ) );
+    if ( pCache->pEntries != NULL )
+    {
+        pCache->size = oldSize * 2;
+
+        for ( i = 0; i < oldSize; i++ )
+        {
+            if ( pOld[i].epoch == pCache->epoch )
+            {
+                pEntry = Lookup( pCache, pOld[i].hVar, pOld[i].tag );
+                *pEntry = pOld[i];
+            }
+        }
+
+        free( pOld );
+        result = EOK;
+    }
+    else
+    {
+        pCache->pEntries = pOld;
+    }
+
+    return result;
+}
+
+/*! @}
+ * end of valcache group */
@@ -0,0 +1,536 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2024 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup varindex Variable Index
+ * @brief Hash index from variable handles to interested objects
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file varindex.c
+
+    Variable Index
+
+    The Variable Index is a chained hash table which maps a variable
+    handle to the objects which need to be told when the variable
+    changes.  Each entry records the role the variable plays for the
+    object, and an optional position of the variable within the object.
+
+    A variable may have any number of entries, one for each object and
+    role.  All entries for a variable are found by calling VARINDEX_Find
+    followed by VARINDEX_Next until it returns NULL.
+
+    The table grows automatically to keep the average chain length
+    below two.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "varindex.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! minimum number of hash buckets */
+#define VARINDEX_MIN_BUCKETS    ( 16 )
+
+/*! maximum average number of entries per bucket before the index grows */
+#define VARINDEX_LOAD_FACTOR    ( 2 )
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static size_t Hash( VarIndex *pIndex, VAR_HANDLE hVar );
+static int Grow( VarIndex *pIndex );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  VARINDEX_Init                                                             */
+/*!
+    Initialize a variable index
+
+    The VARINDEX_Init function allocates the hash buckets for an
+    empty variable index.
+
+    @param[in]
+        pIndex
+            pointer to the variable index to initialize
+
+    @param[in]
+        numBuckets
+            initial number of hash buckets.  This is rounded up to
+            a power of two.
+
+    @retval EOK the variable index was initialized
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARINDEX_Init( VarIndex *pIndex, size_t numBuckets )
+{
+    int result = EINVAL;
+    size_t n = VARINDEX_MIN_BUCKETS;
+
+    if ( pIndex != NULL )
+    {
+        while ( n < numBuckets )
+        {
+            n <<= 1;
+        }
+
+        pIndex->count = 0;
+        pIndex->ppBuckets = calloc( n, sizeof( VarIndexEntry * ) );
+        if ( pIndex->ppBuckets != NULL )
+        {
+            pIndex->numBuckets = n;
+            result = EOK;
+        }
+        else
+        {
+            pIndex->numBuckets = 0;
+            result = ENOMEM;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARINDEX_Add                                                              */
+/*!
+    Add an entry to the variable index
+
+    The VARINDEX_Add function associates a variable with an object.
+    If the variable is already associated with the object in the
+    same role, the existing entry is updated.
+
+    @param[in]
+        pIndex
+            pointer to the variable index
+
+    @param[in]
+        hVar
+            handle of the variable
+
+    @param[in]
+        role
+            role of the variable for the object
+
+    @param[in]
+        idx
+            position of the variable within the object
+
+    @param[in]
+        pData
+            pointer to the object to associate with the variable
+
+    @retval EOK the entry was added
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARINDEX_Add( VarIndex *pIndex,
+                  VAR_HANDLE hVar,
+                  uint32_t role,
+                  size_t idx,
+                  void *pData )
+{
+    int result = EINVAL;
+    VarIndexEntry *pEntry;
+    size_t h;
+
+    if ( ( pIndex != NULL ) &&
+         ( pIndex->ppBuckets != NULL ) &&
+         ( hVar != VAR_INVALID ) )
+    {
+        result = EOK;
+
+        /* look for an existing entry */
+        for ( pEntry = VARINDEX_Find( pIndex, hVar );
+              pEntry != NULL;
+              pEntry = VARINDEX_Next( pEntry ) )
+        {
+            if ( ( pEntry->role == role ) &&
+                 ( pEntry->pData == pData ) )
+            {
+                pEntry->idx = idx;
+                break;
+            }
+        }
+
+        if ( pEntry == NULL )
+        {
+            if ( pIndex->count >=
+                 ( pIndex->numBuckets * VARINDEX_LOAD_FACTOR ) )
+            {
+                /* a failure to grow only affects performance */
+                (void)Grow( pIndex );
+            }
+
+            pEntry = malloc( sizeof( VarIndexEntry ) );
+            if ( pEntry != NULL )
+            {
+                pEntry->hVar = hVar;
+                pEntry->role = role;
+                pEntry->idx = idx;
+                pEntry->pData = pData;
+
+                h = Hash( pIndex, hVar );
+                pEntry->pNext = pIndex->ppBuckets[h];
+                pIndex->ppBuckets[h] = pEntry;
+                pIndex->count++;
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARINDEX_Remove                                                           */
+/*!
+    Remove an entry from the variable index
+
+    The VARINDEX_Remove function removes the association between a
+    variable and an object for the specified role.
+
+    @param[in]
+        pIndex
+            pointer to the variable index
+
+    @param[in]
+        hVar
+            handle of the variable
+
+    @param[in]
+        role
+            role of the variable for the object
+
+    @param[in]
+        pData
+            pointer to the associated object
+
+    @retval EOK the entry was removed
+    @retval ENOENT the entry was not found
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARINDEX_Remove( VarIndex *pIndex,
+                     VAR_HANDLE hVar,
+                     uint32_t role,
+                     void *pData )
+{
+    int result = EINVAL;
+    VarIndexEntry **ppEntry;
+    VarIndexEntry *pEntry;
+
+    if ( ( pIndex != NULL ) &&
+         ( pIndex->ppBuckets != NULL ) )
+    {
+        result = ENOENT;
+
+        ppEntry = &pIndex->ppBuckets[Hash( pIndex, hVar )];
+        while ( *ppEntry != NULL )
+        {
+            pEntry = *ppEntry;
+            if ( ( pEntry->hVar == hVar ) &&
+                 ( pEntry->role == role ) &&
+                 ( pEntry->pData == pData ) )
+            {
+                *ppEntry = pEntry->pNext;
+                free( pEntry );
+                pIndex->count--;
+                result = EOK;
+                break;
+            }
+
+            ppEntry = &pEntry->pNext;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARINDEX_RemoveAll                                                        */
+/*!
+    Remove all entries for an object
+
+    The VARINDEX_RemoveAll function removes every entry which is
+    associated with the specified object.
+
+    @param[in]
+        pIndex
+            pointer to the variable index
+
+    @param[in]
+        pData
+            pointer to the object to remove
+
+    @retval number of entries removed
+
+==============================================================================*/
+size_t VARINDEX_RemoveAll( VarIndex *pIndex, void *pData )
+{
+    size_t n = 0;
+    size_t i;
+    VarIndexEntry **ppEntry;
+    VarIndexEntry *pEntry;
+
+    if ( ( pIndex != NULL ) &&
+         ( pIndex->ppBuckets != NULL ) )
+    {
+        for ( i = 0; i < pIndex->numBuckets; i++ )
+        {
+            ppEntry = &pIndex->ppBuckets[i];
+            while ( *ppEntry != NULL )
+            {
+                pEntry = *ppEntry;
+                if ( pEntry->pData == pData )
+                {
+                    *ppEntry = pEntry->pNext;
+                    free( pEntry );
+                    pIndex->count--;
+                    n++;
+                }
+                else
+                {
+                    ppEntry = &pEntry->pNext;
+                }
+            }
+        }
+    }
+
+    return n;
+}
+
+/*============================================================================*/
+/*  VARINDEX_Find                                                             */
+/*!
+    Find the first entry for a variable
+
+    @param[in]
+        pIndex
+            pointer to the variable index
+
+    @param[in]
+        hVar
+            handle of the variable to look for
+
+    @retval pointer to the first entry for the variable
+    @retval NULL the variable is not in the index
+
+==============================================================================*/
+VarIndexEntry *VARINDEX_Find( VarIndex *pIndex, VAR_HANDLE hVar )
+{
+    VarIndexEntry *pEntry = NULL;
+
+    if ( ( pIndex != NULL ) &&
+         ( pIndex->ppBuckets != NULL ) )
+    {
+        pEntry = pIndex->ppBuckets[Hash( pIndex, hVar )];
+        while ( ( pEntry != NULL ) &&
+                ( pEntry->hVar != hVar ) )
+        {
+            pEntry = pEntry->pNext;
+        }
+    }
+
+    return pEntry;
+}
+
+/*============================================================================*/
+/*  VARINDEX_Next                                                             */
+/*!
+    Find the next entry for a variable
+
+    @param[in]
+        pEntry
+            pointer to the current entry
+
+    @retval pointer to the next entry for the same variable
+    @retval NULL there are no more entries for the variable
+
+==============================================================================*/
+VarIndexEntry *VARINDEX_Next( VarIndexEntry *pEntry )
+{
+    VAR_HANDLE hVar;
+
+    if ( pEntry != NULL )
+    {
+        hVar = pEntry->hVar;
+        pEntry = pEntry->pNext;
+        while ( ( pEntry != NULL ) &&
+                ( pEntry->hVar != hVar ) )
+        {
+            pEntry = pEntry->pNext;
+        }
+    }
+
+    return pEntry;
+}
+
+/*============================================================================*/
+/*  VARINDEX_Free                                                             */
+/*!
+    Release all of the storage used by a variable index
+
+    @param[in]
+        pIndex
+            pointer to the variable index to free
+
+==============================================================================*/
+void VARINDEX_Free( VarIndex *pIndex )
+{
+    size_t i;
+    VarIndexEntry *pEntry;
+    VarIndexEntry *pNext;
+
+    if ( ( pIndex != NULL ) &&
+         ( pIndex->ppBuckets != NULL ) )
+    {
+        for ( i = 0; i < pIndex->numBuckets; i++ )
+        {
+            pEntry = pIndex->ppBuckets[i];
+            while ( pEntry != NULL )
+            {
+                pNext = pEntry->pNext;
+                free( pEntry );
+                pEntry = pNext;
+            }
+        }
+
+        free( pIndex->ppBuckets );
+        pIndex->ppBuckets = NULL;
+        pIndex->numBuckets = 0;
+        pIndex->count = 0;
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  Hash                                                                      */
+/*!
+    Calculate the hash bucket for a variable handle
+
+    Variable handles are allocated sequentially, so a multiplicative
+    hash is used to spread them across the buckets.
+
+    @param[in]
+        pIndex
+            pointer to the variable index
+
+    @param[in]
+        hVar
+            variable handle to hash
+
+    @retval hash bucket index
+
+==============================================================================*/
+static size_t Hash( VarIndex *pIndex, VAR_HANDLE hVar )
+{
+    uint32_t h = (uint32_t)hVar * 2654435761U;
+
+    return (size_t)( h ^ ( h >> 16 ) ) & ( pIndex->numBuckets - 1 );
+}
+
+/*============================================================================*/
+/*  Grow                                                                      */
+/*!
+    Double the number of hash buckets
+
+    The Grow function doubles the size of the hash table and moves
+    all of the entries into their new buckets.
+
+    @param[in]
+        pIndex
+            pointer to the variable index
+
+    @retval EOK the index was grown
+    @retval ENOMEM memory allocation failure
+
+==============================================================================*/
+static int Grow( VarIndex *pIndex )
+{
+    int result = ENOMEM;
+    VarIndexEntry **ppOld = pIndex->ppBuckets;
+    size_t oldBuckets = pIndex->numBuckets;
+    VarIndexEntry *pEntry;
+    VarIndexEntry *pNext;
+    size_t i;
+    size_t h;
+
+    pIndex->ppBuckets = calloc( oldBuckets * 2, sizeof( VarIndexEntry * ) );
+    if ( pIndex->ppBuckets != NULL )
+    {
+        pIndex->numBuckets = oldBuckets * 2;
+
+        for ( i = 0; i < oldBuckets; i++ )
+        {
+            pEntry = ppOld[i];
+            while ( pEntry != NULL )
+            {
+                pNext = pEntry->pNext;
+                h = Hash( pIndex, pEntry->hVar );
+                pEntry->pNext = pIndex->ppBuckets[h];
+                pIndex->ppBuckets[h] = pEntry;
+                pEntry = pNext;
+            }
+        }
+
+        free( ppOld );
+        result = EOK;
+    }
+    else
+    {
+        /* keep using the old buckets */
+        pIndex->ppBuckets = ppOld;
+    }
+
+    return result;
+}
+
+/*! @}
+ * end of varindex group */
@@ -50,6 +50,74 @@ SOFTWARE.
     - standard output (used for testing)
     - output file
     - message queue
+    - shared memory ring
+    - UDP or TCP network peer
+
+    A shared memory ring output is a named POSIX shared memory object
+    containing a ring of message records.  Local consumers map the ring
+    and read messages in place, and sleep on its doorbell futex when it
+    is empty.  The layout of the ring is defined in shmring.h.
+
+    A network output sends messages to a UDP or TCP peer given as
+    host:port, or [address]:port for an IPv6 address.  The batching,
+    reconnection and queueing of network messages are described in
+    the README and in netconn.c.
+
+    Each output is opened once when the configuration is loaded and is
+    shared by all messages which write to it.  Messages sent to a
+    message queue are batched into as few queue messages as possible
+    at the end of each processing cycle.
+
+    Full mode messages with an identical body definition, for example the
+    same body sent to several outputs, share one copy of the body.  When
+    more than one of them is generated in the same processing cycle, the
+    body is only rendered once and the result is sent to each output.
+
+    Messages which are generated in the same processing cycle also share
+    the values of the variables they have in common.  Each variable value
+    is fetched and formatted at most once per processing cycle by each
+    render thread, and later messages in the cycle reuse the formatted
+    value.  The values are discarded at the start of the next cycle, so
+    every message still sees values which are current for its cycle.
+
+    The main thread waits for events with epoll.  Variable server
+    notifications are read from a signalfd and the scheduler timer is a
+    timerfd.  All of the pending events are collected on each wakeup and
+    processed together in one processing cycle, so a variable which was
+    modified several times since the last wakeup is only processed once.
+
+    By default messages are rendered on the main thread.  When varmsg
+    is started with -j N, messages are rendered by a pool of N worker
+    threads, each with its own variable server handle and render buffers.
+    The main thread dispatches ready messages to the workers at the end
+    of each processing cycle, and a message is never rendered by more
+    than one worker at a time.
+
+    When varmsg is started with -q N, rendered messages are handed to a
+    dedicated sink writer thread through a bounded output queue of N
+    messages, so rendering never waits for sink I/O.  The -p option
+    selects what happens when the queue is full: block (the default)
+    waits for room, drop-oldest discards the oldest queued message, and
+    drop-newest discards the new message.  Discarded messages are counted
+    in the dropped status variable.
+
+    When varmsg is started with -b budget, for example -b 200ms, the
+    time spent rendering messages is measured every second and compared
+    with the budget, which is the render time allowed per second.  While
+    the budget is exceeded the shed level rises by one step per second,
+    up to level 3, and lower priority messages are shed so varmsg does
+    not compete with the processes it is observing.  Once the render time
+    has stayed below half of the budget for three seconds the shed level
+    drops by one step.  Messages with priority 0 (the default) are never
+    shed.  A message with priority p from 1 to 3 is shed once the shed
+    level reaches 4 - p, and each further level halves its rate again.
+    A shed message either sends only every Nth message, or, with the
+    "delta" shed policy, is sent in delta mode until the load drops.
+
+    The current shed level is published in /varmsg/shed.  Setting
+    /varmsg/shed_override to a level from 0 to 3 fixes the shed level,
+    and setting it to -1 returns the shed level to automatic control.
+    Messages can be shed with the override even when there is no budget.
 
     Each configuration may have a variable prefix associated with it,
     and exposes status and control variables to change the behavior at
@@ -58,20 +126,121 @@ SOFTWARE.
 
     /msg1/txcount - counts the number of generations/transmissions
     /msg1/errcount - counts the number of errors during generation/transmission
+    /msg1/coalesced - counts the triggers collapsed into a pending message
+    /msg1/dropped - counts the messages discarded by the output queue
     /msg1/enable - enables or disables sending the data
-    /msg1/rescan - forces a re-generation of variable sets
+    /msg1/rescan - reruns the variable queries and patches the message
+    /msg1/render_us - time taken to render the last message in microseconds
+    /msg1/render_avg_us - average message render time in microseconds
+    /msg1/render_max_us - maximum message render time in microseconds
+    /msg1/sink_us - average time taken to write a message to its output
+    /msg1/bytes - counts the bytes of message output
+    /msg1/varcount - counts the variables rendered into the messages
+
+    The performance counters are kept in memory while the messages are
+    generated, and are published at most once per second.  The average
+    and maximum times cover the messages generated since the counters
+    were last published.  The global /varmsg/stats variable holds a JSON
+    object with the depth of the output queue, and histograms of the
+    render and output write times of all messages.  Histogram bucket 0
+    counts times of 0us, and bucket n counts times from 2^(n-1)us up to
+    2^n us.
+
+    When the build finds sys/sdt.h from the SystemTap SDT headers,
+    varmsg is compiled with static tracepoints in the "varmsg" provider
+    around message dispatch, rendering and output.  A tracepoint is a
+    single nop instruction until a tracer such as bpftrace or perf is
+    attached to it, so unlike the -v output the tracepoints can be left
+    in production builds.  See the Tracing section of the README for the
+    list of tracepoints.
 
     Each configuration is configured using a JSON configuration file
-    loaded from the configuration directory on startup.
+    loaded from the configuration directory on startup.  All of the
+    configuration files are loaded before the variable queries are run,
+    and configurations which use identical queries share one result.
+    A configuration which cannot be loaded, for example because it has
+    an unsupported format or its output cannot be opened, is reported
+    on stderr and skipped.
+
+    The configuration directory is watched with inotify while varmsg
+    is running.  When a configuration file is added, changed or removed,
+    only that message is set up, replaced or torn down, at the end of
+    the processing cycle.  The other messages keep their variable
+    caches, outputs and counters.  A file whose content has not changed
+    is left alone, and a file which cannot be loaded or set up leaves
+    the running message in place.  A replaced message with the same
+    prefix keeps its counters.  Hidden files are ignored.
+
+    Each message is allocated from a memory arena which holds its
+    settings, query strings and compiled template, and the body variable
+    information table and its pre-encoded keys are packed into an arena
+    of their own once they are built.  The parsed JSON configuration is
+    released as soon as the file has been loaded, so the memory used by
+    a message does not grow or fragment while it runs, and removing a
+    message releases its memory in a few large blocks.
 
     It has the following settings:
 
     prefix : message prefix for control/status variables
-    interval : generation interval (seconds) (optional)
+    interval : generation interval in seconds, or a string with a units
+               suffix such as "100ms", "5s" or "5m" (optional)
+    interval_ms : generation interval in milliseconds (optional)
+    phase : offset of the interval messages from the start of the schedule,
+            in the same formats as interval, or as phase_ms (optional).
+            When varmsg is started with -s, interval messages without a
+            phase are spread evenly across their interval, including
+            messages loaded by a reload
     triggers : query or variable list (optional)
     outputset : query or variable list
-    outputtype : one of stdout, file, mqueue
-    header : location of header template file
+    output_type : one of disabled, stdout, file, mqueue, shm, udp, tcp
+                  (default stdout)
+    output : name of the output file, message queue or shared memory ring,
+             or host:port of the network peer
+    compression : "lz4" or "zstd" to compress a file or stdout output
+                  (optional, only if varmsg was built with the library)
+    header : name of a message template file the message is wrapped in
+             (optional, json format only)
+    fastpath : format numeric values in-process (default true).  Set this
+               to false if the message contains variables with custom
+               print handlers
+    mode : "full" (default) sends every body variable in every message.
+           "delta" sends only the body variables modified since the
+           previous message
+    keyframe : in delta mode, send a full message every keyframe
+               messages (default 10)
+    format : "json" (default) or "cbor".  CBOR messages are indefinite
+             length maps with numeric values encoded in binary, and
+             printed values encoded as text strings
+    min_interval_ms : minimum time between triggered messages (milliseconds)
+    debounce_ms : time to wait after a trigger before the message is sent,
+                  collapsing any further triggers in the window into the
+                  same message (milliseconds)
+    rescan_interval : time between automatic reruns of the trigger and
+                      body variable queries, in the same formats as
+                      interval, or as rescan_interval_ms (optional)
+    rescan_on : name of a variable which reruns the variable queries
+                when it is modified (optional)
+    priority : load shedding priority from 0 (default, never shed) to 3
+               (shed first)
+    shed : how the message is shed under load.  "sample" (default) only
+           sends every Nth message.  "delta" sends a full mode message in
+           delta mode while it is shed, which keeps track of the modified
+           body variables even when the message is not being shed
+
+    A message can be wrapped in an envelope described by a template file
+    named by the header setting, for example to match the Splunk HTTP
+    Event Collector format.  The template is plain text in which ${name}
+    is replaced with the value of the variable called name, and ${*} is
+    replaced with the message body.  The body follows the template if it
+    does not contain ${*}.  Values are inserted without quotes, so the
+    template controls the quoting, and text values are JSON escaped.
+    The template is compiled when the configuration is loaded, so no
+    template parsing is done when a message is generated.
+
+    For example, the following template sends each message as a Splunk
+    HTTP Event Collector event:
+
+    {"time":${/sys/clock/seconds},"host":"${/sys/info/hostname}","event":${*}}
 
     An example configuration is shown below:
 
@@ -109,54 +278,194 @@ SOFTWARE.
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/mman.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
 #include <time.h>
 #include <dirent.h>
+#include <limits.h>
+#include <signal.h>
+#include <pthread.h>
 #include <tjson/json.h>
 #include <varserver/vartemplate.h>
 #include <varserver/varserver.h>
 #include <varserver/varcache.h>
 #include <varserver/varquery.h>
 #include <varserver/varfp.h>
+#include "msgbuf.h"
+#include "numfmt.h"
+#include "sink.h"
+#include "varindex.h"
+#include "schedule.h"
+#include "outq.h"
+#include "cbor.h"
+#include "strscan.h"
+#include "valcache.h"
+#include "msgtmpl.h"
+#include "msgstats.h"
+#include "evloop.h"
+#include "arena.h"
+#include "msgtable.h"
+#include "trace.h"
+#include "shed.h"
 
 /*==============================================================================
         Private definitions
 ==============================================================================*/
 
-/*! The MsgOutputType specifies the type of output target to write to */
-typedef enum _msgOutputType
+#ifdef VARMSG_BENCH
+/*! the benchmark provides its own main() and runs the generator on a
+    thread, so the generator entry point is renamed */
+#define main VARMSG_Main
+int VARMSG_Main( int argc, char **argv );
+#endif
+
+/*! The MsgFormat specifies the encoding of a message */
+typedef enum _msgFormat
+{
+    /*! JSON text, one message per line */
+    MSGFORMAT_JSON = 0,
+
+    /*! CBOR indefinite length map */
+    MSGFORMAT_CBOR
+
+} MsgFormat;
+
+/*! The VarMeta object caches the information about a message body
+    variable which does not change from one render to the next */
+typedef struct _varMeta
+{
+    /*! handle of the variable */
+    VAR_HANDLE hVar;
+
+    /*! true if the variable value is formatted in-process */
+    bool typed;
+
+    /*! offset of the pre-encoded key in the key buffer */
+    size_t keyOffset;
+
+    /*! length of the pre-encoded key */
+    size_t keyLen;
+
+} VarMeta;
+
+/*! The VarMetaTable object holds the cached information for each
+    variable in a message body, in message order */
+typedef struct _varMetaTable
+{
+    /*! array of variable information */
+    VarMeta *pMeta;
+
+    /*! number of variables in the table */
+    size_t n;
+
+    /*! number of table entries allocated */
+    size_t size;
+
+    /*! buffer containing the pre-encoded keys of all of the
+        variables in the table */
+    MsgBuf keys;
+
+    /*! encoding of the message and its pre-encoded keys */
+    MsgFormat format;
+
+    /*! arena holding the entries and keys of a completed table, or NULL
+        if they are still on the heap.  A table in an arena cannot grow */
+    Arena *pArena;
+
+} VarMetaTable;
+
+/*! The MsgBody object holds the body variables of a message.  Full
+    messages with an identical body definition share one reference
+    counted MsgBody, so the body is only rendered once when several of
+    them are generated in the same processing cycle */
+typedef struct _msgBody
+{
+    /*! number of messages using this body */
+    uint32_t refCount;
+
+    /*! cache of variables to put in message body */
+    VarCache *pVarCache;
+
+    /*! cached information for the variables in the message body */
+    VarMetaTable meta;
+
+    /*! serializes the rendering of a shared body */
+    pthread_mutex_t lock;
+
+    /*! processing cycle the rendered body was generated in, or zero
+        if there is no rendered body */
+    uint64_t cycle;
+
+    /*! result of rendering the body */
+    int renderResult;
+
+    /*! number of variables in the rendered body */
+    size_t outputCount;
+
+    /*! rendered body of a shared message */
+    MsgBuf rendered;
+
+} MsgBody;
+
+/*! The VarRole enumeration lists the roles a variable can play in a
+    message.  It is stored with each variable index entry so a modified
+    notification can be dispatched to the right handler. */
+typedef enum _varRole
 {
-    /*! output disabled */
-    VARMSG_OUTPUT_DISABLED = 0,
+    /*! variable is in the trigger variable set */
+    VARROLE_TRIGGER = 1,
+
+    /*! variable is the message trigger control variable */
+    VARROLE_MSGTRIGGER,
 
-    /*! output to stdout */
-    VARMSG_OUTPUT_STDOUT,
+    /*! variable is the message enable control variable */
+    VARROLE_ENABLE,
 
-    /*! output to message queue */
-    VARMSG_OUTPUT_MQUEUE,
+    /*! variable is a delta mode message body variable */
+    VARROLE_BODY,
 
-    /*! output to file */
-    VARMSG_OUTPUT_FILE
+    /*! variable requests a rescan of the message variable queries */
+    VARROLE_RESCAN,
 
-} MsgOutputType;
+    /*! variable is the global shed level override control variable */
+    VARROLE_SHED
+
+} VarRole;
 
 /*! The VarMsgConfig object manages a single variable message
     to be */
 typedef struct _varMsgConfig
 {
-    /*! flag to indicate if the message is enabled (true) or disabled (false) */
-    bool enabled;
+    /*! identifier of the message in the message table, which holds
+        the enable flag, intervals and coalescing windows of the
+        message */
+    uint32_t id;
+
+    /*! arena which holds the configuration object and everything
+        else which lives as long as the configuration */
+    Arena *pArena;
 
     /*! configuration name */
     char *configName;
 
+    /*! digest of the configuration file, used to check if the file
+        has changed when the configuration directory is reloaded */
+    uint64_t digest;
+
     /*! variable message configuration prefix */
     char *prefix;
 
-    /*! time interval in seconds */
-    int interval;
+    /*! offset of the interval messages from the start of the
+        schedule in milliseconds */
+    uint32_t phase;
+
+    /*! indicates if the phase was specified in the configuration */
+    bool phaseSet;
 
-    /*! countdown timer starts at "interval" and counts down to zero */
-    uint32_t t;
+    /*! scheduler item for the next interval message */
+    SchedItem intervalItem;
 
     /*! transmission counter */
     uint32_t txCount;
@@ -164,6 +473,49 @@ typedef struct _varMsgConfig
     /*! error counter */
     uint32_t errCount;
 
+    /*! scheduler item for a triggered message which is waiting for
+        its coalescing window to end */
+    SchedItem pendingItem;
+
+    /*! number of triggers collapsed into a pending message */
+    uint32_t coalescedCount;
+
+    /*! the coalesced counter has changed since it was published */
+    bool coalescedChanged;
+
+    /*! name of the variable which requests a rescan when it is
+        modified, or NULL if there is none */
+    char *rescanOn;
+
+    /*! scheduler item for the next automatic rescan */
+    SchedItem rescanItem;
+
+    /*! number of messages discarded by the output queue.  This is
+        updated atomically by the render and writer threads */
+    uint32_t dropped;
+
+    /*! value of the dropped counter when it was last published */
+    uint32_t droppedPublished;
+
+    /*! format scalar values in-process instead of using VAR_Print */
+    bool fastpath;
+
+    /*! message encoding */
+    MsgFormat format;
+
+    /*! name of the message template file, or NULL if the message
+        is not wrapped in a template */
+    char *header;
+
+    /*! compiled message template */
+    MsgTemplate *pTemplate;
+
+    /*! type of output the message is sent to */
+    MsgOutputType outputType;
+
+    /*! output sink the message is sent to */
+    MsgSink *pSink;
+
     /* query for trigger variables */
     VarQuery triggerQuery;
 
@@ -173,8 +525,47 @@ typedef struct _varMsgConfig
     /*! cache of variables to trigger on */
     VarCache *pTriggerCache;
 
-    /*! cache of variables to put in message body */
-    VarCache *pVarCache;
+    /*! message body variables, which may be shared with other messages */
+    MsgBody *pBody;
+
+    /*! send only the body variables which were modified since the
+        previous message */
+    bool delta;
+
+    /*! number of messages between full messages in delta mode */
+    uint32_t keyframe;
+
+    /*! number of messages generated since the last full message */
+    uint32_t deltaCount;
+
+    /*! the message is configured in full mode, and is only sent in
+        delta mode while it is being shed.  The body variables are
+        tracked as for a delta mode message */
+    bool shedDelta;
+
+    /*! a shedDelta message is currently being sent in delta mode.
+        This is read atomically by the render workers */
+    bool degraded;
+
+    /*! bitmap of modified body variables indexed by their position
+        in the variable information table.  The bitmap is updated
+        atomically since it is shared with the render workers */
+    uint32_t *pDirty;
+
+    /*! message is in the ready list for the current processing cycle */
+    bool ready;
+
+    /*! message is queued for, or being rendered by, a render worker */
+    bool queued;
+
+    /*! message was made ready again while it was queued */
+    bool rerun;
+
+    /*! pointer to the next message in the ready list */
+    struct _varMsgConfig *pReadyNext;
+
+    /*! pointer to the next message in the work queue */
+    struct _varMsgConfig *pWorkNext;
 
     /*! transmission counter */
     VAR_HANDLE hTxCount;
@@ -182,16 +573,91 @@ typedef struct _varMsgConfig
     /*! transmission error counter */
     VAR_HANDLE hErrCount;
 
+    /*! coalesced trigger counter */
+    VAR_HANDLE hCoalesced;
+
+    /*! dropped message counter */
+    VAR_HANDLE hDropped;
+
     /*! trigger */
     VAR_HANDLE hTrigger;
 
     /*! enable control */
     VAR_HANDLE hEnable;
 
+    /*! rescan control */
+    VAR_HANDLE hRescan;
+
+    /*! last render time */
+    VAR_HANDLE hRenderUs;
+
+    /*! average render time */
+    VAR_HANDLE hRenderAvgUs;
+
+    /*! maximum render time */
+    VAR_HANDLE hRenderMaxUs;
+
+    /*! average sink write time */
+    VAR_HANDLE hSinkUs;
+
+    /*! bytes sent counter */
+    VAR_HANDLE hBytes;
+
+    /*! variables rendered counter */
+    VAR_HANDLE hVarCount;
+
+    /*! performance counters.  These are updated atomically by the
+        render threads */
+    MsgStats stats;
+
+    /*! performance counter values which were last published */
+    MsgStatsSnapshot statsPublished;
+
     /*! pointer to the next variable message */
     struct _varMsgConfig *pNext;
 } VarMsgConfig;
 
+/*! The RenderContext object holds the resources used to render a
+    message.  Each render thread has its own context so messages can
+    be rendered concurrently */
+typedef struct _renderContext
+{
+    /*! variable server handle */
+    VARSERVER_HANDLE hVarServer;
+
+    /*! Variable Output stream */
+    VarFP *pVarFP;
+
+    /*! Variable output file descriptor */
+    int varFd;
+
+    /*! number of variables output for the current render */
+    size_t outputCount;
+
+    /*! identifier of the message being rendered */
+    uint32_t msgId;
+
+    /*! buffer used to assemble the current message */
+    MsgBuf msgbuf;
+
+    /*! buffer the current message is being assembled in.  This is
+        either msgbuf, or the buffer of a shared message body */
+    MsgBuf *pMsgBuf;
+
+    /*! values formatted during the current processing cycle */
+    ValCache values;
+
+    /*! render worker thread */
+    pthread_t thread;
+
+    /*! indicates if the render worker thread was started */
+    bool started;
+
+    /*! pointer to the Variable Message Generator state */
+    struct _varMsgState *pState;
+
+} RenderContext;
+
 /*! Variable Message state */
 typedef struct _varMsgState
 {
@@ -201,6 +667,9 @@ typedef struct _varMsgState
     /*! verbose flag */
     bool verbose;
 
+    /*! automatically spread the interval messages across their interval */
+    bool stagger;
+
     /*! name of the configuration directory */
     char *pConfigDir;
 
@@ -210,22 +679,177 @@ typedef struct _varMsgState
     /*! the number of variable messages this service is managing */
     uint32_t numMsgs;
 
-    /*! Variable Output stream */
-    VarFP *pVarFP;
+    /*! resources used to render messages on the main thread */
+    RenderContext render;
 
-    /*! Variable output file descriptor */
-    int varFd;
+    /*! number of render worker threads */
+    uint32_t numWorkers;
 
-    /*! number of variables output for the current render */
-    size_t outputCount;
+    /*! array of render worker contexts */
+    RenderContext *pWorkers;
 
-    /*! output stream for current render */
-    int fd;
+    /*! asks the render workers to exit once the work queue is empty */
+    bool stopWorkers;
+
+    /*! protects the work queue and the message queued/rerun flags */
+    pthread_mutex_t workLock;
+
+    /*! signals the render workers when messages are queued */
+    pthread_cond_t workCond;
+
+    /*! signals the main thread when a render worker finishes a message */
+    pthread_cond_t idleCond;
+
+    /*! pointer to the first message waiting for a render worker */
+    VarMsgConfig *pWorkHead;
+
+    /*! pointer to the last message waiting for a render worker */
+    VarMsgConfig *pWorkTail;
+
+    /*! pointer to the first message made ready in this cycle */
+    VarMsgConfig *pReadyHead;
+
+    /*! pointer to the last message made ready in this cycle */
+    VarMsgConfig *pReadyTail;
+
+    /*! maximum number of messages in the output queue, or zero
+        to write messages to their sinks as they are rendered */
+    size_t queueDepth;
+
+    /*! policy applied when a message is written to a full output queue */
+    OutQPolicy queuePolicy;
+
+    /*! output queue feeding the sink writer thread */
+    OutQ *pOutQ;
+
+    /*! index of the messages which are interested in each
+        modified notification */
+    VarIndex index;
+
+    /*! schedule of interval and pending messages */
+    Sched sched;
+
+    /*! event loop which the main thread waits on */
+    EvLoop loop;
+
+    /*! signalfd receiving the variable server notification signals */
+    int sigFd;
+
+    /*! event source for the variable server notifications */
+    EvSource sigSource;
+
+    /*! one-shot timerfd which expires when the next scheduled
+        message is due */
+    int timerFd;
+
+    /*! event source for the scheduler timer */
+    EvSource timerSource;
+
+    /*! true if the scheduler timer expired during the current wakeup */
+    bool timerExpired;
+
+    /*! eventfd signalled when a network sink needs a flush retry,
+        or -1 if the sinks do not signal their retries */
+    int flushFd;
+
+    /*! event source for the sink flush retry notifications */
+    EvSource flushSource;
+
+    /*! scheduler item for the next network sink flush retry */
+    SchedItem flushItem;
+
+    /*! handles of the variables modified during the current wakeup,
+        in the order they were first notified */
+    VAR_HANDLE *pModified;
+
+    /*! number of handles in pModified */
+    size_t numModified;
+
+    /*! number of handles allocated for pModified */
+    size_t maxModified;
+
+    /*! set of the handles already in pModified, used to collapse
+        repeated notifications for the same variable */
+    ValCache modifiedSet;
+
+    /*! number of event loop wakeups */
+    uint64_t wakeups;
+
+    /*! inotify descriptor watching the configuration directory,
+        or -1 if the directory is not watched */
+    int watchFd;
+
+    /*! event source for the configuration directory watch */
+    EvSource watchSource;
+
+    /*! NUL terminated names of the configuration files which have
+        changed since the last reload */
+    MsgBuf reloads;
+
+    /*! configuration directory events were lost, so every
+        configuration file is checked on the next reload */
+    bool reloadAll;
+
+    /*! monotonic time the timer is armed for in milliseconds,
+        or zero if the timer is not armed */
+    uint64_t timerDue;
+
+    /*! monotonic time the schedule was started in milliseconds.  All
+        interval messages are phase aligned to this time */
+    uint64_t epoch;
+
+    /*! number of the current processing cycle.  This is read
+        atomically by the render workers */
+    uint64_t cycle;
+
+    /*! scheduler item for the next performance counter publication */
+    SchedItem statsItem;
+
+    /*! histogram of message render times */
+    LatencyHist renderHist;
+
+    /*! histogram of message sink write times */
+    LatencyHist sinkHist;
+
+    /*! global statistics variable */
+    VAR_HANDLE hStats;
+
+    /*! buffer used to assemble the global statistics */
+    MsgBuf stats;
+
+    /*! global statistics which were last published */
+    MsgBuf statsPublished;
+
+    /*! render time budget in microseconds per second, or zero if
+        messages are only shed when the shed level is overridden */
+    uint32_t budget;
+
+    /*! load shedding controller */
+    ShedCtl shed;
+
+    /*! render time since the last shed level update in microseconds.
+        This is updated atomically by the render threads */
+    uint64_t renderUs;
+
+    /*! monotonic time of the last shed level update in milliseconds */
+    uint64_t shedTime;
+
+    /*! scheduler item for the next shed level update */
+    SchedItem shedItem;
+
+    /*! shed level status variable */
+    VAR_HANDLE hShed;
+
+    /*! shed level override control variable */
+    VAR_HANDLE hShedOverride;
 
     /*! pointer to a list of Variable Message Configurations managed
         by this instance */
     VarMsgConfig *pMessageConfigs;
 
+    /*! scheduling state of the messages, indexed by message identifier */
+    MsgTable msgs;
+
 } VarMsgState;
 
 /*! MsgVar object to define a message variable to be created */
@@ -237,13 +861,36 @@ typedef struct _msgVar
     /* variable flags to be set */
     uint32_t flags;
 
+    /*! type of the variable */
+    VarType type;
+
     /*! notification type for the variable */
     NotificationType notifyType;
 
+    /*! role of the variable in the variable index, or zero if the
+        variable is not indexed */
+    uint32_t role;
+
     /*! pointer to a location to store the variable handle once it is created */
     VAR_HANDLE *pVarHandle;
 } MsgVar;
 
+/*! The QueryResult object records the result of a variable query which
+    has been run during startup, so configurations which use an
+    identical query can share the result instead of running it again */
+typedef struct _queryResult
+{
+    /*! pointer to the variable query */
+    VarQuery *pQuery;
+
+    /*! pointer to the variable cache containing the query result */
+    VarCache *pCache;
+
+    /*! pointer to the next query result */
+    struct _queryResult *pNext;
+
+} QueryResult;
+
 /*! Initial variable cache size */
 #define CACHE_SIZE_INITIAL          ( 50 )
 
@@ -253,6 +900,100 @@ typedef struct _msgVar
 /*! size for the variable rendering output buffer */
 #define VARFP_SIZE                  ( 256 * 1024 )
 
+/*! initial size of the message assembly buffer */
+#define MSGBUF_SIZE                 ( 16 * 1024 )
+
+/*! Initial size of the variable metadata table */
+#define META_SIZE_INITIAL           ( 50 )
+
+/*! initial size of the pre-encoded key buffer */
+#define META_KEYS_SIZE              ( 4 * 1024 )
+
+/*! size of the blocks of a message configuration arena */
+#define CONFIG_ARENA_SIZE           ( 4 * 1024 )
+
+/*! default number of messages between full messages in delta mode */
+#define DELTA_KEYFRAME_DEFAULT      ( 10 )
+
+/*! number of bits in each word of the modified variable bitmap */
+#define DIRTY_WORD_BITS             ( 32 )
+
+/*! initial number of buckets in the variable index */
+#define VARINDEX_SIZE               ( 256 )
+
+/*! initial number of slots in each render context's value cache */
+#define VALCACHE_SIZE               ( 256 )
+
+/*! value cache tag for the value of a message template variable */
+#define VALTAG_TEMPLATE             ( 4 )
+
+/*! maximum number of notification signals read in one wakeup */
+#define SIGNAL_DRAIN_MAX            ( 4096 )
+
+/*! number of notification signals read by each signalfd read */
+#define SIGNAL_BATCH                ( 64 )
+
+/*! initial number of modified handles collected in one wakeup */
+#define MODIFIED_SIZE               ( 64 )
+
+/*! configuration directory events which cause a reload */
+#define WATCH_EVENTS                ( IN_CLOSE_WRITE | IN_MOVED_TO | \
+                                      IN_MOVED_FROM | IN_DELETE )
+
+/*! size of the configuration directory event buffer */
+#define WATCH_BUFSIZE               ( 4096 )
+
+/*! FNV-1a offset basis for the configuration file digest */
+#define DIGEST_BASIS                ( 0xcbf29ce484222325ULL )
+
+/*! FNV-1a prime for the configuration file digest */
+#define DIGEST_PRIME                ( 0x100000001b3ULL )
+
+/*! initial size of the message schedule */
+#define SCHED_SIZE                  ( 64 )
+
+/*! initial number of entries in the message table */
+#define MSGTABLE_SIZE               ( 64 )
+
+/*! maximum number of render worker threads */
+#define MAX_WORKERS                 ( 64 )
+
+/*! scheduler item type for an interval message */
+#define SCHED_TYPE_INTERVAL         ( 1 )
+
+/*! scheduler item type for a pending triggered message */
+#define SCHED_TYPE_PENDING          ( 2 )
+
+/*! scheduler item type for an automatic variable query rescan */
+#define SCHED_TYPE_RESCAN           ( 3 )
+
+/*! scheduler item type for the performance counter publication */
+#define SCHED_TYPE_STATS            ( 4 )
+
+/*! scheduler item type for the shed level update */
+#define SCHED_TYPE_SHED             ( 5 )
+
+/*! scheduler item type for a network sink flush retry */
+#define SCHED_TYPE_FLUSH            ( 6 )
+
+/*! time between performance counter publications in milliseconds */
+#define STATS_INTERVAL_MS           ( 1000 )
+
+/*! time between shed level updates in milliseconds */
+#define SHED_INTERVAL_MS            ( 1000 )
+
+/*! name of the global statistics variable */
+#define STATS_VAR_NAME              "/varmsg/stats"
+
+/*! size of the global statistics variable */
+#define STATS_VAR_SIZE              ( 1024 )
+
+/*! name of the shed level status variable */
+#define SHED_VAR_NAME               "/varmsg/shed"
+
+/*! name of the shed level override control variable */
+#define SHED_OVERRIDE_VAR_NAME      "/varmsg/shed_override"
+
 /*==============================================================================
         Private file scoped variables
 ==============================================================================*/
@@ -265,11 +1006,22 @@ static VarMsgConfig *pVarMsgs = NULL;
 
 /*! list of output types.  These must be in the same order
     as the MsgOutputType enumeration */
-static const char const *outputTypes[] = {
+static const char *outputTypes[] = {
     "disabled",
     "stdout",
     "mqueue",
     "file",
+    "shm",
+    "udp",
+    "tcp",
+    NULL
+};
+
+/*! list of message formats.  These must be in the same order
+    as the MsgFormat enumeration */
+static const char *msgFormats[] = {
+    "json",
+    "cbor",
     NULL
 };
 
@@ -285,14 +1037,32 @@ static int ProcessOptions( int argC, char *argV[], VarMsgState *pState );
 static void usage( char *cmdname );
 static void TerminationHandler( int signum, siginfo_t *info, void *ptr );
 static void SetupTerminationHandler( void );
-static int SetupVarFP( VarMsgState *pState );
+static int SetupVarFP( RenderContext *pCtx, int id );
 static int ProcessConfigDir( VarMsgState *pState, char *pDirname );
 static int ProcessConfigFile( VarMsgState *pState, char *filename );
+static void FreeConfig( VarMsgState *pState, VarMsgConfig *pConfig );
+static int SetupConfigs( VarMsgState *pState );
+static int SetupConfig( VarMsgState *pState, VarMsgConfig *pConfig );
+static int RunQueries( VarMsgState *pState );
+static int RunConfigQueries( VarMsgState *pState,
+                             QueryResult **ppResults,
+                             VarMsgConfig *pConfig,
+                             size_t *pTotal );
+static int RunSharedQuery( VarMsgState *pState,
+                           QueryResult **ppResults,
+                           VarQuery *pQuery,
+                           VarCache *pVarCache );
+static bool QueryEqual( VarQuery *pQuery1, VarQuery *pQuery2 );
+static int CopyToCache( VAR_HANDLE hVar, void *arg );
 static MsgOutputType ParseOutputType( char *outputtype );
-static int ProcessQuery( VARSERVER_HANDLE hVarServer,
-                         JObject *config,
+static int ParseFormat( char *format, MsgFormat *pFormat );
+static int SetupOutput( VarMsgState *pState,
+                        JNode *pNode,
+                        VarMsgConfig *pConfig );
+static int ProcessQuery( JObject *config,
                          VarQuery *pVarQuery,
-                         VarCache **ppVarCache );
+                         VarCache **ppVarCache,
+                         Arena *pArena );
 
 static int ProcessTriggerConfig( VarMsgState *pState,
                                  JNode *pNode,
@@ -302,21 +1072,160 @@ static int ProcessVarsConfig( VarMsgState *pState,
                               JNode *pNode,
                               VarMsgConfig *pConfig );
 
-static int BuildQuery( JObject *config, VarQuery *query );
+static int BuildQuery( JObject *config, VarQuery *query, Arena *pArena );
 static int ProcessVarList( JArray *pVarList, VarCache **ppVarCache );
 static int AddToCache( JNode *pNode, void *arg );
-static int SetupTimer( int s );
+static int BuildVarMeta( VarMsgConfig *pConfig );
+static int AddVarMeta( VAR_HANDLE hVar, void *arg );
+static int AddJSONKey( VarMetaTable *pTable, VarInfo *pInfo );
+static int AddCBORKey( VarMetaTable *pTable, VarInfo *pInfo );
+static int SealVarMeta( VarMetaTable *pTable );
+static void FreeVarMeta( VarMetaTable *pTable );
+static int ParseMode( JNode *pNode, VarMsgConfig *pConfig );
+static int LoadTemplate( JNode *pNode, VarMsgConfig *pConfig );
+static int SealTemplate( Arena *pArena, MsgTemplate *pTmpl );
+static int ResolveTemplate( VarMsgState *pState, VarMsgConfig *pConfig );
+static int SetupDeltaMode( VarMsgState *pState, VarMsgConfig *pConfig );
+static MsgBody *CreateBody( void );
+static void FreeBody( MsgBody *pBody );
+static void ShareBodies( VarMsgState *pState );
+static void ShareBody( VarMsgState *pState,
+                       VarMsgConfig *pConfig,
+                       VarMsgConfig *pEnd );
+static bool BodyEqual( VarMsgConfig *pConfig1, VarMsgConfig *pConfig2 );
+static void ReloadConfigs( VarMsgState *pState );
+static int ReloadConfig( VarMsgState *pState, char *name );
+static int StartConfig( VarMsgState *pState, VarMsgConfig *pConfig );
+static void RemoveConfig( VarMsgState *pState, VarMsgConfig *pConfig );
+static void InheritCounters( VarMsgState *pState,
+                             VarMsgConfig *pConfig,
+                             VarMsgConfig *pOld );
+static VarMsgConfig *FindConfig( VarMsgState *pState, char *name );
+static int ReadDigest( char *filename, uint64_t *pDigest );
+static void WaitIdle( VarMsgState *pState, VarMsgConfig *pConfig );
+static void MarkModified( VarMsgConfig *pConfig, size_t idx );
+static bool TestAndClearModified( VarMsgConfig *pConfig, size_t idx );
+static int ParseTime( JNode *pNode, char *name, uint32_t *pValue );
+static int ParseDuration( const char *str, uint32_t *pDuration );
+static int SetupEvents( VarMsgState *pState );
+static void ReadSignals( int fd, uint32_t events, void *arg );
+static int AddModified( VarMsgState *pState, VAR_HANDLE hVar );
+static void ReadTimer( int fd, uint32_t events, void *arg );
+static int SetupTimer( VarMsgState *pState );
+static int UpdateTimer( VarMsgState *pState );
+static int SetupFlush( VarMsgState *pState );
+static void ReadFlush( int fd, uint32_t events, void *arg );
+static void ScheduleFlush( VarMsgState *pState );
+static int SetupWatch( VarMsgState *pState );
+static void ReadWatch( int fd, uint32_t events, void *arg );
+static int AddReload( VarMsgState *pState, char *name );
+static int ScheduleInterval( VarMsgState *pState,
+                             VarMsgConfig *pConfig,
+                             uint64_t now );
+static int StartSchedule( VarMsgState *pState );
+static void StaggerMessages( VarMsgState *pState );
+static void StaggerInterval( VarMsgState *pState, uint32_t interval );
 static int SetupModifiedTrigger( VarMsgState *pState, VarMsgConfig *pConfig );
 static int varmsg_CacheNotify( VAR_HANDLE hVar, void *arg );
+static int IndexVar( VarMsgState *pState,
+                     VarMsgConfig *pConfig,
+                     VAR_HANDLE hVar,
+                     VarRole role,
+                     size_t idx );
+static int UnindexVar( VarMsgState *pState,
+                       VarMsgConfig *pConfig,
+                       VAR_HANDLE hVar,
+                       VarRole role );
+static VarIndexEntry *FindIndexEntry( VarMsgState *pState,
+                                      VarMsgConfig *pConfig,
+                                      VAR_HANDLE hVar,
+                                      VarRole role );
+static int ParseRescan( VarMsgState *pState,
+                        JNode *pNode,
+                        VarMsgConfig *pConfig );
+static int SetupRescan( VarMsgState *pState, VarMsgConfig *pConfig );
+static int RescanMessage( VarMsgState *pState, VarMsgConfig *pConfig );
+static int RescanTriggers( VarMsgState *pState, VarMsgConfig *pConfig );
+static int RescanBody( VarMsgState *pState, VarMsgConfig *pConfig );
+static int RunQuery( VarMsgState *pState,
+                     VarQuery *pQuery,
+                     VarCache **ppVarCache,
+                     VarIndex *pFound );
 
 static void RunMessageGenerator( VarMsgState *pState );
 static int ProcessTimer( VarMsgState *pState );
 static int ProcessModified( VarMsgState *pState, VAR_HANDLE hVar );
+static int ProcessEnable( VarMsgState *pState, VarMsgConfig *pConfig );
+static int TriggerMessage( VarMsgState *pState, VarMsgConfig *pConfig );
+static uint64_t GetTimeMs( void );
+static uint64_t GetTimeUs( void );
+static int SetupStats( VarMsgState *pState );
+static void PublishStats( VarMsgState *pState );
+static void PublishCounter( VarMsgState *pState,
+                            VAR_HANDLE hVar,
+                            VarType type,
+                            uint64_t value,
+                            uint64_t published );
+static int PublishGlobalStats( VarMsgState *pState );
+static int SetupShed( VarMsgState *pState );
+static int CreateGlobalVar( VarMsgState *pState,
+                            char *name,
+                            VarObject *pObj,
+                            VAR_HANDLE *pVarHandle );
+static void UpdateShed( VarMsgState *pState, uint64_t now );
+static int ProcessShedOverride( VarMsgState *pState );
+static void PublishShed( VarMsgState *pState );
 static int ProcessMessage( VarMsgState *pState, VarMsgConfig *pMsgConfig );
-static int RenderMessage( VarMsgState *pState, VarMsgConfig *pMsg, int fd );
-static int OutputVar( VAR_HANDLE hVar, void *arg );
-static int OutputJSONVar( char prefix, VarInfo *info, char *value, int fd );
-static bool IsJSON( char *value );
+static int SetupOutQ( VarMsgState *pState );
+static int SetupWorkers( VarMsgState *pState );
+static void StopWorkers( VarMsgState *pState );
+static void *RenderWorker( void *arg );
+static void QueueMessage( VarMsgState *pState, VarMsgConfig *pMsgConfig );
+static void DispatchMessages( VarMsgState *pState );
+static int GenerateMessage( VarMsgState *pState,
+                            RenderContext *pCtx,
+                            VarMsgConfig *pMsgConfig );
+static int RenderMessage( RenderContext *pCtx, VarMsgConfig *pMsg );
+static int RenderBody( RenderContext *pCtx,
+                       VarMsgConfig *pMsg,
+                       MsgBuf *pMsgBuf,
+                       bool *pComplete );
+static int OutputVar( RenderContext *pCtx,
+                      VarMetaTable *pTable,
+                      VarMeta *pMeta );
+static int OutputTemplate( RenderContext *pCtx,
+                           MsgTemplate *pTmpl,
+                           size_t start,
+                           size_t end );
+static int OutputTemplateVar( RenderContext *pCtx, MsgTmplPart *pPart );
+static int OutputCachedVar( RenderContext *pCtx,
+                            VarMetaTable *pTable,
+                            VarMeta *pMeta,
+                            char prefix,
+                            uint32_t tag );
+static int OutputPrintedVar( RenderContext *pCtx,
+                             VarMetaTable *pTable,
+                             VarMeta *pMeta,
+                             char prefix );
+static int OutputTypedVar( RenderContext *pCtx,
+                           VarMetaTable *pTable,
+                           VarMeta *pMeta,
+                           char prefix );
+static bool IsTypedVar( VarInfo *info );
+static size_t FormatValue( VarObject *obj, char *buf );
+static int OutputJSONVar( char prefix,
+                          const char *key,
+                          size_t keylen,
+                          char *value,
+                          MsgBuf *pMsgBuf );
+static int OutputCBORVar( MsgBuf *pMsgBuf,
+                          VarMetaTable *pTable,
+                          VarMeta *pMeta,
+                          VarObject *obj );
+static int OutputCBORText( MsgBuf *pMsgBuf,
+                           VarMetaTable *pTable,
+                           VarMeta *pMeta,
+                           char *value );
 
 static int SetEnableStatus( VarMsgState *pState, VarMsgConfig *pConfig );
 static int SetupMessageVars( VarMsgState *pState, VarMsgConfig *pConfig );
@@ -324,6 +1233,7 @@ VAR_HANDLE SetupMessageVar( VarMsgState *pState,
                             VarMsgConfig *pConfig,
                             char *name,
                             uint32_t flags,
+                            VarType type,
                             NotificationType notify );
 static int MakeVarName( char *prefix,
                         char *name,
@@ -368,7 +1278,43 @@ int main(int argc, char **argv)
     SetupTerminationHandler();
 
     /* initialize a memory buffer for output */
-    result = SetupVarFP( &state );
+    result = SetupVarFP( &state.render, 0 );
+    if ( result == EOK )
+    {
+        /* initialize the message assembly buffer */
+        result = MSGBUF_Init( &state.render.msgbuf, MSGBUF_SIZE );
+    }
+
+    if ( result == EOK )
+    {
+        /* initialize the per-cycle value cache */
+        result = VALCACHE_Init( &state.render.values, VALCACHE_SIZE );
+    }
+
+    if ( result == EOK )
+    {
+        /* initialize the modified notification index */
+        result = VARINDEX_Init( &state.index, VARINDEX_SIZE );
+    }
+
+    if ( result == EOK )
+    {
+        /* initialize the message schedule */
+        result = SCHED_Init( &state.sched, SCHED_SIZE );
+    }
+
+    if ( result == EOK )
+    {
+        /* initialize the message scheduling state table */
+        result = MSGTABLE_Init( &state.msgs, MSGTABLE_SIZE );
+    }
+
+    if ( result == EOK )
+    {
+        /* set up the event loop before any notification can arrive */
+        result = SetupEvents( &state );
+    }
+
     if ( result == EOK )
     {
         /* open a handle to the variable server */
@@ -376,6 +1322,8 @@ int main(int argc, char **argv)
         if( hVarServer != NULL )
         {
             state.hVarServer = hVarServer;
+            state.render.hVarServer = hVarServer;
+            state.render.pState = &state;
 
             if ( state.pConfigDir != NULL )
             {
@@ -388,6 +1336,15 @@ int main(int argc, char **argv)
                 result = ProcessConfigFile( &state, state.pConfigFile );
             }
 
+            /* run the variable queries and set up the messages */
+            SetupConfigs( &state );
+
+            /* create the global statistics variable */
+            SetupStats( &state );
+
+            /* create the load shedding variables */
+            SetupShed( &state );
+
             if ( state.numMsgs == 0 )
             {
                 fprintf( stderr,
@@ -395,17 +1352,96 @@ int main(int argc, char **argv)
                 usage( argv[0] );
             }
 
-            if ( SetupTimer(1) == EOK )
+            /* schedule the interval messages */
+            StartSchedule( &state );
+
+            /* start the sink writer */
+            result = SetupOutQ( &state );
+
+            if ( result == EOK )
+            {
+                /* start the render workers */
+                result = SetupWorkers( &state );
+            }
+
+            if ( ( result == EOK ) &&
+                 ( SetupWatch( &state ) != EOK ) )
+            {
+                /* the messages run without the configuration reload */
+                fprintf( stderr,
+                         "VARMSG: cannot watch %s\n",
+                         state.pConfigDir );
+            }
+
+            if ( ( result == EOK ) &&
+                 ( SetupFlush( &state ) != EOK ) )
+            {
+                /* flush retries are only scheduled by the main thread */
+                fprintf( stderr,
+                         "VARMSG: cannot set up the sink flush retries\n" );
+            }
+
+            if ( ( result == EOK ) &&
+                 ( SetupTimer( &state ) == EOK ) )
             {
                 RunMessageGenerator( &state );
             }
 
+            /* stop the render workers and release their resources */
+            StopWorkers( &state );
+
             /* close the handle to the variable server */
             VARSERVER_Close( hVarServer );
         }
 
         /* close the output memory buffer */
-        VARFP_Close( state.pVarFP );
+        VARFP_Close( state.render.pVarFP );
+
+        /* release the message assembly buffer */
+        MSGBUF_Free( &state.render.msgbuf );
+
+        /* release the per-cycle value cache */
+        VALCACHE_Free( &state.render.values );
+
+        /* release the global statistics buffers */
+        MSGBUF_Free( &state.stats );
+        MSGBUF_Free( &state.statsPublished );
+
+        /* release the modified notification index */
+        VARINDEX_Free( &state.index );
+
+        /* release the message schedule */
+        SCHED_Free( &state.sched );
+
+        /* release the message scheduling state table */
+        MSGTABLE_Free( &state.msgs );
+
+        /* release the event loop and its event sources */
+        EVLOOP_Free( &state.loop );
+        close( state.sigFd );
+        if ( state.timerFd != -1 )
+        {
+            close( state.timerFd );
+        }
+
+        if ( state.watchFd != -1 )
+        {
+            close( state.watchFd );
+        }
+
+        if ( state.flushFd != -1 )
+        {
+            SINK_SetNotify( -1 );
+            close( state.flushFd );
+        }
+
+        MSGBUF_Free( &state.reloads );
+
+        VALCACHE_Free( &state.modifiedSet );
+        free( state.pModified );
+
+        /* flush and close the message outputs */
+        SINK_CloseAll();
     }
 
     return ( result == EOK ) ? 0 : 1;
@@ -431,9 +1467,18 @@ static void usage( char *cmdname )
     if( cmdname != NULL )
     {
         fprintf(stderr,
-                "usage: %s [-v] [-h] [-f config file] [-d config dir]\n"
+                "usage: %s [-v] [-h] [-s] [-j workers] [-q depth] "
+                "[-p policy] [-b budget]\n"
+                " [-f config file] [-d config dir]\n"
                 " [-h] : display this help\n"
                 " [-v] : verbose output\n"
+                " [-s] : stagger interval messages across their interval\n"
+                " [-j] : number of render worker threads (default 0)\n"
+                " [-q] : output queue depth (default 0, no queue)\n"
+                " [-p] : full output queue policy: block, drop-oldest,\n"
+                "        drop-newest (default block)\n"
+                " [-b] : render time budget per second, such as 200ms.\n"
+                "        Low priority messages are shed while it is exceeded\n"
                 " [-f] : specify the configuration file for a single message\n"
                 " [-d] : specify a configuration directory with many configs\n",
                 cmdname );
@@ -468,7 +1513,8 @@ static int ProcessOptions( int argC, char *argV[], VarMsgState *pState )
 {
     int c;
     int result = EINVAL;
-    const char *options = "hvf:d:";
+    const char *options = "hvsj:q:p:b:f:d:";
+    uint32_t budget;
 
     if( ( pState != NULL ) &&
         ( argV != NULL ) )
@@ -485,11 +1531,46 @@ static int ProcessOptions( int argC, char *argV[], VarMsgState *pState )
                     usage( argV[0] );
                     break;
 
-                case 'f':
-                    pState->pConfigFile = strdup(optarg);
+                case 's':
+                    pState->stagger = true;
                     break;
 
-                case 'd':
+                case 'j':
+                    pState->numWorkers = strtoul( optarg, NULL, 0 );
+                    if ( pState->numWorkers > MAX_WORKERS )
+                    {
+                        pState->numWorkers = MAX_WORKERS;
+                    }
+                    break;
+
+                case 'q':
+                    pState->queueDepth = strtoul( optarg, NULL, 0 );
+                    break;
+
+                case 'p':
+                    if ( OUTQ_ParsePolicy( optarg,
+                                           &pState->queuePolicy ) != EOK )
+                    {
+                        fprintf( stderr, "Invalid queue policy: %s\n", optarg );
+                    }
+                    break;
+
+                case 'b':
+                    if ( ParseDuration( optarg, &budget ) == EOK )
+                    {
+                        pState->budget = budget * 1000;
+                    }
+                    else
+                    {
+                        fprintf( stderr, "Invalid budget: %s\n", optarg );
+                    }
+                    break;
+
+                case 'f':
+                    pState->pConfigFile = strdup(optarg);
+                    break;
+
+                case 'd':
                     pState->pConfigDir = strdup(optarg);
                     break;
 
@@ -510,41 +1591,48 @@ static int ProcessOptions( int argC, char *argV[], VarMsgState *pState )
 
     The SetupVarFP function sets up a shared memory buffer backed by an
     output stream to allow us to render variables (possibly from other
-    processes) into a memory buffer.
+    processes) into a memory buffer.  Each render context has its own
+    output stream, named using the process id and the context id.
 
     @param[in]
-        pState
-            pointer to the Variable Message State object to initialize
+        pCtx
+            pointer to the render context to initialize
+
+    @param[in]
+        id
+            identifier of the render context
 
     @retval EOK the Variable Message rendering buffer was created
     @retval EBADF failed to create the memory buffer
     @retval EINVAL invalid arguments
 
 ==============================================================================*/
-static int SetupVarFP( VarMsgState *pState )
+static int SetupVarFP( RenderContext *pCtx, int id )
 {
     int result = EINVAL;
     char varfp_name[64];
-    time_t now;
     int n;
     size_t len = sizeof(varfp_name);
 
-    if ( pState != NULL )
+    if ( pCtx != NULL )
     {
         result = EBADF;
 
-        /* generate a temporary name for the VarFP */
-        now = time(NULL);
-        n = snprintf(varfp_name, sizeof(varfp_name), "varmsg_%ld", now );
+        /* generate a unique name for the VarFP */
+        n = snprintf( varfp_name,
+                      sizeof(varfp_name),
+                      "varmsg_%d_%d",
+                      (int)getpid(),
+                      id );
         if ( ( n > 0 ) && ( (size_t)n < len ) )
         {
             /* open a VarFP object for printing */
-            pState->pVarFP = VARFP_Open(varfp_name, VARFP_SIZE );
-            if ( pState->pVarFP != NULL )
+            pCtx->pVarFP = VARFP_Open(varfp_name, VARFP_SIZE );
+            if ( pCtx->pVarFP != NULL )
             {
                 /* get a file descriptor for the memory buffer */
-                pState->varFd = VARFP_GetFd( pState->pVarFP );
-                if ( pState->varFd != -1 )
+                pCtx->varFd = VARFP_GetFd( pCtx->pVarFP );
+                if ( pCtx->varFd != -1 )
                 {
                     result = EOK;
                 }
@@ -561,7 +1649,8 @@ static int SetupVarFP( VarMsgState *pState )
     Process a configuration directory containing one or more configuration files
 
     The ProcessConfigDir processes the specified configuration directory
-    by iterating through and processing each configuration file.
+    by iterating through and processing each configuration file.  Hidden
+    files, including the . and .. entries, are skipped.
 
     @param[in]
         pState
@@ -574,6 +1663,8 @@ static int SetupVarFP( VarMsgState *pState )
 
     @retval EINVAL invalid arguments
     @retval EOK the directory was processed successfully
+    @retval ENOENT the directory could not be opened
+    @retval other error from the last file which could not be loaded
 
 ==============================================================================*/
 static int ProcessConfigDir( VarMsgState *pState, char *pDirname )
@@ -581,6 +1672,9 @@ static int ProcessConfigDir( VarMsgState *pState, char *pDirname )
     int result = EINVAL;
     DIR *configdir = NULL;
     struct dirent *entry;
+    char path[PATH_MAX];
+    int n;
+    int rc;
 
     if ( ( pState != NULL ) &&
          ( pDirname != NULL ) )
@@ -597,12 +1691,39 @@ static int ProcessConfigDir( VarMsgState *pState, char *pDirname )
         {
             while( entry = readdir( configdir ) )
             {
-                /* process configuration file */
-                ProcessConfigFile( pState, entry->d_name );
+                /* skip hidden files and the directory entries */
+                if ( entry->d_name[0] != '.' )
+                {
+                    n = snprintf( path,
+                                  sizeof( path ),
+                                  "%s/%s",
+                                  pDirname,
+                                  entry->d_name );
+                    if ( ( n > 0 ) && ( (size_t)n < sizeof( path ) ) )
+                    {
+                        /* process configuration file.  A file which
+                           cannot be loaded does not stop the others */
+                        rc = ProcessConfigFile( pState, path );
+                    }
+                    else
+                    {
+                        rc = ENAMETOOLONG;
+                    }
+
+                    if ( rc != EOK )
+                    {
+                        result = rc;
+                    }
+                }
             }
 
             closedir( configdir );
         }
+        else
+        {
+            fprintf( stderr, "VARMSG: cannot open %s\n", pDirname );
+            result = ENOENT;
+        }
     }
 
     return result;
@@ -616,6 +1737,18 @@ static int ProcessConfigDir( VarMsgState *pState, char *pDirname )
     The ProcessConfigFile function processes a configuration file
     consisting of lines of directives and variable assignments.
 
+    The message settings are parsed, the message output is opened, and
+    the trigger and body variable queries are built.  The queries are
+    not run until all of the configuration files have been loaded, so
+    identical queries from different configurations are only run once.
+    See SetupConfigs.
+
+    A configuration which cannot be sent, for example because it has an
+    unsupported format or mode, or its output cannot be opened, is
+    released and is not added to the message list.  Body and trigger
+    variables which do not exist, and a message template which cannot
+    be loaded, are left out of the message.
+
     @param[in]
         pState
             pointer to the Variable Message Generator state
@@ -625,8 +1758,11 @@ static int ProcessConfigDir( VarMsgState *pState, char *pDirname )
             pointer to the name of the file to load
 
     @retval EINVAL invalid arguments
-    @retval EOK file processed ok
-    @retval other error as returned by ProcessConfigData
+    @retval EOK file processed ok, and the message was added to the
+                message list
+    @retval EBADMSG the file could not be parsed
+    @retval ENOMEM memory allocation failure
+    @retval other error from the message settings or the output
 
 ==============================================================================*/
 static int ProcessConfigFile( VarMsgState *pState, char *filename )
@@ -634,8 +1770,11 @@ static int ProcessConfigFile( VarMsgState *pState, char *filename )
     int result = EINVAL;
     char *pFileName = NULL;
     JNode *config;
-    VarMsgConfig *pConfig;
+    VarMsgConfig *pConfig = NULL;
+    Arena *pArena;
+    MsgTable *pMsgs;
     JNode *node;
+    int n;
 
     if ( filename != NULL )
     {
@@ -654,210 +1793,304 @@ static int ProcessConfigFile( VarMsgState *pState, char *filename )
         config = JSON_Process( pFileName );
         if ( config != NULL )
         {
-            /* allocate a VarMsgConfig object */
-            pConfig = calloc( 1, sizeof( VarMsgConfig ) );
+            /* allocate a VarMsgConfig object from a new configuration
+               arena, along with its name and its message body */
+            pArena = ARENA_Create( CONFIG_ARENA_SIZE );
+            pConfig = ARENA_Calloc( pArena, 1, sizeof( VarMsgConfig ) );
             if ( pConfig != NULL )
             {
-                /* set the configuration name */
-                pConfig->configName = pFileName;
+                pConfig->pArena = pArena;
+                pConfig->configName = ARENA_StrDup( pArena, pFileName );
+                pConfig->pBody = CreateBody();
+                if ( ( pConfig->configName == NULL ) ||
+                     ( pConfig->pBody == NULL ) )
+                {
+                    FreeBody( pConfig->pBody );
+                    pConfig = NULL;
+                }
+            }
+
+            /* assign the message its entry in the message table */
+            pMsgs = &pState->msgs;
+            if ( ( pConfig != NULL ) &&
+                 ( MSGTABLE_Add( pMsgs, pConfig, &pConfig->id ) != EOK ) )
+            {
+                FreeBody( pConfig->pBody );
+                pConfig = NULL;
+            }
+
+            if ( pConfig == NULL )
+            {
+                ARENA_Free( pArena );
+                result = ENOMEM;
+            }
+            else
+            {
+                /* record the file content so a reload can detect
+                   whether the configuration has changed */
+                ReadDigest( pConfig->configName, &pConfig->digest );
 
                 /* check enabled flag */
-                pConfig->enabled = JSON_GetBool( config, "enabled" );
+                pMsgs->pEnabled[pConfig->id] = JSON_GetBool( config,
+                                                             "enabled" );
 
                 /* get variable prefix */
-                pConfig->prefix = JSON_GetStr( config, "prefix" );
+                pConfig->prefix = ARENA_StrDup( pArena,
+                                                JSON_GetStr( config,
+                                                             "prefix" ) );
+
+                /* in-process value formatting is on by default, but can
+                   be turned off for messages containing variables with
+                   custom print handlers */
+                pConfig->fastpath = true;
+                if ( JSON_Find( config, "fastpath" ) != NULL )
+                {
+                    pConfig->fastpath = JSON_GetBool( config, "fastpath" );
+                }
+
+                /* get the message encoding */
+                result = ParseFormat( JSON_GetStr( config, "format" ),
+                                      &pConfig->format );
+
+                if ( result == EOK )
+                {
+                    /* get the full or delta message mode */
+                    result = ParseMode( config, pConfig );
+                }
 
-                /* get processing interval */
-                JSON_GetNum( config, "interval", &pConfig->interval );
-                if ( pConfig->interval != 0 )
+                if ( result == EOK )
                 {
-                    /* initialize the countdown timer */
-                    pConfig->t = pConfig->interval;
+                    /* load the message template.  A message whose
+                       template cannot be loaded is sent without it */
+                    LoadTemplate( config, pConfig );
+
+                    /* get processing interval */
+                    SCHED_InitItem( &pConfig->intervalItem,
+                                    SCHED_TYPE_INTERVAL,
+                                    pConfig );
+                    SCHED_InitItem( &pConfig->pendingItem,
+                                    SCHED_TYPE_PENDING,
+                                    pConfig );
+                    SCHED_InitItem( &pConfig->rescanItem,
+                                    SCHED_TYPE_RESCAN,
+                                    pConfig );
+                    result = ParseTime( config,
+                                        "interval",
+                                        &pMsgs->pInterval[pConfig->id] );
+                    if ( result == ENOENT )
+                    {
+                        /* not an interval message */
+                        result = EOK;
+                    }
                 }
 
-                /* process trigger variables */
-                result = ProcessTriggerConfig( pState, config, pConfig );
+                if ( result == EOK )
+                {
+                    /* get the offset of the interval messages */
+                    if ( ParseTime( config,
+                                    "phase",
+                                    &pConfig->phase ) == EOK )
+                    {
+                        pConfig->phaseSet = true;
+                    }
+
+                    /* get the trigger coalescing windows */
+                    if ( ( JSON_GetNum( config,
+                                        "min_interval_ms",
+                                        &n ) == EOK ) &&
+                         ( n > 0 ) )
+                    {
+                        pMsgs->pMinInterval[pConfig->id] = n;
+                    }
+
+                    if ( ( JSON_GetNum( config, "debounce_ms", &n ) == EOK ) &&
+                         ( n > 0 ) )
+                    {
+                        pMsgs->pDebounce[pConfig->id] = n;
+                    }
+
+                    /* get the load shedding priority */
+                    if ( ( JSON_GetNum( config, "priority", &n ) == EOK ) &&
+                         ( n > 0 ) )
+                    {
+                        pMsgs->pPriority[pConfig->id] = n;
+                    }
 
-                /* process message body variables */
-                result = ProcessVarsConfig( pState, config, pConfig );
+                    /* get the automatic variable query rescans */
+                    result = ParseRescan( pState, config, pConfig );
+                }
 
-                /* set up the variables which will trigger a message
-                   generation when they are modified */
-                result = SetupModifiedTrigger( pState, pConfig );
+                if ( result == EOK )
+                {
+                    /* open the message output */
+                    result = SetupOutput( pState, config, pConfig );
+                }
 
-                /* set up the message variables */
-                result = SetupMessageVars( pState, pConfig );
+                if ( result == EOK )
+                {
+                    /* process trigger variables.  Listed variables which
+                       do not exist are left out of the trigger */
+                    result = ProcessTriggerConfig( pState, config, pConfig );
+                    if ( result == ENOENT )
+                    {
+                        result = EOK;
+                    }
+                }
 
-                /* set the enable status */
-                result = SetEnableStatus( pState, pConfig );
+                if ( result == EOK )
+                {
+                    /* process message body variables.  Listed variables
+                       which do not exist are left out of the message */
+                    result = ProcessVarsConfig( pState, config, pConfig );
+                    if ( result == ENOENT )
+                    {
+                        result = EOK;
+                    }
+                }
 
-                /* increment the number of messages we are handling */
-                pState->numMsgs++;
+                /* the rest of the message is set up by SetupConfig
+                   once all of the configurations have been loaded.
+                   Everything it needs has been copied out of the
+                   parsed configuration */
 
-                if ( pState->pMessageConfigs == NULL )
+                if ( result == EOK )
                 {
-                    /* add the first configuration */
-                    pState->pMessageConfigs = pConfig;
+                    /* increment the number of messages we are handling */
+                    pState->numMsgs++;
+
+                    if ( pState->pMessageConfigs == NULL )
+                    {
+                        /* add the first configuration */
+                        pState->pMessageConfigs = pConfig;
+                    }
+                    else
+                    {
+                        /* insert the new configuration at the head of
+                           the list */
+                        pConfig->pNext = pState->pMessageConfigs;
+                        pState->pMessageConfigs = pConfig;
+                    }
                 }
                 else
                 {
-                    /* insert the new configuration at the head of the list */
-                    pConfig->pNext = pState->pMessageConfigs;
-                    pState->pMessageConfigs = pConfig;
+                    fprintf( stderr,
+                             "VARMSG: cannot load %s: %s\n",
+                             pFileName,
+                             strerror( result ) );
+
+                    /* a message which cannot be sent is not set up */
+                    FreeConfig( pState, pConfig );
                 }
             }
+
+            /* release the parse tree as soon as the file is loaded */
+            JSON_Free( config );
+        }
+        else
+        {
+            fprintf( stderr, "VARMSG: cannot parse %s\n", pFileName );
+            result = EBADMSG;
         }
     }
 
+    free( pFileName );
+
     return result;
 }
 
 /*============================================================================*/
-/*  ProcessTriggerConfig                                                      */
+/*  FreeConfig                                                                */
 /*!
-    Process the "trigger" configuration in the JSON config file
-
-    The ProcessTriggerConfig function processes a "trigger" configuration
-    attribute in the JSON configuration object.  The trigger can either be
-    an explicit list of variables, or a variable search definition object.
-
-    This function will parse the trigger definition and build the
-    triggerQuery VarQuery object if the trigger is a search
-    definition.
-
-    It will also run the search and populate the trigger cache
-    if the trigger is a search definition.
+    Release a message configuration
 
-    If the trigger is an explicit variable list, then the handle of each
-    variable will be added to the trigger cache.
+    The FreeConfig function releases the message table entry, the output,
+    the message body and the other resources of a message configuration,
+    and then its arena.  The message must not be in the message list,
+    the schedule or the variable index, and its output must not be
+    referred to by the output queue.  The output and the message body
+    are only released if no other message shares them.
 
     @param[in]
         pState
             pointer to the Variable Message Generator state
 
     @param[in]
-        pNode
-            pointer to the JNode for the trigger configuration
-
-    @param[in,out]
         pConfig
-            pointer to the VarMsgConfig message definition to populate
-
-    @retval EINVAL invalid arguments
-    @retval EOK trigger configuration was processed or not specified
-    @retval ENOENT one or more variables did not exist
-    @retval ENOMEM memory allocation failure
+            pointer to the variable message configuration to release
 
 ==============================================================================*/
-static int ProcessTriggerConfig( VarMsgState *pState,
-                                 JNode *pNode,
-                                 VarMsgConfig *pConfig )
+static void FreeConfig( VarMsgState *pState, VarMsgConfig *pConfig )
 {
-    int result = EINVAL;
-    JNode *trigger;
-
     if ( ( pState != NULL ) &&
-         ( pNode != NULL ) &&
          ( pConfig != NULL ) )
     {
-        /* process trigger variables */
-        trigger = JSON_Find( pNode, "trigger" );
-        if ( trigger != NULL )
-        {
-            if ( trigger->type == JSON_OBJECT )
-            {
-                /* process a variable query */
-                result = ProcessQuery( pState->hVarServer,
-                                       (JObject *)trigger,
-                                       &(pConfig->triggerQuery),
-                                       &(pConfig->pTriggerCache) );
-            }
-            else if ( trigger->type == JSON_ARRAY )
-            {
-                /* process a variable list */
-                result = ProcessVarList( (JArray *)trigger,
-                                         &(pConfig->pTriggerCache) );
-            }
-        }
-        else
+        MSGTABLE_Remove( &pState->msgs, pConfig->id );
+
+        SINK_Close( pConfig->pSink );
+        FreeBody( pConfig->pBody );
+
+        if ( pConfig->pTriggerCache != NULL )
         {
-            /* trigger configuration is optional since we might just
-               be doing a timed message generation */
-            result = EOK;
+            VARCACHE_Free( pConfig->pTriggerCache );
         }
-    }
 
-    return result;
+        free( pConfig->pDirty );
+
+        /* release the configuration object, its strings and its
+           template */
+        ARENA_Free( pConfig->pArena );
+    }
 }
 
 /*============================================================================*/
-/*  ProcessVarsConfig                                                         */
+/*  SetupConfigs                                                              */
 /*!
-    Process the "vars" configuration in the JSON config file
-
-    The ProcessTriggerConfig function processes a "vars" configuration
-    attribute in the JSON configuration object.  The vars can either be
-    an explicit list of variables, or a variable search definition object.
+    Set up all of the loaded message configurations
 
-    This function will parse the vars definition and build the
-    varSet VarQuery object if the vars attribute is a search
-    definition.
-
-    It will also run the search and populate the vars cache
-    if the vars attribute is a search definition.
-
-    If the vars attribute is an explicit variable list, then the handle of each
-    variable will be added to the vars cache.
+    The SetupConfigs function is called once all of the configuration
+    files have been loaded.  It runs the variable queries of all of the
+    configurations, finds the messages which can share a message body,
+    and then sets up each message.  A configuration which failed to load
+    was never added to the message list, so it is not queried, shared
+    or scheduled.
 
     @param[in]
         pState
             pointer to the Variable Message Generator state
 
-    @param[in]
-        pNode
-            pointer to the JNode for the trigger configuration
-
-    @param[in,out]
-        pConfig
-            pointer to the VarMsgConfig message definition to populate
-
+    @retval EOK all of the messages were set up
     @retval EINVAL invalid arguments
-    @retval EOK trigger configuration was processed or not specified
-    @retval ENOENT one or more variables did not exist
-    @retval ENOMEM memory allocation failure
+    @retval other error from RunQueries or SetupConfig
 
 ==============================================================================*/
-static int ProcessVarsConfig( VarMsgState *pState,
-                              JNode *pNode,
-                              VarMsgConfig *pConfig )
+static int SetupConfigs( VarMsgState *pState )
 {
     int result = EINVAL;
-    JNode *vars;
+    VarMsgConfig *pConfig;
+    int rc;
 
-    if ( ( pState != NULL ) &&
-         ( pNode != NULL ) &&
-         ( pConfig != NULL ) )
+    if ( pState != NULL )
     {
-        result = ENOENT;
+        /* run the trigger and body variable queries */
+        result = RunQueries( pState );
 
-        /* process message body variables */
-        vars = JSON_Find( pNode, "vars" );
-        if ( vars != NULL )
+        /* let messages with identical bodies share them */
+        ShareBodies( pState );
+
+        pConfig = pState->pMessageConfigs;
+        while ( pConfig != NULL )
         {
-            if ( vars->type == JSON_OBJECT )
-            {
-                /* process a variable query */
-                result = ProcessQuery( pState->hVarServer,
-                                       (JObject *)vars,
-                                       &(pConfig->varSet),
-                                       &(pConfig->pVarCache) );
-            }
-            else if ( vars->type == JSON_ARRAY )
+            rc = SetupConfig( pState, pConfig );
+            if ( rc != EOK )
             {
-                /* process a variable list */
-                result = ProcessVarList( (JArray *)vars,
-                                         &(pConfig->pVarCache) );
+                fprintf( stderr,
+                         "VARMSG: cannot set up %s: %s\n",
+                         pConfig->configName,
+                         strerror( rc ) );
+                result = rc;
             }
+
+            pConfig = pConfig->pNext;
         }
     }
 
@@ -865,152 +2098,233 @@ static int ProcessVarsConfig( VarMsgState *pState,
 }
 
 /*============================================================================*/
-/*  ParseOutputType                                                           */
+/*  SetupConfig                                                               */
 /*!
-    Parse the output type string
+    Set up a message configuration
 
-    The ParseOutputType function processes the specified output type string
-    and converts it into a MsgOutputType enum.  If an invalid string
-    is specified, the output type will be silently set to VARMSG_OUTPUT_DISABLED
+    The SetupConfig function completes the set up of a message once its
+    variable caches have been populated.  It builds the body variable
+    information table, sets up delta mode and the modified triggers,
+    and creates the message control and status variables.  Every step
+    is attempted, and the first error is returned.
 
     @param[in]
-        outputtype
-            pointer to a NUL terminated output type string
+        pState
+            pointer to the Variable Message Generator state
 
-    @retval the corresponding output type enumeration value.
+    @param[in]
+        pConfig
+            pointer to the variable message configuration
+
+    @retval EOK the message was set up
+    @retval EINVAL invalid arguments
+    @retval other error from the message set up functions
 
 ==============================================================================*/
-static MsgOutputType ParseOutputType( char *outputtype )
+static int SetupConfig( VarMsgState *pState, VarMsgConfig *pConfig )
 {
-    int i = 0;
-    int n = sizeof(outputTypes)/sizeof(outputTypes[0]);
-    MsgOutputType outputType = VARMSG_OUTPUT_DISABLED;
-    const char *type;
+    int result = EINVAL;
+    int rc;
 
-    if ( outputtype != NULL )
+    if ( ( pState != NULL ) &&
+         ( pConfig != NULL ) )
     {
-        /* get the first output type */
-        type = outputTypes[i];
-        while ( type != NULL )
+        /* cache the message body variable information.  A shared
+           body is only built by the first message which uses it */
+        result = EOK;
+        if ( pConfig->pBody->meta.pMeta == NULL )
         {
-            if ( strcmp(type, outputtype ) == 0 )
-            {
-                outputType = (MsgOutputType)i;
-                break;
-            }
+            result = BuildVarMeta( pConfig );
+        }
 
-            type = outputTypes[++i];
+        if ( result == EOK )
+        {
+            /* set up change tracking for delta messages */
+            result = SetupDeltaMode( pState, pConfig );
         }
-    }
 
-    return outputType;
-}
+        /* set up the variables which will trigger a message
+           generation when they are modified */
+        rc = SetupModifiedTrigger( pState, pConfig );
+        if ( result == EOK )
+        {
+            result = rc;
+        }
 
-/*============================================================================*/
-/*  BuildQuery                                                              */
-/*!
-    Build a Variable Query object from a JSON configuration
+        /* set up the message variables */
+        rc = SetupMessageVars( pState, pConfig );
+        if ( result == EOK )
+        {
+            result = rc;
+        }
 
-    The BuildQuery function processes a variable query JSON object
-    which specifies the variable search parameters used to generate
-    a list of variables to process.
+        /* find the message template variables.  The slot of a template
+           variable which does not exist is left empty */
+        rc = ResolveTemplate( pState, pConfig );
+        if ( ( result == EOK ) &&
+             ( rc != ENOENT ) )
+        {
+            result = rc;
+        }
 
-    A JSON variable query can have one or more of the following attributes:
+        /* set up the automatic variable query rescans */
+        rc = SetupRescan( pState, pConfig );
+        if ( result == EOK )
+        {
+            result = rc;
+        }
 
-    instanceID - instance identifier
-    match - partial name string match
-    flags - flags match ( comma separated list of flags to search for )
-    tags - tags match ( comma separated list of tags to search for )
+        /* set the enable status */
+        rc = SetEnableStatus( pState, pConfig );
+        if ( result == EOK )
+        {
+            result = rc;
+        }
+    }
 
-    @param[in]
-        config
-            pointer to a JSON Object containing variable query
-            parameters
+    return result;
+}
 
-    @param[in,out]
-        query
-            pointer to a Variable Query object to populate
+/*============================================================================*/
+/*  RunQueries                                                                */
+/*!
+    Run the variable queries of all of the message configurations
 
-    @retval EOK the variable query was successfully processed
+    The RunQueries function populates the trigger and body variable
+    caches of every configuration which uses a variable query.  Each
+    distinct query is only run once, and configurations which use an
+    identical query get a copy of its result, so a large number of
+    configurations using the same query spec do not each traverse the
+    variable server.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @retval EOK the queries were run
     @retval EINVAL invalid arguments
+    @retval other error from RunSharedQuery
 
 ==============================================================================*/
-static int BuildQuery( JObject *config, VarQuery *query )
+static int RunQueries( VarMsgState *pState )
 {
     int result = EINVAL;
-    JNode *pNode;
-    char *tags;
-    char *match;
-    char *flags;
-    size_t len;
+    QueryResult *pResults = NULL;
+    QueryResult *pResult;
+    VarMsgConfig *pConfig;
+    size_t distinct = 0;
+    size_t total = 0;
+    int rc;
 
-    if ( ( config != NULL ) &&
-         ( config->node.type == JSON_OBJECT ) &&
-         ( query != NULL ) )
+    if ( pState != NULL )
     {
         result = EOK;
 
-        query->type = 0;
-
-        /* get a pointer to the JSON node */
-        pNode = &(config->node);
-
-        /* see if we are doing a tags search */
-        tags = JSON_GetStr( pNode, "tags" );
-        if ( tags != NULL )
+        pConfig = pState->pMessageConfigs;
+        while ( pConfig != NULL )
         {
-            len = strlen( tags );
-            if ( len < MAX_TAGSPEC_LEN )
-            {
-                strcpy( query->tagspec, tags );
-                query->type |= QUERY_TAGS;
-            }
-            else
+            rc = RunConfigQueries( pState, &pResults, pConfig, &total );
+            if ( rc != EOK )
             {
-                result = E2BIG;
+                result = rc;
             }
+
+            pConfig = pConfig->pNext;
         }
 
-        /* see if we are doing a match search */
-        match = JSON_GetStr( pNode, "match" );
-        if ( match != NULL )
+        /* release the query results.  The variable caches they
+           refer to belong to the configurations */
+        while ( pResults != NULL )
         {
-            query->match = strdup( match );
-            if ( query->match != NULL )
-            {
-                query->type |= QUERY_MATCH;
-            }
-            else
-            {
-                result = ENOMEM;
-            }
+            pResult = pResults;
+            pResults = pResult->pNext;
+            free( pResult );
+            distinct++;
         }
 
-        /* see if we are doing a flags search */
-        flags = JSON_GetStr( pNode, "flags" );
-        if ( flags != NULL )
+        if ( pState->verbose == true )
         {
-            /* convert flags string list to flags bitmap */
-            if ( VARSERVER_StrToFlags( flags, &query->flags ) == EOK )
-            {
-                query->type |= QUERY_FLAGS;
-            }
-            else
-            {
-                result = ENOTSUP;
-            }
+            printf( "VARMSG: %zu variable queries, %zu distinct\n",
+                    total,
+                    distinct );
         }
+    }
 
-        /* see if we are doing an instance identifier search */
-        if ( JSON_GetNum( pNode, "instanceID", &query->instanceID ) == EOK )
+    return result;
+}
+
+/*============================================================================*/
+/*  RunConfigQueries                                                          */
+/*!
+    Run the variable queries of a message configuration
+
+    The RunConfigQueries function populates the trigger and body variable
+    caches of a configuration which uses variable queries, sharing the
+    results of identical queries in the list of query results.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in,out]
+        ppResults
+            pointer to the head of the list of query results
+
+    @param[in]
+        pConfig
+            pointer to the variable message configuration
+
+    @param[in,out]
+        pTotal
+            pointer to the number of queries, which is incremented for
+            each query of the configuration
+
+    @retval EOK the queries were run
+    @retval EINVAL invalid arguments
+    @retval other error from RunSharedQuery
+
+==============================================================================*/
+static int RunConfigQueries( VarMsgState *pState,
+                             QueryResult **ppResults,
+                             VarMsgConfig *pConfig,
+                             size_t *pTotal )
+{
+    int result = EINVAL;
+    int rc;
+
+    if ( ( pState != NULL ) &&
+         ( ppResults != NULL ) &&
+         ( pConfig != NULL ) &&
+         ( pTotal != NULL ) )
+    {
+        result = EOK;
+
+        if ( pConfig->triggerQuery.type != 0 )
         {
-            query->type |= QUERY_INSTANCEID;
+            rc = RunSharedQuery( pState,
+                                 ppResults,
+                                 &pConfig->triggerQuery,
+                                 pConfig->pTriggerCache );
+            if ( rc != EOK )
+            {
+                result = rc;
+            }
+
+            (*pTotal)++;
         }
 
-        if ( ( result == EOK ) &&
-             ( query->type == 0 ) )
+        if ( pConfig->varSet.type != 0 )
         {
-            result = ENOTSUP;
+            rc = RunSharedQuery( pState,
+                                 ppResults,
+                                 &pConfig->varSet,
+                                 pConfig->pBody->pVarCache );
+            if ( rc != EOK )
+            {
+                result = rc;
+            }
+
+            (*pTotal)++;
         }
     }
 
@@ -1018,80 +2332,82 @@ static int BuildQuery( JObject *config, VarQuery *query )
 }
 
 /*============================================================================*/
-/*  ProcessQuery                                                              */
+/*  RunSharedQuery                                                            */
 /*!
-    Process a variable query JSON definition into a variable cache
+    Run a variable query, or share the result of an identical query
 
-    The ProcessQuery function processes a variable query JSON object
-    which specifies the variable search parameters used to generate
-    a list of variables to process and builds a cache of variable handles
-    from it.
-
-    If the output variable cache does not exist, then it will be
-    created with an initial size of CACHE_SIZE_INITIAL
+    The RunSharedQuery function looks for an identical query in the list
+    of query results.  If one is found, its result is copied into the
+    variable cache.  Otherwise the query is run into the variable cache,
+    and the result is added to the list so later identical queries can
+    share it.
 
-    A JSON variable query can have one or more of the following attributes:
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
 
-    instanceID - instance identifier
-    match - partial name string match
-    flags - flags match ( comma separated list of flags to search for )
-    tags - tags match ( comma separated list of tags to search for )
+    @param[in,out]
+        ppResults
+            pointer to the head of the list of query results
 
     @param[in]
-        hVarServer
-            handle to the variable server
+        pQuery
+            pointer to the variable query to run
 
     @param[in]
-        config
-            pointer to a JSON Object containing variable query
-            parameters
-
-    @param[in,out]
-        pVarQuery
-            pointer to a Variable Query object to populate
-
-    @param[in,out]
-        ppVarCache
-            pointer to a pointer to a Variable Cache to populate.
+        pVarCache
+            pointer to the variable cache to populate
 
-    @retval EOK the variable query was successfully processed
+    @retval EOK the variable cache was populated
     @retval EINVAL invalid arguments
-    @retval ENOMEM memory
+    @retval other error from VARQUERY_CacheUnique or VARCACHE_Add
 
 ==============================================================================*/
-static int ProcessQuery( VARSERVER_HANDLE hVarServer,
-                         JObject *config,
-                         VarQuery *pVarQuery,
-                         VarCache **ppVarCache )
+static int RunSharedQuery( VarMsgState *pState,
+                           QueryResult **ppResults,
+                           VarQuery *pQuery,
+                           VarCache *pVarCache )
 {
     int result = EINVAL;
-    size_t len = CACHE_SIZE_INITIAL;
-    size_t growBy = CACHE_SIZE_GROW_BY;
+    QueryResult *pResult;
 
-    if ( ppVarCache != NULL )
+    if ( ( pState != NULL ) &&
+         ( ppResults != NULL ) &&
+         ( pQuery != NULL ) &&
+         ( pVarCache != NULL ) )
     {
-        /* allocate cache if it does not exist */
-        if ( *ppVarCache != NULL )
+        pResult = *ppResults;
+        while ( ( pResult != NULL ) &&
+                ( QueryEqual( pResult->pQuery, pQuery ) == false ) )
         {
-            /* we already have a cache, we don't need to initialize it */
-            result = EOK;
+            pResult = pResult->pNext;
         }
-        else
+
+        if ( pResult != NULL )
         {
-            /* initialize the variable cache with a default size */
-            result = VARCACHE_Init( ppVarCache, len, growBy );
+            /* share the result of the identical query */
+            result = VARCACHE_Map( pResult->pCache,
+                                   CopyToCache,
+                                   (void *)pVarCache );
         }
-
-        if ( result == EOK )
+        else
         {
-            /* populate a VarQuery object from the JSON query object */
-            result = BuildQuery( config, pVarQuery );
+            /* run the query to build the variable cache */
+            result = VARQUERY_CacheUnique( pState->hVarServer,
+                                           pQuery,
+                                           pVarCache );
             if ( result == EOK )
             {
-                /* run the query to build a variable cache */
-                result = VARQUERY_CacheUnique( hVarServer,
-                                               pVarQuery,
-                                               *ppVarCache );
+                /* if the result cannot be recorded, the next identical
+                   query will just be run again */
+                pResult = calloc( 1, sizeof( QueryResult ) );
+                if ( pResult != NULL )
+                {
+                    pResult->pQuery = pQuery;
+                    pResult->pCache = pVarCache;
+                    pResult->pNext = *ppResults;
+                    *ppResults = pResult;
+                }
             }
         }
     }
@@ -1100,61 +2416,6213 @@ static int ProcessQuery( VARSERVER_HANDLE hVarServer,
 }
 
 /*============================================================================*/
-/*  ProcessVarList                                                            */
+/*  QueryEqual                                                                */
 /*!
-    Process a JSON array of variables and build a VarCache list
+    Compare two variable queries
 
-    The ProcessVarList function iterates through the variable name
-    array (array of strings), and adds each variable to a variable
-    cache.  The variable cache is created and a pointer to it
-    is returned via the ppVarCache argument.
+    The QueryEqual function checks if two variable queries have the same
+    search type and the same search parameters, so they will find the
+    same set of variables.
 
     @param[in]
-        pVarList
-            pointer to a JSON Array containing a list of variable
-            names.
+        pQuery1
+            pointer to the first variable query
 
-    @param[in,out]
-        ppVarCache
-            pointer to a pointer to a variable cache
+    @param[in]
+        pQuery2
+            pointer to the second variable query
 
-    @retval EOK the variable was added to the VarCache
-    @retval ENOTSUP the type of object in the array is not a string
-    @retval ENOENT the variable was not found
-    @retval EINVAL invalid arguments
+    @retval true the queries are identical
+    @retval false the queries are different
 
 ==============================================================================*/
-static int ProcessVarList( JArray *pVarList, VarCache **ppVarCache )
+static bool QueryEqual( VarQuery *pQuery1, VarQuery *pQuery2 )
 {
-    int result = EINVAL;
-    VarCache *pVarCache;
-    int n;
-    int i;
-    JNode *pNode;
+    bool result = false;
 
-    if ( ( pVarList != NULL ) &&
-         ( pVarList->node.type == JSON_ARRAY ) &&
-         ( ppVarCache != NULL ) )
+    if ( ( pQuery1 != NULL ) &&
+         ( pQuery2 != NULL ) &&
+         ( pQuery1->type == pQuery2->type ) )
     {
-        pVarCache = *ppVarCache;
-        if ( pVarCache == NULL )
+        result = true;
+
+        if ( ( pQuery1->type & QUERY_MATCH ) &&
+             ( strcmp( pQuery1->match, pQuery2->match ) != 0 ) )
         {
-            /* count the number of items in the array */
-            n = JSON_GetArraySize( pVarList );
-            if ( n > 0 )
-            {
-                /* build a VarCache of the same size */
-                result = VARCACHE_Init( ppVarCache, n, 10 );
-                if ( result == EOK )
-                {
-                    /* iterate through the variable list and build
-                       the VarCache */
-                    pVarCache = *ppVarCache;
-                    result = JSON_Iterate( pVarList,
-                                           AddToCache,
-                                           (void *)pVarCache );
+            result = false;
+        }
+
+        if ( ( pQuery1->type & QUERY_TAGS ) &&
+             ( strcmp( pQuery1->tagspec, pQuery2->tagspec ) != 0 ) )
+        {
+            result = false;
+        }
+
+        if ( ( pQuery1->type & QUERY_FLAGS ) &&
+             ( pQuery1->flags != pQuery2->flags ) )
+        {
+            result = false;
+        }
+
+        if ( ( pQuery1->type & QUERY_INSTANCEID ) &&
+             ( pQuery1->instanceID != pQuery2->instanceID ) )
+        {
+            result = false;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CopyToCache                                                               */
+/*!
+    Mapping callback function to copy a variable into a variable cache
+
+    The CopyToCache callback function is used by the VARCACHE_Map function
+    to copy the variables of a shared query result into the variable
+    cache of another configuration.
+
+    @param[in]
+        hVar
+            handle of the variable to copy
+
+    @param[in]
+        arg
+            opaque pointer to the destination variable cache
+
+    @retval EOK the variable was added to the cache
+    @retval EINVAL invalid arguments
+    @retval other error from VARCACHE_Add
+
+==============================================================================*/
+static int CopyToCache( VAR_HANDLE hVar, void *arg )
+{
+    return VARCACHE_Add( (VarCache *)arg, hVar );
+}
+
+/*============================================================================*/
+/*  CreateBody                                                                */
+/*!
+    Create a message body
+
+    The CreateBody function allocates an empty message body with a
+    single reference.
+
+    @retval pointer to the new message body
+    @retval NULL memory allocation failure
+
+==============================================================================*/
+static MsgBody *CreateBody( void )
+{
+    MsgBody *pBody;
+
+    pBody = calloc( 1, sizeof( MsgBody ) );
+    if ( pBody != NULL )
+    {
+        pBody->refCount = 1;
+        pthread_mutex_init( &pBody->lock, NULL );
+    }
+
+    return pBody;
+}
+
+/*============================================================================*/
+/*  FreeBody                                                                  */
+/*!
+    Release a message body
+
+    The FreeBody function drops a reference to a message body, and
+    releases the body and its variable cache when the last reference
+    is dropped.
+
+    @param[in]
+        pBody
+            pointer to the message body to release
+
+==============================================================================*/
+static void FreeBody( MsgBody *pBody )
+{
+    if ( ( pBody != NULL ) &&
+         ( --pBody->refCount == 0 ) )
+    {
+        if ( pBody->pVarCache != NULL )
+        {
+            VARCACHE_Free( pBody->pVarCache );
+        }
+
+        FreeVarMeta( &pBody->meta );
+        MSGBUF_Free( &pBody->rendered );
+        pthread_mutex_destroy( &pBody->lock );
+        free( pBody );
+    }
+}
+
+/*============================================================================*/
+/*  ShareBodies                                                               */
+/*!
+    Share the bodies of messages with identical body definitions
+
+    The ShareBodies function looks for messages whose body is identical
+    to the body of an earlier message, and makes them share the earlier
+    message's body.  This must be called after the variable queries
+    have been run, and before the message bodies are built.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+==============================================================================*/
+static void ShareBodies( VarMsgState *pState )
+{
+    VarMsgConfig *pConfig;
+
+    if ( pState != NULL )
+    {
+        for ( pConfig = pState->pMessageConfigs;
+              pConfig != NULL;
+              pConfig = pConfig->pNext )
+        {
+            /* use the body of an earlier message */
+            ShareBody( pState, pConfig, pConfig );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  ShareBody                                                                 */
+/*!
+    Share the body of a message with an identical body definition
+
+    The ShareBody function looks for a message whose body is identical
+    to the body of the specified message and makes the message share
+    it.  The messages from the start of the message list up to, but not
+    including, the end message are searched.  This must be called after
+    the variable queries of the message have been run, and before its
+    body is built.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        pConfig
+            pointer to the message which may share a body
+
+    @param[in]
+        pEnd
+            pointer to the message to stop searching at, or NULL to
+            search all of the other messages
+
+==============================================================================*/
+static void ShareBody( VarMsgState *pState,
+                       VarMsgConfig *pConfig,
+                       VarMsgConfig *pEnd )
+{
+    VarMsgConfig *pOther;
+
+    if ( ( pState != NULL ) &&
+         ( pConfig != NULL ) )
+    {
+        pOther = pState->pMessageConfigs;
+        while ( ( pOther != pEnd ) &&
+                ( ( pOther == pConfig ) ||
+                  ( BodyEqual( pOther, pConfig ) == false ) ) )
+        {
+            pOther = pOther->pNext;
+        }
+
+        if ( pOther != pEnd )
+        {
+            FreeBody( pConfig->pBody );
+            pConfig->pBody = pOther->pBody;
+            pConfig->pBody->refCount++;
+
+            if ( pState->verbose == true )
+            {
+                printf( "VARMSG: %s shares the body of %s\n",
+                        pConfig->configName,
+                        pOther->configName );
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  BodyEqual                                                                 */
+/*!
+    Check if two messages have identical bodies
+
+    The BodyEqual function checks if two messages will always render
+    the same body.  This is the case for full mode messages with the
+    same encoding, formatting options and message template, and either
+    identical body variable queries, or identical body variable lists.
+    Delta mode messages track the changes since their own previous
+    message, so their bodies are never shared.
+
+    @param[in]
+        pConfig1
+            pointer to the first variable message configuration
+
+    @param[in]
+        pConfig2
+            pointer to the second variable message configuration
+
+    @retval true the message bodies are identical
+    @retval false the message bodies are different
+
+==============================================================================*/
+static bool BodyEqual( VarMsgConfig *pConfig1, VarMsgConfig *pConfig2 )
+{
+    bool result = false;
+    VarCache *pCache1;
+    VarCache *pCache2;
+    int n;
+    int i;
+
+    if ( ( pConfig1 != NULL ) &&
+         ( pConfig2 != NULL ) &&
+         ( pConfig1->delta == false ) &&
+         ( pConfig2->delta == false ) &&
+         ( pConfig1->format == pConfig2->format ) &&
+         ( pConfig1->fastpath == pConfig2->fastpath ) &&
+         ( ( pConfig1->header == pConfig2->header ) ||
+           ( ( pConfig1->header != NULL ) &&
+             ( pConfig2->header != NULL ) &&
+             ( strcmp( pConfig1->header, pConfig2->header ) == 0 ) ) ) )
+    {
+        pCache1 = pConfig1->pBody->pVarCache;
+        pCache2 = pConfig2->pBody->pVarCache;
+
+        if ( ( pConfig1->varSet.type != 0 ) ||
+             ( pConfig2->varSet.type != 0 ) )
+        {
+            /* both bodies must come from the same query */
+            result = QueryEqual( &pConfig1->varSet, &pConfig2->varSet );
+        }
+        else if ( ( pCache1 != NULL ) &&
+                  ( pCache2 != NULL ) )
+        {
+            /* both bodies must list the same variables in order */
+            n = VARCACHE_Size( pCache1 );
+            result = ( n == VARCACHE_Size( pCache2 ) );
+            for ( i = 0; ( result == true ) && ( i < n ); i++ )
+            {
+                result = ( VARCACHE_Get( pCache1, i ) ==
+                           VARCACHE_Get( pCache2, i ) );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ReloadConfigs                                                             */
+/*!
+    Apply the changes to the configuration directory
+
+    The ReloadConfigs function is called at the end of a processing cycle
+    when configuration files have changed.  Each changed file is reloaded
+    once, however many events were received for it, so the cost of a
+    reload depends on the number of changed files rather than on the
+    number of messages.  If directory events were lost, every file in
+    the directory and every message loaded from it is checked, and only
+    the files whose content has changed are reloaded.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+==============================================================================*/
+static void ReloadConfigs( VarMsgState *pState )
+{
+    DIR *configdir;
+    struct dirent *entry;
+    VarMsgConfig *pConfig;
+    size_t offset;
+    size_t len;
+    char *name;
+
+    if ( ( pState != NULL ) &&
+         ( pState->pConfigDir != NULL ) )
+    {
+        if ( pState->reloadAll == true )
+        {
+            /* check the files which are in the directory now */
+            pState->reloadAll = false;
+            configdir = opendir( pState->pConfigDir );
+            if ( configdir != NULL )
+            {
+                while ( ( entry = readdir( configdir ) ) != NULL )
+                {
+                    if ( entry->d_name[0] != '.' )
+                    {
+                        AddReload( pState, entry->d_name );
+                    }
+                }
+
+                closedir( configdir );
+            }
+
+            /* and the files the running messages were loaded from */
+            len = strlen( pState->pConfigDir );
+            for ( pConfig = pState->pMessageConfigs;
+                  pConfig != NULL;
+                  pConfig = pConfig->pNext )
+            {
+                if ( ( strncmp( pConfig->configName,
+                                pState->pConfigDir,
+                                len ) == 0 ) &&
+                     ( pConfig->configName[len] == '/' ) )
+                {
+                    AddReload( pState, &pConfig->configName[len + 1] );
+                }
+            }
+        }
+
+        offset = 0;
+        while ( offset < pState->reloads.len )
+        {
+            name = &pState->reloads.pData[offset];
+            offset += strlen( name ) + 1;
+
+            ReloadConfig( pState, name );
+        }
+
+        MSGBUF_Reset( &pState->reloads );
+    }
+}
+
+/*============================================================================*/
+/*  ReloadConfig                                                              */
+/*!
+    Reload a configuration file from the configuration directory
+
+    The ReloadConfig function compares a configuration file with the
+    message which was loaded from it.  A message whose file has been
+    removed is torn down.  A new file is loaded and its message is set
+    up, and a changed file is loaded and its message replaces the
+    running message.  If the changed file cannot be loaded, or its
+    message cannot be set up, the new message is discarded and the
+    running message is left in place.  A file whose content has not
+    changed is not loaded again.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        name
+            name of the file in the configuration directory
+
+    @retval EOK the configuration was reloaded, or has not changed
+    @retval ENOENT the file does not exist and no message uses it
+    @retval EBADMSG the file could not be parsed
+    @retval ENAMETOOLONG the file name is too long
+    @retval EINVAL invalid arguments
+    @retval other error from ProcessConfigFile or StartConfig
+
+==============================================================================*/
+static int ReloadConfig( VarMsgState *pState, char *name )
+{
+    int result = EINVAL;
+    char path[PATH_MAX];
+    VarMsgConfig *pOld;
+    VarMsgConfig *pNew;
+    uint64_t digest = 0;
+    int n;
+
+    if ( ( pState != NULL ) &&
+         ( pState->pConfigDir != NULL ) &&
+         ( name != NULL ) )
+    {
+        n = snprintf( path, sizeof( path ), "%s/%s", pState->pConfigDir, name );
+        result = ( ( n > 0 ) && ( (size_t)n < sizeof( path ) ) )
+                 ? EOK
+                 : ENAMETOOLONG;
+    }
+
+    if ( result == EOK )
+    {
+        pOld = FindConfig( pState, path );
+
+        result = ReadDigest( path, &digest );
+        if ( result != EOK )
+        {
+            if ( pOld != NULL )
+            {
+                /* the configuration file was removed */
+                if ( pState->verbose == true )
+                {
+                    printf( "VARMSG: removing %s\n", path );
+                }
+
+                RemoveConfig( pState, pOld );
+                result = EOK;
+            }
+        }
+        else if ( ( pOld == NULL ) ||
+                  ( pOld->digest != digest ) )
+        {
+            if ( pState->verbose == true )
+            {
+                printf( "VARMSG: reloading %s\n", path );
+            }
+
+            result = ProcessConfigFile( pState, path );
+            if ( result == EOK )
+            {
+                /* a loaded configuration is added to the head of
+                   the list */
+                pNew = pState->pMessageConfigs;
+
+                if ( pOld != NULL )
+                {
+                    /* carry the counters over to the new message */
+                    WaitIdle( pState, pOld );
+                    InheritCounters( pState, pNew, pOld );
+                }
+                else if ( ( pState->stagger == true ) &&
+                          ( pNew->phaseSet == false ) &&
+                          ( pState->msgs.pInterval[pNew->id] != 0 ) )
+                {
+                    /* make room for the new message amongst the
+                       running messages with the same interval */
+                    StaggerInterval( pState,
+                                     pState->msgs.pInterval[pNew->id] );
+                }
+
+                result = StartConfig( pState, pNew );
+                if ( result != EOK )
+                {
+                    fprintf( stderr,
+                             "VARMSG: cannot start %s: %s\n",
+                             path,
+                             strerror( result ) );
+
+                    /* keep the running message */
+                    RemoveConfig( pState, pNew );
+                }
+                else if ( pOld != NULL )
+                {
+                    RemoveConfig( pState, pOld );
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  StartConfig                                                               */
+/*!
+    Set up and schedule a message loaded while the generator is running
+
+    The StartConfig function does the set up which SetupConfigs and
+    StartSchedule do for the messages loaded on startup, for a single
+    message.  Its variable queries are run, it shares the body of an
+    identical message if there is one, and its interval messages and
+    automatic rescans are scheduled.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        pConfig
+            pointer to the variable message configuration
+
+    @retval EOK the message was set up
+    @retval EINVAL invalid arguments
+    @retval other error from the message set up functions
+
+==============================================================================*/
+static int StartConfig( VarMsgState *pState, VarMsgConfig *pConfig )
+{
+    int result = EINVAL;
+    QueryResult *pResults = NULL;
+    QueryResult *pResult;
+    size_t total = 0;
+    uint32_t interval;
+    uint64_t now;
+    int rc;
+
+    if ( ( pState != NULL ) &&
+         ( pConfig != NULL ) )
+    {
+        result = RunConfigQueries( pState, &pResults, pConfig, &total );
+        if ( result == ENOENT )
+        {
+            /* a query which finds no variables is not an error,
+               a rescan may find them later */
+            result = EOK;
+        }
+
+        while ( pResults != NULL )
+        {
+            pResult = pResults;
+            pResults = pResult->pNext;
+            free( pResult );
+        }
+
+        ShareBody( pState, pConfig, NULL );
+
+        rc = SetupConfig( pState, pConfig );
+        if ( rc != EOK )
+        {
+            result = rc;
+        }
+
+        now = GetTimeMs();
+
+        if ( pState->msgs.pEnabled[pConfig->id] == true )
+        {
+            rc = ScheduleInterval( pState, pConfig, now );
+            if ( rc != EOK )
+            {
+                result = rc;
+            }
+        }
+
+        interval = pState->msgs.pRescanInterval[pConfig->id];
+        if ( interval != 0 )
+        {
+            rc = SCHED_Insert( &pState->sched,
+                               &pConfig->rescanItem,
+                               now + interval );
+            if ( rc != EOK )
+            {
+                result = rc;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RemoveConfig                                                              */
+/*!
+    Tear down a message
+
+    The RemoveConfig function waits for the message to be idle, removes
+    it from the schedule, and removes its variables from the variable
+    index.  Notifications which no other message uses are cancelled.
+    Any of its output which is still in the output queue is written
+    before its output is closed, and nothing is released unless the
+    output queue writer has reached the sync marker.  The output and
+    the message body are only released if no other message shares
+    them.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        pConfig
+            pointer to the variable message configuration to remove
+
+==============================================================================*/
+static void RemoveConfig( VarMsgState *pState, VarMsgConfig *pConfig )
+{
+    VarMsgConfig **ppConfig;
+    VarMetaTable *pTable;
+    VAR_HANDLE hVar;
+    int synced = EOK;
+    size_t i;
+    int n;
+    int k;
+
+    if ( ( pState != NULL ) &&
+         ( pConfig != NULL ) )
+    {
+        WaitIdle( pState, pConfig );
+
+        SCHED_Remove( &pState->sched, &pConfig->intervalItem );
+        SCHED_Remove( &pState->sched, &pConfig->pendingItem );
+        SCHED_Remove( &pState->sched, &pConfig->rescanItem );
+
+        /* stop dispatching notifications to the message */
+        n = VARCACHE_Size( pConfig->pTriggerCache );
+        for ( k = 0; k < n; k++ )
+        {
+            UnindexVar( pState,
+                        pConfig,
+                        VARCACHE_Get( pConfig->pTriggerCache, k ),
+                        VARROLE_TRIGGER );
+        }
+
+        if ( pConfig->delta == true )
+        {
+            pTable = &pConfig->pBody->meta;
+            for ( i = 0; i < pTable->n; i++ )
+            {
+                UnindexVar( pState,
+                            pConfig,
+                            pTable->pMeta[i].hVar,
+                            VARROLE_BODY );
+            }
+        }
+
+        UnindexVar( pState, pConfig, pConfig->hTrigger, VARROLE_MSGTRIGGER );
+        UnindexVar( pState, pConfig, pConfig->hEnable, VARROLE_ENABLE );
+        UnindexVar( pState, pConfig, pConfig->hRescan, VARROLE_RESCAN );
+
+        if ( pConfig->rescanOn != NULL )
+        {
+            hVar = VAR_FindByName( pState->hVarServer, pConfig->rescanOn );
+            UnindexVar( pState, pConfig, hVar, VARROLE_RESCAN );
+        }
+
+        if ( pState->pOutQ != NULL )
+        {
+            /* queued output refers to the sink and dropped counter */
+            synced = OUTQ_Sync( pState->pOutQ );
+        }
+
+        /* remove the message from the message list */
+        ppConfig = &pState->pMessageConfigs;
+        while ( *ppConfig != NULL )
+        {
+            if ( *ppConfig == pConfig )
+            {
+                *ppConfig = pConfig->pNext;
+                pState->numMsgs--;
+                break;
+            }
+
+            ppConfig = &((*ppConfig)->pNext);
+        }
+
+        if ( synced == EOK )
+        {
+            FreeConfig( pState, pConfig );
+        }
+        else
+        {
+            /* the output queue may still refer to the message, so its
+               output and arena are not released */
+            fprintf( stderr,
+                     "VARMSG: cannot release %s: %s\n",
+                     pConfig->configName,
+                     strerror( synced ) );
+            MSGTABLE_Remove( &pState->msgs, pConfig->id );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  InheritCounters                                                           */
+/*!
+    Carry the counters of a replaced message over to its replacement
+
+    The InheritCounters function copies the transmission, error and
+    performance counters of a message which is being replaced to the
+    message replacing it, if both use the same variable prefix and so
+    publish their counters to the same variables.  The replacement
+    keeps the phase of the replaced message unless it specifies its
+    own, so a reload does not move a staggered message.  The replaced
+    message must be idle.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        pConfig
+            pointer to the new variable message configuration
+
+    @param[in]
+        pOld
+            pointer to the variable message configuration it replaces
+
+==============================================================================*/
+static void InheritCounters( VarMsgState *pState,
+                             VarMsgConfig *pConfig,
+                             VarMsgConfig *pOld )
+{
+    MsgTable *pMsgs;
+
+    if ( ( pConfig != NULL ) &&
+         ( pOld != NULL ) &&
+         ( pConfig->phaseSet == false ) )
+    {
+        pConfig->phase = pOld->phase;
+    }
+
+    if ( ( pState != NULL ) &&
+         ( pConfig != NULL ) &&
+         ( pOld != NULL ) &&
+         ( ( pConfig->prefix == pOld->prefix ) ||
+           ( ( pConfig->prefix != NULL ) &&
+             ( pOld->prefix != NULL ) &&
+             ( strcmp( pConfig->prefix, pOld->prefix ) == 0 ) ) ) )
+    {
+        pMsgs = &pState->msgs;
+
+        pConfig->txCount = pOld->txCount;
+        pConfig->errCount = pOld->errCount;
+        pConfig->coalescedCount = pOld->coalescedCount;
+        pMsgs->pLastSent[pConfig->id] = pMsgs->pLastSent[pOld->id];
+        pConfig->dropped = __atomic_load_n( &pOld->dropped, __ATOMIC_RELAXED );
+        pConfig->droppedPublished = pOld->droppedPublished;
+        pConfig->stats = pOld->stats;
+        pConfig->statsPublished = pOld->statsPublished;
+    }
+}
+
+/*============================================================================*/
+/*  FindConfig                                                                */
+/*!
+    Find the message loaded from a configuration file
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        name
+            name of the configuration file
+
+    @retval pointer to the message loaded from the file
+    @retval NULL no message was loaded from the file
+
+==============================================================================*/
+static VarMsgConfig *FindConfig( VarMsgState *pState, char *name )
+{
+    VarMsgConfig *pConfig = NULL;
+
+    if ( ( pState != NULL ) &&
+         ( name != NULL ) )
+    {
+        pConfig = pState->pMessageConfigs;
+        while ( ( pConfig != NULL ) &&
+                ( strcmp( pConfig->configName, name ) != 0 ) )
+        {
+            pConfig = pConfig->pNext;
+        }
+    }
+
+    return pConfig;
+}
+
+/*============================================================================*/
+/*  ReadDigest                                                                */
+/*!
+    Calculate the digest of a configuration file
+
+    The ReadDigest function calculates a 64 bit FNV-1a digest of the
+    content of a file, which is used to check if a configuration file
+    has changed.
+
+    @param[in]
+        filename
+            name of the file
+
+    @param[out]
+        pDigest
+            pointer to a location to store the digest
+
+    @retval EOK the digest was calculated
+    @retval EINVAL invalid arguments
+    @retval other error from open() or read()
+
+==============================================================================*/
+static int ReadDigest( char *filename, uint64_t *pDigest )
+{
+    int result = EINVAL;
+    uint64_t digest = DIGEST_BASIS;
+    unsigned char buf[BUFSIZ];
+    ssize_t n;
+    ssize_t i;
+    int fd;
+
+    if ( ( filename != NULL ) &&
+         ( pDigest != NULL ) )
+    {
+        fd = open( filename, O_RDONLY | O_CLOEXEC );
+        if ( fd != -1 )
+        {
+            while ( ( n = read( fd, buf, sizeof( buf ) ) ) > 0 )
+            {
+                for ( i = 0; i < n; i++ )
+                {
+                    digest = ( digest ^ buf[i] ) * DIGEST_PRIME;
+                }
+            }
+
+            result = ( n == 0 ) ? EOK : errno;
+            close( fd );
+        }
+        else
+        {
+            result = errno;
+        }
+
+        if ( result == EOK )
+        {
+            *pDigest = digest;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  WaitIdle                                                                  */
+/*!
+    Wait for a message to be idle
+
+    The WaitIdle function waits for a message which is queued for, or
+    being rendered by, a render worker to finish.  The message cannot be
+    queued again while the caller is using it, since messages are only
+    queued by the main thread.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        pConfig
+            pointer to the variable message configuration
+
+==============================================================================*/
+static void WaitIdle( VarMsgState *pState, VarMsgConfig *pConfig )
+{
+    if ( ( pState != NULL ) &&
+         ( pConfig != NULL ) &&
+         ( pState->numWorkers > 0 ) )
+    {
+        pthread_mutex_lock( &pState->workLock );
+        while ( pConfig->queued == true )
+        {
+            pthread_cond_wait( &pState->idleCond, &pState->workLock );
+        }
+
+        pthread_mutex_unlock( &pState->workLock );
+    }
+}
+
+/*============================================================================*/
+/*  ProcessTriggerConfig                                                      */
+/*!
+    Process the "trigger" configuration in the JSON config file
+
+    The ProcessTriggerConfig function processes a "trigger" configuration
+    attribute in the JSON configuration object.  The trigger can either be
+    an explicit list of variables, or a variable search definition object.
+
+    This function will parse the trigger definition and build the
+    triggerQuery VarQuery object if the trigger is a search
+    definition.
+
+    If the trigger is a search definition, the search is run to populate
+    the trigger cache once all of the configurations have been loaded.
+
+    If the trigger is an explicit variable list, then the handle of each
+    variable will be added to the trigger cache.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        pNode
+            pointer to the JNode for the trigger configuration
+
+    @param[in,out]
+        pConfig
+            pointer to the VarMsgConfig message definition to populate
+
+    @retval EINVAL invalid arguments
+    @retval EOK trigger configuration was processed or not specified
+    @retval ENOENT one or more variables did not exist
+    @retval ENOMEM memory allocation failure
+
+==============================================================================*/
+static int ProcessTriggerConfig( VarMsgState *pState,
+                                 JNode *pNode,
+                                 VarMsgConfig *pConfig )
+{
+    int result = EINVAL;
+    JNode *trigger;
+
+    if ( ( pState != NULL ) &&
+         ( pNode != NULL ) &&
+         ( pConfig != NULL ) )
+    {
+        /* process trigger variables */
+        trigger = JSON_Find( pNode, "trigger" );
+        if ( trigger != NULL )
+        {
+            if ( trigger->type == JSON_OBJECT )
+            {
+                /* process a variable query */
+                result = ProcessQuery( (JObject *)trigger,
+                                       &(pConfig->triggerQuery),
+                                       &(pConfig->pTriggerCache),
+                                       pConfig->pArena );
+            }
+            else if ( trigger->type == JSON_ARRAY )
+            {
+                /* process a variable list */
+                result = ProcessVarList( (JArray *)trigger,
+                                         &(pConfig->pTriggerCache) );
+            }
+        }
+        else
+        {
+            /* trigger configuration is optional since we might just
+               be doing a timed message generation */
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarsConfig                                                         */
+/*!
+    Process the "vars" configuration in the JSON config file
+
+    The ProcessTriggerConfig function processes a "vars" configuration
+    attribute in the JSON configuration object.  The vars can either be
+    an explicit list of variables, or a variable search definition object.
+
+    This function will parse the vars definition and build the
+    varSet VarQuery object if the vars attribute is a search
+    definition.
+
+    If the vars attribute is a search definition, the search is run to populate
+    the vars cache once all of the configurations have been loaded.
+
+    If the vars attribute is an explicit variable list, then the handle of each
+    variable will be added to the vars cache.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        pNode
+            pointer to the JNode for the trigger configuration
+
+    @param[in,out]
+        pConfig
+            pointer to the VarMsgConfig message definition to populate
+
+    @retval EINVAL invalid arguments
+    @retval EOK trigger configuration was processed or not specified
+    @retval ENOENT one or more variables did not exist
+    @retval ENOMEM memory allocation failure
+
+==============================================================================*/
+static int ProcessVarsConfig( VarMsgState *pState,
+                              JNode *pNode,
+                              VarMsgConfig *pConfig )
+{
+    int result = EINVAL;
+    JNode *vars;
+
+    if ( ( pState != NULL ) &&
+         ( pNode != NULL ) &&
+         ( pConfig != NULL ) )
+    {
+        result = ENOENT;
+
+        /* process message body variables */
+        vars = JSON_Find( pNode, "vars" );
+        if ( vars != NULL )
+        {
+            if ( vars->type == JSON_OBJECT )
+            {
+                /* process a variable query */
+                result = ProcessQuery( (JObject *)vars,
+                                       &(pConfig->varSet),
+                                       &(pConfig->pBody->pVarCache),
+                                       pConfig->pArena );
+            }
+            else if ( vars->type == JSON_ARRAY )
+            {
+                /* process a variable list */
+                result = ProcessVarList( (JArray *)vars,
+                                         &(pConfig->pBody->pVarCache) );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseOutputType                                                           */
+/*!
+    Parse the output type string
+
+    The ParseOutputType function processes the specified output type string
+    and converts it into a MsgOutputType enum.  If an invalid string
+    is specified, the output type will be silently set to VARMSG_OUTPUT_DISABLED
+
+    @param[in]
+        outputtype
+            pointer to a NUL terminated output type string
+
+    @retval the corresponding output type enumeration value.
+
+==============================================================================*/
+static MsgOutputType ParseOutputType( char *outputtype )
+{
+    int i = 0;
+    int n = sizeof(outputTypes)/sizeof(outputTypes[0]);
+    MsgOutputType outputType = VARMSG_OUTPUT_DISABLED;
+    const char *type;
+
+    if ( outputtype != NULL )
+    {
+        /* get the first output type */
+        type = outputTypes[i];
+        while ( type != NULL )
+        {
+            if ( strcmp(type, outputtype ) == 0 )
+            {
+                outputType = (MsgOutputType)i;
+                break;
+            }
+
+            type = outputTypes[++i];
+        }
+    }
+
+    return outputType;
+}
+
+/*============================================================================*/
+/*  ParseFormat                                                               */
+/*!
+    Parse the message format
+
+    The ParseFormat function converts the message format name from the
+    configuration into a MsgFormat value.  If no format is specified
+    the message is encoded as JSON.
+
+    @param[in]
+        format
+            pointer to the format name, or NULL if no format is specified
+
+    @param[out]
+        pFormat
+            pointer to the location to store the message format
+
+    @retval EOK the message format was parsed
+    @retval ENOTSUP unsupported message format
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int ParseFormat( char *format, MsgFormat *pFormat )
+{
+    int result = EINVAL;
+    int i = 0;
+
+    if ( pFormat != NULL )
+    {
+        *pFormat = MSGFORMAT_JSON;
+        result = EOK;
+
+        if ( format != NULL )
+        {
+            result = ENOTSUP;
+
+            while ( msgFormats[i] != NULL )
+            {
+                if ( strcmp( msgFormats[i], format ) == 0 )
+                {
+                    *pFormat = (MsgFormat)i;
+                    result = EOK;
+                    break;
+                }
+
+                i++;
+            }
+
+            if ( result != EOK )
+            {
+                fprintf( stderr, "VARMSG: unsupported format %s\n", format );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupOutput                                                               */
+/*!
+    Set up the message output
+
+    The SetupOutput function processes the "output_type" and "output"
+    attributes of the JSON configuration, and opens the sink which
+    the message will be sent to.  The sink is kept open for the life
+    of the message, and is shared with any other message which uses
+    the same output.
+
+    If no output type is specified, the message is sent to the
+    standard output.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        pNode
+            pointer to the JNode for the message configuration
+
+    @param[in,out]
+        pConfig
+            pointer to the VarMsgConfig message definition to populate
+
+    @retval EOK the output was opened
+    @retval EINVAL invalid arguments
+    @retval ENOENT the output could not be opened
+    @retval EEXIST the output is already open with a different compression
+
+==============================================================================*/
+static int SetupOutput( VarMsgState *pState,
+                        JNode *pNode,
+                        VarMsgConfig *pConfig )
+{
+    int result = EINVAL;
+    char *outputtype;
+    char *output;
+    char *compression;
+    CompressType compressType;
+
+    if ( ( pState != NULL ) &&
+         ( pNode != NULL ) &&
+         ( pConfig != NULL ) )
+    {
+        outputtype = JSON_GetStr( pNode, "output_type" );
+        if ( outputtype != NULL )
+        {
+            pConfig->outputType = ParseOutputType( outputtype );
+        }
+        else
+        {
+            pConfig->outputType = VARMSG_OUTPUT_STDOUT;
+        }
+
+        output = JSON_GetStr( pNode, "output" );
+
+        compression = JSON_GetStr( pNode, "compression" );
+        if ( COMPRESS_ParseType( compression, &compressType ) != EOK )
+        {
+            fprintf( stderr,
+                     "VARMSG: unsupported compression %s\n",
+                     compression );
+            result = ENOTSUP;
+        }
+        else
+        {
+            errno = 0;
+            pConfig->pSink = SINK_Open( pConfig->outputType,
+                                        output,
+                                        compressType );
+        }
+
+        if ( pConfig->pSink != NULL )
+        {
+            result = EOK;
+        }
+        else if ( ( result != ENOTSUP ) &&
+                  ( errno == EEXIST ) )
+        {
+            fprintf( stderr,
+                     "VARMSG: %s output %s is already open with a "
+                     "different compression\n",
+                     outputTypes[pConfig->outputType],
+                     ( output != NULL ) ? output : "" );
+            result = EEXIST;
+        }
+        else if ( result != ENOTSUP )
+        {
+            fprintf( stderr,
+                     "VARMSG: failed to open %s output %s\n",
+                     outputTypes[pConfig->outputType],
+                     ( output != NULL ) ? output : "" );
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  BuildQuery                                                              */
+/*!
+    Build a Variable Query object from a JSON configuration
+
+    The BuildQuery function processes a variable query JSON object
+    which specifies the variable search parameters used to generate
+    a list of variables to process.
+
+    A JSON variable query can have one or more of the following attributes:
+
+    instanceID - instance identifier
+    match - partial name string match
+    flags - flags match ( comma separated list of flags to search for )
+    tags - tags match ( comma separated list of tags to search for )
+
+    @param[in]
+        config
+            pointer to a JSON Object containing variable query
+            parameters
+
+    @param[in,out]
+        query
+            pointer to a Variable Query object to populate
+
+    @param[in]
+        pArena
+            pointer to the arena the query strings are copied into
+
+    @retval EOK the variable query was successfully processed
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int BuildQuery( JObject *config, VarQuery *query, Arena *pArena )
+{
+    int result = EINVAL;
+    JNode *pNode;
+    char *tags;
+    char *match;
+    char *flags;
+    size_t len;
+
+    if ( ( config != NULL ) &&
+         ( config->node.type == JSON_OBJECT ) &&
+         ( query != NULL ) )
+    {
+        result = EOK;
+
+        query->type = 0;
+
+        /* get a pointer to the JSON node */
+        pNode = &(config->node);
+
+        /* see if we are doing a tags search */
+        tags = JSON_GetStr( pNode, "tags" );
+        if ( tags != NULL )
+        {
+            len = strlen( tags );
+            if ( len < MAX_TAGSPEC_LEN )
+            {
+                strcpy( query->tagspec, tags );
+                query->type |= QUERY_TAGS;
+            }
+            else
+            {
+                result = E2BIG;
+            }
+        }
+
+        /* see if we are doing a match search */
+        match = JSON_GetStr( pNode, "match" );
+        if ( match != NULL )
+        {
+            query->match = ARENA_StrDup( pArena, match );
+            if ( query->match != NULL )
+            {
+                query->type |= QUERY_MATCH;
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+
+        /* see if we are doing a flags search */
+        flags = JSON_GetStr( pNode, "flags" );
+        if ( flags != NULL )
+        {
+            /* convert flags string list to flags bitmap */
+            if ( VARSERVER_StrToFlags( flags, &query->flags ) == EOK )
+            {
+                query->type |= QUERY_FLAGS;
+            }
+            else
+            {
+                result = ENOTSUP;
+            }
+        }
+
+        /* see if we are doing an instance identifier search */
+        if ( JSON_GetNum( pNode, "instanceID", &query->instanceID ) == EOK )
+        {
+            query->type |= QUERY_INSTANCEID;
+        }
+
+        if ( ( result == EOK ) &&
+             ( query->type == 0 ) )
+        {
+            result = ENOTSUP;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessQuery                                                              */
+/*!
+    Process a variable query JSON definition
+
+    The ProcessQuery function processes a variable query JSON object
+    which specifies the variable search parameters used to generate
+    a list of variables to process, and creates the variable cache
+    which will hold the variable handles.  The query is run into the
+    cache by RunQueries once all of the configurations are loaded.
+
+    If the output variable cache does not exist, then it will be
+    created with an initial size of CACHE_SIZE_INITIAL
+
+    A JSON variable query can have one or more of the following attributes:
+
+    instanceID - instance identifier
+    match - partial name string match
+    flags - flags match ( comma separated list of flags to search for )
+    tags - tags match ( comma separated list of tags to search for )
+
+    @param[in]
+        config
+            pointer to a JSON Object containing variable query
+            parameters
+
+    @param[in,out]
+        pVarQuery
+            pointer to a Variable Query object to populate
+
+    @param[in,out]
+        ppVarCache
+            pointer to a pointer to a Variable Cache to populate.
+
+    @param[in]
+        pArena
+            pointer to the arena the query strings are copied into
+
+    @retval EOK the variable query was successfully processed
+    @retval EINVAL invalid arguments
+    @retval ENOMEM memory
+
+==============================================================================*/
+static int ProcessQuery( JObject *config,
+                         VarQuery *pVarQuery,
+                         VarCache **ppVarCache,
+                         Arena *pArena )
+{
+    int result = EINVAL;
+    size_t len = CACHE_SIZE_INITIAL;
+    size_t growBy = CACHE_SIZE_GROW_BY;
+
+    if ( ppVarCache != NULL )
+    {
+        /* allocate cache if it does not exist */
+        if ( *ppVarCache != NULL )
+        {
+            /* we already have a cache, we don't need to initialize it */
+            result = EOK;
+        }
+        else
+        {
+            /* initialize the variable cache with a default size */
+            result = VARCACHE_Init( ppVarCache, len, growBy );
+        }
+
+        if ( result == EOK )
+        {
+            /* populate a VarQuery object from the JSON query object */
+            result = BuildQuery( config, pVarQuery, pArena );
+            if ( ( result != EOK ) &&
+                 ( pVarQuery != NULL ) )
+            {
+                /* an invalid query is never run */
+                pVarQuery->type = 0;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarList                                                            */
+/*!
+    Process a JSON array of variables and build a VarCache list
+
+    The ProcessVarList function iterates through the variable name
+    array (array of strings), and adds each variable to a variable
+    cache.  The variable cache is created and a pointer to it
+    is returned via the ppVarCache argument.
+
+    @param[in]
+        pVarList
+            pointer to a JSON Array containing a list of variable
+            names.
+
+    @param[in,out]
+        ppVarCache
+            pointer to a pointer to a variable cache
+
+    @retval EOK the variable was added to the VarCache
+    @retval ENOTSUP the type of object in the array is not a string
+    @retval ENOENT the variable was not found
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int ProcessVarList( JArray *pVarList, VarCache **ppVarCache )
+{
+    int result = EINVAL;
+    VarCache *pVarCache;
+    int n;
+    int i;
+    JNode *pNode;
+
+    if ( ( pVarList != NULL ) &&
+         ( pVarList->node.type == JSON_ARRAY ) &&
+         ( ppVarCache != NULL ) )
+    {
+        pVarCache = *ppVarCache;
+        if ( pVarCache == NULL )
+        {
+            /* count the number of items in the array */
+            n = JSON_GetArraySize( pVarList );
+            if ( n > 0 )
+            {
+                /* build a VarCache of the same size */
+                result = VARCACHE_Init( ppVarCache, n, 10 );
+                if ( result == EOK )
+                {
+                    /* iterate through the variable list and build
+                       the VarCache */
+                    pVarCache = *ppVarCache;
+                    result = JSON_Iterate( pVarList,
+                                           AddToCache,
+                                           (void *)pVarCache );
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  AddToCache                                                                */
+/*!
+    Add variable name from a JArray to the variable cache
+
+    The AddToCache function is a callback function for the JSON_Iterate
+    function used to add a variable name string from a JSON array to
+    a VarCache list.
+
+    @param[in]
+        pNode
+            pointer to the item in the JSON Array.  The type of this item
+            is expected to be a string value.  If it is not, the function
+            will fail with an ENOTSUP error
+
+    @param[in]
+        arg
+            opaque argument pointer which points to a VarCache object.
+
+    @retval EOK the variable was added to the VarCache
+    @retval ENOTSUP the type of object in the array is not a string
+    @retval ENOENT the variable was not found
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int AddToCache( JNode *pNode, void *arg )
+{
+    int result = EINVAL;
+    VarCache *pVarCache = (VarCache *)arg;
+    JVar *pVar = (JVar *)pNode;
+    VAR_HANDLE hVar;
+
+    if ( ( pNode != NULL ) &&
+         ( pNode->type == JSON_VAR ) &&
+         ( pVarCache != NULL ) )
+    {
+        /* only strings are supported */
+        result = ENOTSUP;
+        if ( pVar->var.type == JVARTYPE_STR )
+        {
+            /* look for a variable given its name */
+            hVar = VAR_FindByName( hVarServer, pVar->var.val.str );
+            if ( hVar != VAR_INVALID )
+            {
+                /* add the variable to the cache */
+                result = VARCACHE_Add( pVarCache, hVar );
+            }
+            else
+            {
+                /* variable not found */
+                result = ENOENT;
+            }
+        }
+        else
+        {
+            printf("Expected string type for variable name\n");
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  BuildVarMeta                                                              */
+/*!
+    Build the message body variable information table
+
+    The BuildVarMeta function gets the variable information for each
+    variable in the message body variable cache, and stores the
+    information which is needed to render the variable.  This includes
+    the pre-encoded JSON key for each variable so the variable name
+    does not need to be looked up or formatted when the message is
+    rendered.
+
+    Any existing table content is discarded, so this function can be
+    used to refresh the table after the variable cache changes.  The
+    completed table is sealed into an arena of its own.
+
+    @param[in]
+        pConfig
+            pointer to the variable message configuration
+
+    @retval EOK the variable information table was built
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int BuildVarMeta( VarMsgConfig *pConfig )
+{
+    int result = EINVAL;
+    VarMetaTable *pTable;
+
+    if ( pConfig != NULL )
+    {
+        pTable = &pConfig->pBody->meta;
+
+        /* discard any existing table */
+        FreeVarMeta( pTable );
+        pTable->format = pConfig->format;
+
+        pTable->pMeta = calloc( META_SIZE_INITIAL, sizeof( VarMeta ) );
+        if ( pTable->pMeta != NULL )
+        {
+            pTable->size = META_SIZE_INITIAL;
+            result = MSGBUF_Init( &pTable->keys, META_KEYS_SIZE );
+        }
+        else
+        {
+            result = ENOMEM;
+        }
+
+        if ( ( result == EOK ) &&
+             ( pConfig->pBody->pVarCache != NULL ) )
+        {
+            result = VARCACHE_Map( pConfig->pBody->pVarCache,
+                                   AddVarMeta,
+                                   (void *)pConfig );
+        }
+
+        if ( result == EOK )
+        {
+            result = SealVarMeta( pTable );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  AddVarMeta                                                                */
+/*!
+    Add a variable to the message body variable information table
+
+    The AddVarMeta function is a VARCACHE_Map callback which gets the
+    information for a message body variable, and appends it to the
+    message variable information table, along with its pre-encoded
+    JSON key.
+
+    The JSON key has the form "name": or "[instanceID]name": with
+    any special characters in the name escaped.
+
+    @param[in]
+        hVar
+            handle of the variable to add
+
+    @param[in]
+        arg
+            opaque pointer to the VarMsgConfig object
+
+    @retval EOK the variable was added to the table
+    @retval ENOENT the variable information could not be retrieved
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int AddVarMeta( VAR_HANDLE hVar, void *arg )
+{
+    VarMsgConfig *pConfig = (VarMsgConfig *)arg;
+    VarMetaTable *pTable;
+    VarMeta *pMeta;
+    VarInfo info;
+    size_t size;
+    int result = EINVAL;
+
+    if ( ( pConfig != NULL ) &&
+         ( hVar != VAR_INVALID ) )
+    {
+        pTable = &pConfig->pBody->meta;
+
+        result = VAR_GetInfo( hVarServer, hVar, &info );
+        if ( result == EOK )
+        {
+            if ( pTable->n == pTable->size )
+            {
+                /* grow the table */
+                size = pTable->size + META_SIZE_INITIAL;
+                pMeta = realloc( pTable->pMeta, size * sizeof( VarMeta ) );
+                if ( pMeta != NULL )
+                {
+                    pTable->pMeta = pMeta;
+                    pTable->size = size;
+                }
+                else
+                {
+                    result = ENOMEM;
+                }
+            }
+        }
+        else
+        {
+            fprintf( stderr,
+                     "VARMSG: Cannot get info for variable %d\n",
+                     hVar );
+            result = ENOENT;
+        }
+
+        if ( result == EOK )
+        {
+            pMeta = &pTable->pMeta[pTable->n];
+            pMeta->hVar = hVar;
+            pMeta->typed = ( pConfig->fastpath == true ) &&
+                           ( IsTypedVar( &info ) == true );
+            pMeta->keyOffset = pTable->keys.len;
+
+            if ( pTable->format == MSGFORMAT_CBOR )
+            {
+                /* encode the CBOR text string key */
+                result = AddCBORKey( pTable, &info );
+            }
+            else
+            {
+                /* encode the JSON key */
+                result = AddJSONKey( pTable, &info );
+            }
+
+            if ( result == EOK )
+            {
+                pMeta->keyLen = pTable->keys.len - pMeta->keyOffset;
+                pTable->n++;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  AddJSONKey                                                                */
+/*!
+    Pre-encode the JSON key of a message body variable
+
+    The AddJSONKey function appends the quoted and escaped name of the
+    variable, followed by a colon, to the key buffer.  The name of an
+    instanced variable is prefixed with its instance identifier.
+
+    @param[in]
+        pTable
+            pointer to the variable information table
+
+    @param[in]
+        pInfo
+            pointer to the variable information
+
+    @retval EOK the key was encoded
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int AddJSONKey( VarMetaTable *pTable, VarInfo *pInfo )
+{
+    int result = EINVAL;
+
+    if ( ( pTable != NULL ) &&
+         ( pInfo != NULL ) )
+    {
+        if ( pInfo->instanceID == 0 )
+        {
+            result = MSGBUF_AppendChar( &pTable->keys, '"' );
+        }
+        else
+        {
+            result = MSGBUF_Printf( &pTable->keys,
+                                    "\"[%d]",
+                                    pInfo->instanceID );
+        }
+
+        if ( result == EOK )
+        {
+            result = MSGBUF_AppendEscaped( &pTable->keys,
+                                           pInfo->name,
+                                           strlen( pInfo->name ) );
+        }
+
+        if ( result == EOK )
+        {
+            result = MSGBUF_Append( &pTable->keys, "\":", 2 );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  AddCBORKey                                                                */
+/*!
+    Pre-encode the CBOR key of a message body variable
+
+    The AddCBORKey function appends the name of the variable to the key
+    buffer as a CBOR text string.  The name of an instanced variable is
+    prefixed with its instance identifier, as it is for JSON keys.
+
+    @param[in]
+        pTable
+            pointer to the variable information table
+
+    @param[in]
+        pInfo
+            pointer to the variable information
+
+    @retval EOK the key was encoded
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int AddCBORKey( VarMetaTable *pTable, VarInfo *pInfo )
+{
+    int result = EINVAL;
+    char key[MAX_NAME_LEN + 16];
+    int n;
+
+    if ( ( pTable != NULL ) &&
+         ( pInfo != NULL ) )
+    {
+        if ( pInfo->instanceID == 0 )
+        {
+            n = snprintf( key, sizeof( key ), "%s", pInfo->name );
+        }
+        else
+        {
+            n = snprintf( key,
+                          sizeof( key ),
+                          "[%d]%s",
+                          pInfo->instanceID,
+                          pInfo->name );
+        }
+
+        if ( ( n > 0 ) && ( (size_t)n < sizeof( key ) ) )
+        {
+            result = CBOR_AppendText( &pTable->keys, key, n );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SealVarMeta                                                               */
+/*!
+    Move a completed variable information table into an arena
+
+    The SealVarMeta function copies the entries and the pre-encoded
+    keys of the table into an arena which is sized to hold exactly
+    those, and releases the heap storage which the table was grown in.
+    The table and its keys are then contiguous in memory, and the
+    whole table is released with a single call.  A sealed table cannot
+    grow, so a table which needs to change is rebuilt.  Empty tables
+    are left as they are.
+
+    @param[in,out]
+        pTable
+            pointer to the variable information table to seal
+
+    @retval EOK the table was sealed, or is empty
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int SealVarMeta( VarMetaTable *pTable )
+{
+    int result = EINVAL;
+    Arena *pArena;
+    VarMeta *pMeta;
+    char *pKeys;
+    size_t size;
+    size_t len;
+
+    if ( ( pTable != NULL ) &&
+         ( pTable->pArena == NULL ) )
+    {
+        result = EOK;
+
+        if ( pTable->n > 0 )
+        {
+            len = pTable->keys.len;
+            size = ARENA_ROUND( pTable->n * sizeof( VarMeta ) ) +
+                   ARENA_ROUND( len );
+
+            pArena = ARENA_Create( size );
+            pMeta = ARENA_Dup( pArena,
+                               pTable->pMeta,
+                               pTable->n * sizeof( VarMeta ) );
+            pKeys = ARENA_Dup( pArena, pTable->keys.pData, len );
+            if ( ( pMeta != NULL ) &&
+                 ( pKeys != NULL ) )
+            {
+                free( pTable->pMeta );
+                MSGBUF_Free( &pTable->keys );
+
+                pTable->pArena = pArena;
+                pTable->pMeta = pMeta;
+                pTable->size = pTable->n;
+                pTable->keys.pData = pKeys;
+                pTable->keys.len = len;
+                pTable->keys.size = len;
+            }
+            else
+            {
+                ARENA_Free( pArena );
+                result = ENOMEM;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  FreeVarMeta                                                               */
+/*!
+    Release a message body variable information table
+
+    @param[in]
+        pTable
+            pointer to the variable information table to release
+
+==============================================================================*/
+static void FreeVarMeta( VarMetaTable *pTable )
+{
+    if ( pTable != NULL )
+    {
+        if ( pTable->pArena != NULL )
+        {
+            /* the entries and keys were sealed into the arena */
+            ARENA_Free( pTable->pArena );
+            pTable->pArena = NULL;
+            pTable->keys.pData = NULL;
+            pTable->keys.len = 0;
+            pTable->keys.size = 0;
+        }
+        else
+        {
+            free( pTable->pMeta );
+            MSGBUF_Free( &pTable->keys );
+        }
+
+        pTable->pMeta = NULL;
+        pTable->n = 0;
+        pTable->size = 0;
+    }
+}
+
+/*============================================================================*/
+/*  ParseMode                                                                 */
+/*!
+    Parse the message mode
+
+    The ParseMode function processes the "mode", "keyframe" and "shed"
+    attributes of the JSON configuration.  When the mode is "delta",
+    only the body variables which have been modified since the previous
+    message are included in each message.  A full message (keyframe)
+    is generated every "keyframe" messages.
+
+    When the shed policy is "delta", a full mode message is sent in
+    delta mode instead of being sampled while it is being shed, so its
+    body variables are tracked as for a delta mode message.
+
+    @param[in]
+        pNode
+            pointer to the JNode for the message configuration
+
+    @param[in,out]
+        pConfig
+            pointer to the VarMsgConfig message definition to populate
+
+    @retval EOK the mode was parsed
+    @retval ENOTSUP unsupported mode
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int ParseMode( JNode *pNode, VarMsgConfig *pConfig )
+{
+    int result = EINVAL;
+    char *mode;
+    char *shed;
+    int keyframe;
+
+    if ( ( pNode != NULL ) &&
+         ( pConfig != NULL ) )
+    {
+        result = EOK;
+
+        mode = JSON_GetStr( pNode, "mode" );
+        if ( ( mode != NULL ) && ( strcmp( mode, "delta" ) == 0 ) )
+        {
+            pConfig->delta = true;
+        }
+        else if ( ( mode != NULL ) && ( strcmp( mode, "full" ) != 0 ) )
+        {
+            fprintf( stderr, "VARMSG: unsupported mode: %s\n", mode );
+            result = ENOTSUP;
+        }
+
+        shed = JSON_GetStr( pNode, "shed" );
+        if ( ( shed != NULL ) && ( strcmp( shed, "delta" ) == 0 ) )
+        {
+            /* a message which is already in delta mode is sampled */
+            if ( pConfig->delta == false )
+            {
+                pConfig->delta = true;
+                pConfig->shedDelta = true;
+            }
+        }
+        else if ( ( shed != NULL ) && ( strcmp( shed, "sample" ) != 0 ) )
+        {
+            fprintf( stderr, "VARMSG: unsupported shed policy: %s\n", shed );
+            result = ENOTSUP;
+        }
+
+        if ( pConfig->delta == true )
+        {
+            pConfig->keyframe = DELTA_KEYFRAME_DEFAULT;
+            if ( ( JSON_GetNum( pNode, "keyframe", &keyframe ) == EOK ) &&
+                 ( keyframe > 0 ) )
+            {
+                pConfig->keyframe = keyframe;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  LoadTemplate                                                              */
+/*!
+    Load the message template
+
+    The LoadTemplate function processes the "header" attribute of the
+    JSON configuration.  It names a template file which the message is
+    wrapped in, and is compiled once here so no template parsing is
+    done when the message is rendered.  The compiled template is kept
+    in the configuration arena.  Templates are only supported for JSON
+    messages.
+
+    @param[in]
+        pNode
+            pointer to the JNode for the message configuration
+
+    @param[in,out]
+        pConfig
+            pointer to the VarMsgConfig message definition to populate
+
+    @retval EOK the template was loaded, or is not required
+    @retval ENOTSUP the message format does not support templates
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+    @retval other error from MSGTMPL_Load
+
+==============================================================================*/
+static int LoadTemplate( JNode *pNode, VarMsgConfig *pConfig )
+{
+    int result = EINVAL;
+    MsgTemplate *pTemplate;
+
+    if ( ( pNode != NULL ) &&
+         ( pConfig != NULL ) )
+    {
+        result = EOK;
+
+        pConfig->header = ARENA_StrDup( pConfig->pArena,
+                                        JSON_GetStr( pNode, "header" ) );
+        if ( pConfig->header != NULL )
+        {
+            if ( pConfig->format != MSGFORMAT_JSON )
+            {
+                fprintf( stderr,
+                         "VARMSG: templates are only supported for json\n" );
+                result = ENOTSUP;
+            }
+            else
+            {
+                pTemplate = ARENA_Calloc( pConfig->pArena,
+                                          1,
+                                          sizeof( MsgTemplate ) );
+                if ( pTemplate != NULL )
+                {
+                    result = MSGTMPL_Load( pTemplate, pConfig->header );
+                    if ( result == EOK )
+                    {
+                        result = SealTemplate( pConfig->pArena, pTemplate );
+                    }
+
+                    if ( result == EOK )
+                    {
+                        pConfig->pTemplate = pTemplate;
+                    }
+                    else
+                    {
+                        fprintf( stderr,
+                                 "VARMSG: cannot load template %s: %s\n",
+                                 pConfig->header,
+                                 strerror( result ) );
+                        MSGTMPL_Free( pTemplate );
+                    }
+                }
+                else
+                {
+                    result = ENOMEM;
+                }
+            }
+
+            if ( result != EOK )
+            {
+                /* send the message without a template */
+                pConfig->header = NULL;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SealTemplate                                                              */
+/*!
+    Move a compiled message template into an arena
+
+    The SealTemplate function copies the parts and the text of a
+    compiled template into the specified arena, and releases the heap
+    storage used while the template was compiled.  A sealed template
+    is released with its arena and must not be passed to MSGTMPL_Free.
+
+    @param[in]
+        pArena
+            pointer to the arena to copy the template into
+
+    @param[in,out]
+        pTmpl
+            pointer to the compiled template to move
+
+    @retval EOK the template was moved into the arena
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int SealTemplate( Arena *pArena, MsgTemplate *pTmpl )
+{
+    int result = EINVAL;
+    MsgTmplPart *pParts;
+    char *pText;
+    size_t bodyIdx;
+    size_t len;
+    size_t n;
+
+    if ( ( pArena != NULL ) &&
+         ( pTmpl != NULL ) )
+    {
+        n = pTmpl->n;
+        bodyIdx = pTmpl->bodyIdx;
+        len = pTmpl->text.len;
+
+        pParts = ARENA_Dup( pArena, pTmpl->pParts, n * sizeof( MsgTmplPart ) );
+        pText = ARENA_Dup( pArena, pTmpl->text.pData, len );
+        if ( ( ( pParts != NULL ) || ( n == 0 ) ) &&
+             ( ( pText != NULL ) || ( len == 0 ) ) )
+        {
+            MSGTMPL_Free( pTmpl );
+
+            pTmpl->pParts = pParts;
+            pTmpl->n = n;
+            pTmpl->bodyIdx = bodyIdx;
+            pTmpl->text.pData = pText;
+            pTmpl->text.len = len;
+            pTmpl->text.size = len;
+            result = EOK;
+        }
+        else
+        {
+            result = ENOMEM;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ResolveTemplate                                                           */
+/*!
+    Find the variables used by the message template
+
+    The ResolveTemplate function looks up the handle of each variable
+    slot in the message template, and decides whether its value can be
+    formatted in-process.  A slot whose variable does not exist is left
+    empty when the message is rendered.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in,out]
+        pConfig
+            pointer to the VarMsgConfig message definition
+
+    @retval EOK the template variables were found, or there is no template
+    @retval ENOENT one or more template variables do not exist
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int ResolveTemplate( VarMsgState *pState, VarMsgConfig *pConfig )
+{
+    int result = EINVAL;
+    MsgTemplate *pTmpl;
+    MsgTmplPart *pPart;
+    VarInfo info;
+    char *name;
+    size_t i;
+
+    if ( ( pState != NULL ) &&
+         ( pConfig != NULL ) )
+    {
+        result = EOK;
+        pTmpl = pConfig->pTemplate;
+
+        for ( i = 0; ( pTmpl != NULL ) && ( i < pTmpl->n ); i++ )
+        {
+            pPart = &pTmpl->pParts[i];
+            if ( pPart->type == MSGTMPL_VAR )
+            {
+                name = &pTmpl->text.pData[pPart->offset];
+                pPart->hVar = VAR_FindByName( pState->hVarServer, name );
+                if ( pPart->hVar == VAR_INVALID )
+                {
+                    fprintf( stderr,
+                             "VARMSG: template variable %s not found\n",
+                             name );
+                    result = ENOENT;
+                }
+                else if ( ( pConfig->fastpath == true ) &&
+                          ( VAR_GetInfo( pState->hVarServer,
+                                         pPart->hVar,
+                                         &info ) == EOK ) )
+                {
+                    pPart->typed = IsTypedVar( &info );
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupDeltaMode                                                            */
+/*!
+    Set up delta message generation
+
+    The SetupDeltaMode function sets up the change tracking for a
+    delta mode message.  A NOTIFY_MODIFIED notification is requested
+    for each body variable, each body variable is added to the variable
+    index with its position in the message body, and a bitmap is created
+    to track which body variables have been modified.  All variables
+    start out marked as modified.
+
+    This function must be called after the body variable information
+    table has been built.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in,out]
+        pConfig
+            pointer to the VarMsgConfig message definition to populate
+
+    @retval EOK delta mode was set up, or is not required
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+    @retval other error from VAR_Notify
+
+==============================================================================*/
+static int SetupDeltaMode( VarMsgState *pState, VarMsgConfig *pConfig )
+{
+    int result = EINVAL;
+    VarMetaTable *pTable;
+    size_t words;
+    size_t i;
+
+    if ( ( pState != NULL ) &&
+         ( pConfig != NULL ) )
+    {
+        result = EOK;
+
+        if ( pConfig->delta == true )
+        {
+            /* mark all of the variables as modified */
+            pTable = &pConfig->pBody->meta;
+            words = ( pTable->n + DIRTY_WORD_BITS - 1 ) / DIRTY_WORD_BITS;
+            pConfig->pDirty = malloc( ( words + 1 ) * sizeof( uint32_t ) );
+            if ( pConfig->pDirty != NULL )
+            {
+                memset( pConfig->pDirty,
+                        0xFF,
+                        ( words + 1 ) * sizeof( uint32_t ) );
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+
+            /* get notified when the body variables change */
+            for ( i = 0; ( result == EOK ) && ( i < pTable->n ); i++ )
+            {
+                result = IndexVar( pState,
+                                   pConfig,
+                                   pTable->pMeta[i].hVar,
+                                   VARROLE_BODY,
+                                   i );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  MarkModified                                                              */
+/*!
+    Mark a body variable as modified
+
+    The MarkModified function marks the body variable at the specified
+    position in a delta mode message as modified so it will be included
+    in the next message.
+
+    @param[in]
+        pConfig
+            pointer to the variable message configuration
+
+    @param[in]
+        idx
+            position of the variable in the variable information table
+
+==============================================================================*/
+static void MarkModified( VarMsgConfig *pConfig, size_t idx )
+{
+    if ( ( pConfig != NULL ) &&
+         ( pConfig->pDirty != NULL ) &&
+         ( idx < pConfig->pBody->meta.n ) )
+    {
+        __atomic_fetch_or( &pConfig->pDirty[idx / DIRTY_WORD_BITS],
+                           ( 1U << ( idx % DIRTY_WORD_BITS ) ),
+                           __ATOMIC_RELAXED );
+    }
+}
+
+/*============================================================================*/
+/*  TestAndClearModified                                                      */
+/*!
+    Test and clear the modified flag of a body variable
+
+    @param[in]
+        pConfig
+            pointer to the variable message configuration
+
+    @param[in]
+        idx
+            position of the variable in the variable information table
+
+    @retval true the variable was modified since the previous message
+    @retval false the variable was not modified
+
+==============================================================================*/
+static bool TestAndClearModified( VarMsgConfig *pConfig, size_t idx )
+{
+    bool result = false;
+    uint32_t mask;
+    uint32_t old;
+
+    if ( ( pConfig != NULL ) &&
+         ( pConfig->pDirty != NULL ) )
+    {
+        mask = 1U << ( idx % DIRTY_WORD_BITS );
+        old = __atomic_fetch_and( &pConfig->pDirty[idx / DIRTY_WORD_BITS],
+                                  ~mask,
+                                  __ATOMIC_RELAXED );
+
+        result = ( old & mask ) ? true : false;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseTime                                                                 */
+/*!
+    Get a time setting from the message configuration
+
+    The ParseTime function gets a time setting from the message
+    configuration.  The setting may be specified as "<name>_ms"
+    (milliseconds), as a numeric "<name>" (seconds), or as a "<name>"
+    string with a units suffix, such as "100ms", "5s" or "5m".
+
+    @param[in]
+        pNode
+            pointer to the JNode for the message configuration
+
+    @param[in]
+        name
+            name of the time setting
+
+    @param[out]
+        pValue
+            pointer to the location to store the time in milliseconds
+
+    @retval EOK the time setting was retrieved
+    @retval ENOENT the time setting was not specified
+    @retval EINVAL invalid arguments or invalid time string
+
+==============================================================================*/
+static int ParseTime( JNode *pNode, char *name, uint32_t *pValue )
+{
+    int result = EINVAL;
+    char msname[64];
+    char *str;
+    int n;
+
+    if ( ( pNode != NULL ) &&
+         ( name != NULL ) &&
+         ( pValue != NULL ) )
+    {
+        result = ENOENT;
+
+        snprintf( msname, sizeof( msname ), "%s_ms", name );
+        str = JSON_GetStr( pNode, name );
+
+        if ( JSON_GetNum( pNode, msname, &n ) == EOK )
+        {
+            result = ( n >= 0 ) ? EOK : EINVAL;
+            *pValue = ( n >= 0 ) ? n : 0;
+        }
+        else if ( str != NULL )
+        {
+            result = ParseDuration( str, pValue );
+        }
+        else if ( JSON_GetNum( pNode, name, &n ) == EOK )
+        {
+            result = ( ( n >= 0 ) && ( n <= ( INT32_MAX / 1000 ) ) ) ? EOK
+                                                                    : EINVAL;
+            *pValue = ( result == EOK ) ? n * 1000 : 0;
+        }
+
+        if ( result == EINVAL )
+        {
+            fprintf( stderr, "VARMSG: invalid %s\n", name );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseDuration                                                             */
+/*!
+    Convert a duration string to milliseconds
+
+    The ParseDuration function converts a number followed by an optional
+    units suffix to milliseconds.  The supported suffixes are
+    "ms" (milliseconds), "s" (seconds), "m" (minutes) and "h" (hours).
+    A number without a suffix is in seconds.
+
+    @param[in]
+        str
+            pointer to the duration string
+
+    @param[out]
+        pDuration
+            pointer to the location to store the duration in milliseconds
+
+    @retval EOK the duration was converted
+    @retval EINVAL invalid arguments or invalid duration string
+
+==============================================================================*/
+static int ParseDuration( const char *str, uint32_t *pDuration )
+{
+    int result = EINVAL;
+    unsigned long n;
+    unsigned long scale = 0;
+    char *end = NULL;
+
+    if ( ( str != NULL ) &&
+         ( pDuration != NULL ) &&
+         ( isdigit( (unsigned char)*str ) ) )
+    {
+        n = strtoul( str, &end, 10 );
+
+        while ( isspace( (unsigned char)*end ) )
+        {
+            end++;
+        }
+
+        if ( strcmp( end, "ms" ) == 0 )
+        {
+            scale = 1;
+        }
+        else if ( ( *end == '\0' ) || ( strcmp( end, "s" ) == 0 ) )
+        {
+            scale = 1000;
+        }
+        else if ( strcmp( end, "m" ) == 0 )
+        {
+            scale = 60 * 1000;
+        }
+        else if ( strcmp( end, "h" ) == 0 )
+        {
+            scale = 60 * 60 * 1000;
+        }
+
+        if ( ( scale != 0 ) &&
+             ( n <= ( UINT32_MAX / scale ) ) )
+        {
+            *pDuration = (uint32_t)( n * scale );
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupEvents                                                               */
+/*!
+    Set up the event loop and the variable server notifications
+
+    The SetupEvents function creates the event loop which the main
+    thread waits on, and the state used to collect the modified
+    notifications.  The variable server notification signal is blocked
+    and received through a signalfd, so it must be set up before any
+    notification is requested, and before any thread is started.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @retval EOK the event loop was set up
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+    @retval other error from EVLOOP_Init, signalfd or EVLOOP_Add
+
+==============================================================================*/
+static int SetupEvents( VarMsgState *pState )
+{
+    int result = EINVAL;
+    sigset_t mask;
+
+    if ( pState != NULL )
+    {
+        pState->sigFd = -1;
+        pState->timerFd = -1;
+        pState->watchFd = -1;
+        pState->flushFd = -1;
+
+        result = EVLOOP_Init( &pState->loop );
+        if ( result == EOK )
+        {
+            result = VALCACHE_Init( &pState->modifiedSet, MODIFIED_SIZE );
+        }
+
+        if ( result == EOK )
+        {
+            pState->pModified = malloc( MODIFIED_SIZE * sizeof( VAR_HANDLE ) );
+            pState->maxModified = MODIFIED_SIZE;
+            result = ( pState->pModified != NULL ) ? EOK : ENOMEM;
+        }
+
+        if ( result == EOK )
+        {
+            sigemptyset( &mask );
+            sigaddset( &mask, SIG_VAR_MODIFIED );
+            pthread_sigmask( SIG_BLOCK, &mask, NULL );
+
+            pState->sigFd = signalfd( -1, &mask, SFD_NONBLOCK | SFD_CLOEXEC );
+            result = ( pState->sigFd != -1 ) ? EOK : errno;
+        }
+
+        if ( result == EOK )
+        {
+            result = EVLOOP_Add( &pState->loop,
+                                 &pState->sigSource,
+                                 pState->sigFd,
+                                 EVLOOP_READ,
+                                 ReadSignals,
+                                 pState );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ReadSignals                                                               */
+/*!
+    Collect the pending variable server notifications
+
+    The ReadSignals function is the event loop handler for the
+    notification signalfd.  It reads the pending notifications in
+    batches, and adds the handle of each modified variable to the list
+    of variables modified in this wakeup.  At most SIGNAL_DRAIN_MAX
+    notifications are read, so a flood of notifications cannot hold
+    up the processing cycle; any remaining notifications are collected
+    on the next wakeup.
+
+    @param[in]
+        fd
+            signalfd file descriptor
+
+    @param[in]
+        events
+            ready events (unused)
+
+    @param[in]
+        arg
+            pointer to the Variable Message Generator state
+
+==============================================================================*/
+static void ReadSignals( int fd, uint32_t events, void *arg )
+{
+    VarMsgState *pState = (VarMsgState *)arg;
+    struct signalfd_siginfo info[SIGNAL_BATCH];
+    size_t total = 0;
+    size_t count;
+    ssize_t n;
+    size_t i;
+
+    (void)events;
+
+    if ( pState != NULL )
+    {
+        /* the handle set is emptied on each wakeup */
+        VALCACHE_Begin( &pState->modifiedSet, ++pState->wakeups );
+
+        do
+        {
+            n = read( fd, info, sizeof( info ) );
+            count = ( n > 0 ) ? (size_t)n / sizeof( info[0] ) : 0;
+
+            for ( i = 0; i < count; i++ )
+            {
+                if ( (int)info[i].ssi_signo == SIG_VAR_MODIFIED )
+                {
+                    AddModified( pState, (VAR_HANDLE)info[i].ssi_int );
+                }
+            }
+
+            total += count;
+
+        } while ( ( count == SIGNAL_BATCH ) &&
+                  ( total < SIGNAL_DRAIN_MAX ) );
+    }
+}
+
+/*============================================================================*/
+/*  AddModified                                                               */
+/*!
+    Add a variable to the list of variables modified in this wakeup
+
+    The AddModified function appends the variable handle to the list of
+    modified variables, unless it is already in the list.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        hVar
+            handle of the modified variable
+
+    @retval EOK the handle was added
+    @retval EEXIST the handle is already in the list
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int AddModified( VarMsgState *pState, VAR_HANDLE hVar )
+{
+    int result = EINVAL;
+    const char *pData;
+    size_t len;
+    VAR_HANDLE *p;
+
+    if ( pState != NULL )
+    {
+        if ( VALCACHE_Find( &pState->modifiedSet,
+                            hVar,
+                            0,
+                            &pData,
+                            &len ) == EOK )
+        {
+            result = EEXIST;
+        }
+        else if ( pState->numModified == pState->maxModified )
+        {
+            p = realloc( pState->pModified,
+                         pState->maxModified * 2 * sizeof( VAR_HANDLE ) );
+            if ( p != NULL )
+            {
+                pState->pModified = p;
+                pState->maxModified *= 2;
+                result = EOK;
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+        else
+        {
+            result = EOK;
+        }
+
+        if ( result == EOK )
+        {
+            /* the set only records the handle, so it stores no data */
+            VALCACHE_Add( &pState->modifiedSet, hVar, 0, "", 0 );
+            pState->pModified[pState->numModified++] = hVar;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ReadTimer                                                                 */
+/*!
+    Handle a scheduler timer expiry
+
+    The ReadTimer function is the event loop handler for the scheduler
+    timerfd.  It clears the expiry and records that the timer expired,
+    so the schedule is processed in this wakeup.
+
+    @param[in]
+        fd
+            timerfd file descriptor
+
+    @param[in]
+        events
+            ready events (unused)
+
+    @param[in]
+        arg
+            pointer to the Variable Message Generator state
+
+==============================================================================*/
+static void ReadTimer( int fd, uint32_t events, void *arg )
+{
+    VarMsgState *pState = (VarMsgState *)arg;
+    uint64_t expirations;
+
+    (void)events;
+
+    if ( ( pState != NULL ) &&
+         ( read( fd, &expirations, sizeof( expirations ) ) ==
+                 sizeof( expirations ) ) )
+    {
+        pState->timerExpired = true;
+    }
+}
+
+/*============================================================================*/
+/*  SetupTimer                                                                */
+/*!
+    Set up the scheduler timer
+
+    The SetupTimer function creates a one-shot CLOCK_MONOTONIC timerfd
+    which is used to wake up the message generator when the next
+    scheduled message is due, and adds it to the event loop.  The timer
+    is armed by UpdateTimer.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @retval EOK timer set up ok
+    @retval EINVAL invalid arguments
+    @retval other error from timerfd_create or EVLOOP_Add
+
+==============================================================================*/
+static int SetupTimer( VarMsgState *pState )
+{
+    int result = EINVAL;
+
+    if ( pState != NULL )
+    {
+        pState->timerFd = timerfd_create( CLOCK_MONOTONIC,
+                                          TFD_NONBLOCK | TFD_CLOEXEC );
+        if ( pState->timerFd != -1 )
+        {
+            result = EVLOOP_Add( &pState->loop,
+                                 &pState->timerSource,
+                                 pState->timerFd,
+                                 EVLOOP_READ,
+                                 ReadTimer,
+                                 pState );
+        }
+        else
+        {
+            result = errno;
+        }
+
+        if ( result == EOK )
+        {
+            pState->timerDue = 0;
+            result = UpdateTimer( pState );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  UpdateTimer                                                               */
+/*!
+    Arm the scheduler timer for the next scheduled message
+
+    The UpdateTimer function arms the scheduler timer to expire when the
+    earliest scheduled message is due, or disarms it if there are no
+    scheduled messages.  The timer is only changed if the earliest
+    due time has changed.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @retval EOK the timer was updated
+    @retval EINVAL invalid arguments
+    @retval other error from timerfd_settime
+
+==============================================================================*/
+static int UpdateTimer( VarMsgState *pState )
+{
+    int result = EINVAL;
+    struct itimerspec its;
+    SchedItem *pItem;
+    uint64_t due;
+
+    if ( pState != NULL )
+    {
+        result = EOK;
+
+        pItem = SCHED_Top( &pState->sched );
+        due = ( pItem != NULL ) ? pItem->due : 0;
+
+        if ( due != pState->timerDue )
+        {
+            /* a zero expiry time disarms the timer */
+            memset( &its, 0, sizeof( its ) );
+            its.it_value.tv_sec = due / 1000;
+            its.it_value.tv_nsec = ( due % 1000 ) * 1000000;
+            if ( timerfd_settime( pState->timerFd,
+                                  TFD_TIMER_ABSTIME,
+                                  &its,
+                                  NULL ) == 0 )
+            {
+                pState->timerDue = due;
+            }
+            else
+            {
+                result = errno;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupFlush                                                                */
+/*!
+    Set up the network sink flush retries
+
+    The SetupFlush function creates an eventfd which the sinks signal
+    when a flush on any thread leaves a network sink with data to send
+    or a connection to make, and adds it to the event loop, so the
+    retry is scheduled even if no other event arrives.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @retval EOK the flush retries were set up
+    @retval EINVAL invalid arguments
+    @retval other error from eventfd or EVLOOP_Add
+
+==============================================================================*/
+static int SetupFlush( VarMsgState *pState )
+{
+    int result = EINVAL;
+
+    if ( pState != NULL )
+    {
+        SCHED_InitItem( &pState->flushItem, SCHED_TYPE_FLUSH, pState );
+
+        pState->flushFd = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+        if ( pState->flushFd != -1 )
+        {
+            result = EVLOOP_Add( &pState->loop,
+                                 &pState->flushSource,
+                                 pState->flushFd,
+                                 EVLOOP_READ,
+                                 ReadFlush,
+                                 pState );
+        }
+        else
+        {
+            result = errno;
+        }
+
+        if ( result == EOK )
+        {
+            SINK_SetNotify( pState->flushFd );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ReadFlush                                                                 */
+/*!
+    Read the sink flush retry notifications
+
+    The ReadFlush function is the event loop callback for the sink flush
+    retry eventfd.  It clears the notification count.  The retry itself
+    is scheduled by ScheduleFlush at the end of the processing cycle.
+
+    @param[in]
+        fd
+            the flush retry eventfd
+
+    @param[in]
+        events
+            the epoll events which occurred (unused)
+
+    @param[in]
+        arg
+            pointer to the Variable Message Generator state
+
+==============================================================================*/
+static void ReadFlush( int fd, uint32_t events, void *arg )
+{
+    uint64_t count;
+
+    (void)events;
+    (void)arg;
+
+    if ( read( fd, &count, sizeof( count ) ) != sizeof( count ) )
+    {
+        /* there were no notifications to read */
+    }
+}
+
+/*============================================================================*/
+/*  ScheduleFlush                                                             */
+/*!
+    Schedule the next network sink flush retry
+
+    The ScheduleFlush function schedules a flush of the sinks for the
+    time at which a network sink next needs one, to resend data which
+    the socket would not take, to complete a connection which is being
+    made, or to make the next connection attempt at the end of the
+    reconnection backoff.  The retry is removed from the schedule if
+    no sink needs it.  Any notification signalled by the flushes in
+    this processing cycle is collected here, so it does not cause
+    another wakeup.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+==============================================================================*/
+static void ScheduleFlush( VarMsgState *pState )
+{
+    uint64_t due;
+
+    if ( pState != NULL )
+    {
+        if ( pState->flushFd != -1 )
+        {
+            ReadFlush( pState->flushFd, EVLOOP_READ, pState );
+        }
+
+        due = SINK_FlushDue();
+        if ( due != 0 )
+        {
+            SCHED_Insert( &pState->sched, &pState->flushItem, due );
+        }
+        else
+        {
+            SCHED_Remove( &pState->sched, &pState->flushItem );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  SetupWatch                                                                */
+/*!
+    Watch the configuration directory for changes
+
+    The SetupWatch function creates an inotify descriptor which watches
+    the configuration directory for configuration files which are
+    written, moved in or out, or deleted, and adds it to the event loop.
+    Nothing is watched if no configuration directory was specified.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @retval EOK the directory is being watched, or there is no directory
+    @retval EINVAL invalid arguments
+    @retval other error from inotify or EVLOOP_Add
+
+==============================================================================*/
+static int SetupWatch( VarMsgState *pState )
+{
+    int result = EINVAL;
+
+    if ( pState != NULL )
+    {
+        result = EOK;
+
+        if ( pState->pConfigDir != NULL )
+        {
+            result = MSGBUF_Init( &pState->reloads, 0 );
+            if ( result == EOK )
+            {
+                pState->watchFd = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+                result = ( pState->watchFd != -1 ) ? EOK : errno;
+            }
+
+            if ( ( result == EOK ) &&
+                 ( inotify_add_watch( pState->watchFd,
+                                      pState->pConfigDir,
+                                      WATCH_EVENTS ) == -1 ) )
+            {
+                result = errno;
+            }
+
+            if ( result == EOK )
+            {
+                result = EVLOOP_Add( &pState->loop,
+                                     &pState->watchSource,
+                                     pState->watchFd,
+                                     EVLOOP_READ,
+                                     ReadWatch,
+                                     pState );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ReadWatch                                                                 */
+/*!
+    Collect the configuration directory changes
+
+    The ReadWatch function is the event loop handler for the
+    configuration directory watch.  It reads the pending directory
+    events and records the name of each changed configuration file, so
+    the files can be reloaded at the end of the processing cycle.
+    Hidden files are skipped.  If the kernel event queue overflowed,
+    every configuration file is checked on the next reload.
+
+    @param[in]
+        fd
+            inotify file descriptor
+
+    @param[in]
+        events
+            ready events (unused)
+
+    @param[in]
+        arg
+            pointer to the Variable Message Generator state
+
+==============================================================================*/
+static void ReadWatch( int fd, uint32_t events, void *arg )
+{
+    VarMsgState *pState = (VarMsgState *)arg;
+    char buf[WATCH_BUFSIZE]
+        __attribute__(( aligned( __alignof__( struct inotify_event ) ) ));
+    struct inotify_event *pEvent;
+    ssize_t offset;
+    ssize_t n;
+
+    (void)events;
+
+    if ( pState != NULL )
+    {
+        while ( ( n = read( fd, buf, sizeof( buf ) ) ) > 0 )
+        {
+            offset = 0;
+            while ( offset < n )
+            {
+                pEvent = (struct inotify_event *)&buf[offset];
+                if ( pEvent->mask & IN_Q_OVERFLOW )
+                {
+                    pState->reloadAll = true;
+                }
+                else if ( ( pEvent->len > 0 ) &&
+                          ( pEvent->name[0] != '.' ) )
+                {
+                    AddReload( pState, pEvent->name );
+                }
+
+                offset += sizeof( struct inotify_event ) + pEvent->len;
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  AddReload                                                                 */
+/*!
+    Add a configuration file to the list of files to reload
+
+    The AddReload function adds the name of a changed configuration file
+    to the list of files to reload, unless it is already in the list.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        name
+            name of the file in the configuration directory
+
+    @retval EOK the name was added
+    @retval EEXIST the name is already in the list
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int AddReload( VarMsgState *pState, char *name )
+{
+    int result = EINVAL;
+    size_t offset = 0;
+    char *p;
+
+    if ( ( pState != NULL ) &&
+         ( name != NULL ) )
+    {
+        result = EOK;
+
+        while ( offset < pState->reloads.len )
+        {
+            p = &pState->reloads.pData[offset];
+            if ( strcmp( p, name ) == 0 )
+            {
+                result = EEXIST;
+                break;
+            }
+
+            offset += strlen( p ) + 1;
+        }
+
+        if ( result == EOK )
+        {
+            /* keep the NUL terminator to separate the names */
+            result = MSGBUF_Append( &pState->reloads,
+                                    name,
+                                    strlen( name ) + 1 );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ScheduleInterval                                                          */
+/*!
+    Schedule the next interval message
+
+    The ScheduleInterval function schedules the next interval message
+    of a configuration.  Interval messages are aligned to the start of
+    the schedule plus the message phase, so the next message is due at
+    the first such boundary after the specified time.  Messages without
+    an interval are not scheduled.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        pConfig
+            pointer to the variable message configuration
+
+    @param[in]
+        now
+            monotonic time to schedule from in milliseconds
+
+    @retval EOK the message was scheduled, or has no interval
+    @retval EINVAL invalid arguments
+    @retval ENOMEM memory allocation failure
+
+==============================================================================*/
+static int ScheduleInterval( VarMsgState *pState,
+                             VarMsgConfig *pConfig,
+                             uint64_t now )
+{
+    int result = EINVAL;
+    uint32_t interval;
+    uint64_t base;
+    uint64_t due;
+
+    if ( ( pState != NULL ) &&
+         ( pConfig != NULL ) )
+    {
+        result = EOK;
+
+        interval = pState->msgs.pInterval[pConfig->id];
+        if ( interval != 0 )
+        {
+            base = pState->epoch + ( pConfig->phase % interval );
+            if ( now < base )
+            {
+                due = base;
+            }
+            else
+            {
+                due = base + ( ( ( now - base ) / interval ) + 1 ) * interval;
+            }
+
+            result = SCHED_Insert( &pState->sched,
+                                   &pConfig->intervalItem,
+                                   due );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  StartSchedule                                                             */
+/*!
+    Schedule all of the enabled interval messages
+
+    The StartSchedule function is called once all of the message
+    configurations have been loaded.  It records the start time of the
+    schedule, assigns phases to the interval messages if automatic
+    staggering is enabled, and schedules the first message of each
+    enabled interval message, the first automatic rescan of each
+    message which has a rescan interval, the first publication of
+    the performance counters, and the first shed level update if
+    there is a render time budget.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @retval EOK the messages were scheduled
+    @retval EINVAL invalid arguments
+    @retval ENOMEM memory allocation failure
+
+==============================================================================*/
+static int StartSchedule( VarMsgState *pState )
+{
+    int result = EINVAL;
+    VarMsgConfig *pConfig;
+    MsgTable *pMsgs;
+    size_t id;
+    int rc;
+
+    if ( pState != NULL )
+    {
+        result = EOK;
+
+        pState->epoch = GetTimeMs();
+
+        if ( pState->stagger == true )
+        {
+            StaggerMessages( pState );
+        }
+
+        pMsgs = &pState->msgs;
+        for ( id = 0; id < pMsgs->n; id++ )
+        {
+            pConfig = (VarMsgConfig *)pMsgs->ppData[id];
+
+            if ( pMsgs->pEnabled[id] == true )
+            {
+                rc = ScheduleInterval( pState, pConfig, pState->epoch );
+                if ( rc != EOK )
+                {
+                    result = rc;
+                }
+            }
+
+            if ( pMsgs->pRescanInterval[id] != 0 )
+            {
+                rc = SCHED_Insert( &pState->sched,
+                                   &pConfig->rescanItem,
+                                   pState->epoch + pMsgs->pRescanInterval[id] );
+                if ( rc != EOK )
+                {
+                    result = rc;
+                }
+            }
+        }
+
+        /* schedule the first performance counter publication */
+        rc = SCHED_Insert( &pState->sched,
+                           &pState->statsItem,
+                           pState->epoch + STATS_INTERVAL_MS );
+        if ( rc != EOK )
+        {
+            result = rc;
+        }
+
+        /* start measuring the render time */
+        pState->shedTime = pState->epoch;
+        if ( pState->budget != 0 )
+        {
+            rc = SCHED_Insert( &pState->sched,
+                               &pState->shedItem,
+                               pState->epoch + SHED_INTERVAL_MS );
+            if ( rc != EOK )
+            {
+                result = rc;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  StaggerMessages                                                           */
+/*!
+    Spread the interval messages evenly across their interval
+
+    The StaggerMessages function assigns a phase to each interval
+    message which does not have an explicit phase.  The messages which
+    share an interval are spaced evenly across that interval, so they
+    do not all become due at the same time.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+==============================================================================*/
+static void StaggerMessages( VarMsgState *pState )
+{
+    VarMsgConfig *pConfig;
+    uint32_t interval;
+
+    pConfig = pState->pMessageConfigs;
+    while ( pConfig != NULL )
+    {
+        interval = pState->msgs.pInterval[pConfig->id];
+        if ( ( interval != 0 ) &&
+             ( pConfig->phaseSet == false ) )
+        {
+            StaggerInterval( pState, interval );
+        }
+
+        pConfig = pConfig->pNext;
+    }
+}
+
+/*============================================================================*/
+/*  StaggerInterval                                                           */
+/*!
+    Spread the messages which share an interval evenly across it
+
+    The StaggerInterval function assigns a phase to each message with
+    the specified interval which does not have an explicit phase, in
+    the order of the message list.  A message which is already
+    scheduled is moved to the next time it is due at its new phase,
+    so a message loaded by a reload can be staggered amongst the
+    running messages.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        interval
+            the message interval in milliseconds
+
+==============================================================================*/
+static void StaggerInterval( VarMsgState *pState, uint32_t interval )
+{
+    VarMsgConfig *pConfig;
+    uint32_t *pInterval = pState->msgs.pInterval;
+    uint64_t count = 0;
+    uint64_t k = 0;
+    uint64_t now;
+
+    /* count the messages with the interval */
+    pConfig = pState->pMessageConfigs;
+    while ( pConfig != NULL )
+    {
+        if ( ( pInterval[pConfig->id] == interval ) &&
+             ( pConfig->phaseSet == false ) )
+        {
+            count++;
+        }
+
+        pConfig = pConfig->pNext;
+    }
+
+    now = GetTimeMs();
+
+    pConfig = pState->pMessageConfigs;
+    while ( pConfig != NULL )
+    {
+        if ( ( pInterval[pConfig->id] == interval ) &&
+             ( pConfig->phaseSet == false ) )
+        {
+            pConfig->phase = ( k * interval ) / count;
+            k++;
+
+            if ( SCHED_IsScheduled( &pConfig->intervalItem ) == true )
+            {
+                ScheduleInterval( pState, pConfig, now );
+            }
+        }
+
+        pConfig = pConfig->pNext;
+    }
+}
+
+/*============================================================================*/
+/*  SetupModifiedTrigger                                                      */
+/*!
+    Set up "modified" triggers for the message
+
+    The SetupModifiedTrigger function requests a NOTIFY_MODIFIED notification
+    for each appropriate variable in the message.  This includes
+    any "trigger" variable, and any message group with the trigger
+    flag set.  Each trigger variable is added to the variable index
+    so its notifications are dispatched to this message.
+
+    @param[in]
+        pState
+            Pointer to the Variable Message state
+
+    @param[in]
+        pConfig
+            Pointer to the configuration for the Variable Message
+
+    @retval EOK notifications were set up ok
+    @retval EINVAL invalid arguments
+    @retval other error from VAR_Notify
+
+==============================================================================*/
+static int SetupModifiedTrigger( VarMsgState *pState, VarMsgConfig *pConfig )
+{
+    int result = EINVAL;
+
+    if ( ( pState != NULL ) &&
+         ( pConfig != NULL ) )
+    {
+        result = EOK;
+
+        if ( pConfig->pTriggerCache != NULL )
+        {
+            result = VARCACHE_Map( pConfig->pTriggerCache,
+                                   varmsg_CacheNotify,
+                                   pConfig );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varmsg_CacheNotify                                                        */
+/*!
+    Mapping callback function to request a variable notification
+
+    The varmsg_CacheNotify callback function is used by the
+    VARCACHE_Map function to request a NOTIFY_MODIFIED notification for a
+    trigger cache variable, and add it to the variable index.
+
+    @param[in]
+        hVar
+            handle of the trigger variable
+
+    @param[in]
+        arg
+            opaque pointer argument from the map function
+            which is converted to the variable message configuration
+
+    @retval EOK - notify request was successful
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+static int varmsg_CacheNotify( VAR_HANDLE hVar, void *arg )
+{
+    VarMsgConfig *pConfig = (VarMsgConfig *)arg;
+
+    return IndexVar( &state, pConfig, hVar, VARROLE_TRIGGER, 0 );
+}
+
+/*============================================================================*/
+/*  IndexVar                                                                  */
+/*!
+    Add a message variable to the variable index
+
+    The IndexVar function requests a NOTIFY_MODIFIED notification for
+    a variable, and adds it to the variable index so notifications for
+    the variable are dispatched to the specified message.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        pConfig
+            pointer to the variable message configuration
+
+    @param[in]
+        hVar
+            handle of the variable
+
+    @param[in]
+        role
+            role of the variable in the message
+
+    @param[in]
+        idx
+            position of the variable in the message body
+
+    @retval EOK - the variable was indexed
+    @retval ENOMEM - memory allocation failure
+    @retval EINVAL - invalid arguments
+    @retval other error from VAR_Notify
+
+==============================================================================*/
+static int IndexVar( VarMsgState *pState,
+                     VarMsgConfig *pConfig,
+                     VAR_HANDLE hVar,
+                     VarRole role,
+                     size_t idx )
+{
+    int result = EINVAL;
+
+    if ( ( pState != NULL ) &&
+         ( pConfig != NULL ) &&
+         ( hVar != VAR_INVALID ) )
+    {
+        if ( VARINDEX_Find( &pState->index, hVar ) == NULL )
+        {
+            /* the first message to use this variable requests
+               the notification */
+            result = VAR_Notify( pState->hVarServer, hVar, NOTIFY_MODIFIED );
+        }
+        else
+        {
+            result = EOK;
+        }
+
+        if ( result == EOK )
+        {
+            result = VARINDEX_Add( &pState->index, hVar, role, idx, pConfig );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  UnindexVar                                                                */
+/*!
+    Remove a message variable from the variable index
+
+    The UnindexVar function removes the variable index entry which
+    associates a variable with a message in the specified role.  When
+    no other message is interested in the variable, its NOTIFY_MODIFIED
+    notification is cancelled.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        pConfig
+            pointer to the variable message configuration
+
+    @param[in]
+        hVar
+            handle of the variable
+
+    @param[in]
+        role
+            role of the variable in the message
+
+    @retval EOK - the variable was removed from the index
+    @retval ENOENT - the variable was not indexed for this message
+    @retval EINVAL - invalid arguments
+    @retval other error from VAR_NotifyCancel
+
+==============================================================================*/
+static int UnindexVar( VarMsgState *pState,
+                       VarMsgConfig *pConfig,
+                       VAR_HANDLE hVar,
+                       VarRole role )
+{
+    int result = EINVAL;
+
+    if ( ( pState != NULL ) &&
+         ( pConfig != NULL ) &&
+         ( hVar != VAR_INVALID ) )
+    {
+        result = VARINDEX_Remove( &pState->index, hVar, role, pConfig );
+        if ( ( result == EOK ) &&
+             ( VARINDEX_Find( &pState->index, hVar ) == NULL ) )
+        {
+            /* the last message to use this variable cancels
+               the notification */
+            result = VAR_NotifyCancel( pState->hVarServer,
+                                       hVar,
+                                       NOTIFY_MODIFIED );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  FindIndexEntry                                                            */
+/*!
+    Find the variable index entry for a message variable
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        pConfig
+            pointer to the variable message configuration
+
+    @param[in]
+        hVar
+            handle of the variable
+
+    @param[in]
+        role
+            role of the variable in the message
+
+    @retval pointer to the variable index entry
+    @retval NULL the variable is not indexed for this message
+
+==============================================================================*/
+static VarIndexEntry *FindIndexEntry( VarMsgState *pState,
+                                      VarMsgConfig *pConfig,
+                                      VAR_HANDLE hVar,
+                                      VarRole role )
+{
+    VarIndexEntry *pEntry = NULL;
+
+    if ( pState != NULL )
+    {
+        pEntry = VARINDEX_Find( &pState->index, hVar );
+        while ( ( pEntry != NULL ) &&
+                ( ( pEntry->role != role ) ||
+                  ( pEntry->pData != pConfig ) ) )
+        {
+            pEntry = VARINDEX_Next( pEntry );
+        }
+    }
+
+    return pEntry;
+}
+
+/*============================================================================*/
+/*  ParseRescan                                                               */
+/*!
+    Parse the automatic rescan settings
+
+    The ParseRescan function processes the "rescan_interval" and
+    "rescan_on" attributes of the JSON configuration.  The rescan_on
+    variable name is copied into the configuration arena, since the
+    parsed configuration is released once it has been loaded.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        pNode
+            pointer to the JNode for the message configuration
+
+    @param[in,out]
+        pConfig
+            pointer to the VarMsgConfig message definition to populate
+
+    @retval EOK the rescan settings were parsed, or are not specified
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+    @retval other error from ParseTime
+
+==============================================================================*/
+static int ParseRescan( VarMsgState *pState,
+                        JNode *pNode,
+                        VarMsgConfig *pConfig )
+{
+    int result = EINVAL;
+    char *name;
+
+    if ( ( pState != NULL ) &&
+         ( pNode != NULL ) &&
+         ( pConfig != NULL ) )
+    {
+        result = ParseTime( pNode,
+                            "rescan_interval",
+                            &pState->msgs.pRescanInterval[pConfig->id] );
+        if ( result == ENOENT )
+        {
+            /* automatic rescans are optional */
+            result = EOK;
+        }
+
+        name = JSON_GetStr( pNode, "rescan_on" );
+        if ( name != NULL )
+        {
+            pConfig->rescanOn = ARENA_StrDup( pConfig->pArena, name );
+            if ( pConfig->rescanOn == NULL )
+            {
+                result = ENOMEM;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupRescan                                                               */
+/*!
+    Set up automatic rescans of the message variable queries
+
+    The SetupRescan function sets up the rescans which were requested
+    by the "rescan_interval" and "rescan_on" attributes of the JSON
+    configuration.  A message with a rescan interval has its variable
+    queries rerun periodically.  A message with a rescan_on variable
+    has its variable queries rerun whenever that variable is modified,
+    for example when a variable server change counter is updated.
+
+    Rescans can also be requested at any time by writing to the message
+    rescan variable.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in,out]
+        pConfig
+            pointer to the VarMsgConfig message definition to populate
+
+    @retval EOK the automatic rescans were set up, or are not required
+    @retval ENOENT the rescan_on variable was not found
+    @retval EINVAL invalid arguments
+    @retval other error from IndexVar
+
+==============================================================================*/
+static int SetupRescan( VarMsgState *pState, VarMsgConfig *pConfig )
+{
+    int result = EINVAL;
+    VAR_HANDLE hVar;
+    char *name;
+
+    if ( ( pState != NULL ) &&
+         ( pConfig != NULL ) )
+    {
+        result = EOK;
+
+        name = pConfig->rescanOn;
+        if ( name != NULL )
+        {
+            hVar = VAR_FindByName( pState->hVarServer, name );
+            if ( hVar != VAR_INVALID )
+            {
+                result = IndexVar( pState, pConfig, hVar, VARROLE_RESCAN, 0 );
+            }
+            else
+            {
+                fprintf( stderr, "VARMSG: rescan_on variable %s not found\n",
+                         name );
+                result = ENOENT;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RescanMessage                                                             */
+/*!
+    Rescan the variable queries of a message
+
+    The RescanMessage function reruns the trigger and message body
+    variable queries of a message, and patches the message with the
+    variables which were added or removed since the previous scan.
+    Variables which are given as a list instead of a query are not
+    rescanned.
+
+    If the message is being rendered by a render worker, the rescan
+    waits for the render to finish before the message is patched.  The
+    message cannot be queued again until the rescan is complete, since
+    messages are only queued by the main thread.  A shared message body
+    is locked while it is patched, since it may be being rendered for
+    one of the other messages which use it.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        pConfig
+            pointer to the variable message configuration
+
+    @retval EOK the variable queries were rescanned
+    @retval EINVAL invalid arguments
+    @retval other error from RescanTriggers or RescanBody
+
+==============================================================================*/
+static int RescanMessage( VarMsgState *pState, VarMsgConfig *pConfig )
+{
+    int result = EINVAL;
+    VarObject obj;
+
+    if ( ( pState != NULL ) &&
+         ( pConfig != NULL ) )
+    {
+        result = EOK;
+
+        /* wait for the message to be idle */
+        WaitIdle( pState, pConfig );
+
+        if ( pConfig->triggerQuery.type != 0 )
+        {
+            result = RescanTriggers( pState, pConfig );
+        }
+
+        if ( ( result == EOK ) &&
+             ( pConfig->varSet.type != 0 ) )
+        {
+            /* a shared body may be being rendered for another message */
+            pthread_mutex_lock( &pConfig->pBody->lock );
+            result = RescanBody( pState, pConfig );
+            pConfig->pBody->cycle = 0;
+            pthread_mutex_unlock( &pConfig->pBody->lock );
+        }
+
+        if ( result != EOK )
+        {
+            fprintf( stderr,
+                     "VARMSG: rescan of %s failed: %s\n",
+                     pConfig->configName,
+                     strerror( result ) );
+
+            obj.type = VARTYPE_UINT32;
+            obj.val.ul = ++pConfig->errCount;
+            VAR_Set( pState->hVarServer, pConfig->hErrCount, &obj );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RescanTriggers                                                            */
+/*!
+    Rescan the trigger variable query of a message
+
+    The RescanTriggers function reruns the trigger variable query, and
+    compares the result with the existing trigger variable cache.
+    Trigger variables which no longer match the query are removed from
+    the variable index, and variables which newly match the query are
+    added to it.  The trigger variable cache is then replaced with the
+    result of the query.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        pConfig
+            pointer to the variable message configuration
+
+    @retval EOK the trigger variables were rescanned
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+    @retval other error from the variable query or the notification
+            requests
+
+==============================================================================*/
+static int RescanTriggers( VarMsgState *pState, VarMsgConfig *pConfig )
+{
+    int result = EINVAL;
+    VarCache *pCache = NULL;
+    VarIndex found;
+    VarIndexEntry *pEntry;
+    VAR_HANDLE hVar;
+    size_t added = 0;
+    size_t removed = 0;
+    int rc;
+    int n;
+    int i;
+
+    memset( &found, 0, sizeof( found ) );
+
+    if ( ( pState != NULL ) &&
+         ( pConfig != NULL ) )
+    {
+        result = RunQuery( pState, &pConfig->triggerQuery, &pCache, &found );
+        if ( result == EOK )
+        {
+            /* stop triggering on the variables which no longer match */
+            n = VARCACHE_Size( pConfig->pTriggerCache );
+            for ( i = 0; i < n; i++ )
+            {
+                hVar = VARCACHE_Get( pConfig->pTriggerCache, i );
+                pEntry = VARINDEX_Find( &found, hVar );
+                if ( pEntry != NULL )
+                {
+                    pEntry->role = VARROLE_TRIGGER;
+                }
+                else
+                {
+                    rc = UnindexVar( pState, pConfig, hVar, VARROLE_TRIGGER );
+                    if ( ( rc != EOK ) && ( rc != ENOENT ) )
+                    {
+                        result = rc;
+                    }
+
+                    removed++;
+                }
+            }
+
+            /* start triggering on the new variables */
+            n = VARCACHE_Size( pCache );
+            for ( i = 0; i < n; i++ )
+            {
+                hVar = VARCACHE_Get( pCache, i );
+                pEntry = VARINDEX_Find( &found, hVar );
+                if ( ( pEntry != NULL ) &&
+                     ( pEntry->role == 0 ) )
+                {
+                    rc = IndexVar( pState, pConfig, hVar, VARROLE_TRIGGER, 0 );
+                    if ( rc != EOK )
+                    {
+                        result = rc;
+                    }
+
+                    added++;
+                }
+            }
+
+            VARCACHE_Free( pConfig->pTriggerCache );
+            pConfig->pTriggerCache = pCache;
+            pCache = NULL;
+
+            if ( ( pState->verbose == true ) &&
+                 ( ( added + removed ) > 0 ) )
+            {
+                printf( "Rescan %s: %zu triggers added, %zu removed\n",
+                        pConfig->configName,
+                        added,
+                        removed );
+            }
+        }
+    }
+
+    VARINDEX_Free( &found );
+
+    if ( pCache != NULL )
+    {
+        VARCACHE_Free( pCache );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RescanBody                                                                */
+/*!
+    Rescan the message body variable query of a message
+
+    The RescanBody function reruns the message body variable query, and
+    compares the result with the existing variable information table.
+    When the variable set has changed, the table is compacted to remove
+    the variables which no longer match the query, keeping the relative
+    order and pre-encoded keys of the remaining variables, and the new
+    variables are appended to it.  Only the new variables need their
+    variable information to be retrieved.
+
+    In delta mode the variable index entries and modified flags of the
+    remaining variables follow them to their new positions, the removed
+    variables are removed from the variable index, and the new
+    variables are added to the index and marked as modified so they
+    are included in the next message.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        pConfig
+            pointer to the variable message configuration
+
+    @retval EOK the message body variables were rescanned
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+    @retval other error from the variable query, the variable information
+            table, or the notification requests
+
+==============================================================================*/
+static int RescanBody( VarMsgState *pState, VarMsgConfig *pConfig )
+{
+    int result = EINVAL;
+    VarCache *pCache = NULL;
+    VarIndex found;
+    VarIndexEntry *pEntry;
+    VarMetaTable table;
+    VarMetaTable *pOld;
+    VarMeta *pMeta;
+    uint32_t *pDirty = NULL;
+    VAR_HANDLE hVar;
+    size_t kept = 0;
+    size_t added = 0;
+    size_t removed = 0;
+    size_t words;
+    size_t i;
+    int rc;
+    int n;
+    int k;
+
+    memset( &found, 0, sizeof( found ) );
+    memset( &table, 0, sizeof( table ) );
+
+    if ( ( pState != NULL ) &&
+         ( pConfig != NULL ) )
+    {
+        pOld = &pConfig->pBody->meta;
+
+        result = RunQuery( pState, &pConfig->varSet, &pCache, &found );
+        if ( result == EOK )
+        {
+            /* find the variables which still match the query */
+            for ( i = 0; i < pOld->n; i++ )
+            {
+                pEntry = VARINDEX_Find( &found, pOld->pMeta[i].hVar );
+                if ( pEntry != NULL )
+                {
+                    pEntry->role = VARROLE_BODY;
+                    kept++;
+                }
+            }
+
+            n = VARCACHE_Size( pCache );
+            added = (size_t)n - kept;
+            removed = pOld->n - kept;
+        }
+
+        if ( ( result == EOK ) &&
+             ( ( removed != 0 ) || ( added != 0 ) ) )
+        {
+            /* build the compacted table */
+            table.format = pOld->format;
+            table.size = kept + added + 1;
+            table.pMeta = calloc( table.size, sizeof( VarMeta ) );
+            result = ( table.pMeta != NULL ) ? EOK : ENOMEM;
+
+            if ( result == EOK )
+            {
+                result = MSGBUF_Init( &table.keys, pOld->keys.size );
+            }
+
+            if ( ( result == EOK ) &&
+                 ( pConfig->delta == true ) )
+            {
+                words = ( table.size + DIRTY_WORD_BITS - 1 ) /
+                        DIRTY_WORD_BITS;
+                pDirty = calloc( words + 1, sizeof( uint32_t ) );
+                result = ( pDirty != NULL ) ? EOK : ENOMEM;
+            }
+
+            for ( i = 0; ( result == EOK ) && ( i < pOld->n ); i++ )
+            {
+                pMeta = &pOld->pMeta[i];
+                if ( VARINDEX_Find( &found, pMeta->hVar ) == NULL )
+                {
+                    /* the variable no longer matches the query */
+                    if ( pConfig->delta == true )
+                    {
+                        UnindexVar( pState,
+                                    pConfig,
+                                    pMeta->hVar,
+                                    VARROLE_BODY );
+                    }
+                }
+                else
+                {
+                    /* move the variable and its key to its new position */
+                    table.pMeta[table.n] = *pMeta;
+                    table.pMeta[table.n].keyOffset = table.keys.len;
+                    result = MSGBUF_Append( &table.keys,
+                                            &pOld->keys.pData[pMeta->keyOffset],
+                                            pMeta->keyLen );
+
+                    if ( ( result == EOK ) &&
+                         ( pConfig->delta == true ) )
+                    {
+                        if ( TestAndClearModified( pConfig, i ) == true )
+                        {
+                            pDirty[table.n / DIRTY_WORD_BITS] |=
+                                    1U << ( table.n % DIRTY_WORD_BITS );
+                        }
+
+                        pEntry = FindIndexEntry( pState,
+                                                 pConfig,
+                                                 pMeta->hVar,
+                                                 VARROLE_BODY );
+                        if ( pEntry != NULL )
+                        {
+                            pEntry->idx = table.n;
+                        }
+                    }
+
+                    table.n++;
+                }
+            }
+
+            if ( result == EOK )
+            {
+                /* install the compacted table */
+                FreeVarMeta( pOld );
+                *pOld = table;
+                memset( &table, 0, sizeof( table ) );
+
+                if ( pConfig->delta == true )
+                {
+                    free( pConfig->pDirty );
+                    pConfig->pDirty = pDirty;
+                    pDirty = NULL;
+                }
+            }
+
+            /* append the new variables */
+            n = VARCACHE_Size( pCache );
+            for ( k = 0; ( result == EOK ) && ( k < n ); k++ )
+            {
+                hVar = VARCACHE_Get( pCache, k );
+                pEntry = VARINDEX_Find( &found, hVar );
+                if ( ( pEntry != NULL ) &&
+                     ( pEntry->role == 0 ) )
+                {
+                    /* new variables are included in the next message */
+                    rc = AddVarMeta( hVar, pConfig );
+                    if ( ( rc == EOK ) &&
+                         ( pConfig->delta == true ) )
+                    {
+                        MarkModified( pConfig, pOld->n - 1 );
+                        rc = IndexVar( pState,
+                                       pConfig,
+                                       hVar,
+                                       VARROLE_BODY,
+                                       pOld->n - 1 );
+                    }
+
+                    if ( rc == ENOMEM )
+                    {
+                        result = rc;
+                    }
+                }
+            }
+
+            if ( result == EOK )
+            {
+                /* the patched table is complete */
+                result = SealVarMeta( pOld );
+            }
+
+            if ( pState->verbose == true )
+            {
+                printf( "Rescan %s: %zu variables added, %zu removed\n",
+                        pConfig->configName,
+                        added,
+                        removed );
+            }
+        }
+
+        if ( result == EOK )
+        {
+            VARCACHE_Free( pConfig->pBody->pVarCache );
+            pConfig->pBody->pVarCache = pCache;
+            pCache = NULL;
+        }
+    }
+
+    free( pDirty );
+    FreeVarMeta( &table );
+    VARINDEX_Free( &found );
+
+    if ( pCache != NULL )
+    {
+        VARCACHE_Free( pCache );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RunQuery                                                                  */
+/*!
+    Run a variable query for a rescan
+
+    The RunQuery function runs a variable query into a new variable
+    cache, and builds a temporary variable index of the variables which
+    were found, so the result can be compared with the existing variable
+    set without searching the cache.  Each entry in the temporary index
+    has a role of zero until it is matched with an existing variable.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        pQuery
+            pointer to the variable query to run
+
+    @param[out]
+        ppVarCache
+            pointer to a location to store the new variable cache
+
+    @param[out]
+        pFound
+            pointer to the temporary variable index to initialize
+
+    @retval EOK the query was run
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+    @retval other error from VARQUERY_CacheUnique
+
+==============================================================================*/
+static int RunQuery( VarMsgState *pState,
+                     VarQuery *pQuery,
+                     VarCache **ppVarCache,
+                     VarIndex *pFound )
+{
+    int result = EINVAL;
+    int n;
+    int i;
+
+    if ( ( pState != NULL ) &&
+         ( pQuery != NULL ) &&
+         ( ppVarCache != NULL ) &&
+         ( pFound != NULL ) )
+    {
+        result = VARCACHE_Init( ppVarCache,
+                                CACHE_SIZE_INITIAL,
+                                CACHE_SIZE_GROW_BY );
+        if ( result == EOK )
+        {
+            result = VARQUERY_CacheUnique( pState->hVarServer,
+                                           pQuery,
+                                           *ppVarCache );
+        }
+
+        if ( result == EOK )
+        {
+            n = VARCACHE_Size( *ppVarCache );
+            result = VARINDEX_Init( pFound, n );
+            for ( i = 0; ( result == EOK ) && ( i < n ); i++ )
+            {
+                result = VARINDEX_Add( pFound,
+                                       VARCACHE_Get( *ppVarCache, i ),
+                                       0,
+                                       i,
+                                       NULL );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RunMessageGenerator                                                       */
+/*!
+    Run the message generator main loop
+
+    The RunMessageGenerator function waits on the event loop for the
+    scheduler timer, for notifications from the variable server, or for
+    changes to the configuration directory.
+    Each wakeup collects every pending event, and the events are then
+    processed together in a single processing cycle: the timer expiry
+    first, then each modified variable once, however many notifications
+    were received for it.  At the end of the cycle any output which has
+    been batched by the message sinks is sent, any changed configuration
+    files are reloaded, and the timer is re-armed for the next scheduled
+    message.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state object
+
+==============================================================================*/
+static void RunMessageGenerator( VarMsgState *pState )
+{
+    size_t i;
+
+    while( 1 )
+    {
+        /* wait for and collect the pending events */
+        while ( EVLOOP_Wait( &pState->loop, -1 ) != EOK )
+        {
+        }
+
+        /* start a new processing cycle */
+        __atomic_add_fetch( &pState->cycle, 1, __ATOMIC_RELEASE );
+        if ( pState->timerExpired == true )
+        {
+            /* process the timer expiry */
+            pState->timerExpired = false;
+            ProcessTimer( pState );
+        }
+
+        for ( i = 0; i < pState->numModified; i++ )
+        {
+            ProcessModified( pState, pState->pModified[i] );
+        }
+
+        pState->numModified = 0;
+
+        /* hand the messages made ready in this cycle to the workers */
+        DispatchMessages( pState );
+
+        if ( pState->pOutQ == NULL )
+        {
+            /* send any messages batched up during this processing cycle */
+            SINK_FlushAll();
+        }
+
+        if ( ( pState->reloads.len > 0 ) ||
+             ( pState->reloadAll == true ) )
+        {
+            /* apply the configuration directory changes */
+            ReloadConfigs( pState );
+        }
+
+        /* retry the network sinks which have work left over */
+        ScheduleFlush( pState );
+
+        /* wake up when the next message is due */
+        UpdateTimer( pState );
+    }
+}
+
+/*============================================================================*/
+/*  ProcessTimer                                                              */
+/*!
+    Process a scheduler timer expiry
+
+    The ProcessTimer function generates every scheduled message which
+    is due.  Interval messages are rescheduled relative to their previous
+    due time so they do not drift.  If a message is so late that one or
+    more intervals were missed, it is rescheduled for the next interval
+    boundary after the current time.  Automatic rescans which are due
+    are also run here, the performance counters are published, the
+    shed level is updated, and network sinks which could not finish
+    sending are flushed again.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state object
+            containing the message schedule
+
+    @retval EOK Timer handler processed successfully
+    @retval EINVAL invalid argument
+
+==============================================================================*/
+static int ProcessTimer( VarMsgState *pState )
+{
+    VarMsgConfig *pMsgConfig;
+    SchedItem *pItem;
+    uint32_t interval;
+    uint64_t now;
+    uint64_t due;
+    uint64_t late;
+    int result = EINVAL;
+
+    if ( pState != NULL )
+    {
+        result = EOK;
+
+        now = GetTimeMs();
+
+        /* the timer is no longer armed */
+        pState->timerDue = 0;
+
+        while ( ( ( pItem = SCHED_Top( &pState->sched ) ) != NULL ) &&
+                ( pItem->due <= now ) )
+        {
+            pMsgConfig = (VarMsgConfig *)pItem->pData;
+            late = now - pItem->due;
+
+            if ( pItem->type == SCHED_TYPE_STATS )
+            {
+                /* publish the performance counters every interval */
+                SCHED_Insert( &pState->sched,
+                              pItem,
+                              now + STATS_INTERVAL_MS );
+                PublishStats( pState );
+            }
+            else if ( pItem->type == SCHED_TYPE_SHED )
+            {
+                /* compare the render time with the budget */
+                SCHED_Insert( &pState->sched,
+                              pItem,
+                              now + SHED_INTERVAL_MS );
+                UpdateShed( pState, now );
+            }
+            else if ( pItem->type == SCHED_TYPE_FLUSH )
+            {
+                /* finish sending the network sink data, or make the
+                   next connection attempt */
+                SCHED_Remove( &pState->sched, pItem );
+                SINK_FlushAll();
+            }
+            else if ( pItem->type == SCHED_TYPE_INTERVAL )
+            {
+                /* reschedule the interval message */
+                interval = pState->msgs.pInterval[pMsgConfig->id];
+                due = pItem->due + interval;
+                if ( due <= now )
+                {
+                    due += ( ( ( now - due ) / interval ) + 1 ) * interval;
+                }
+
+                SCHED_Insert( &pState->sched, pItem, due );
+            }
+            else if ( pItem->type == SCHED_TYPE_RESCAN )
+            {
+                /* rescans are not phase aligned, so a late rescan
+                   just runs once and schedules the next one from now */
+                interval = pState->msgs.pRescanInterval[pMsgConfig->id];
+                SCHED_Insert( &pState->sched, pItem, now + interval );
+            }
+            else
+            {
+                SCHED_Remove( &pState->sched, pItem );
+            }
+
+            if ( ( pItem->type == SCHED_TYPE_STATS ) ||
+                 ( pItem->type == SCHED_TYPE_SHED ) ||
+                 ( pItem->type == SCHED_TYPE_FLUSH ) )
+            {
+                /* the item was handled above */
+            }
+            else if ( pItem->type == SCHED_TYPE_RESCAN )
+            {
+                /* refresh the message variable sets */
+                result = RescanMessage( pState, pMsgConfig );
+            }
+            else
+            {
+                /* Process (generate) the message */
+                VARMSG_TRACE3( timer_due, pMsgConfig->id, pItem->type, late );
+                result = ProcessMessage( pState, pMsgConfig );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessModified                                                           */
+/*!
+    Process a NOTIFY_MODIFIED notification
+
+    The ProcessModified function looks up the modified variable in the
+    variable index, and dispatches the notification to each Variable
+    Message Configuration which uses the variable.
+
+    Delta mode body variables are marked as modified before any message
+    is generated, so a message which is triggered by one of its own body
+    variables includes the new value.  Requested rescans are run after
+    all of the other handlers.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state object
+            containing the Variable Message Configurations to process.
+
+    @param[in]
+        hVar
+            handle to the modified variable
+
+    @retval EOK the notification was processed successfully
+    @retval ENOENT the variable is not used by any message
+    @retval EINVAL invalid argument
+
+==============================================================================*/
+static int ProcessModified( VarMsgState *pState, VAR_HANDLE hVar )
+{
+    int result = EINVAL;
+    VarIndexEntry *pEntry;
+    VarMsgConfig *pConfig;
+    MsgTable *pMsgs;
+    bool rescan = false;
+    size_t id;
+
+    if ( pState != NULL )
+    {
+        VARMSG_TRACE1( modified, hVar );
+
+        pMsgs = &pState->msgs;
+
+        pEntry = VARINDEX_Find( &pState->index, hVar );
+        result = ( pEntry != NULL ) ? EOK : ENOENT;
+
+        /* track modified variables for delta messages */
+        for ( ; pEntry != NULL; pEntry = VARINDEX_Next( pEntry ) )
+        {
+            if ( pEntry->role == VARROLE_BODY )
+            {
+                MarkModified( (VarMsgConfig *)pEntry->pData, pEntry->idx );
+            }
+        }
+
+        /* generate the triggered messages */
+        for ( pEntry = VARINDEX_Find( &pState->index, hVar );
+              pEntry != NULL;
+              pEntry = VARINDEX_Next( pEntry ) )
+        {
+            pConfig = (VarMsgConfig *)pEntry->pData;
+
+            switch( pEntry->role )
+            {
+                case VARROLE_ENABLE:
+                    VARMSG_TRACE3( dispatch, pConfig->id, hVar, pEntry->role );
+
+                    /* force processing when the message is turned on */
+                    if ( ProcessEnable( pState, pConfig ) == EOK )
+                    {
+                        ProcessMessage( pState, pConfig );
+                    }
+                    break;
+
+                case VARROLE_TRIGGER:
+                case VARROLE_MSGTRIGGER:
+                    VARMSG_TRACE3( dispatch, pConfig->id, hVar, pEntry->role );
+                    TriggerMessage( pState, pConfig );
+                    break;
+
+                case VARROLE_RESCAN:
+                    VARMSG_TRACE3( dispatch, pConfig->id, hVar, pEntry->role );
+                    pMsgs->pRescan[pConfig->id] = true;
+                    rescan = true;
+                    break;
+
+                case VARROLE_SHED:
+                    ProcessShedOverride( pState );
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        if ( rescan == true )
+        {
+            /* a rescan patches the variable index, so the rescans are
+               run once the notification has been dispatched */
+            for ( id = 0; id < pMsgs->n; id++ )
+            {
+                if ( pMsgs->pRescan[id] == true )
+                {
+                    pMsgs->pRescan[id] = false;
+                    RescanMessage( pState, (VarMsgConfig *)pMsgs->ppData[id] );
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessEnable                                                             */
+/*!
+    Process a change to a message enable variable
+
+    The ProcessEnable function gets the value of the message enable
+    variable and enables or disables the message.  When a message is
+    enabled its interval schedule is restarted, and when it is disabled
+    it is removed from the schedule.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state object
+
+    @param[in]
+        pConfig
+            pointer to the variable message configuration
+
+    @retval EOK the message was enabled
+    @retval ENOTCONN the message was disabled
+    @retval EINVAL invalid argument
+    @retval other error from VAR_Get
+
+==============================================================================*/
+static int ProcessEnable( VarMsgState *pState, VarMsgConfig *pConfig )
+{
+    int result = EINVAL;
+    VarObject obj;
+
+    if ( ( pState != NULL ) &&
+         ( pConfig != NULL ) )
+    {
+        /* get the value of the enable variable */
+        result = VAR_Get( pState->hVarServer, pConfig->hEnable, &obj );
+        if ( result == EOK )
+        {
+            pState->msgs.pEnabled[pConfig->id] = ( obj.val.ul != 0 );
+            if ( pState->msgs.pEnabled[pConfig->id] == true )
+            {
+                /* restart the interval schedule */
+                ScheduleInterval( pState, pConfig, GetTimeMs() );
+            }
+            else
+            {
+                /* a disabled message is not scheduled */
+                SCHED_Remove( &pState->sched, &pConfig->intervalItem );
+                SCHED_Remove( &pState->sched, &pConfig->pendingItem );
+                result = ENOTCONN;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  TriggerMessage                                                            */
+/*!
+    Handle a trigger for a Variable Message
+
+    The TriggerMessage function processes the message immediately
+    unless it has a coalescing window.  A message with a debounce
+    window, or which was sent less than min_interval_ms ago, is
+    scheduled as pending and is sent when its window ends.  Triggers
+    which arrive while the message is pending are counted and
+    collapsed into the pending message, which reads the latest
+    variable values when it is generated.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state object
+
+    @param[in]
+        pConfig
+            pointer to the triggered variable message
+
+    @retval EOK the trigger was processed
+    @retval EINVAL invalid argument
+
+==============================================================================*/
+static int TriggerMessage( VarMsgState *pState, VarMsgConfig *pConfig )
+{
+    int result = EINVAL;
+    uint32_t debounce;
+    uint32_t minInterval;
+    uint64_t lastSent;
+    uint64_t now;
+    uint64_t due;
+
+    if ( ( pState != NULL ) &&
+         ( pConfig != NULL ) )
+    {
+        result = EOK;
+
+        debounce = pState->msgs.pDebounce[pConfig->id];
+        minInterval = pState->msgs.pMinInterval[pConfig->id];
+
+        if ( ( debounce == 0 ) &&
+             ( minInterval == 0 ) )
+        {
+            /* no coalescing window */
+            result = ProcessMessage( pState, pConfig );
+        }
+        else if ( SCHED_IsScheduled( &pConfig->pendingItem ) == true )
+        {
+            /* collapse the trigger into the pending message */
+            pConfig->coalescedCount++;
+            pConfig->coalescedChanged = true;
+        }
+        else
+        {
+            now = GetTimeMs();
+            due = now + debounce;
+            lastSent = pState->msgs.pLastSent[pConfig->id];
+            if ( ( lastSent != 0 ) &&
+                 ( due < lastSent + minInterval ) )
+            {
+                due = lastSent + minInterval;
+            }
+
+            if ( due <= now )
+            {
+                result = ProcessMessage( pState, pConfig );
+            }
+            else
+            {
+                result = SCHED_Insert( &pState->sched,
+                                       &pConfig->pendingItem,
+                                       due );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  GetTimeMs                                                                 */
+/*!
+    Get the monotonic clock time in milliseconds
+
+    @retval the current monotonic clock time in milliseconds
+
+==============================================================================*/
+static uint64_t GetTimeMs( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( (uint64_t)ts.tv_sec * 1000 ) + ( ts.tv_nsec / 1000000 );
+}
+
+/*============================================================================*/
+/*  GetTimeUs                                                                 */
+/*!
+    Get the current monotonic time in microseconds
+
+    @retval the current CLOCK_MONOTONIC time in microseconds
+
+==============================================================================*/
+static uint64_t GetTimeUs( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( (uint64_t)ts.tv_sec * 1000000 ) + ( ts.tv_nsec / 1000 );
+}
+
+/*============================================================================*/
+/*  SetupStats                                                                */
+/*!
+    Set up the performance counter publication
+
+    The SetupStats function creates the global statistics variable,
+    which holds a JSON object with the output queue depth and the
+    render and sink write latency histograms, and prepares the
+    scheduler item which publishes the performance counters.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @retval EOK the statistics were set up
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+    @retval other error from VARSERVER_CreateVar
+
+==============================================================================*/
+static int SetupStats( VarMsgState *pState )
+{
+    int result = EINVAL;
+    VarObject obj;
+
+    if ( pState != NULL )
+    {
+        SCHED_InitItem( &pState->statsItem, SCHED_TYPE_STATS, pState );
+
+        result = MSGBUF_Init( &pState->stats, STATS_VAR_SIZE );
+        if ( result == EOK )
+        {
+            result = MSGBUF_Init( &pState->statsPublished, STATS_VAR_SIZE );
+        }
+
+        pState->hStats = VAR_INVALID;
+        if ( result == EOK )
+        {
+            memset( &obj, 0, sizeof( VarObject ) );
+            obj.type = VARTYPE_STR;
+            obj.len = STATS_VAR_SIZE;
+            result = CreateGlobalVar( pState,
+                                      STATS_VAR_NAME,
+                                      &obj,
+                                      &pState->hStats );
+        }
+
+        if ( result != EOK )
+        {
+            fprintf( stderr,
+                     "VARMSG: failed to create %s: %s\n",
+                     STATS_VAR_NAME,
+                     strerror( result ) );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  PublishStats                                                              */
+/*!
+    Publish the performance counters
+
+    The PublishStats function takes a snapshot of the performance
+    counters of each message, and sets the message's counter variables
+    whose value has changed since they were last published.  It then
+    publishes the global statistics.  This is called once every
+    STATS_INTERVAL_MS, so the render threads only ever update the
+    in-process counters.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+==============================================================================*/
+static void PublishStats( VarMsgState *pState )
+{
+    VarMsgConfig *pConfig;
+    MsgStatsSnapshot snap;
+    MsgStatsSnapshot *pPub;
+
+    if ( pState != NULL )
+    {
+        pConfig = pState->pMessageConfigs;
+        while ( pConfig != NULL )
+        {
+            MSGSTATS_Snapshot( &pConfig->stats, &snap );
+            pPub = &pConfig->statsPublished;
+
+            PublishCounter( pState,
+                            pConfig->hRenderUs,
+                            VARTYPE_UINT32,
+                            snap.lastRender,
+                            pPub->lastRender );
+            PublishCounter( pState,
+                            pConfig->hRenderAvgUs,
+                            VARTYPE_UINT32,
+                            snap.avgRender,
+                            pPub->avgRender );
+            PublishCounter( pState,
+                            pConfig->hRenderMaxUs,
+                            VARTYPE_UINT32,
+                            snap.maxRender,
+                            pPub->maxRender );
+            PublishCounter( pState,
+                            pConfig->hSinkUs,
+                            VARTYPE_UINT32,
+                            snap.avgSink,
+                            pPub->avgSink );
+            PublishCounter( pState,
+                            pConfig->hBytes,
+                            VARTYPE_UINT64,
+                            snap.bytes,
+                            pPub->bytes );
+            PublishCounter( pState,
+                            pConfig->hVarCount,
+                            VARTYPE_UINT64,
+                            snap.vars,
+                            pPub->vars );
+
+            *pPub = snap;
+            pConfig = pConfig->pNext;
+        }
+
+        PublishGlobalStats( pState );
+    }
+}
+
+/*============================================================================*/
+/*  PublishCounter                                                            */
+/*!
+    Publish a performance counter
+
+    The PublishCounter function sets a performance counter variable
+    if its value has changed since it was last published.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        hVar
+            handle of the performance counter variable
+
+    @param[in]
+        type
+            type of the performance counter variable
+
+    @param[in]
+        value
+            current value of the performance counter
+
+    @param[in]
+        published
+            value of the performance counter when it was last published
+
+==============================================================================*/
+static void PublishCounter( VarMsgState *pState,
+                            VAR_HANDLE hVar,
+                            VarType type,
+                            uint64_t value,
+                            uint64_t published )
+{
+    VarObject obj;
+
+    if ( ( pState != NULL ) &&
+         ( hVar != VAR_INVALID ) &&
+         ( value != published ) )
+    {
+        obj.type = type;
+        if ( type == VARTYPE_UINT64 )
+        {
+            obj.val.ull = value;
+        }
+        else
+        {
+            obj.val.ul = (uint32_t)value;
+        }
+
+        VAR_Set( pState->hVarServer, hVar, &obj );
+    }
+}
+
+/*============================================================================*/
+/*  PublishGlobalStats                                                        */
+/*!
+    Publish the global statistics
+
+    The PublishGlobalStats function formats the output queue depth and
+    the render and sink write latency histograms as a JSON object, and
+    sets the global statistics variable if the object has changed since
+    it was last published.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @retval EOK the global statistics were published, or are unchanged
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+    @retval other error from VAR_Set
+
+==============================================================================*/
+static int PublishGlobalStats( VarMsgState *pState )
+{
+    int result = EINVAL;
+    MsgBuf *pMsgBuf;
+    MsgBuf tmp;
+    VarObject obj;
+
+    if ( ( pState != NULL ) &&
+         ( pState->hStats != VAR_INVALID ) )
+    {
+        pMsgBuf = &pState->stats;
+        MSGBUF_Reset( pMsgBuf );
+
+        result = MSGBUF_Printf( pMsgBuf,
+                                "{\"queue_depth\":%zu,\"render_us\":",
+                                OUTQ_Depth( pState->pOutQ ) );
+        if ( result == EOK )
+        {
+            result = MSGSTATS_HistFormat( &pState->renderHist, pMsgBuf );
+        }
+
+        if ( result == EOK )
+        {
+            result = MSGBUF_AppendStr( pMsgBuf, ",\"sink_us\":" );
+        }
+
+        if ( result == EOK )
+        {
+            result = MSGSTATS_HistFormat( &pState->sinkHist, pMsgBuf );
+        }
+
+        if ( result == EOK )
+        {
+            result = MSGBUF_Append( pMsgBuf, "}", 2 );
+        }
+
+        if ( ( result == EOK ) &&
+             ( ( pMsgBuf->len != pState->statsPublished.len ) ||
+               ( memcmp( pMsgBuf->pData,
+                         pState->statsPublished.pData,
+                         pMsgBuf->len ) != 0 ) ) )
+        {
+            obj.type = VARTYPE_STR;
+            obj.val.str = pMsgBuf->pData;
+            obj.len = pMsgBuf->len;
+            result = VAR_Set( pState->hVarServer, pState->hStats, &obj );
+
+            /* keep the published statistics for the next comparison */
+            tmp = pState->statsPublished;
+            pState->statsPublished = *pMsgBuf;
+            pState->stats = tmp;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupShed                                                                 */
+/*!
+    Set up the load shedding
+
+    The SetupShed function initializes the load shedding controller
+    with the render time budget, and creates the global shed level
+    status variable and the shed level override control variable.
+    The override variable holds -1 when the shed level is controlled
+    automatically.  An override which is still set from a previous run
+    is applied straight away.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @retval EOK the load shedding was set up
+    @retval EINVAL invalid arguments
+    @retval other error from CreateGlobalVar, VAR_Notify or VARINDEX_Add
+
+==============================================================================*/
+static int SetupShed( VarMsgState *pState )
+{
+    int result = EINVAL;
+    VarObject obj;
+
+    if ( pState != NULL )
+    {
+        SHED_Init( &pState->shed, pState->budget );
+        SCHED_InitItem( &pState->shedItem, SCHED_TYPE_SHED, pState );
+
+        memset( &obj, 0, sizeof( VarObject ) );
+        obj.type = VARTYPE_UINT32;
+        obj.val.ul = 0;
+        result = CreateGlobalVar( pState, SHED_VAR_NAME, &obj, &pState->hShed );
+
+        if ( result == EOK )
+        {
+            obj.type = VARTYPE_INT32;
+            obj.val.l = -1;
+            result = CreateGlobalVar( pState,
+                                      SHED_OVERRIDE_VAR_NAME,
+                                      &obj,
+                                      &pState->hShedOverride );
+        }
+
+        /* replace any shed level left over from a previous run */
+        PublishShed( pState );
+
+        if ( result == EOK )
+        {
+            /* get notified when an operator sets the shed level */
+            result = VAR_Notify( pState->hVarServer,
+                                 pState->hShedOverride,
+                                 NOTIFY_MODIFIED );
+        }
+
+        if ( result == EOK )
+        {
+            result = VARINDEX_Add( &pState->index,
+                                   pState->hShedOverride,
+                                   VARROLE_SHED,
+                                   0,
+                                   pState );
+        }
+
+        if ( result == EOK )
+        {
+            ProcessShedOverride( pState );
+        }
+        else
+        {
+            fprintf( stderr,
+                     "VARMSG: failed to set up load shedding: %s\n",
+                     strerror( result ) );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CreateGlobalVar                                                           */
+/*!
+    Create a global variable of the message generator
+
+    The CreateGlobalVar function creates a volatile variable which
+    belongs to the message generator rather than to one of its messages.
+    If the variable already exists, for example because the generator
+    has been restarted, the existing variable is used.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        name
+            name of the variable to create
+
+    @param[in]
+        pObj
+            pointer to the type and initial value of the variable
+
+    @param[out]
+        pVarHandle
+            pointer to a location to store the variable handle
+
+    @retval EOK the variable was created, or already exists
+    @retval EINVAL invalid arguments
+    @retval other error from VARSERVER_CreateVar
+
+==============================================================================*/
+static int CreateGlobalVar( VarMsgState *pState,
+                            char *name,
+                            VarObject *pObj,
+                            VAR_HANDLE *pVarHandle )
+{
+    int result = EINVAL;
+    VarInfo info;
+
+    if ( ( pState != NULL ) &&
+         ( name != NULL ) &&
+         ( pObj != NULL ) &&
+         ( pVarHandle != NULL ) )
+    {
+        memset( &info, 0, sizeof( VarInfo ) );
+        strcpy( info.name, name );
+        info.flags = VARFLAG_VOLATILE;
+        info.var = *pObj;
+
+        *pVarHandle = VAR_INVALID;
+        result = VARSERVER_CreateVar( pState->hVarServer, &info );
+        if ( result == EOK )
+        {
+            *pVarHandle = info.hVar;
+        }
+        else
+        {
+            *pVarHandle = VAR_FindByName( pState->hVarServer, name );
+            result = ( *pVarHandle != VAR_INVALID ) ? EOK : result;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  UpdateShed                                                                */
+/*!
+    Update the shed level
+
+    The UpdateShed function hands the render time measured since the
+    previous update to the load shedding controller, and publishes the
+    shed level if it has changed.  This is called every SHED_INTERVAL_MS
+    when there is a render time budget.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @param[in]
+        now
+            current monotonic time in milliseconds
+
+==============================================================================*/
+static void UpdateShed( VarMsgState *pState, uint64_t now )
+{
+    uint64_t renderUs;
+
+    if ( pState != NULL )
+    {
+        renderUs = __atomic_exchange_n( &pState->renderUs,
+                                        0,
+                                        __ATOMIC_RELAXED );
+
+        if ( SHED_Update( &pState->shed,
+                          renderUs,
+                          now - pState->shedTime ) == true )
+        {
+            PublishShed( pState );
+        }
+
+        pState->shedTime = now;
+    }
+}
+
+/*============================================================================*/
+/*  ProcessShedOverride                                                       */
+/*!
+    Process a change to the shed level override variable
+
+    The ProcessShedOverride function gets the value of the shed level
+    override variable.  A value from zero to SHED_LEVEL_MAX fixes the
+    shed level, and a negative value returns it to automatic control.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+    @retval EOK the override was applied
+    @retval ENOTSUP the override variable has an unexpected type
+    @retval EINVAL invalid arguments
+    @retval other error from VAR_Get
+
+==============================================================================*/
+static int ProcessShedOverride( VarMsgState *pState )
+{
+    int result = EINVAL;
+    VarObject obj;
+
+    if ( pState != NULL )
+    {
+        result = VAR_Get( pState->hVarServer, pState->hShedOverride, &obj );
+        if ( ( result == EOK ) &&
+             ( obj.type != VARTYPE_INT32 ) )
+        {
+            result = ENOTSUP;
+        }
+
+        if ( ( result == EOK ) &&
+             ( SHED_Override( &pState->shed, obj.val.l ) == true ) )
+        {
+            PublishShed( pState );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  PublishShed                                                               */
+/*!
+    Publish the shed level
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state
+
+==============================================================================*/
+static void PublishShed( VarMsgState *pState )
+{
+    VarObject obj;
+
+    if ( pState != NULL )
+    {
+        if ( pState->verbose == true )
+        {
+            printf( "Shed level: %u\n", pState->shed.level );
+        }
+
+        obj.type = VARTYPE_UINT32;
+        obj.val.ul = pState->shed.level;
+        VAR_Set( pState->hVarServer, pState->hShed, &obj );
+    }
+}
+
+/*============================================================================*/
+/*  ProcessMessage                                                            */
+/*!
+    Process a Variable Message
+
+    The ProcessMessage function processes a Variable Message.
+    Message content is generated if the message is enabled.
+    The message is sent to the requested output stream.
+
+    If there are render workers, the message is added to the ready
+    list, and is handed to the workers at the end of the current
+    processing cycle.  Otherwise it is generated immediately.
+
+    While the message is being shed it is either switched to delta
+    mode, or only one in every N messages is generated, where N is
+    the sampling factor for the message priority at the current shed
+    level.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state object
+            containing the Variable Message Configurations to process.
+
+    @param[in]
+        pMsgConfig
+            pointer to the specific variable message to process
+
+    @retval EOK The variable message was successfully processed
+    @retval EINVAL invalid argument
+
+==============================================================================*/
+static int ProcessMessage( VarMsgState *pState, VarMsgConfig *pMsgConfig )
+{
+    int result = EINVAL;
+    VarObject obj;
+    uint32_t dropped;
+    uint32_t factor;
+    bool skip = false;
+    MsgTable *pMsgs;
+    uint32_t id;
+
+    if ( ( pState != NULL ) &&
+         ( pMsgConfig != NULL ) )
+    {
+        pMsgs = &pState->msgs;
+        id = pMsgConfig->id;
+
+        /* only process messages which are enabled */
+        if( pMsgs->pEnabled[id] == true )
+        {
+            /* this message satisfies any pending trigger */
+            SCHED_Remove( &pState->sched, &pMsgConfig->pendingItem );
+
+            if ( ( pMsgs->pDebounce[id] != 0 ) ||
+                 ( pMsgs->pMinInterval[id] != 0 ) )
+            {
+                /* start the minimum interval window */
+                pMsgs->pLastSent[id] = GetTimeMs();
+            }
+
+            if ( pMsgConfig->coalescedChanged == true )
+            {
+                /* publish the coalesced trigger counter */
+                pMsgConfig->coalescedChanged = false;
+                obj.type = VARTYPE_UINT32;
+                obj.val.ul = pMsgConfig->coalescedCount;
+                VAR_Set( pState->hVarServer, pMsgConfig->hCoalesced, &obj );
+            }
+
+            dropped = __atomic_load_n( &pMsgConfig->dropped, __ATOMIC_RELAXED );
+            if ( dropped != pMsgConfig->droppedPublished )
+            {
+                /* publish the dropped message counter */
+                pMsgConfig->droppedPublished = dropped;
+                obj.type = VARTYPE_UINT32;
+                obj.val.ul = dropped;
+                VAR_Set( pState->hVarServer, pMsgConfig->hDropped, &obj );
+            }
+
+            /* shed low priority messages while the generator is
+               overloaded */
+            factor = SHED_Factor( &pState->shed, pMsgs->pPriority[id] );
+            if ( pMsgConfig->shedDelta == true )
+            {
+                __atomic_store_n( &pMsgConfig->degraded,
+                                  ( factor > 1 ),
+                                  __ATOMIC_RELAXED );
+            }
+            else if ( factor > 1 )
+            {
+                skip = ( ( ++pMsgs->pSampled[id] % factor ) != 0 );
+            }
+
+            if ( skip == true )
+            {
+                /* this message is not part of the sample */
+            }
+            else if ( pState->numWorkers > 0 )
+            {
+                QueueMessage( pState, pMsgConfig );
+            }
+            else
+            {
+                GenerateMessage( pState, &pState->render, pMsgConfig );
+            }
+        }
+
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupOutQ                                                                 */
+/*!
+    Start the output queue
+
+    The SetupOutQ function creates the output queue and its sink writer
+    thread if an output queue depth was requested.  Rendered messages are
+    then handed to the writer via the queue instead of being written to
+    their sinks by the render threads.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state object
+
+    @retval EOK the output queue was started, or none was requested
+    @retval ENOMEM the output queue could not be created
+    @retval EINVAL invalid argument
+
+==============================================================================*/
+static int SetupOutQ( VarMsgState *pState )
+{
+    int result = EINVAL;
+
+    if ( pState != NULL )
+    {
+        result = EOK;
+
+        if ( pState->queueDepth > 0 )
+        {
+            pState->pOutQ = OUTQ_Create( pState->queueDepth,
+                                         pState->queuePolicy );
+            if ( pState->pOutQ == NULL )
+            {
+                fprintf( stderr, "Failed to create the output queue\n" );
+                result = ENOMEM;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupWorkers                                                              */
+/*!
+    Start the render worker threads
+
+    The SetupWorkers function creates the requested number of render
+    worker threads.  Each worker has its own render context, with its
+    own variable server handle, VarFP output stream and message buffer.
+
+    The workers are started with all asynchronous signals blocked, so
+    that the variable server signals are always left for the main
+    thread's signalfd.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state object
+
+    @retval EOK the workers were started, or none were requested
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid argument
+    @retval other error from the render context setup or pthread_create
+
+==============================================================================*/
+static int SetupWorkers( VarMsgState *pState )
+{
+    int result = EINVAL;
+    RenderContext *pCtx;
+    sigset_t mask;
+    sigset_t oldmask;
+    uint32_t i;
+
+    if ( pState != NULL )
+    {
+        result = EOK;
+
+        if ( pState->numWorkers > 0 )
+        {
+            pthread_mutex_init( &pState->workLock, NULL );
+            pthread_cond_init( &pState->workCond, NULL );
+            pthread_cond_init( &pState->idleCond, NULL );
+
+            pState->pWorkers = calloc( pState->numWorkers,
+                                       sizeof( RenderContext ) );
+            if ( pState->pWorkers == NULL )
+            {
+                result = ENOMEM;
+            }
+
+            /* the workers inherit the blocked signal mask */
+            sigfillset( &mask );
+            sigdelset( &mask, SIGSEGV );
+            sigdelset( &mask, SIGBUS );
+            sigdelset( &mask, SIGFPE );
+            sigdelset( &mask, SIGILL );
+            pthread_sigmask( SIG_BLOCK, &mask, &oldmask );
+
+            for ( i = 0; ( result == EOK ) && ( i < pState->numWorkers ); i++ )
+            {
+                pCtx = &pState->pWorkers[i];
+                pCtx->pState = pState;
+
+                pCtx->hVarServer = VARSERVER_Open();
+                if ( pCtx->hVarServer == NULL )
+                {
+                    result = EBADF;
+                }
+
+                if ( result == EOK )
+                {
+                    result = SetupVarFP( pCtx, i + 1 );
+                }
+
+                if ( result == EOK )
+                {
+                    result = MSGBUF_Init( &pCtx->msgbuf, MSGBUF_SIZE );
+                }
+
+                if ( result == EOK )
+                {
+                    result = VALCACHE_Init( &pCtx->values, VALCACHE_SIZE );
+                }
+
+                if ( result == EOK )
+                {
+                    result = pthread_create( &pCtx->thread,
+                                             NULL,
+                                             RenderWorker,
+                                             pCtx );
+                    pCtx->started = ( result == EOK );
+                }
+
+                if ( result != EOK )
+                {
+                    fprintf( stderr,
+                             "VARMSG: failed to start render worker %u\n",
+                             i );
+                }
+            }
+
+            pthread_sigmask( SIG_SETMASK, &oldmask, NULL );
+
+            if ( result != EOK )
+            {
+                /* release the workers which were already set up */
+                StopWorkers( pState );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  StopWorkers                                                               */
+/*!
+    Stop the render worker threads
+
+    The StopWorkers function asks the render workers to exit once the
+    work queue is empty, waits for each of them to finish, and then
+    closes the variable server handle and VarFP output stream of each
+    worker and releases its buffers.  It also releases the workers of
+    a partially completed SetupWorkers.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state object
+
+==============================================================================*/
+static void StopWorkers( VarMsgState *pState )
+{
+    RenderContext *pCtx;
+    uint32_t i;
+
+    if ( ( pState != NULL ) &&
+         ( pState->pWorkers != NULL ) )
+    {
+        pthread_mutex_lock( &pState->workLock );
+        pState->stopWorkers = true;
+        pthread_cond_broadcast( &pState->workCond );
+        pthread_mutex_unlock( &pState->workLock );
+
+        for ( i = 0; i < pState->numWorkers; i++ )
+        {
+            pCtx = &pState->pWorkers[i];
+
+            if ( pCtx->started == true )
+            {
+                pthread_join( pCtx->thread, NULL );
+                pCtx->started = false;
+            }
+
+            if ( pCtx->hVarServer != NULL )
+            {
+                VARSERVER_Close( pCtx->hVarServer );
+                pCtx->hVarServer = NULL;
+            }
+
+            if ( pCtx->pVarFP != NULL )
+            {
+                VARFP_Close( pCtx->pVarFP );
+                pCtx->pVarFP = NULL;
+            }
+
+            MSGBUF_Free( &pCtx->msgbuf );
+            VALCACHE_Free( &pCtx->values );
+        }
+
+        free( pState->pWorkers );
+        pState->pWorkers = NULL;
+        pState->numWorkers = 0;
+
+        pthread_cond_destroy( &pState->idleCond );
+        pthread_cond_destroy( &pState->workCond );
+        pthread_mutex_destroy( &pState->workLock );
+    }
+}
+
+/*============================================================================*/
+/*  RenderWorker                                                              */
+/*!
+    Render worker thread
+
+    The RenderWorker function takes messages from the work queue and
+    generates them using the worker's render context.  A message which
+    was made ready again while it was being rendered is put back on the
+    work queue, so each message is only ever rendered by one worker at
+    a time.  When the work queue is empty the worker flushes the sinks
+    before waiting for more work, or exits if it has been asked to stop.
+
+    @param[in]
+        arg
+            pointer to the worker's render context
+
+    @retval NULL
+
+==============================================================================*/
+static void *RenderWorker( void *arg )
+{
+    RenderContext *pCtx = (RenderContext *)arg;
+    VarMsgState *pState = pCtx->pState;
+    VarMsgConfig *pConfig;
+    bool flush = false;
+
+    pthread_mutex_lock( &pState->workLock );
+
+    while ( 1 )
+    {
+        if ( pState->pWorkHead == NULL )
+        {
+            if ( flush == true )
+            {
+                /* send the batched output before going idle */
+                flush = false;
+                pthread_mutex_unlock( &pState->workLock );
+                SINK_FlushAll();
+                pthread_mutex_lock( &pState->workLock );
+            }
+            else if ( pState->stopWorkers == true )
+            {
+                break;
+            }
+            else
+            {
+                pthread_cond_wait( &pState->workCond, &pState->workLock );
+            }
+        }
+        else
+        {
+            /* take the next message from the work queue */
+            pConfig = pState->pWorkHead;
+            pState->pWorkHead = pConfig->pWorkNext;
+            if ( pState->pWorkHead == NULL )
+            {
+                pState->pWorkTail = NULL;
+            }
+
+            pConfig->pWorkNext = NULL;
+            pthread_mutex_unlock( &pState->workLock );
+
+            GenerateMessage( pState, pCtx, pConfig );
+
+            /* the sink writer flushes the sinks when there is an
+               output queue */
+            flush = ( pState->pOutQ == NULL );
+
+            pthread_mutex_lock( &pState->workLock );
+            if ( pConfig->rerun == true )
+            {
+                /* the message was made ready while it was being
+                   rendered, so queue it again */
+                pConfig->rerun = false;
+                if ( pState->pWorkTail == NULL )
+                {
+                    pState->pWorkHead = pConfig;
+                }
+                else
+                {
+                    pState->pWorkTail->pWorkNext = pConfig;
+                }
+
+                pState->pWorkTail = pConfig;
+            }
+            else
+            {
+                pConfig->queued = false;
+
+                /* a rescan may be waiting for the message to finish */
+                pthread_cond_broadcast( &pState->idleCond );
+            }
+        }
+    }
+
+    pthread_mutex_unlock( &pState->workLock );
+
+    return NULL;
+}
+
+/*============================================================================*/
+/*  QueueMessage                                                              */
+/*!
+    Add a message to the ready list
+
+    The QueueMessage function adds a message to the ready list of the
+    current processing cycle.  A message which is made ready more than
+    once in the same cycle is only added once.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state object
+
+    @param[in]
+        pMsgConfig
+            pointer to the message to add
+
+==============================================================================*/
+static void QueueMessage( VarMsgState *pState, VarMsgConfig *pMsgConfig )
+{
+    if ( pMsgConfig->ready == false )
+    {
+        pMsgConfig->ready = true;
+        pMsgConfig->pReadyNext = NULL;
+
+        if ( pState->pReadyTail == NULL )
+        {
+            pState->pReadyHead = pMsgConfig;
+        }
+        else
+        {
+            pState->pReadyTail->pReadyNext = pMsgConfig;
+        }
+
+        pState->pReadyTail = pMsgConfig;
+    }
+}
+
+/*============================================================================*/
+/*  DispatchMessages                                                          */
+/*!
+    Hand the ready messages to the render workers
+
+    The DispatchMessages function moves all of the messages in the
+    ready list onto the work queue, and wakes up the render workers.
+    A message which is already queued or being rendered is flagged to
+    be rendered again instead of being queued twice.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state object
+
+==============================================================================*/
+static void DispatchMessages( VarMsgState *pState )
+{
+    VarMsgConfig *pConfig;
+
+    if ( ( pState != NULL ) &&
+         ( pState->pReadyHead != NULL ) )
+    {
+        pthread_mutex_lock( &pState->workLock );
+
+        pConfig = pState->pReadyHead;
+        while ( pConfig != NULL )
+        {
+            pConfig->ready = false;
+
+            if ( pConfig->queued == true )
+            {
+                pConfig->rerun = true;
+            }
+            else
+            {
+                pConfig->queued = true;
+                pConfig->pWorkNext = NULL;
+                if ( pState->pWorkTail == NULL )
+                {
+                    pState->pWorkHead = pConfig;
+                }
+                else
+                {
+                    pState->pWorkTail->pWorkNext = pConfig;
+                }
+
+                pState->pWorkTail = pConfig;
+            }
+
+            pConfig = pConfig->pReadyNext;
+        }
+
+        pState->pReadyHead = NULL;
+        pState->pReadyTail = NULL;
+
+        pthread_cond_broadcast( &pState->workCond );
+        pthread_mutex_unlock( &pState->workLock );
+    }
+}
+
+/*============================================================================*/
+/*  GenerateMessage                                                           */
+/*!
+    Generate a Variable Message
+
+    The GenerateMessage function renders a message using the specified
+    render context, sends it to its output, and updates the message
+    transmission and error counters.
+
+    @param[in]
+        pState
+            pointer to the Variable Message Generator state object
+
+    @param[in]
+        pCtx
+            pointer to the render context to use
+
+    @param[in]
+        pMsgConfig
+            pointer to the message to generate
+
+    @retval EOK the message was generated
+    @retval ENODATA delta message with nothing to send
+    @retval EINVAL invalid argument
+    @retval other error from RenderMessage
+
+==============================================================================*/
+static int GenerateMessage( VarMsgState *pState,
+                            RenderContext *pCtx,
+                            VarMsgConfig *pMsgConfig )
+{
+    int result = EINVAL;
+    VarObject obj;
+
+    if ( ( pState != NULL ) &&
+         ( pCtx != NULL ) &&
+         ( pMsgConfig != NULL ) )
+    {
+        if ( pState->verbose == true )
+        {
+            printf("Processing Message: %s\n", pMsgConfig->configName );
+        }
+
+        /* set up the message object */
+        obj.type = VARTYPE_UINT32;
+
+        /* render message to its output */
+        result = RenderMessage( pCtx, pMsgConfig );
+        if ( result == ENODATA )
+        {
+            /* delta message with nothing to send */
+        }
+        else if ( result == EOK )
+        {
+            obj.val.ul = ++pMsgConfig->txCount;
+            VAR_Set( pCtx->hVarServer, pMsgConfig->hTxCount, &obj );
+        }
+        else
+        {
+            obj.val.ul = ++pMsgConfig->errCount;
+            VAR_Set( pCtx->hVarServer, pMsgConfig->hErrCount, &obj );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RenderMessage                                                             */
+/*!
+    Render a Variable Message
+
+    The RenderMessage function renders the specified variable message
+    and sends it to the message output sink.  The complete message is
+    assembled in the message buffer and then handed to the sink in one
+    piece so the message arrives at its destination intact.
+
+    Any variable which cannot be output is left out of the message,
+    and its error is returned once the message has been sent.
+
+    For delta mode messages, only the body variables which were modified
+    since the previous message are included, except for every
+    "keyframe"th message, which includes all of the body variables.
+    If none of the variables were modified, no message is sent.
+
+    A message with a shared body is rendered into the body's own
+    buffer.  If the body was already rendered in the current processing
+    cycle for another message, that rendering is sent to this message's
+    sink instead of reading and formatting the variables again.
+
+    @param[in]
+        pCtx
+            pointer to the render context used to assemble the message
+
+    @param[in]
+        pMsg
+            pointer to the specific variable message to render
+
+    @retval EOK The variable message was successfully rendered
+    @retval ENODATA delta message with no modified variables to send
+    @retval EINVAL invalid argument
+    @retval ENOMEM memory allocation failure
+    @retval other error from the sink or from a variable output
+
+==============================================================================*/
+static int RenderMessage( RenderContext *pCtx, VarMsgConfig *pMsg )
+{
+    int result = EINVAL;
+    int rc;
+    MsgBuf *pMsgBuf;
+    MsgBody *pBody;
+    bool shared;
+    bool complete = false;
+    uint64_t cycle = 0;
+    uint64_t start;
+    uint64_t rendered;
+    uint64_t written;
+    size_t count;
+
+    if ( ( pCtx != NULL ) &&
+         ( pMsg != NULL ) &&
+         ( pMsg->pBody != NULL ) &&
+         ( pMsg->pSink != NULL ) )
+    {
+        start = GetTimeUs();
+
+        pCtx->msgId = pMsg->id;
+        VARMSG_TRACE1( render_start, pMsg->id );
+
+        pBody = pMsg->pBody;
+        shared = ( pBody->refCount > 1 );
+        if ( shared == true )
+        {
+            /* the body is rendered into its own buffer so it can be
+               sent by the other messages which share it */
+            pthread_mutex_lock( &pBody->lock );
+            pMsgBuf = &pBody->rendered;
+            cycle = __atomic_load_n( &pCtx->pState->cycle, __ATOMIC_ACQUIRE );
+        }
+        else
+        {
+            pMsgBuf = &pCtx->msgbuf;
+        }
+
+        if ( ( shared == true ) &&
+             ( pBody->cycle == cycle ) )
+        {
+            /* reuse the body rendered for another message */
+            result = pBody->renderResult;
+            count = pBody->outputCount;
+            complete = true;
+        }
+        else
+        {
+            result = RenderBody( pCtx, pMsg, pMsgBuf, &complete );
+            count = pCtx->outputCount;
+            if ( shared == true )
+            {
+                pBody->cycle = ( complete == true ) ? cycle : 0;
+                pBody->renderResult = result;
+                pBody->outputCount = count;
+            }
+        }
+
+        rendered = GetTimeUs();
+
+        VARMSG_TRACE5( render_end,
+                       pMsg->id,
+                       result,
+                       pMsgBuf->len,
+                       count,
+                       rendered - start );
+
+        if ( ( result != ENODATA ) &&
+             ( complete == true ) )
+        {
+            if ( pCtx->pState->pOutQ != NULL )
+            {
+                /* hand the finished message to the sink writer */
+                rc = OUTQ_Write( pCtx->pState->pOutQ,
+                                 pMsg->pSink,
+                                 pMsgBuf->pData,
+                                 pMsgBuf->len,
+                                 &pMsg->dropped );
+            }
+            else
+            {
+                /* send the whole message to the output */
+                rc = SINK_Write( pMsg->pSink, pMsgBuf->pData, pMsgBuf->len );
+            }
+
+            if ( rc != EOK )
+            {
+                result = rc;
+            }
+            else
+            {
+                /* update the performance counters */
+                written = GetTimeUs();
+                MSGSTATS_Record( &pMsg->stats,
+                                 rendered - start,
+                                 written - rendered,
+                                 pMsgBuf->len,
+                                 count );
+                MSGSTATS_HistAdd( &pCtx->pState->renderHist,
+                                  rendered - start );
+                __atomic_add_fetch( &pCtx->pState->renderUs,
+                                    rendered - start,
+                                    __ATOMIC_RELAXED );
+                MSGSTATS_HistAdd( &pCtx->pState->sinkHist,
+                                  written - rendered );
+            }
+        }
+
+        if ( shared == true )
+        {
+            pthread_mutex_unlock( &pBody->lock );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RenderBody                                                                */
+/*!
+    Render the body of a Variable Message
+
+    The RenderBody function assembles the specified variable message in
+    the message buffer.
+
+    @param[in]
+        pCtx
+            pointer to the render context used to assemble the message
+
+    @param[in]
+        pMsg
+            pointer to the specific variable message to render
+
+    @param[in]
+        pMsgBuf
+            pointer to the message buffer to assemble the message in
+
+    @param[out]
+        pComplete
+            set to true if the message buffer contains a complete
+            message which can be sent
+
+    @retval EOK The variable message was successfully rendered
+    @retval ENODATA delta message with no modified variables to send
+    @retval EINVAL invalid argument
+    @retval ENOMEM memory allocation failure
+    @retval other error from a variable output
+
+==============================================================================*/
+static int RenderBody( RenderContext *pCtx,
+                       VarMsgConfig *pMsg,
+                       MsgBuf *pMsgBuf,
+                       bool *pComplete )
+{
+    int result = EINVAL;
+    int rc;
+    VarMetaTable *pTable;
+    size_t i;
+    bool keyframe;
+    size_t words;
+
+    if ( ( pCtx != NULL ) &&
+         ( pMsg != NULL ) &&
+         ( pMsgBuf != NULL ) &&
+         ( pComplete != NULL ) )
+    {
+        result = EOK;
+        *pComplete = false;
+
+        /* initialize the variable count for the current render */
+        pCtx->outputCount = 0;
+
+        /* start a new message */
+        pCtx->pMsgBuf = pMsgBuf;
+        MSGBUF_Reset( pMsgBuf );
+
+        /* values formatted earlier in this processing cycle are reused */
+        VALCACHE_Begin( &pCtx->values,
+                        __atomic_load_n( &pCtx->pState->cycle,
+                                         __ATOMIC_ACQUIRE ) );
+        pTable = &pMsg->pBody->meta;
+
+        /* see if this message contains all of the body variables.
+           A shedDelta message is only sent in delta mode while it is
+           being shed */
+        keyframe = ( pMsg->delta == false ) ||
+                   ( pMsg->deltaCount == 0 ) ||
+                   ( ( pMsg->shedDelta == true ) &&
+                     ( __atomic_load_n( &pMsg->degraded,
+                                        __ATOMIC_RELAXED ) == false ) );
+        if ( pMsg->delta == true )
+        {
+            if ( keyframe == true )
+            {
+                /* all variables are sent so clear the modified flags */
+                words = ( pTable->n + DIRTY_WORD_BITS - 1 ) / DIRTY_WORD_BITS;
+                for ( i = 0; i < words; i++ )
+                {
+                    __atomic_store_n( &pMsg->pDirty[i], 0, __ATOMIC_RELAXED );
+                }
+            }
+
+            pMsg->deltaCount = ( pMsg->deltaCount + 1 ) % pMsg->keyframe;
+        }
+
+        rc = EOK;
+        if ( pMsg->pTemplate != NULL )
+        {
+            /* output the part of the template before the body */
+            rc = OutputTemplate( pCtx,
+                                 pMsg->pTemplate,
+                                 0,
+                                 pMsg->pTemplate->bodyIdx );
+            if ( rc != ENOMEM )
+            {
+                result = rc;
+                rc = EOK;
+            }
+        }
+
+        if ( rc != EOK )
+        {
+            /* the message is incomplete */
+        }
+        else if ( pTable->format == MSGFORMAT_CBOR )
+        {
+            rc = CBOR_BeginMap( pMsgBuf );
+        }
+        else
+        {
+            rc = MSGBUF_AppendChar( pMsgBuf, '{' );
+        }
+
+        /* output each variable in the message body */
+        for ( i = 0; ( i < pTable->n ) && ( rc != ENOMEM ) ; i++ )
+        {
+            if ( ( keyframe == true ) ||
+                 ( TestAndClearModified( pMsg, i ) == true ) )
+            {
+                rc = OutputVar( pCtx, pTable, &pTable->pMeta[i] );
+                if ( rc != EOK )
+                {
+                    result = rc;
+                }
+            }
+        }
+
+        if ( ( keyframe == false ) &&
+             ( pCtx->outputCount == 0 ) &&
+             ( result == EOK ) )
+        {
+            /* nothing was modified so there is nothing to send */
+            result = ENODATA;
+        }
+        else
+        {
+            if ( rc == ENOMEM )
+            {
+                /* the message is incomplete */
+            }
+            else if ( pTable->format == MSGFORMAT_CBOR )
+            {
+                rc = CBOR_AppendBreak( pMsgBuf );
+            }
+            else if ( pMsg->pTemplate != NULL )
+            {
+                /* close the body and output the rest of the template */
+                rc = MSGBUF_AppendChar( pMsgBuf, '}' );
+                if ( rc == EOK )
+                {
+                    rc = OutputTemplate( pCtx,
+                                         pMsg->pTemplate,
+                                         pMsg->pTemplate->bodyIdx + 1,
+                                         pMsg->pTemplate->n );
+                }
+
+                if ( rc != ENOMEM )
+                {
+                    if ( rc != EOK )
+                    {
+                        result = rc;
+                    }
+
+                    rc = MSGBUF_AppendChar( pMsgBuf, '\n' );
                 }
             }
+            else
+            {
+                rc = MSGBUF_Append( pMsgBuf, "}\n", 2 );
+            }
+
+            if ( rc == EOK )
+            {
+                *pComplete = true;
+            }
+            else
+            {
+                result = rc;
+            }
         }
     }
 
@@ -1162,154 +8630,180 @@ static int ProcessVarList( JArray *pVarList, VarCache **ppVarCache )
 }
 
 /*============================================================================*/
-/*  AddToCache                                                                */
+/*  OutputVar                                                                 */
 /*!
-    Add variable name from a JArray to the variable cache
+    Output Variable data
 
-    The AddToCache function is a callback function for the JSON_Iterate
-    function used to add a variable name string from a JSON array to
-    a VarCache list.
+    The OutputVar function outputs a variable name/value JSON
+    attribute using the cached variable information.
+
+    Scalar numeric variables without a custom format specifier are
+    fetched with VAR_Get and formatted in-process.  All other variables
+    are printed by the variable server via VAR_Print.
+
+    The formatted value is kept in the render context's value cache
+    until the end of the processing cycle, so a variable which appears
+    in several messages generated in the same cycle is only fetched
+    and formatted once.
 
     @param[in]
-        pNode
-            pointer to the item in the JSON Array.  The type of this item
-            is expected to be a string value.  If it is not, the function
-            will fail with an ENOTSUP error
+        pCtx
+            pointer to the render context
 
     @param[in]
-        arg
-            opaque argument pointer which points to a VarCache object.
+        pTable
+            pointer to the variable information table
 
-    @retval EOK the variable was added to the VarCache
-    @retval ENOTSUP the type of object in the array is not a string
-    @retval ENOENT the variable was not found
+    @param[in]
+        pMeta
+            pointer to the information for the variable to output
+
+    @retval EOK the variable was output
     @retval EINVAL invalid arguments
 
 ==============================================================================*/
-static int AddToCache( JNode *pNode, void *arg )
+static int OutputVar( RenderContext *pCtx,
+                      VarMetaTable *pTable,
+                      VarMeta *pMeta )
 {
     int result = EINVAL;
-    VarCache *pVarCache = (VarCache *)arg;
-    JVar *pVar = (JVar *)pNode;
-    VAR_HANDLE hVar;
-
-    if ( ( pNode != NULL ) &&
-         ( pNode->type == JSON_VAR ) &&
-         ( pVarCache != NULL ) )
+    char prefix;
+    uint32_t tag;
+    size_t start;
+    size_t skip;
+    MsgBuf *pMsgBuf;
+    bool fetched = false;
+
+    if ( ( pCtx != NULL ) &&
+         ( pTable != NULL ) &&
+         ( pMeta != NULL ) )
     {
-        /* only strings are supported */
-        result = ENOTSUP;
-        if ( pVar->var.type == JVARTYPE_STR )
+        /* see if we need to prepend a comma */
+        prefix = ( pCtx->outputCount > 0 ) ? ',' : ' ';
+
+        /* the value encoding depends on the format and formatter */
+        tag = ( (uint32_t)pTable->format << 1 ) | ( pMeta->typed ? 1 : 0 );
+
+        pMsgBuf = pCtx->pMsgBuf;
+        start = pMsgBuf->len;
+
+        result = OutputCachedVar( pCtx, pTable, pMeta, prefix, tag );
+        if ( result != ENOENT )
         {
-            /* look for a variable given its name */
-            hVar = VAR_FindByName( hVarServer, pVar->var.val.str );
-            if ( hVar != VAR_INVALID )
-            {
-                /* add the variable to the cache */
-                result = VARCACHE_Add( pVarCache, hVar );
-            }
-            else
-            {
-                /* variable not found */
-                result = ENOENT;
-            }
+            /* the value was already formatted in this cycle */
+        }
+        else if ( pMeta->typed == true )
+        {
+            /* format the value locally */
+            result = OutputTypedVar( pCtx, pTable, pMeta, prefix );
+            fetched = true;
         }
         else
         {
-            printf("Expected string type for variable name\n");
+            /* have the variable server print the value */
+            result = OutputPrintedVar( pCtx, pTable, pMeta, prefix );
+            fetched = true;
         }
-    }
-
-    return result;
-}
-
-/*============================================================================*/
-/*  SetupTimer                                                                */
-/*!
-    Set up a timer
-
-    The SetupTimer function sets up a timer to periodically process the
-    message configurations for transmission on a schedule.
-
-    @param[in]
-        s
-            Timer tick rate (in seconds)
 
-    @retval EOK timer set up ok
-    @retval other error from timer_create or timer_settime
+        if ( ( result == EOK ) &&
+             ( fetched == true ) &&
+             ( pCtx->values.epoch != 0 ) )
+        {
+            /* remember the value which follows the prefix and key */
+            skip = pMeta->keyLen;
+            if ( pTable->format == MSGFORMAT_JSON )
+            {
+                skip++;
+            }
 
-==============================================================================*/
-static int SetupTimer( int s )
-{
-    struct sigevent te;
-    struct itimerspec its;
-    time_t secs = (time_t)s;
-    timer_t *timerID;
-    int result = EINVAL;
-    static timer_t timer = 0;
-    int rc;
+            VALCACHE_Add( &pCtx->values,
+                          pMeta->hVar,
+                          tag,
+                          &pMsgBuf->pData[start + skip],
+                          pMsgBuf->len - start - skip );
+        }
 
-    timerID = &timer;
+        VARMSG_TRACE5( var_output,
+                       pCtx->msgId,
+                       pMeta->hVar,
+                       result,
+                       pMsgBuf->len - start,
+                       fetched );
 
-    /* Set and enable alarm */
-    te.sigev_notify = SIGEV_SIGNAL;
-    te.sigev_signo = SIG_VAR_TIMER;
-    te.sigev_value.sival_int = 1;
-    rc = timer_create(CLOCK_REALTIME, &te, timerID);
-    if ( rc == 0 )
-    {
-        its.it_interval.tv_sec = secs;
-        its.it_interval.tv_nsec = 0;
-        its.it_value.tv_sec = secs;
-        its.it_value.tv_nsec = 0;
-        rc = timer_settime(*timerID, 0, &its, NULL);
-        result = ( rc == 0 ) ? EOK : errno;
-    }
-    else
-    {
-        result = errno;
+        if ( result == EOK )
+        {
+            /* increment the variable count */
+            pCtx->outputCount++;
+        }
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  SetupModifiedTrigger                                                                */
+/*  OutputTemplate                                                            */
 /*!
-    Set up "modified" triggers for the message
+    Output a range of message template parts
 
-    The SetupModifiedTrigger function requests a NOTIFY_MODIFIED notification
-    for each appropriate variable in the message.  This includes
-    any "trigger" variable, and any message group with the trigger
-    flag set.
+    The OutputTemplate function copies the static text segments of
+    the specified range of template parts into the message, and fills
+    each variable slot with the value of its variable.
 
     @param[in]
-        pState
-            Pointer to the Variable Message state
+        pCtx
+            pointer to the render context
 
     @param[in]
-        pConfig
-            Pointer to the configuration for the Variable Message
+        pTmpl
+            pointer to the compiled message template
 
-    @retval EOK notifications were set up ok
+    @param[in]
+        start
+            index of the first template part to output
+
+    @param[in]
+        end
+            index after the last template part to output
+
+    @retval EOK the template parts were output
+    @retval ENOMEM memory allocation failure
     @retval EINVAL invalid arguments
-    @retval other error from VAR_Notify
+    @retval other error from a variable output
 
 ==============================================================================*/
-static int SetupModifiedTrigger( VarMsgState *pState, VarMsgConfig *pConfig )
+static int OutputTemplate( RenderContext *pCtx,
+                           MsgTemplate *pTmpl,
+                           size_t start,
+                           size_t end )
 {
     int result = EINVAL;
+    int rc = EOK;
+    MsgTmplPart *pPart;
+    size_t i;
 
-    if ( ( pState != NULL ) &&
-         ( pConfig != NULL ) )
+    if ( ( pCtx != NULL ) &&
+         ( pTmpl != NULL ) )
     {
         result = EOK;
 
-        if ( pConfig->pTriggerCache != NULL )
+        for ( i = start; ( i < end ) && ( rc != ENOMEM ); i++ )
         {
-            result = VARCACHE_Map( pConfig->pTriggerCache,
-                                   varmsg_CacheNotify,
-                                   pState->hVarServer );
+            pPart = &pTmpl->pParts[i];
+            if ( pPart->type == MSGTMPL_TEXT )
+            {
+                rc = MSGBUF_Append( pCtx->pMsgBuf,
+                                    &pTmpl->text.pData[pPart->offset],
+                                    pPart->len );
+            }
+            else if ( pPart->type == MSGTMPL_VAR )
+            {
+                rc = OutputTemplateVar( pCtx, pPart );
+            }
+
+            if ( rc != EOK )
+            {
+                result = rc;
+            }
         }
     }
 
@@ -1317,140 +8811,184 @@ static int SetupModifiedTrigger( VarMsgState *pState, VarMsgConfig *pConfig )
 }
 
 /*============================================================================*/
-/*  varmsg_CacheNotify                                                        */
+/*  OutputTemplateVar                                                         */
 /*!
-    Mapping callback function to request a variable notification
+    Fill a message template variable slot
 
-    The varmsg_CacheNotify callback function is used by the
-    VARQUERY_Map function to request a NOTIFY_MODIFIED notification for a cache
-    variable.
+    The OutputTemplateVar function outputs the value of a template slot
+    variable.  The value is inserted as is, so the template controls
+    any quoting, but text values are JSON escaped.  Like the body
+    variables, the formatted value is kept in the value cache until the
+    end of the processing cycle.
 
     @param[in]
-        hVar
-            handle of variable to be added to the cache
+        pCtx
+            pointer to the render context
 
     @param[in]
-        arg
-            opaque pointer argument from the map function
-            which is converted to the variable server handle.
+        pPart
+            pointer to the template variable slot
 
-    @retval EOK - notify request was successful
-    @retval EINVAL - invalid arguments
+    @retval EOK the variable was output, or does not exist
+    @retval ENOTSUP the variable is not a scalar type
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+    @retval other error from VAR_Get or VAR_Print
 
 ==============================================================================*/
-static int varmsg_CacheNotify( VAR_HANDLE hVar, void *arg )
+static int OutputTemplateVar( RenderContext *pCtx, MsgTmplPart *pPart )
 {
     int result = EINVAL;
-    VARSERVER_HANDLE hVarServer = (VARSERVER_HANDLE)arg;
+    MsgBuf *pMsgBuf;
+    uint32_t tag;
+    const char *pValue;
+    char *pData;
+    size_t start;
+    size_t len;
+    VarObject obj;
+    char buf[NUMFMT_MAX_LEN];
 
-    if ( ( hVarServer != NULL ) &&
-         ( hVar != VAR_INVALID ) )
+    if ( ( pCtx != NULL ) &&
+         ( pPart != NULL ) )
     {
-        result = VAR_Notify( hVarServer, hVar, NOTIFY_MODIFIED );
+        pMsgBuf = pCtx->pMsgBuf;
+        start = pMsgBuf->len;
+        tag = VALTAG_TEMPLATE | ( pPart->typed ? 1 : 0 );
+
+        if ( pPart->hVar == VAR_INVALID )
+        {
+            /* the variable does not exist so the slot is left empty */
+            result = EOK;
+        }
+        else if ( VALCACHE_Find( &pCtx->values,
+                                 pPart->hVar,
+                                 tag,
+                                 &pValue,
+                                 &len ) == EOK )
+        {
+            /* the value was already formatted in this cycle */
+            result = MSGBUF_Append( pMsgBuf, pValue, len );
+            start = pMsgBuf->len;
+        }
+        else if ( pPart->typed == true )
+        {
+            result = VAR_Get( pCtx->hVarServer, pPart->hVar, &obj );
+            if ( result == EOK )
+            {
+                len = FormatValue( &obj, buf );
+                result = ( len > 0 ) ? MSGBUF_Append( pMsgBuf, buf, len )
+                                     : ENOTSUP;
+            }
+        }
+        else
+        {
+            /* print the variable value to the output buffer */
+            result = VAR_Print( pCtx->hVarServer, pPart->hVar, pCtx->varFd );
+            if ( ( result == EOK ) &&
+                 ( write( pCtx->varFd, "\0", 1 ) != 1 ) )
+            {
+                result = EIO;
+            }
+
+            pData = VARFP_GetData( pCtx->pVarFP );
+            if ( ( result == EOK ) && ( pData != NULL ) )
+            {
+                result = MSGBUF_AppendEscaped( pMsgBuf,
+                                               pData,
+                                               strlen( pData ) );
+                pData[0] = '\0';
+            }
+
+            /* seek to the beginning of the output buffer */
+            lseek( pCtx->varFd, 0, SEEK_SET );
+        }
+
+        if ( ( result == EOK ) &&
+             ( pMsgBuf->len > start ) )
+        {
+            /* remember the newly formatted value */
+            VALCACHE_Add( &pCtx->values,
+                          pPart->hVar,
+                          tag,
+                          &pMsgBuf->pData[start],
+                          pMsgBuf->len - start );
+        }
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  RunMessageGenerator                                                       */
+/*  OutputCachedVar                                                           */
 /*!
-    Run the message generator main loop
+    Output a variable value formatted earlier in the processing cycle
 
-    The RunMessageGenerator function waits for an external signal
-    either from a timer, or from the variable server.
+    The OutputCachedVar function looks up the variable in the render
+    context's value cache, and if it has already been formatted in the
+    current processing cycle, outputs the key followed by the cached
+    value.
 
     @param[in]
-        pState
-            pointer to the Variable Message Generator state object
-
-    @retval EOK timer set up ok
-    @retval other error from timer_create or timer_settime
-
-==============================================================================*/
-static void RunMessageGenerator( VarMsgState *pState )
-{
-    int sig;
-    int sigval;
-    int result;
-    VAR_HANDLE hVar;
+        pCtx
+            pointer to the render context
 
-    while( 1 )
-    {
-        /* wait for a received signal */
-        sig = VARSERVER_WaitSignal( &sigval );
-        if ( sig == SIG_VAR_TIMER )
-        {
-            /* process received timer signal */
-            result = ProcessTimer( pState );
-        }
-        else if ( sig == SIG_VAR_MODIFIED )
-        {
-            hVar = (VAR_HANDLE)sigval;
-            result = ProcessModified( pState, hVar );
-        }
-    }
-}
+    @param[in]
+        pTable
+            pointer to the variable information table
 
-/*============================================================================*/
-/*  ProcessTimer                                                              */
-/*!
-    Process a received timer tick
+    @param[in]
+        pMeta
+            pointer to the information for the variable to output
 
-    The ProcessTimer function iterates through all of the Variable
-    Message Configurations, and if they are set up to be processed
-    on an interval, it will decrement the interval countdown.
-    If the interval countdown reaches zero, the Variable Message
-    will be processed (generated), and the interval timer will
-    be reset to its initial value.
+    @param[in]
+        prefix
+            prefix character to output before a JSON key
 
     @param[in]
-        pState
-            pointer to the Variable Message Generator state object
-            containing the Variable Message Configurations to process.
+        tag
+            value cache tag describing how the value is encoded
 
-    @retval EOK Timer handler processed successfully
-    @retval EINVAL invalid argument
+    @retval EOK the variable was output
+    @retval ENOENT the value has not been formatted in this cycle
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
 
 ==============================================================================*/
-static int ProcessTimer( VarMsgState *pState )
+static int OutputCachedVar( RenderContext *pCtx,
+                            VarMetaTable *pTable,
+                            VarMeta *pMeta,
+                            char prefix,
+                            uint32_t tag )
 {
-    VarMsgConfig *pMsgConfig;
     int result = EINVAL;
+    const char *pData;
+    size_t len;
 
-    if ( pState != NULL )
+    if ( ( pCtx != NULL ) &&
+         ( pTable != NULL ) &&
+         ( pMeta != NULL ) )
     {
-        result = EOK;
-
-        /* get the first message configuration */
-        pMsgConfig = pState->pMessageConfigs;
-        while ( pMsgConfig != NULL )
+        result = VALCACHE_Find( &pCtx->values,
+                                pMeta->hVar,
+                                tag,
+                                &pData,
+                                &len );
+        if ( ( result == EOK ) &&
+             ( pTable->format == MSGFORMAT_JSON ) )
         {
-            /* check if it has an interval processing requirement
-               and it is enabled */
-            if ( ( pMsgConfig->interval != 0 ) &&
-                 ( pMsgConfig->enabled == true ) )
-            {
-                if ( pMsgConfig->t > 0 )
-                {
-                    /* decrement the interval countdown */
-                    pMsgConfig->t--;
-                }
-
-                /* when the interval countdown reaches zero, it is time to
-                   process (generate) this message */
-                if ( pMsgConfig->t == 0 )
-                {
-                    /* reset the interval countdown */
-                    pMsgConfig->t = pMsgConfig->interval;
+            result = MSGBUF_AppendChar( pCtx->pMsgBuf, prefix );
+        }
 
-                    /* Process (generate) the message */
-                    result = ProcessMessage( pState, pMsgConfig );
-                }
-            }
+        if ( result == EOK )
+        {
+            result = MSGBUF_Append( pCtx->pMsgBuf,
+                                    &pTable->keys.pData[pMeta->keyOffset],
+                                    pMeta->keyLen );
+        }
 
-            /* get the next message configuration */
-            pMsgConfig = pMsgConfig->pNext;
+        if ( result == EOK )
+        {
+            result = MSGBUF_Append( pCtx->pMsgBuf, pData, len );
         }
     }
 
@@ -1458,272 +8996,276 @@ static int ProcessTimer( VarMsgState *pState )
 }
 
 /*============================================================================*/
-/*  ProcessModified                                                           */
+/*  OutputPrintedVar                                                          */
 /*!
-    Process a NOTIFY_MODIFIED notification
+    Output a variable printed by the variable server
 
-    The ProcessModified function iterates through all of the Variable
-    Message Configurations, and checks if the variable modified notication
-    should trigger a message transmission.
+    The OutputPrintedVar function requests the variable server to print
+    the variable value into the render context VarFP output buffer, and then
+    outputs the printed value as a JSON attribute.
 
     @param[in]
-        pState
-            pointer to the Variable Message Generator state object
-            containing the Variable Message Configurations to process.
+        pCtx
+            pointer to the render context
 
     @param[in]
-        hVar
-            handle to the modified variable
+        pTable
+            pointer to the variable information table
 
-    @retval EOK Timer handler processed successfully
-    @retval EINVAL invalid argument
+    @param[in]
+        pMeta
+            pointer to the information for the variable to output
+
+    @param[in]
+        prefix
+            prefix character to output before the variable
+
+    @retval EOK the variable was output
+    @retval EINVAL invalid arguments
+    @retval EIO failed to terminate the printed value
 
 ==============================================================================*/
-static int ProcessModified( VarMsgState *pState, VAR_HANDLE hVar )
+static int OutputPrintedVar( RenderContext *pCtx,
+                             VarMetaTable *pTable,
+                             VarMeta *pMeta,
+                             char prefix )
 {
-    VarMsgConfig *pConfig;
-    VarObject obj;
-    int result;
-    bool forceProcess = false;
+    char *pData;
+    char *pKey;
+    int result = EINVAL;
+    int fd;
+    ssize_t n;
 
-    pConfig = pState->pMessageConfigs;
-    while ( pConfig != NULL )
+    if ( ( pCtx != NULL ) &&
+         ( pTable != NULL ) &&
+         ( pMeta != NULL ) )
     {
-        forceProcess = false;
+        fd = pCtx->varFd;
 
-        if ( hVar == pConfig->hTrigger )
+        /* print the variable value to the output buffer */
+        if( VAR_Print( pCtx->hVarServer,
+                       pMeta->hVar,
+                       fd ) == EOK )
         {
-            forceProcess = true;
-        }
+            /* NUL terminate */
+            n = write( fd, "\0", 1 );
+            if ( n != 1 )
+            {
+                /* I/O error */
+                result = EIO;
+            }
 
-        if ( hVar == pConfig->hEnable )
-        {
-            /* get the value of the enable variable */
-            result = VAR_Get( pState->hVarServer, hVar, &obj );
-            if ( result == EOK )
+            /* get a handle to the output buffer */
+            pData = VARFP_GetData( pCtx->pVarFP );
+            if( pData != NULL )
             {
-                pConfig->enabled = ( obj.val.ul == 0 ) ? false : true;
-                if ( pConfig->enabled == true )
+                /* output the data */
+                if ( pTable->format == MSGFORMAT_CBOR )
                 {
-                    /* force processing when message is turned on */
-                    forceProcess = true;
-
-                    if ( pConfig->interval != 0 )
-                    {
-                        /* initialize the countdown timer */
-                        pConfig->t = pConfig->interval;
-                    }
-
+                    result = OutputCBORText( pCtx->pMsgBuf,
+                                             pTable,
+                                             pMeta,
+                                             pData );
+                }
+                else
+                {
+                    pKey = &pTable->keys.pData[pMeta->keyOffset];
+                    result = OutputJSONVar( prefix,
+                                            pKey,
+                                            pMeta->keyLen,
+                                            pData,
+                                            pCtx->pMsgBuf );
                 }
-            }
-        }
 
-        /* see if we are forcing a message generation via the message
-           trigger or by enabling the message, or if the modified variable
-           is in the trigger variable cache */
-        if ( ( forceProcess == true ) ||
-             ( VARCACHE_HasVar( pConfig->pTriggerCache, hVar ) == true ) )
-        {
-            ProcessMessage( pState, pConfig );
+                /* clear the memory */
+                pData[0] = '\0';
+            }
         }
 
-        pConfig = pConfig->pNext;
+        /* seek to the beginning of the output buffer */
+        lseek( fd, 0, SEEK_SET );
     }
+
+    return result;
 }
 
 /*============================================================================*/
-/*  ProcessMessage                                                            */
+/*  OutputTypedVar                                                            */
 /*!
-    Process a Variable Message
+    Output a scalar variable formatted in-process
 
-    The ProcessMessage function processes a Variable Message.
-    Message content is generated if the message is enabled.
-    The message is sent to the requested output stream.
+    The OutputTypedVar function gets the value of a scalar variable
+    with VAR_Get and formats it directly, avoiding the variable server
+    print request and the VarFP round trip.
 
     @param[in]
-        pState
-            pointer to the Variable Message Generator state object
-            containing the Variable Message Configurations to process.
+        pCtx
+            pointer to the render context
 
     @param[in]
-        pMsgConfig
-            pointer to the specific variable message to process
+        pTable
+            pointer to the variable information table
 
-    @retval EOK The variable message was successfully processed
-    @retval EINVAL invalid argument
+    @param[in]
+        pMeta
+            pointer to the information for the variable to output
+
+    @param[in]
+        prefix
+            prefix character to output before the variable
+
+    @retval EOK the variable was output
+    @retval EINVAL invalid arguments
+    @retval ENOTSUP the variable is not a scalar type
+    @retval other error from VAR_Get
 
 ==============================================================================*/
-static int ProcessMessage( VarMsgState *pState, VarMsgConfig *pMsgConfig )
+static int OutputTypedVar( RenderContext *pCtx,
+                           VarMetaTable *pTable,
+                           VarMeta *pMeta,
+                           char prefix )
 {
     int result = EINVAL;
     VarObject obj;
+    char buf[NUMFMT_MAX_LEN];
 
-    if ( ( pState != NULL ) &&
-         ( pMsgConfig != NULL ) )
+    if ( ( pCtx != NULL ) &&
+         ( pTable != NULL ) &&
+         ( pMeta != NULL ) )
     {
-        /* only process messages which are enabled */
-        if( pMsgConfig->enabled == true )
+        result = VAR_Get( pCtx->hVarServer, pMeta->hVar, &obj );
+        if ( result == EOK )
         {
-            if ( pState->verbose == true )
+            if ( pTable->format == MSGFORMAT_CBOR )
             {
-                printf("Processing Message: %s\n", pMsgConfig->configName );
+                /* encode the value directly without formatting it */
+                result = OutputCBORVar( pCtx->pMsgBuf, pTable, pMeta, &obj );
             }
-
-            /* set up the message object */
-            obj.type = VARTYPE_UINT32;
-
-            /* render message to standard output */
-            result = RenderMessage( pState, pMsgConfig, STDOUT_FILENO );
-            if ( result == EOK )
+            else if ( FormatValue( &obj, buf ) > 0 )
             {
-                obj.val.ul = ++pMsgConfig->txCount;
-                VAR_Set( pState->hVarServer, pMsgConfig->hTxCount, &obj );
+                result = OutputJSONVar( prefix,
+                                        &pTable->keys.pData[pMeta->keyOffset],
+                                        pMeta->keyLen,
+                                        buf,
+                                        pCtx->pMsgBuf );
             }
             else
             {
-                obj.val.ul = ++pMsgConfig->errCount;
-                VAR_Set( pState->hVarServer, pMsgConfig->hErrCount, &obj );
+                result = ENOTSUP;
             }
         }
-
-        result = EOK;
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  RenderMessage                                                             */
+/*  IsTypedVar                                                                */
 /*!
-    Render a Variable Message
-
-    The RenderMessage function renders the specified variable message
-    to an output file descriptor.
-
-    @param[in]
-        pState
-            pointer to the Variable Message Generator state object
-            containing the Variable Message Configurations to process.
+    Determine if a variable can be formatted in-process
 
-    @param[in]
-        pMsg
-            pointer to the specific variable message to render
+    The IsTypedVar function checks if the variable is a scalar numeric
+    type which uses the default output format, and can therefore be
+    formatted locally instead of being printed by the variable server.
 
     @param[in]
-        fd
-            output file descriptor to write to
+        info
+            pointer to the variable information
 
-    @retval EOK The variable message was successfully rendered
-    @retval EINVAL invalid argument
+    @retval true the variable can be formatted in-process
+    @retval false the variable must be printed by the variable server
 
 ==============================================================================*/
-static int RenderMessage( VarMsgState *pState, VarMsgConfig *pMsg, int fd )
+static bool IsTypedVar( VarInfo *info )
 {
-    int result = EINVAL;
+    bool result = false;
 
-    if ( ( pState != NULL ) &&
-         ( pMsg != NULL ) &&
-         ( fd != -1 ) )
+    if ( ( info != NULL ) &&
+         ( info->formatspec[0] == '\0' ) )
     {
-        /* initialize the variable count for the current render */
-        pState->outputCount = 0;
-
-        /* initialize the output file descriptor */
-        pState->fd = fd;
-
-        write( fd, "{", 1 );
-
-        /* map the OutputVar function across the variable cache */
-        result = VARCACHE_Map( pMsg->pVarCache, OutputVar, (void *)pState );
-
-        write( fd, "}", 1 );
-        write( fd, "\n", 1 );
+        switch( info->var.type )
+        {
+            case VARTYPE_UINT16:
+            case VARTYPE_INT16:
+            case VARTYPE_UINT32:
+            case VARTYPE_INT32:
+            case VARTYPE_UINT64:
+            case VARTYPE_INT64:
+            case VARTYPE_FLOAT:
+                result = true;
+                break;
 
+            default:
+                break;
+        }
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  OutputVar                                                                 */
+/*  FormatValue                                                               */
 /*!
-    Output Variable data
+    Format a scalar variable value
 
-    The OutputVar function outputs a variable name/value JSON
-    attribute.
+    The FormatValue function converts a scalar variable value to text
+    in the same form as the variable server would print it.
 
     @param[in]
-        hVar
-            handle to the variable to output
+        obj
+            pointer to the variable object to format
 
-    @param[in]
-        arg
-            handle to the VarMsgState object
+    @param[in,out]
+        buf
+            pointer to an output buffer of at least NUMFMT_MAX_LEN bytes
 
-    @retval EOK the variable was output
-    @retval EINVAL invalid arguments
+    @retval length of the formatted value
+    @retval 0 the variable object is not a scalar type
 
 ==============================================================================*/
-static int OutputVar( VAR_HANDLE hVar, void *arg )
+static size_t FormatValue( VarObject *obj, char *buf )
 {
-    VarMsgState *pState = (VarMsgState *)arg;
-    char *pData;
-    int result = EINVAL;
-    int fd;
-    char prefix;
-    VarInfo info;
-    ssize_t n;
+    size_t len = 0;
 
-    if ( ( pState != NULL ) &&
-         ( hVar != VAR_INVALID ) )
+    if ( ( obj != NULL ) &&
+         ( buf != NULL ) )
     {
-        fd = pState->varFd;
-
-        /* get the variable info */
-        if ( VAR_GetInfo( pState->hVarServer,
-                          hVar,
-                          &info ) == EOK )
-
+        switch( obj->type )
         {
-            /* print the variable value to the output buffer */
-            if( VAR_Print( pState->hVarServer,
-                           hVar,
-                           fd ) == EOK )
-            {
-                /* NUL terminate */
-                n = write( fd, "\0", 1 );
-                if ( n != 1 )
-                {
-                    /* I/O error */
-                    result = EIO;
-                }
+            case VARTYPE_UINT16:
+                len = NUMFMT_U64( buf, obj->val.ui );
+                break;
 
-                /* get a handle to the output buffer */
-                pData = VARFP_GetData( pState->pVarFP );
-                if( pData != NULL )
-                {
-                    /* see if we need to prepend a comma */
-                    prefix = ( pState->outputCount > 0 ) ? ',' : ' ';
+            case VARTYPE_INT16:
+                len = NUMFMT_I64( buf, obj->val.i );
+                break;
 
-                    /* output the data */
-                    OutputJSONVar( prefix, &info, pData, pState->fd );
+            case VARTYPE_UINT32:
+                len = NUMFMT_U64( buf, obj->val.ul );
+                break;
 
-                    /* clear the memory */
-                    pData[0] = '\0';
+            case VARTYPE_INT32:
+                len = NUMFMT_I64( buf, obj->val.l );
+                break;
 
-                    /* increment the variable count */
-                    pState->outputCount++;
+            case VARTYPE_UINT64:
+                len = NUMFMT_U64( buf, obj->val.ull );
+                break;
 
-                    result = EOK;
-                }
-            }
+            case VARTYPE_INT64:
+                len = NUMFMT_I64( buf, obj->val.ll );
+                break;
 
-            /* seek to the beginning of the output buffer */
-            lseek( fd, 0, SEEK_SET );
+            case VARTYPE_FLOAT:
+                len = NUMFMT_Float( buf, obj->val.f );
+                break;
+
+            default:
+                break;
         }
     }
 
-    return result;
+    return len;
 }
 
 /*============================================================================*/
@@ -1731,152 +9273,250 @@ static int OutputVar( VAR_HANDLE hVar, void *arg )
 /*!
     Output a variable JSON value
 
-    The OutputJSONVar function prints a variable JSON value with a prefix
-    The prefix is intended to be either a space, or a comma so this
-    function can be used to output a list of variables and prepend (or not)
-    a comma.
+    The OutputJSONVar function appends a variable JSON value with a prefix
+    to the message buffer.  The prefix is intended to be either a space,
+    or a comma so this function can be used to output a list of variables
+    and prepend (or not) a comma.
+
+    The value is scanned once to find its length, its first and last
+    non-whitespace characters, and any characters which need escaping.
+    A value which starts with [ or { and ends with the matching ] or }
+    is likely a JSON array or object, and is output as is.  Any other
+    value is output as a JSON string, and is only escaped if it
+    contains characters which must be escaped.
 
     The output will be similar to the following:
 
     "name" : "value"
 
     @param[in]
-        info
-            pointer to the variable information
+        prefix
+            prefix character to output before the variable
+
+    @param[in]
+        key
+            pointer to the pre-encoded JSON key of the variable
+
+    @param[in]
+        keylen
+            length of the pre-encoded JSON key
 
     @param[in]
         value
             value of the variable as a string
 
     @param[in]
-        fd
-            output file descriptor
+        pMsgBuf
+            pointer to the message buffer to append to
 
     @retval EOK the JSON value was output
     @retval EINVAL invalid arguments
+    @retval ENOMEM memory allocation failure
 
 ==============================================================================*/
-static int OutputJSONVar( char prefix, VarInfo *info, char *value, int fd )
+static int OutputJSONVar( char prefix,
+                          const char *key,
+                          size_t keylen,
+                          char *value,
+                          MsgBuf *pMsgBuf )
 {
     int result = EINVAL;
-
-    if ( ( info != NULL ) &&
-         ( value != NULL ) )
+    StrScan scan;
+    char first;
+    char last;
+    bool json;
+
+    if ( ( key != NULL ) &&
+         ( value != NULL ) &&
+         ( pMsgBuf != NULL ) )
     {
-        if (IsJSON( value ) == true )
+        STRSCAN_Scan( value, &scan );
+
+        /* check if we have a JSON object or array */
+        first = value[scan.first];
+        last = value[scan.last];
+        json = ( ( first == '[' ) && ( last == ']' ) ) ||
+               ( ( first == '{' ) && ( last == '}' ) );
+
+        result = MSGBUF_AppendChar( pMsgBuf, prefix );
+        if ( result == EOK )
         {
-            if ( info->instanceID == 0 )
-            {
-                dprintf( fd,
-                        "%c\"%s\":%s",
-                        prefix,
-                        info->name,
-                        value );
-            }
-            else
-            {
-                dprintf( fd,
-                        "%c\"[%d]%s\":%s",
-                        prefix,
-                        info->instanceID,
-                        info->name,
-                        value );
-            }
+            result = MSGBUF_Append( pMsgBuf, key, keylen );
+        }
+
+        if ( ( result == EOK ) && ( json == false ) )
+        {
+            result = MSGBUF_AppendChar( pMsgBuf, '"' );
+        }
+
+        if ( result != EOK )
+        {
+            /* the key could not be appended */
+        }
+        else if ( ( json == true ) || ( scan.escape == false ) )
+        {
+            result = MSGBUF_Append( pMsgBuf, value, scan.len );
         }
         else
         {
-            if ( info->instanceID == 0 )
-            {
-                dprintf( fd,
-                        "%c\"%s\":\"%s\"",
-                        prefix,
-                        info->name,
-                        value );
-            }
-            else
-            {
-                dprintf( fd,
-                        "%c\"[%d]%s\":\"%s\"",
-                        prefix,
-                        info->instanceID,
-                        info->name,
-                        value );
-            }
+            result = MSGBUF_AppendEscaped( pMsgBuf, value, scan.len );
         }
 
-        result = EOK;
+        if ( ( result == EOK ) && ( json == false ) )
+        {
+            result = MSGBUF_AppendChar( pMsgBuf, '"' );
+        }
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  IsJSON                                                                    */
+/*  OutputCBORVar                                                             */
 /*!
-    Determine if the string is a JSON object
+    Output a scalar variable as a CBOR map entry
 
-    The IsJSON function examines the non-whitespace characters at the
-    beginning and end of the value to determine if the value is likely
-    a JSON object.  If the first and last non-whitespace characters are
-    [ and ] or { and }, then the value is likely a JSON object
+    The OutputCBORVar function appends the pre-encoded CBOR key of the
+    variable, followed by its value encoded directly from the variable
+    object as a CBOR integer or single precision float.
 
     @param[in]
-        value
-            value to be checked to see if it is JSON
+        pMsgBuf
+            pointer to the message buffer to append to
+
+    @param[in]
+        pTable
+            pointer to the variable information table
+
+    @param[in]
+        pMeta
+            pointer to the information for the variable to output
 
+    @param[in]
+        obj
+            pointer to the variable object to encode
 
-    @retval true the value is likely a JSON object
-    @retval false the value is not a JSON object
+    @retval EOK the map entry was output
+    @retval ENOTSUP the variable is not a scalar type
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
 
 ==============================================================================*/
-static bool IsJSON( char *value )
+static int OutputCBORVar( MsgBuf *pMsgBuf,
+                          VarMetaTable *pTable,
+                          VarMeta *pMeta,
+                          VarObject *obj )
 {
-    char c_start = ' ';
-    char c_end = ' ';
-    bool result = false;
-    int i=0;
-    int len;
+    int result = EINVAL;
+    size_t len;
 
-    if ( value != NULL )
+    if ( ( pMsgBuf != NULL ) &&
+         ( pTable != NULL ) &&
+         ( pMeta != NULL ) &&
+         ( obj != NULL ) )
     {
-        // get the length of the string
-        len = strlen(value);
-        if ( len > 0 )
+        /* remember where the entry starts in case it is not supported */
+        len = pMsgBuf->len;
+
+        result = MSGBUF_Append( pMsgBuf,
+                                &pTable->keys.pData[pMeta->keyOffset],
+                                pMeta->keyLen );
+        if ( result == EOK )
         {
-            // get the first non-space character at the
-            // beginning of the value
-            while(isspace(value[i]) && ( i < len))
+            switch( obj->type )
             {
-                i++;
-            }
+                case VARTYPE_UINT16:
+                    result = CBOR_AppendUInt( pMsgBuf, obj->val.ui );
+                    break;
 
-            if ( i < len )
-            {
-                c_start = value[i];
-            }
+                case VARTYPE_INT16:
+                    result = CBOR_AppendInt( pMsgBuf, obj->val.i );
+                    break;
 
-            // search for the first non-whitespace character at the
-            // end of the value
-            i = len-1;
-            while(isspace(value[i]) && ( i >= 0 ))
-            {
-                i--;
-            }
+                case VARTYPE_UINT32:
+                    result = CBOR_AppendUInt( pMsgBuf, obj->val.ul );
+                    break;
 
-            if ( i >= 0 )
-            {
-                c_end = value[i];
-            }
+                case VARTYPE_INT32:
+                    result = CBOR_AppendInt( pMsgBuf, obj->val.l );
+                    break;
 
-            // check if we have a JSON object
-            if ( ( c_start == '[' && c_end == ']' ) ||
-                ( c_start == '{' && c_end == '}' ) )
-            {
-                // probably a JSON object since the start and end
-                // characters of the value are '
-                result = true;
+                case VARTYPE_UINT64:
+                    result = CBOR_AppendUInt( pMsgBuf, obj->val.ull );
+                    break;
+
+                case VARTYPE_INT64:
+                    result = CBOR_AppendInt( pMsgBuf, obj->val.ll );
+                    break;
+
+                case VARTYPE_FLOAT:
+                    result = CBOR_AppendFloat( pMsgBuf, obj->val.f );
+                    break;
+
+                default:
+                    result = ENOTSUP;
+                    break;
             }
         }
+
+        if ( result != EOK )
+        {
+            /* leave the key out of the message */
+            pMsgBuf->len = len;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  OutputCBORText                                                            */
+/*!
+    Output a printed variable as a CBOR map entry
+
+    The OutputCBORText function appends the pre-encoded CBOR key of the
+    variable, followed by its printed value as a CBOR text string.
+
+    @param[in]
+        pMsgBuf
+            pointer to the message buffer to append to
+
+    @param[in]
+        pTable
+            pointer to the variable information table
+
+    @param[in]
+        pMeta
+            pointer to the information for the variable to output
+
+    @param[in]
+        value
+            NUL terminated printed value of the variable
+
+    @retval EOK the map entry was output
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int OutputCBORText( MsgBuf *pMsgBuf,
+                           VarMetaTable *pTable,
+                           VarMeta *pMeta,
+                           char *value )
+{
+    int result = EINVAL;
+
+    if ( ( pMsgBuf != NULL ) &&
+         ( pTable != NULL ) &&
+         ( pMeta != NULL ) &&
+         ( value != NULL ) )
+    {
+        result = MSGBUF_Append( pMsgBuf,
+                                &pTable->keys.pData[pMeta->keyOffset],
+                                pMeta->keyLen );
+        if ( result == EOK )
+        {
+            result = CBOR_AppendText( pMsgBuf, value, strlen( value ) );
+        }
     }
 
     return result;
@@ -1931,6 +9571,8 @@ static void SetupTerminationHandler( void )
 ==============================================================================*/
 static void TerminationHandler( int signum, siginfo_t *info, void *ptr )
 {
+    uint32_t i;
+
     /* signum, info, and ptr are unused */
     (void)signum;
     (void)info;
@@ -1943,12 +9585,30 @@ static void TerminationHandler( int signum, siginfo_t *info, void *ptr )
         VARSERVER_Close( state.hVarServer );
     }
 
-    if ( state.pVarFP != NULL )
+    if ( state.render.pVarFP != NULL )
     {
         /* close the output memory buffer */
-        VARFP_Close( state.pVarFP );
+        VARFP_Close( state.render.pVarFP );
+    }
+
+    for ( i = 0; ( state.pWorkers != NULL ) && ( i < state.numWorkers ); i++ )
+    {
+        /* close the render worker variable server handles */
+        if ( state.pWorkers[i].hVarServer != NULL )
+        {
+            VARSERVER_Close( state.pWorkers[i].hVarServer );
+        }
+
+        /* close the render worker output memory buffers */
+        if ( state.pWorkers[i].pVarFP != NULL )
+        {
+            VARFP_Close( state.pWorkers[i].pVarFP );
+        }
     }
 
+    /* flush and close the message outputs */
+    SINK_CloseAll();
+
     exit( 1 );
 }
 
@@ -1958,12 +9618,21 @@ static void TerminationHandler( int signum, siginfo_t *info, void *ptr )
     Set up the message variables
 
     The SetupMessageVars function creates and configures the following
-    variables for the specied message:
+    variables for the specied message, and adds the control variables
+    to the variable index:
 
     <prefix>trigger - variable to manually trigger message generation
     <prefix>txcount - count the number of times the message has been generated
     <prefix>errcount - count the number of errors during message generation
+    <prefix>coalesced - count the triggers collapsed into a pending message
     <prefix>enable - enable (non-zero) or disable (zero) message generation
+    <prefix>rescan - rerun the variable queries of the message
+    <prefix>render_us - time taken by the last render in microseconds
+    <prefix>render_avg_us - average render time in microseconds
+    <prefix>render_max_us - longest render time in microseconds
+    <prefix>sink_us - average time taken to write to the output
+    <prefix>bytes - count the number of bytes sent
+    <prefix>varcount - count the number of variables rendered
 
     @param[in]
         pState
@@ -1990,23 +9659,94 @@ static int SetupMessageVars( VarMsgState *pState, VarMsgConfig *pConfig )
     {
         { "trigger",
            VARFLAG_TRIGGER | VARFLAG_VOLATILE,
+           VARTYPE_UINT32,
            NOTIFY_MODIFIED,
+           VARROLE_MSGTRIGGER,
            &(pConfig->hTrigger) },
 
         { "txcount",
           VARFLAG_VOLATILE,
+          VARTYPE_UINT32,
           NOTIFY_NONE,
+          0,
           &(pConfig->hTxCount ) },
 
         { "errcount",
           VARFLAG_VOLATILE,
+          VARTYPE_UINT32,
           NOTIFY_NONE,
+          0,
           &(pConfig->hErrCount ) },
 
+        { "coalesced",
+          VARFLAG_VOLATILE,
+          VARTYPE_UINT32,
+          NOTIFY_NONE,
+          0,
+          &(pConfig->hCoalesced ) },
+
+        { "dropped",
+          VARFLAG_VOLATILE,
+          VARTYPE_UINT32,
+          NOTIFY_NONE,
+          0,
+          &(pConfig->hDropped ) },
+
         { "enable",
           VARFLAG_NONE,
+          VARTYPE_UINT32,
+          NOTIFY_MODIFIED,
+          VARROLE_ENABLE,
+          &(pConfig->hEnable ) },
+
+        { "rescan",
+          VARFLAG_TRIGGER | VARFLAG_VOLATILE,
+          VARTYPE_UINT32,
           NOTIFY_MODIFIED,
-          &(pConfig->hEnable ) }
+          VARROLE_RESCAN,
+          &(pConfig->hRescan ) },
+
+        { "render_us",
+          VARFLAG_VOLATILE,
+          VARTYPE_UINT32,
+          NOTIFY_NONE,
+          0,
+          &(pConfig->hRenderUs ) },
+
+        { "render_avg_us",
+          VARFLAG_VOLATILE,
+          VARTYPE_UINT32,
+          NOTIFY_NONE,
+          0,
+          &(pConfig->hRenderAvgUs ) },
+
+        { "render_max_us",
+          VARFLAG_VOLATILE,
+          VARTYPE_UINT32,
+          NOTIFY_NONE,
+          0,
+          &(pConfig->hRenderMaxUs ) },
+
+        { "sink_us",
+          VARFLAG_VOLATILE,
+          VARTYPE_UINT32,
+          NOTIFY_NONE,
+          0,
+          &(pConfig->hSinkUs ) },
+
+        { "bytes",
+          VARFLAG_VOLATILE,
+          VARTYPE_UINT64,
+          NOTIFY_NONE,
+          0,
+          &(pConfig->hBytes ) },
+
+        { "varcount",
+          VARFLAG_VOLATILE,
+          VARTYPE_UINT64,
+          NOTIFY_NONE,
+          0,
+          &(pConfig->hVarCount ) }
     };
 
     n = sizeof( vars ) / sizeof( vars[0] );
@@ -2025,12 +9765,23 @@ static int SetupMessageVars( VarMsgState *pState, VarMsgConfig *pConfig )
                                                pConfig,
                                                vars[i].name,
                                                vars[i].flags,
+                                               vars[i].type,
                                                vars[i].notifyType );
                 if ( *pVarHandle == VAR_INVALID )
                 {
                     printf("Error creating variable: %s\n", vars[i].name );
                     errcount++;
                 }
+                else if ( ( vars[i].role != 0 ) &&
+                          ( VARINDEX_Add( &pState->index,
+                                          *pVarHandle,
+                                          vars[i].role,
+                                          0,
+                                          pConfig ) != EOK ) )
+                {
+                    printf("Error indexing variable: %s\n", vars[i].name );
+                    errcount++;
+                }
             }
         }
     }
@@ -2074,7 +9825,7 @@ static int SetEnableStatus( VarMsgState *pState, VarMsgConfig *pConfig )
          ( pConfig != NULL ) )
     {
         obj.type = VARTYPE_UINT32;
-        obj.val.ul = pConfig->enabled == true ? 1 : 0;
+        obj.val.ul = pState->msgs.pEnabled[pConfig->id] == true ? 1 : 0;
         result = VAR_Set( pState->hVarServer, pConfig->hEnable, &obj );
     }
 
@@ -2106,6 +9857,10 @@ static int SetEnableStatus( VarMsgState *pState, VarMsgConfig *pConfig )
     flags
         flags to add to the variable flag set
 
+@param[in]
+    type
+        type of the variable to create
+
 @param[in]
     notify
         specify the notification type.  Use NOTIFY_NONE if no notification is
@@ -2116,6 +9871,7 @@ VAR_HANDLE SetupMessageVar( VarMsgState *pState,
                             VarMsgConfig *pConfig,
                             char *name,
                             uint32_t flags,
+                            VarType type,
                             NotificationType notify )
 {
     VAR_HANDLE hVar = VAR_INVALID;
@@ -2129,7 +9885,7 @@ VAR_HANDLE SetupMessageVar( VarMsgState *pState,
         memset( &info, 0, sizeof( VarInfo ) );
 
         info.flags = flags;
-        info.var.type = VARTYPE_UINT32;
+        info.var.type = type;
 
         /* make a variable name */
         result = MakeVarName( pConfig->prefix,
@@ -2199,7 +9955,7 @@ static int MakeVarName( char *prefix,
                         char *out,
                         size_t outlen )
 {
-    size_t prefixlen;
+    size_t prefixlen = 0;
     size_t namelen;
     int result = EINVAL;
 